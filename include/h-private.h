@@ -27,6 +27,71 @@
 /** Macro to avoid compiler warning when some parameters are unused and that's ok **/
 #define UNUSED(x) (void)(x)
 
+/**
+ * Value of a column decoded by a backend, before it's stored in a struct _h_result
+ * text and blob values are not copied, value points to the backend buffer
+ */
+struct _h_cell {
+  int           type;
+  long long int i_value;
+  double        d_value;
+  struct tm     dt_value;
+  const void  * value;
+  size_t        length;
+};
+
+/**
+ * Growable buffer used to build the sql queries
+ * The buffer size is doubled when it's full, so building a query is linear in its length
+ * error is set if an allocation failed, the next appends are then ignored
+ * str is always NULL-terminated when it's not NULL
+ */
+struct _h_sql_buffer {
+  char * str;
+  size_t len;
+  size_t size;
+  int    error;
+};
+
+/**
+ * Allocate a new empty arena
+ * return pointer to the new arena
+ * return NULL on error
+ */
+void * h_arena_new(void);
+
+/**
+ * Allocate size bytes in the arena
+ * The memory is released by h_arena_free only
+ * return pointer to the allocated memory
+ * return NULL on error
+ */
+void * h_arena_alloc(void * arena, size_t size);
+
+/**
+ * Free all the chunks of the arena and the arena itself
+ */
+void h_arena_free(void * arena);
+
+/**
+ * Initialize an empty result with nb_columns columns
+ * if options has H_OPTION_ARENA set, the rows and values will be allocated in an arena
+ * return H_OK on success
+ */
+int h_result_init(struct _h_result * result, unsigned int nb_columns, int options);
+
+/**
+ * Append a new row to the result, all the columns are set to NULL
+ * return H_OK on success
+ */
+int h_result_new_row(struct _h_result * result, struct _h_data ** row);
+
+/**
+ * Set the value of a cell of the result from a decoded column value
+ * return H_OK on success
+ */
+int h_result_set_cell(struct _h_result * result, struct _h_data * data, const struct _h_cell * cell);
+
 /**
  * Add a new struct _h_data * to an array of struct _h_data *, which already has cols columns
  * return H_OK on success
@@ -35,7 +100,8 @@ int h_row_add_data(struct _h_data ** result, struct _h_data * data, int cols);
 
 /**
  * Add a new row of struct _h_data * in a struct _h_result *
- * return H_OK on success
+ * The rows of a result allocated in an arena must be added with h_result_new_row
+ * return H_OK on success, H_ERROR_PARAMS if the result has an arena
  */
 int h_result_add_row(struct _h_result * result, struct _h_data * row, int rows);
 
@@ -81,4 +147,559 @@ struct _h_data * h_new_data_datetime(const struct tm * datetime);
  */
 struct _h_data * h_new_data_null(void);
 
+/**
+ * Convert a struct tm in UTC into a number of seconds since epoch
+ */
+long long int h_tm_to_epoch(const struct tm * tm);
+
+/**
+ * Initialize an empty columnar result with nb_columns columns
+ * return H_OK on success
+ */
+int h_result_columnar_init(struct _h_result_columnar * result, unsigned int nb_columns);
+
+/**
+ * Set the name of the column col
+ * return H_OK on success
+ */
+int h_result_columnar_set_name(struct _h_result_columnar * result, unsigned int col, const char * name);
+
+/**
+ * Append a new row to the columnar result, all the values are set to null
+ * return H_OK on success
+ */
+int h_result_columnar_new_row(struct _h_result_columnar * result);
+
+/**
+ * Set the value of the column col in the last row of the columnar result
+ * The column type is widened if the value has a different type
+ * return H_OK on success
+ */
+int h_result_columnar_set_cell(struct _h_result_columnar * result, unsigned int col, const struct _h_cell * cell);
+
+/**
+ * Initialize an empty value result with nb_columns columns
+ * return H_OK on success
+ */
+int h_value_result_init(struct _h_value_result * result, unsigned int nb_columns);
+
+/**
+ * Append a new row to the value result, all the values are set to null
+ * return H_OK on success
+ */
+int h_value_result_new_row(struct _h_value_result * result, struct _h_value ** row);
+
+/**
+ * Set a value of the value result from a decoded column value
+ * return H_OK on success
+ */
+int h_value_result_set_cell(struct _h_value_result * result, struct _h_value * value, const struct _h_cell * cell);
+
+/**
+ * Return the value of the column col in the row row of a mariadb result view as returned by the database
+ * row and col must be in bounds
+ */
+const char * h_result_view_get_value_mariadb(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length);
+
+/**
+ * Return the value of the column col in the row row of a pgsql result view as returned by the database
+ * row and col must be in bounds
+ */
+const char * h_result_view_get_value_pgsql(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length);
+
+/**
+ * Decode the value of the column col in the row row of a mariadb result view
+ * row and col must be in bounds
+ */
+void h_result_view_get_cell_mariadb(const struct _h_result_view * view, unsigned int row, unsigned int col, struct _h_cell * cell);
+
+/**
+ * Decode the value of the column col in the row row of a pgsql result view
+ * row and col must be in bounds
+ */
+void h_result_view_get_cell_pgsql(const struct _h_result_view * view, unsigned int row, unsigned int col, struct _h_cell * cell);
+
+/**
+ * Convert a decoded column value into a json_t *
+ * dates are converted into a string in ISO 8601 format
+ * return NULL on error
+ */
+json_t * h_cell_to_json(const struct _h_cell * cell);
+
+/**
+ * Allocate the json result of a query
+ * j_result is a json array of json objects,
+ * or a json object {"columns":[],"rows":[]} if options has H_OPTION_JSON_COMPACT
+ * j_rows is set to the json array where the rows must be appended
+ * return H_OK on success
+ */
+int h_json_result_init(json_t ** j_result, json_t ** j_rows, int options);
+
+/**
+ * Add the column name to the columns list of a compact json result
+ * Does nothing if j_result isn't compact
+ */
+void h_json_result_add_column(json_t * j_result, const char * name);
+
+/**
+ * Allocate a new json row, a json object, or a json array if options has H_OPTION_JSON_COMPACT
+ * return NULL on error
+ */
+json_t * h_json_row_new(int options);
+
+/**
+ * Set the value of the column name in the json row
+ * j_value is appended if j_row is an array
+ */
+void h_json_row_set(json_t * j_row, const char * name, json_t * j_value);
+
+/**
+ * Prepare the query on a sqlite connection, set stmt->nb_params and stmt->handle
+ * return H_OK on success
+ */
+int h_prepare_sqlite(const struct _h_connection * conn, const char * query, struct _h_statement * stmt);
+
+/**
+ * Execute the sqlite prepared statement with the values bound and set the cursor on the rows returned
+ * return H_OK on success
+ */
+int h_cursor_open_prepared_sqlite(struct _h_statement * stmt, struct _h_cursor * cursor);
+
+/**
+ * Free the sqlite prepared statement
+ */
+void h_finalize_sqlite(struct _h_statement * stmt);
+
+/**
+ * Prepare the query on a mariadb connection, set stmt->nb_params and stmt->handle
+ * return H_OK on success
+ */
+int h_prepare_mariadb(const struct _h_connection * conn, const char * query, struct _h_statement * stmt);
+
+/**
+ * Execute the mariadb prepared statement with the values bound and set the cursor on the rows returned
+ * return H_OK on success
+ */
+int h_cursor_open_prepared_mariadb(struct _h_statement * stmt, struct _h_cursor * cursor);
+
+/**
+ * Free the mariadb prepared statement
+ */
+void h_finalize_mariadb(struct _h_statement * stmt);
+
+/**
+ * Return the thread id of the server session of a mariadb connection, it changes when the client reconnects
+ */
+unsigned long h_session_id_mariadb(const struct _h_connection * conn);
+
+/**
+ * Prepare the query on a pgsql connection, set stmt->nb_params and stmt->handle
+ * return H_OK on success
+ */
+int h_prepare_pgsql(const struct _h_connection * conn, const char * query, struct _h_statement * stmt);
+
+/**
+ * Execute the pgsql prepared statement with the values bound and set the cursor on the rows returned
+ * return H_OK on success
+ */
+int h_cursor_open_prepared_pgsql(struct _h_statement * stmt, struct _h_cursor * cursor);
+
+/**
+ * Free the pgsql prepared statement
+ */
+void h_finalize_pgsql(struct _h_statement * stmt);
+
+/**
+ * Check if an asynchronous query, a pipeline or a cursor is running on a pgsql connection
+ * return 1 if the connection is busy, 0 otherwise
+ */
+int h_connection_busy_pgsql(const struct _h_connection * conn);
+
+/**
+ * Return the process id of the server backend of a pgsql connection, it changes when the connection is reset
+ */
+unsigned long h_session_id_pgsql(const struct _h_connection * conn);
+
+/**
+ * Execute the query and set the sqlite cursor on the rows returned
+ * return H_OK on success
+ */
+int h_cursor_open_sqlite(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor);
+
+/**
+ * Read the next row of a sqlite cursor, set cursor->end if there's no more row
+ * return H_OK on success
+ */
+int h_cursor_fetch_sqlite(struct _h_cursor * cursor);
+
+/**
+ * Decode the value of the column col in the current row of a sqlite cursor
+ */
+void h_cursor_get_cell_sqlite(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell);
+
+/**
+ * Return the name of the column col of a sqlite cursor
+ */
+const char * h_cursor_get_name_sqlite(const struct _h_cursor * cursor, unsigned int col);
+
+/**
+ * Close a sqlite cursor
+ */
+void h_cursor_close_sqlite(struct _h_cursor * cursor);
+
+/**
+ * Execute the query and set the mariadb cursor on the rows returned
+ * return H_OK on success
+ */
+int h_cursor_open_mariadb(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor);
+
+/**
+ * Read the next row of a mariadb cursor, set cursor->end if there's no more row
+ * return H_OK on success
+ */
+int h_cursor_fetch_mariadb(struct _h_cursor * cursor);
+
+/**
+ * Decode the value of the column col in the current row of a mariadb cursor
+ */
+void h_cursor_get_cell_mariadb(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell);
+
+/**
+ * Return the name of the column col of a mariadb cursor
+ */
+const char * h_cursor_get_name_mariadb(const struct _h_cursor * cursor, unsigned int col);
+
+/**
+ * Close a mariadb cursor
+ */
+void h_cursor_close_mariadb(struct _h_cursor * cursor);
+
+/**
+ * Execute the query and set the pgsql cursor on the rows returned
+ * return H_OK on success
+ */
+int h_cursor_open_pgsql(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor);
+
+/**
+ * Read the next row of a pgsql cursor, set cursor->end if there's no more row
+ * return H_OK on success
+ */
+int h_cursor_fetch_pgsql(struct _h_cursor * cursor);
+
+/**
+ * Decode the value of the column col in the current row of a pgsql cursor
+ */
+void h_cursor_get_cell_pgsql(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell);
+
+/**
+ * Return the name of the column col of a pgsql cursor
+ */
+const char * h_cursor_get_name_pgsql(const struct _h_cursor * cursor, unsigned int col);
+
+/**
+ * Close a pgsql cursor
+ */
+void h_cursor_close_pgsql(struct _h_cursor * cursor);
+
+/**
+ * Send a query on a pgsql connection without waiting for its result
+ * return H_OK on success
+ */
+int h_async_send_pgsql(const struct _h_connection * conn, const char * query);
+
+/**
+ * Send the pgsql prepared statement with the values bound without waiting for its result
+ * return H_OK on success
+ */
+int h_async_send_prepared_pgsql(struct _h_statement * stmt);
+
+/**
+ * Read the data available on the socket of a pgsql connection
+ * return H_OK if the result of the asynchronous query is ready, H_AGAIN if it's not
+ */
+int h_async_poll_pgsql(const struct _h_connection * conn);
+
+/**
+ * Read the result of the asynchronous query on a pgsql connection
+ * return H_OK on success
+ */
+int h_async_get_result_pgsql(const struct _h_connection * conn, struct _h_result * result, int options);
+
+/**
+ * Read the result of the asynchronous query on a pgsql connection as a json array
+ * return H_OK on success
+ */
+int h_async_get_result_json_pgsql(const struct _h_connection * conn, json_t ** j_result, int options);
+
+/**
+ * Return the socket of a pgsql connection
+ */
+int h_get_socket_fd_pgsql(const struct _h_connection * conn);
+
+/**
+ * Send a query on a mariadb connection without waiting for its result
+ * return H_OK on success
+ */
+int h_async_send_mariadb(const struct _h_connection * conn, const char * query);
+
+/**
+ * Continue the asynchronous query on a mariadb connection if the socket is ready
+ * return H_OK if the result of the asynchronous query is ready, H_AGAIN if it's not
+ */
+int h_async_poll_mariadb(const struct _h_connection * conn);
+
+/**
+ * Read the result of the asynchronous query on a mariadb connection
+ * return H_OK on success
+ */
+int h_async_get_result_mariadb(const struct _h_connection * conn, struct _h_result * result, int options);
+
+/**
+ * Read the result of the asynchronous query on a mariadb connection as a json array
+ * return H_OK on success
+ */
+int h_async_get_result_json_mariadb(const struct _h_connection * conn, json_t ** j_result, int options);
+
+/**
+ * Return the socket of a mariadb connection
+ */
+int h_get_socket_fd_mariadb(const struct _h_connection * conn);
+
+/**
+ * Enter pipeline mode on a pgsql connection
+ * return H_OK on success
+ */
+int h_pipeline_begin_pgsql(const struct _h_connection * conn);
+
+/**
+ * Queue a query in the pipeline of a pgsql connection
+ * return H_OK on success
+ */
+int h_pipeline_queue_pgsql(const struct _h_connection * conn, const char * query);
+
+/**
+ * Queue the pgsql prepared statement with the values bound in the pipeline of its connection
+ * return H_OK on success
+ */
+int h_pipeline_queue_prepared_pgsql(struct _h_statement * stmt);
+
+/**
+ * Send a sync point in the pipeline of a pgsql connection
+ * return H_OK on success
+ */
+int h_pipeline_sync_pgsql(const struct _h_connection * conn);
+
+/**
+ * Read the result of the next query of the pipeline of a pgsql connection
+ * return H_OK on success
+ */
+int h_pipeline_get_result_pgsql(const struct _h_connection * conn, struct _h_result * result, int options);
+
+/**
+ * Read the result of the next query of the pipeline of a pgsql connection as a json array
+ * return H_OK on success
+ */
+int h_pipeline_get_result_json_pgsql(const struct _h_connection * conn, json_t ** j_result, int options);
+
+/**
+ * Read the results left in the pipeline and exit pipeline mode on a pgsql connection
+ * return H_OK on success
+ */
+int h_pipeline_end_pgsql(const struct _h_connection * conn);
+
+/**
+ * Insert the rows of j_values in the table with COPY FROM STDIN on a pgsql connection
+ * return H_OK on success
+ */
+int h_bulk_insert_pgsql(const struct _h_connection * conn, const char * table, const json_t * j_values);
+
+/**
+ * Insert the rows of j_values in the table with array binding on a mariadb connection
+ * return H_OK on success
+ */
+int h_bulk_insert_mariadb(const struct _h_connection * conn, const char * table, const json_t * j_values);
+
+/**
+ * Insert the rows of j_values in the table with a single prepared statement in a transaction on a sqlite connection
+ * return H_OK on success
+ */
+int h_bulk_insert_sqlite(const struct _h_connection * conn, const char * table, const json_t * j_values);
+
+/**
+ * Start a transaction on a sqlite connection and keep the connection locked
+ * return H_OK on success
+ */
+int h_transaction_begin_sqlite(const struct _h_connection * conn);
+
+/**
+ * Commit or rollback the transaction on a sqlite connection and unlock the connection
+ * return H_OK on success
+ */
+int h_transaction_end_sqlite(const struct _h_connection * conn, int commit);
+
+/**
+ * Execute a savepoint query in the transaction of a sqlite connection
+ * return H_OK on success
+ */
+int h_transaction_query_sqlite(const struct _h_connection * conn, const char * query);
+
+/**
+ * Check if a transaction is open on a sqlite connection, started with h_transaction_begin or by a query
+ * return 1 if a transaction is open, 0 otherwise
+ */
+int h_in_transaction_sqlite(const struct _h_connection * conn);
+
+/**
+ * Start a transaction on a mariadb connection and keep the connection locked
+ * return H_OK on success
+ */
+int h_transaction_begin_mariadb(const struct _h_connection * conn);
+
+/**
+ * Commit or rollback the transaction on a mariadb connection and unlock the connection
+ * return H_OK on success
+ */
+int h_transaction_end_mariadb(const struct _h_connection * conn, int commit);
+
+/**
+ * Execute a savepoint query in the transaction of a mariadb connection
+ * return H_OK on success
+ */
+int h_transaction_query_mariadb(const struct _h_connection * conn, const char * query);
+
+/**
+ * Check if a transaction is open on a mariadb connection, started with h_transaction_begin or by a query
+ * return 1 if a transaction is open, 0 otherwise
+ */
+int h_in_transaction_mariadb(const struct _h_connection * conn);
+
+/**
+ * Start a transaction on a pgsql connection and keep the connection locked
+ * return H_OK on success
+ */
+int h_transaction_begin_pgsql(const struct _h_connection * conn);
+
+/**
+ * Commit or rollback the transaction on a pgsql connection and unlock the connection
+ * return H_OK on success
+ */
+int h_transaction_end_pgsql(const struct _h_connection * conn, int commit);
+
+/**
+ * Execute a savepoint query in the transaction of a pgsql connection
+ * return H_OK on success
+ */
+int h_transaction_query_pgsql(const struct _h_connection * conn, const char * query);
+
+/**
+ * Check if a transaction is open on a pgsql connection, started with h_transaction_begin or by a query
+ * return 1 if a transaction is open, 0 otherwise
+ */
+int h_in_transaction_pgsql(const struct _h_connection * conn);
+
+/**
+ * Initialize the cache of the statements prepared by h_select, h_update and h_delete
+ * If the cache can't be allocated, the queries are executed with the values inlined
+ */
+void h_json_cache_init(struct _h_connection * conn);
+
+/**
+ * Set the maximum number of statements kept in the json statement cache, 0 disables the cache
+ * return H_OK on success
+ */
+int h_json_cache_set_size(const struct _h_connection * conn, unsigned int size);
+
+/**
+ * Get the number of statements reused from the json statement cache and the number of statements prepared
+ * return H_OK on success
+ */
+int h_json_cache_get_stats(const struct _h_connection * conn, unsigned long * nb_hits, unsigned long * nb_prepared);
+
+/**
+ * Finalize the statements of the json statement cache and free the cache
+ * Must be called before the database connection is closed
+ */
+void h_json_cache_clean(struct _h_connection * conn);
+
+/**
+ * Return the maximum length of a sql query on a sqlite connection
+ */
+size_t h_max_query_length_sqlite(const struct _h_connection * conn);
+
+/**
+ * Return the maximum length of a sql query on a mariadb connection, 0 if unknown
+ */
+size_t h_max_query_length_mariadb(const struct _h_connection * conn);
+
+/**
+ * Check that the values of an insert query are a non empty json array of non empty json objects
+ * return H_OK on success
+ */
+int h_insert_check_values(const json_t * j_values);
+
+/**
+ * Get the maximum number of rows and bytes of the insert queries of j_query, with the default limits if chunks is set
+ */
+void h_insert_chunk_limits(const struct _h_connection * conn, const json_t * j_query, int chunks, size_t * max_rows, size_t * max_bytes);
+
+/**
+ * Builds an insert query with at most max_rows rows and max_bytes bytes of j_values from offset
+ * nb_rows is set to the number of rows in the query
+ * Returned value must be h_free'd after use
+ */
+char * h_get_insert_query_chunk(const struct _h_connection * conn, const json_t * j_values, const char * table, size_t offset, size_t max_rows, size_t max_bytes, size_t * nb_rows);
+
+/**
+ * Create the report of an insert chunk
+ */
+json_t * h_insert_chunk_report(size_t offset, size_t nb_rows, int result);
+
+/**
+ * Initialize an empty sql buffer
+ */
+void h_sql_buffer_init(struct _h_sql_buffer * buffer);
+
+/**
+ * Free the string of the sql buffer and empty it
+ */
+void h_sql_buffer_clean(struct _h_sql_buffer * buffer);
+
+/**
+ * Append the len first characters of str to the sql buffer
+ */
+void h_sql_buffer_append_len(struct _h_sql_buffer * buffer, const char * str, size_t len);
+
+/**
+ * Append str to the sql buffer
+ */
+void h_sql_buffer_append(struct _h_sql_buffer * buffer, const char * str);
+
+/**
+ * Append a formatted string to the sql buffer
+ */
+void h_sql_buffer_appendf(struct _h_sql_buffer * buffer, const char * format, ...);
+
+/**
+ * Append a string value escaped and quoted for the database of the connection to the sql buffer
+ */
+void h_sql_buffer_append_escaped(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const char * value);
+
+/**
+ * Return the string built in the sql buffer, must be h_free'd after use
+ * return NULL if an error occured while building the string
+ */
+char * h_sql_buffer_release(struct _h_sql_buffer * buffer);
+
+/**
+ * Get the columns of a bulk insert, the keys of the first row of j_values
+ * columns is set to an array of nb_columns names borrowed from the first row, it must be h_free'd after use
+ * return H_OK on success, H_ERROR_PARAMS if a row isn't a json object or has a key missing in the first row
+ */
+int h_bulk_insert_columns(const json_t * j_values, const char *** columns, size_t * nb_columns);
+
+/**
+ * Append the columns of a bulk insert to the sql buffer, separated by commas
+ */
+void h_sql_buffer_append_columns(struct _h_sql_buffer * buffer, const char ** columns, size_t nb_columns);
+
 #endif /* __H_PRIVATE_H_ */
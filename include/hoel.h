@@ -66,11 +66,18 @@ extern "C"
 #define H_ERROR_PARAMS      2  /* Error in input parameters */
 #define H_ERROR_CONNECTION  3  /* Error in database connection */
 #define H_ERROR_QUERY       4  /* Error executing query */
+#define H_ERROR_TIMEOUT     5  /* Timeout waiting for a connection */
+#define H_AGAIN             6  /* The result of an asynchronous query isn't ready yet */
 #define H_ERROR_MEMORY      99 /* Error allocating memory */
 
 #define H_OPTION_NONE   0x0000 /* Nothing whatsoever */
 #define H_OPTION_SELECT 0x0001 /* Execute a SELECT statement */
 #define H_OPTION_EXEC   0x0010 /* Execute an INSERT, UPDATE or DELETE statement */
+#define H_OPTION_ARENA  0x0100 /* Allocate the result rows and values in an arena owned by the result */
+#define H_OPTION_JSON_COMPACT 0x0200 /* Return a json result {"columns":[],"rows":[[]]} */
+#define H_OPTION_BINARY 0x0400 /* Receive the values in binary format (PostgreSQL and MariaDB only) */
+
+#define H_POOL_DEFAULT_TIMEOUT 30000 /* Default time in milliseconds to wait for a connection of a pool */
 
 /**
  * @}
@@ -87,6 +94,24 @@ extern "C"
 struct _h_connection {
   int type;
   void * connection;
+  struct _h_json_cache * json_cache; /* Prepared statements of h_select, h_update and h_delete */
+};
+
+/**
+ * connection pool
+ * The connections are created at startup and checked out by one thread at a time
+ */
+struct _h_pool {
+  int                     type;         /* Database type of the connections */
+  char                 ** params;       /* Connection parameters, used to reconnect */
+  unsigned int            port;         /* MariaDB TCP port */
+  unsigned int            size;         /* Number of connections */
+  struct _h_connection ** connections;  /* Connections, NULL if a reconnection has failed */
+  unsigned int          * available;    /* Stack of the indexes of the connections available */
+  unsigned int            nb_available; /* Number of connections available */
+  unsigned int            timeout;      /* Time in milliseconds to wait for a connection */
+  pthread_mutex_t         lock;
+  pthread_cond_t          cond;
 };
 
 /**
@@ -136,11 +161,139 @@ struct _h_data {
 
 /**
  * sql result structure
+ * if arena is not NULL, the rows and the values are allocated in the arena,
+ * they can't be cleaned individually and are all released by h_clean_result
  */
 struct _h_result {
   unsigned int      nb_rows;
   unsigned int      nb_columns;
   struct _h_data ** data;
+  void            * arena;
+};
+
+/**
+ * Maximum length of a text or blob value stored inline in a struct _h_value
+ */
+#define H_VALUE_INLINE_LENGTH 15
+
+/**
+ * sql value with its data stored inline
+ * type is the type of the value:
+ * - HOEL_COL_TYPE_INT: the value is in i_value
+ * - HOEL_COL_TYPE_DOUBLE: the value is in d_value
+ * - HOEL_COL_TYPE_DATE: the value is in i_value as a number of seconds since epoch (UTC)
+ * - HOEL_COL_TYPE_TEXT or HOEL_COL_TYPE_BLOB: if length is at most H_VALUE_INLINE_LENGTH,
+ *   the value is in text, otherwise it's pointed by ptr,
+ *   use h_value_get_bytes to get a pointer to the value whatever its length
+ *   text values are always '\0'-terminated
+ * - HOEL_COL_TYPE_NULL: null value
+ */
+struct _h_value {
+  int    type;
+  size_t length;
+  union {
+    long long int i_value;
+    double        d_value;
+    char        * ptr;
+    char          text[H_VALUE_INLINE_LENGTH+1];
+  } v;
+};
+
+/**
+ * sql result structure with inline values
+ * values is an array of nb_rows*nb_columns struct _h_value, row after row
+ * the text and blob values too long to be stored inline are allocated in arena
+ */
+struct _h_value_result {
+  unsigned int      nb_rows;
+  unsigned int      nb_columns;
+  unsigned int      nb_rows_allocated;
+  struct _h_value * values;
+  void            * arena;
+};
+
+/**
+ * sql result view structure
+ * The values are not copied, they are read in the result returned by the database driver
+ * which is kept until h_result_view_free is called
+ * type is the database type of the connection
+ * result is the driver result (PGresult * or MYSQL_RES *)
+ * col_types, rows and lengths are used internally to access the values
+ */
+struct _h_result_view {
+  int             type;
+  unsigned int    nb_rows;
+  unsigned int    nb_columns;
+  void          * result;
+  int           * col_types;
+  void         ** rows;
+  unsigned long * lengths;
+};
+
+/**
+ * sql prepared statement structure
+ * conn is the connection the statement was prepared on
+ * nb_params is the number of parameters of the statement
+ * params are the values bound to the parameters, the text and blob values are copied
+ * handle is the backend prepared statement, used internally
+ */
+struct _h_statement {
+  const struct _h_connection * conn;
+  unsigned int                 nb_params;
+  struct _h_value            * params;
+  void                       * handle;
+};
+
+/**
+ * sql cursor structure
+ * conn is the connection the cursor was opened on
+ * statement is the prepared statement the cursor was opened on, NULL if the cursor was opened on a query
+ * nb_columns is the number of columns of the rows returned by the query
+ * end is set to 1 when all the rows have been read
+ * handle is the backend statement or result, used internally
+ */
+struct _h_cursor {
+  const struct _h_connection * conn;
+  struct _h_statement        * statement;
+  unsigned int                 nb_columns;
+  int                          end;
+  void                       * handle;
+};
+
+/**
+ * sql column of a columnar result
+ * type is the type shared by all the values of the column:
+ * - HOEL_COL_TYPE_INT: values are in i_values
+ * - HOEL_COL_TYPE_DATE: values are in i_values as a number of seconds since epoch (UTC)
+ * - HOEL_COL_TYPE_DOUBLE: values are in d_values
+ * - HOEL_COL_TYPE_TEXT or HOEL_COL_TYPE_BLOB: the value of the row r is
+ *   the offsets[r+1]-offsets[r] bytes starting at bytes+offsets[r], text values are not '\0'-terminated
+ * - HOEL_COL_TYPE_NULL: all the values of the column are null
+ * if the values returned by the database have different types, the column type is widened,
+ * int to double, then to text or blob
+ * The bit r of validity is set if the value of the row r is not null
+ */
+struct _h_column {
+  int             type;
+  char          * name;
+  long long int * i_values;
+  double        * d_values;
+  size_t        * offsets;
+  char          * bytes;
+  size_t          bytes_size;
+  unsigned char * validity;
+};
+
+/**
+ * sql columnar result structure
+ * columns is an array of nb_columns struct _h_column, each column has nb_rows values
+ * nb_rows_allocated is the number of rows the columns have room for
+ */
+struct _h_result_columnar {
+  unsigned int       nb_rows;
+  unsigned int       nb_columns;
+  unsigned int       nb_rows_allocated;
+  struct _h_column * columns;
 };
 
 /**
@@ -159,6 +312,41 @@ struct _h_result {
  */
 int h_close_db(struct _h_connection * conn);
 
+/**
+ * h_set_statement_cache_size
+ * Set the maximum number of prepared statements kept in the statement cache of the connection
+ * With SQLite, the statements of the queries are cached by sql text, so executing the same query again
+ * doesn't parse it again, the default size is 16
+ * The statements are prepared again by the database if the schema changes
+ * With all backends, this also sets the size of the cache of the statements prepared by h_select, h_update and h_delete,
+ * the default size is 16
+ * @param conn the connection to the database
+ * @param size the maximum number of statements in the cache, 0 disables the cache
+ * @return H_OK on success
+ */
+int h_set_statement_cache_size(const struct _h_connection * conn, unsigned int size);
+
+/**
+ * h_get_statement_cache_stats
+ * Get the statistics of the cache of the statements prepared by h_select, h_update and h_delete
+ * @param conn the connection to the database
+ * @param nb_hits set to the number of statements reused from the cache
+ * @param nb_prepared set to the number of statements prepared for the cache
+ * @return H_OK on success
+ */
+int h_get_statement_cache_stats(const struct _h_connection * conn, unsigned long * nb_hits, unsigned long * nb_prepared);
+
+/**
+ * h_check_connection
+ * Check a database connection before it's used again
+ * With SQLite and PostgreSQL, a transaction left open is rolled back,
+ * a broken PostgreSQL connection is reset, a MariaDB connection is pinged
+ * A transaction started with h_transaction_begin by the current thread is rolled back with all backends
+ * @param conn the connection to the database
+ * @return H_OK on success, H_ERROR_CONNECTION if the connection is not usable
+ */
+int h_check_connection(const struct _h_connection * conn);
+
 /**
  * @}
  */
@@ -225,6 +413,10 @@ char * h_escape_string_with_quotes(const struct _h_connection * conn, const char
  * H_OPTION_NONE (0): no option
  * H_OPTION_SELECT: Execute a prepare statement (sqlite only)
  * H_OPTION_EXEC: Execute an exec statement (sqlite only)
+ * H_OPTION_ARENA: Allocate all the rows and values of the result in chunks owned by the result,
+ * the values can't be cleaned individually, h_clean_result releases them all at once
+ * H_OPTION_BINARY: Receive the values in binary format (PostgreSQL and MariaDB only, ignored by SQLite),
+ * see h_execute_query_json_options
  * @return H_OK on success
  */
 int h_execute_query(const struct _h_connection * conn, const char * query, struct _h_result * result, int options);
@@ -295,6 +487,46 @@ int h_query_select(const struct _h_connection * conn, const char * query, struct
  */
 int h_execute_query_json(const struct _h_connection * conn, const char * query, json_t ** j_result);
 
+/**
+ * h_execute_query_json_compact
+ * Execute a query, set the returned values in the json result in compact format
+ * The column names are listed once and each row is an array of values in the column order:
+ * {"columns":["col1","col2"],"rows":[[value1,value2],[value1,value2]]}
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param j_result a json_t * reference that will be allocated and filled with the result
+ * if the query succeeds and is a SELECT query
+ * @return H_OK on success
+ */
+int h_execute_query_json_compact(const struct _h_connection * conn, const char * query, json_t ** j_result);
+
+/**
+ * h_execute_query_json_options
+ * Execute a query, set the returned values in the json result
+ * options available
+ * H_OPTION_NONE (0): no option
+ * H_OPTION_JSON_COMPACT: Return the result in compact format, see h_execute_query_json_compact
+ * H_OPTION_BINARY: Receive the values in binary format (PostgreSQL and MariaDB only, ignored by SQLite),
+ * the numbers and dates are decoded without text parsing. The query must have one statement only.
+ * With MariaDB, the query is executed as a prepared statement without parameters, the integers,
+ * doubles and dates are decoded from the binary protocol, the other values are the same as in text format.
+ * With PostgreSQL, bytea values aren't hex-encoded on the wire,
+ * int2, int4, int8, oid and bool values are integers, float4, float8 and numeric values are doubles,
+ * date values are dates, time, timestamp and timestamptz values are text formatted like the server does
+ * with their fractions of seconds, timestamptz values are in UTC with the offset +00,
+ * bytea values are returned raw, uuid and the text types are text,
+ * the values of the other types are returned as blob in their binary representation.
+ * In the json result, the blob values are hex-encoded like bytea values in text format
+ * and the dates have the format "%Y-%m-%dT%H:%M:%S"
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param j_result a json_t * reference that will be allocated and filled with the result
+ * if the query succeeds and is a SELECT query
+ * @param options H_OPTION_NONE, H_OPTION_JSON_COMPACT and/or H_OPTION_BINARY
+ * @return H_OK on success
+ */
+int h_execute_query_json_options(const struct _h_connection * conn, const char * query, json_t ** j_result, int options);
+
 /**
  * h_query_select_json
  * Execute a select query, set the returned values in the json results
@@ -321,6 +553,7 @@ int h_query_select_json(const struct _h_connection * conn, const char * query, j
  *   "group_by": "col_name"            // Non empty string, available for h_select, specify the group by clause, optional, the value is not escaped by the library
  *   "limit": integer_value            // Integer, available for h_select, specify the limit value, optional
  *   "offset"                          // Integer, available for h_select, specify the limit value, optional but available only if limit is set
+ *   "compact": true                   // Boolean, available for h_select, optional, if true, j_result has the format of h_execute_query_json_compact
  *   "values": [{                      // json object or json array of json objects, available for h_insert, mandatory, specify the values to update
  *     "col1": "value1",               // Generates col1='value1' for an update query
  *     "col2": value_integer,          // Generates col2=value_integer for an update query
@@ -370,14 +603,77 @@ int h_select(const struct _h_connection * conn, const json_t * j_query, json_t *
  * h_insert
  * Execute an insert query
  * Uses a json_t * parameter for the query parameters
+ * If values is a json array, the rows are inserted with a single query, unless "chunk_rows" or "chunk_bytes" is set,
+ * or the query would exceed the maximum query length of the database:
+ * SQLITE_LIMIT_SQL_LENGTH with SQLite, max_allowed_packet with MariaDB
+ * The rows are then inserted by chunks of at most "chunk_rows" rows and "chunk_bytes" bytes,
+ * in a transaction, or in a savepoint if a transaction is already open on the connection,
+ * so if a chunk fails, none of the rows is inserted
+ * In a PostgreSQL pipeline, the chunks are queued in the implicit transaction of the pipeline
  * @param conn the connection to the database
  * @param j_query the query encapsulated ina JSON object to execute
  * @param generated_query a char * reference that will be allocated by the library and will contain the generated SQL query,
- * optional, must be h_free'd after use
+ * the queries of all the chunks separated by ";\n" if the rows are inserted by chunks, optional, must be h_free'd after use
  * @return H_OK on success
  */
 int h_insert(const struct _h_connection * conn, const json_t * j_query, char ** generated_query);
 
+/**
+ * h_insert_chunks
+ * Execute an insert query by chunks and report the result of each chunk
+ * The chunks have at most "chunk_rows" rows, default 1000, and "chunk_bytes" bytes, default 4MB,
+ * also limited by the maximum query length of the database
+ * Each chunk is committed on its own: if a chunk fails, the next chunks aren't executed and the previous chunks
+ * stay inserted unless the insert is run in a transaction
+ * @param conn the connection to the database
+ * @param j_query the query encapsulated in a JSON object to execute
+ * @param j_report a json_t * reference set with a json array containing an object for each chunk executed:
+ * {"offset": index of the first row of the chunk, "rows": number of rows of the chunk, "result": H_OK or the error code}
+ * must be decref'd after use
+ * @return H_OK on success
+ */
+int h_insert_chunks(const struct _h_connection * conn, const json_t * j_query, json_t ** j_report);
+
+/**
+ * h_upsert
+ * Execute an insert query, a row conflicting with an existing row updates it instead
+ * Uses a json_t * parameter for the query parameters like h_insert, with the following keys:
+ * "conflict": json array of the columns of the unique constraint checked, mandatory,
+ * with MariaDB the constraint checked is the unique key violated by the row
+ * "update": json array of the columns updated with the values of the row, optional, default is all the columns
+ * inserted except the conflict columns, if empty the conflicting rows are left unchanged
+ * With SQLite and PostgreSQL, the query is INSERT ... ON CONFLICT (conflict) DO UPDATE SET col=excluded.col,
+ * with MariaDB, the query is INSERT ... ON DUPLICATE KEY UPDATE col=VALUES(col)
+ * A json array of rows is inserted with a single query, or by chunks in a transaction like h_insert
+ * @param conn the connection to the database
+ * @param j_query the query encapsulated in a JSON object to execute
+ * @param generated_query a char * reference that will be allocated by the library and will contain the generated SQL query,
+ * the queries of all the chunks separated by ";\n" if the rows are inserted by chunks, optional, must be h_free'd after use
+ * @return H_OK on success
+ */
+int h_upsert(const struct _h_connection * conn, const json_t * j_query, char ** generated_query);
+
+/**
+ * h_bulk_insert
+ * Insert a large number of rows
+ * Uses a json_t * parameter for the query parameters like h_insert,
+ * values must be a json array of json objects with the same keys in the same order, raw values aren't available
+ * The columns are the keys of the first row, a key of the first row missing in another row is inserted as NULL,
+ * a key missing in the first row returns H_ERROR_PARAMS and none of the rows is inserted
+ * With PostgreSQL, the rows are streamed with COPY FROM STDIN without building an SQL query,
+ * none of the rows is inserted if one of them is invalid
+ * With MariaDB Connector/C 3 or newer, the INSERT query is prepared once and the values are sent
+ * in binary form by chunks of at most 4096 rows and max_allowed_packet bytes, in a single transaction,
+ * or in a savepoint if a transaction is already open, none of the rows is inserted on error,
+ * with the MySQL client library, the rows are inserted with h_insert
+ * With SQLite, the INSERT query is prepared once and run for each row in a single transaction,
+ * or in a savepoint if a transaction is already open, none of the rows is inserted on error
+ * @param conn the connection to the database
+ * @param j_query the query encapsulated in a JSON object to execute
+ * @return H_OK on success
+ */
+int h_bulk_insert(const struct _h_connection * conn, const json_t * j_query);
+
 /**
  * h_last_insert_id
  * return the id of the last inserted value
@@ -444,6 +740,7 @@ char * h_build_where_clause(const struct _h_connection * conn, const char * patt
 /**
  * h_clean_result
  * Free all the memory allocated by the struct _h_result
+ * If the result was allocated in an arena, all the arena chunks are released at once
  * @param result the result to free
  * @return H_OK on success
  */
@@ -470,250 +767,1113 @@ int h_clean_data_full(struct _h_data * data);
  */
 
 /**
- * @defgroup init Initialize and cosing connection functions
+ * @defgroup columnar _h_result_columnar SQL query management functions
+ * SQL query management for struct _h_result_columnar format
  * @{
  */
 
 /**
- * h_clean_connection
- * free memory allocated by the struct _h_connection
+ * h_execute_query_columnar
+ * Execute a query, set the columnar result structure with the returned values
  * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result the columnar result structure to fill with the result data
  * @return H_OK on success
  */
-int h_clean_connection(struct _h_connection * conn);
+int h_execute_query_columnar(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result);
 
 /**
- * h_connect_sqlite
- * Opens a database connection to a sqlite3 db file
- * @param db_path the path to the sqlite db file
- * @return pointer to a struct _h_connection * on sucess, NULL on error
+ * h_column_is_null
+ * Return true if the value of the row row in the column is null
+ * @param column the column
+ * @param row the row index
+ * @return 1 if the value is null, 0 otherwise
  */
-struct _h_connection * h_connect_sqlite(const char * db_path);
+int h_column_is_null(const struct _h_column * column, unsigned int row);
 
 /**
- * close a sqlite3 connection
- * @param conn the connection to the database
+ * h_column_get_bytes
+ * Return the text or blob value of the row row in the column
+ * @param column the column
+ * @param row the row index
+ * @param length set to the length of the value if not NULL
+ * @return a pointer to the value in the column bytes, NULL if the value is null
+ * or the column isn't a text or blob column
  */
-void h_close_sqlite(struct _h_connection * conn);
+const char * h_column_get_bytes(const struct _h_column * column, unsigned int row, size_t * length);
+
+/**
+ * h_clean_result_columnar
+ * Free all the memory allocated by the struct _h_result_columnar
+ * @param result the result to free
+ * @return H_OK on success
+ */
+int h_clean_result_columnar(struct _h_result_columnar * result);
 
 /**
  * @}
  */
 
 /**
- * @defgroup escape Escape string functions
+ * @defgroup value _h_value_result SQL query management functions
+ * SQL query management for struct _h_value_result format
  * @{
  */
 
 /**
- * escape a string
- * returned value must be h_free'd after use
- * This is an internal function, you should use h_escape_string instead
+ * h_execute_query_value
+ * Execute a query, set the value result structure with the returned values
  * @param conn the connection to the database
- * @param unsafe the string to escape
- * @return a heap-allocated string
+ * @param query the SQL query to execute
+ * @param result the value result structure to fill with the result data
+ * @return H_OK on success
  */
-char * h_escape_string_sqlite(const struct _h_connection * conn, const char * unsafe);
+int h_execute_query_value(const struct _h_connection * conn, const char * query, struct _h_value_result * result);
 
 /**
- * escape a string
- * returned value must be h_free'd after use
- * This is an internal function, you should use h_escape_string_with_quotes instead
- * @param conn the connection to the database
- * @param unsafe the string to escape
- * @return a heap-allocated string
+ * h_value_result_get
+ * Return the value of the column col in the row row
+ * @param result the value result
+ * @param row the row index
+ * @param col the column index
+ * @return a pointer to the value, NULL if row or col is out of bounds
  */
-char * h_escape_string_with_quotes_sqlite(const struct _h_connection * conn, const char * unsafe);
+const struct _h_value * h_value_result_get(const struct _h_value_result * result, unsigned int row, unsigned int col);
 
 /**
- * @}
+ * h_value_get_bytes
+ * Return a pointer to the text or blob value, inline or not
+ * @param value the value
+ * @return a pointer to the bytes of the value, NULL if the value isn't a text or a blob
  */
+const char * h_value_get_bytes(const struct _h_value * value);
 
 /**
- * @defgroup json JSON SQL query management functions
- * SQL query management for JSON format
- * @{
+ * h_clean_value_result
+ * Free all the memory allocated by the struct _h_value_result
+ * @param result the result to free
+ * @return H_OK on success
  */
+int h_clean_value_result(struct _h_value_result * result);
 
 /**
- * Return the id of the last inserted value
- * This is an internal function, you should use h_last_insert_id instead
- * @param conn the connection to the database
- * @return a long long int value
+ * @}
  */
-long long int h_last_insert_id_sqlite(const struct _h_connection * conn);
 
 /**
- * h_exec_query_sqlite
- * legacy function name, didn't realize the typo until now...
- * redirect to h_execute_query_sqlite
- * @param conn the connection to the database
- * @param query the SQL query to execute
- * @return H_OK on success
+ * @defgroup view _h_result_view SQL query management functions
+ * SQL query management for struct _h_result_view format
+ * Available for MariaDB and PostgreSQL databases only
+ * @{
  */
-int h_exec_query_sqlite(const struct _h_connection * conn, const char * query);
 
 /**
- * h_execute_query_sqlite
- * Execute a query on a sqlite connection
- * This is an internal function, you should use h_exec_query instead
- * Should not be executed by the user because all parameters are supposed to be correct
- * No result is returned, useful for single INSERT, UPDATE or DELETE statements
+ * h_execute_query_view
+ * Execute a query, set the result view with the returned values
+ * The values are not copied, the view must be freed with h_result_view_free after use
+ * With MariaDB and PostgreSQL, the view is set empty on error, so it can be freed as well
  * @param conn the connection to the database
  * @param query the SQL query to execute
+ * @param view the result view to set
  * @return H_OK on success
  */
-int h_execute_query_sqlite(const struct _h_connection * conn, const char * query);
+int h_execute_query_view(const struct _h_connection * conn, const char * query, struct _h_result_view * view);
 
 /**
- * h_execute_query_json_sqlite
- * Execute a query on a sqlite connection, set the returned values in the json result
- * This is an internal function, you should use h_execute_query_json instead
- * Should not be executed by the user because all parameters are supposed to be correct
- * @param conn the connection to the database
- * @param query the SQL query to execute
- * @param j_result a json_t * reference that will be allocated and filled with the result
+ * h_result_view_get
+ * Return the value of the column col in the row row as returned by the database
+ * The pointer is valid until h_result_view_free is called
+ * @param view the result view
+ * @param row the row index
+ * @param col the column index
+ * @param length set to the length of the value if not NULL
+ * @return a pointer to the value, NULL if the value is null or row or col is out of bounds
+ */
+const char * h_result_view_get(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length);
+
+/**
+ * h_result_view_get_type
+ * Return the hoel type of the value of the column col in the row row
+ * @param view the result view
+ * @param row the row index
+ * @param col the column index
+ * @return the HOEL_COL_TYPE_* of the value, HOEL_COL_TYPE_NULL if the value is null or row or col is out of bounds
+ */
+int h_result_view_get_type(const struct _h_result_view * view, unsigned int row, unsigned int col);
+
+/**
+ * h_result_view_get_int
+ * Get the integer value of the column col in the row row
+ * @param view the result view
+ * @param row the row index
+ * @param col the column index
+ * @param value set to the value
+ * @return H_OK on success, H_ERROR_PARAMS if the value is null or isn't an integer
+ */
+int h_result_view_get_int(const struct _h_result_view * view, unsigned int row, unsigned int col, long long int * value);
+
+/**
+ * h_result_view_get_double
+ * Get the double value of the column col in the row row, integer values are converted
+ * @param view the result view
+ * @param row the row index
+ * @param col the column index
+ * @param value set to the value
+ * @return H_OK on success, H_ERROR_PARAMS if the value is null or isn't a number
+ */
+int h_result_view_get_double(const struct _h_result_view * view, unsigned int row, unsigned int col, double * value);
+
+/**
+ * h_result_view_get_date
+ * Get the date value of the column col in the row row
+ * @param view the result view
+ * @param row the row index
+ * @param col the column index
+ * @param value set to the value
+ * @return H_OK on success, H_ERROR_PARAMS if the value is null or isn't a date
+ */
+int h_result_view_get_date(const struct _h_result_view * view, unsigned int row, unsigned int col, struct tm * value);
+
+/**
+ * h_result_view_free
+ * Free the driver result and the memory allocated by the struct _h_result_view
+ * @param view the result view to free
  * @return H_OK on success
  */
-int h_execute_query_json_sqlite(const struct _h_connection * conn, const char * query, json_t ** j_result);
+int h_result_view_free(struct _h_result_view * view);
 
 /**
  * @}
  */
 
 /**
- * @defgroup h_result _h_result SQL query management functions
- * SQL query management for struct _h_result format
+ * @defgroup cursor Cursor SQL query management functions
+ * Read the rows returned by a query a batch at a time
+ * The rows are read from the database while the cursor is read,
+ * so the memory used doesn't depend on the number of rows returned by the query
+ * The connection can't be used to run other queries until the cursor is closed
  * @{
  */
 
 /**
- * h_select_query_sqlite
- * Execute a select query on a sqlite connection, set the result structure with the returned values
- * This is an internal function, you should use h_select_query instead
- * Should not be executed by the user because all parameters are supposed to be correct
- * if result is NULL, the query is executed but no value will be returned
- * Useful for SELECT statements
+ * h_cursor_open
+ * Execute a query and open a cursor on the rows returned
+ * sqlite3_step is used with SQLite, mysql_use_result with MariaDB
+ * and the single row mode (or the chunked rows mode if available) with PostgreSQL
  * @param conn the connection to the database
  * @param query the SQL query to execute
- * @param result a _h_result that will be filled with the result
- * return H_OK on success
+ * @param cursor the cursor to open, must be closed with h_cursor_close after use
+ * @return H_OK on success
  */
-int h_select_query_sqlite(const struct _h_connection * conn, const char * query, struct _h_result * result);
+int h_cursor_open(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor);
+
+/**
+ * h_cursor_next
+ * Read the next rows of the cursor in a struct _h_result
+ * @param cursor the cursor
+ * @param result the result structure to fill with at most max_rows rows,
+ * result has no row if all the rows have been read, result must be cleaned with h_clean_result after use
+ * @param max_rows the maximum number of rows to read, must be greater than 0
+ * @return H_OK on success
+ */
+int h_cursor_next(struct _h_cursor * cursor, struct _h_result * result, unsigned int max_rows);
+
+/**
+ * h_cursor_next_json
+ * Read the next rows of the cursor in a json array
+ * @param cursor the cursor
+ * @param j_result a json_t * reference that will be allocated and filled with an array of at most max_rows rows,
+ * the array is empty if all the rows have been read, j_result must be decref'd after use
+ * @param max_rows the maximum number of rows to read, must be greater than 0
+ * @return H_OK on success
+ */
+int h_cursor_next_json(struct _h_cursor * cursor, json_t ** j_result, unsigned int max_rows);
+
+/**
+ * h_cursor_close
+ * Close the cursor, the rows not read are discarded
+ * @param cursor the cursor to close
+ * @return H_OK on success
+ */
+int h_cursor_close(struct _h_cursor * cursor);
 
 /**
  * @}
  */
 
 /**
- * @defgroup init Initialize and cosing connection functions
+ * @defgroup prepared Prepared statement management functions
+ * Prepare a query once and execute it many times with different parameters
+ * The parameters are written ? in the query, PostgreSQL parameters are converted to $1, $2, etc.
+ * so the PostgreSQL operators containing a ? character can't be used in a prepared statement
+ * The connection is locked while a prepared statement is executed
  * @{
  */
 
 /**
- * h_connect_mariadb
- * Opens a database connection to a mariadb server
- * @param host the hostname of the database server
- * @param user the username to connect to the database
- * @param passwd the password to connect to the database
- * @param db the database name
- * @param port the TCP port number for the database connection, 0 means system default
- * @param unix_socket a UNIX socket to use for the connection, optional
- * @return pointer to a struct _h_connection * on success, NULL on error
+ * h_prepare
+ * Prepare a query on the database
+ * @param conn the connection to the database
+ * @param query the SQL query to prepare, the parameters are written ?
+ * with PostgreSQL, every ? outside of strings, quoted identifiers and comments is a parameter,
+ * so the jsonb operators ?, ?| and ?& can't be used, use jsonb_exists, jsonb_exists_any
+ * and jsonb_exists_all instead
+ * @param stmt the statement to initialize, must be finalized with h_finalize after use
+ * @return H_OK on success
  */
-struct _h_connection * h_connect_mariadb(const char * host, const char * user, const char * passwd, const char * db, const unsigned int port, const char * unix_socket);
+int h_prepare(const struct _h_connection * conn, const char * query, struct _h_statement * stmt);
 
 /**
- * close connection to database
+ * Bind a value to the parameter index of the statement
+ * The values stay bound until they are bound again or the statement is finalized
+ * @param stmt the prepared statement
+ * @param index the index of the parameter, starting at 1
+ * @param value the value to bind, text and blob values are copied
+ * @param length the length of the blob value
+ * @return H_OK on success, H_ERROR_PARAMS if index is out of range
  */
-void h_close_mariadb(struct _h_connection * conn);
+int h_bind_int(struct _h_statement * stmt, unsigned int index, long long int value);
+int h_bind_double(struct _h_statement * stmt, unsigned int index, double value);
+int h_bind_text(struct _h_statement * stmt, unsigned int index, const char * value);
+int h_bind_blob(struct _h_statement * stmt, unsigned int index, const void * value, size_t length);
+int h_bind_null(struct _h_statement * stmt, unsigned int index);
 
 /**
- * @}
+ * h_execute_prepared
+ * Execute a prepared statement with the values bound, set the result structure with the returned values
+ * @param stmt the prepared statement
+ * @param result the result structure that will be filled with the returned values,
+ * if result is NULL, the statement is executed but no value is returned,
+ * must be cleaned with h_clean_result after use
+ * @return H_OK on success
  */
+int h_execute_prepared(struct _h_statement * stmt, struct _h_result * result);
 
 /**
- * @defgroup escape Escape string functions
- * @{
+ * h_execute_prepared_json
+ * Execute a prepared statement with the values bound, set the returned values in the json result
+ * @param stmt the prepared statement
+ * @param j_result a json_t * reference that will be allocated and filled with the result,
+ * must be decref'd after use
+ * @return H_OK on success
  */
+int h_execute_prepared_json(struct _h_statement * stmt, json_t ** j_result);
 
 /**
- * escape a string
- * This is an internal function, you should use h_escape_string instead
- * returned value must be h_free'd after use
- * @param conn the connection to the database
- * @param unsafe the string to escape
- * @return a heap-allocated string
+ * h_cursor_open_prepared
+ * Execute a prepared statement with the values bound and open a cursor on the rows returned
+ * The rows are read with h_cursor_next or h_cursor_next_json
+ * @param stmt the prepared statement
+ * @param cursor the cursor to open, must be closed with h_cursor_close before the statement is executed again
+ * @return H_OK on success
  */
-char * h_escape_string_mariadb(const struct _h_connection * conn, const char * unsafe);
+int h_cursor_open_prepared(struct _h_statement * stmt, struct _h_cursor * cursor);
 
 /**
- * escape a string
- * This is an internal function, you should use h_escape_string_with_quotes instead
- * returned value must be h_free'd after use
- * @param conn the connection to the database
- * @param unsafe the string to escape
- * @return a heap-allocated string
+ * h_finalize
+ * Free the prepared statement and the values bound
+ * @param stmt the prepared statement
+ * @return H_OK on success
  */
-char * h_escape_string_with_quotes_mariadb(const struct _h_connection * conn, const char * unsafe);
+int h_finalize(struct _h_statement * stmt);
 
 /**
  * @}
  */
 
 /**
- * @defgroup json JSON SQL query management functions
- * SQL query management for JSON format
+ * @defgroup stream JSON stream SQL query management functions
+ * Write the rows returned by a query as json text, without building a json_t * array
  * @{
  */
 
 /**
- * Return the id of the last inserted value
- * This is an internal function, you should use h_last_insert_id instead
+ * Write callback used by h_query_select_json_stream
+ * @param buffer the json text to write, not '\0'-terminated
+ * @param size the size of buffer
+ * @param user_data the user_data given to h_query_select_json_stream
+ * @return 0 on success, any other value will stop the query
+ */
+typedef int (* h_json_stream_write)(const char * buffer, size_t size, void * user_data);
+
+/**
+ * h_query_select_json_stream
+ * Execute a select query and write the rows returned as a json array to the write callback
+ * The json text is the same as json_dumps(j_result, JSON_COMPACT) with j_result returned by h_execute_query_json,
+ * except the blob values which are hex-encoded with the prefix \x like the PostgreSQL bytea values,
+ * e.g. "\\x00ff", so the json text is valid whatever the blob contains
+ * The rows are read with a cursor and written as soon as they are decoded,
+ * so the memory used doesn't depend on the number of rows returned by the query
+ * Text values are written as is, so they must be valid UTF-8
  * @param conn the connection to the database
- * @return a long long int value
+ * @param query the SQL query to execute
+ * @param write_cb the callback function called to write the json text by chunks
+ * @param user_data a pointer given to write_cb
+ * @return H_OK on success, if an error occurs after the first rows have been written,
+ * the json text written is incomplete
  */
-long long int h_last_insert_id_mariadb(const struct _h_connection * conn);
+int h_query_select_json_stream(const struct _h_connection * conn, const char * query, h_json_stream_write write_cb, void * user_data);
 
 /**
- * Execute a query on a mariadb connection, set the returned values in the json result
- * This is an internal function, you should use h_execute_query_json instead
- * Should not be executed by the user because all parameters are supposed to be correct
+ * h_query_select_json_fd
+ * Execute a select query and write the rows returned as a json array to a file descriptor
  * @param conn the connection to the database
  * @param query the SQL query to execute
- * @param j_result a json_t * reference that will be allocated and filled with the result
+ * @param fd the file descriptor to write to
  * @return H_OK on success
  */
-int h_execute_query_json_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result);
+int h_query_select_json_fd(const struct _h_connection * conn, const char * query, int fd);
 
 /**
  * @}
  */
 
 /**
- * @defgroup h_result _h_result SQL query management functions
- * SQL query management for struct _h_result format
+ * @defgroup async Asynchronous query functions
+ * Send a query and read its result later, so an event loop can run queries
+ * on several connections without blocking
+ * Available for PostgreSQL and MariaDB databases, h_async_send_prepared is
+ * available for PostgreSQL only
+ * MariaDB connections use the non-blocking API of the MariaDB client library,
+ * the socket may have to be writable instead of readable to continue a query,
+ * h_async_poll checks the socket and returns H_AGAIN if it's not ready
+ * PostgreSQL connections are in nonblocking mode while an asynchronous query runs,
+ * h_async_poll sends the part of a large query not sent yet and returns H_AGAIN
+ * until the whole query is sent
+ * The connection is locked from h_async_send until the result is read by
+ * h_async_get_result or h_async_get_result_json, so all those functions must be
+ * called by the same thread, and no other query can be executed on the connection meanwhile
  * @{
  */
 
 /**
- * h_execute_query_mariadb
- * Execute a select query on a mariadb connection, set the result structure with the returned values
- * This is an internal function, you should use h_select_query instead
- * Should not be executed by the user because all parameters are supposed to be correct
- * if result is NULL, the query is executed but no value will be returned
- * Useful for SELECT statements
+ * h_async_send
+ * Send a query without waiting for its result
  * @param conn the connection to the database
  * @param query the SQL query to execute
- * @param result a _h_result that will be filled with the result
  * @return H_OK on success
  */
-int h_execute_query_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * result);
+int h_async_send(const struct _h_connection * conn, const char * query);
 
 /**
- * h_get_mariadb_value
- * convert value into a struct _h_data * depening on the m_type given
- * This is an internal function, you should not use it
+ * h_async_send_prepared
+ * Send a prepared statement with the values bound without waiting for its result
+ * @param stmt the prepared statement
+ * @return H_OK on success
+ */
+int h_async_send_prepared(struct _h_statement * stmt);
+
+/**
+ * h_async_poll
+ * Read the data available for the asynchronous query
+ * Call this function when the socket returned by h_get_socket_fd is readable
+ * @param conn the connection to the database
+ * @return H_OK if the result is ready, H_AGAIN if it's not
+ */
+int h_async_poll(const struct _h_connection * conn);
+
+/**
+ * h_async_get_result
+ * Read the result of the asynchronous query and unlock the connection
+ * Blocks until the result is received if h_async_poll hasn't returned H_OK
+ * If the query has several statements, the result of the last one is returned
+ * @param conn the connection to the database
+ * @param result the result of the query, may be NULL
+ * @return H_OK on success
+ */
+int h_async_get_result(const struct _h_connection * conn, struct _h_result * result);
+
+/**
+ * h_async_get_result_json
+ * Read the result of the asynchronous query as a json array and unlock the connection
+ * Blocks until the result is received if h_async_poll hasn't returned H_OK
+ * @param conn the connection to the database
+ * @param j_result the result of the query, must be free'd after use
+ * @return H_OK on success
+ */
+int h_async_get_result_json(const struct _h_connection * conn, json_t ** j_result);
+
+/**
+ * h_get_socket_fd
+ * Return the socket of the connection, to wait for it with poll, epoll or select
+ * @param conn the connection to the database
+ * @return the file descriptor, -1 on error or if the backend has no socket
+ */
+int h_get_socket_fd(const struct _h_connection * conn);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup pipeline Pipeline functions
+ * Queue several queries and read their results in order, the queries are sent
+ * to the server without waiting for the previous results, so a batch of queries
+ * costs about one network round trip
+ * Available for PostgreSQL databases with libpq 14 or newer only
+ * The connection is locked from h_pipeline_begin until h_pipeline_end, so all those functions
+ * must be called by the same thread
+ * While the connection is in pipeline mode, h_query_insert, h_query_update, h_query_delete,
+ * h_insert, h_update and h_delete queue their query instead of executing it,
+ * their result is read by h_pipeline_get_result or h_pipeline_end
+ * The queries between two sync points run in the same implicit transaction: if one fails,
+ * the previous ones are rolled back and the next ones aren't executed
+ * @{
+ */
+
+/**
+ * h_pipeline_begin
+ * Enter pipeline mode
+ * @param conn the connection to the database
+ * @return H_OK on success
+ */
+int h_pipeline_begin(const struct _h_connection * conn);
+
+/**
+ * h_pipeline_queue
+ * Queue a query in the pipeline
+ * The query must have one statement only
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @return H_OK on success
+ */
+int h_pipeline_queue(const struct _h_connection * conn, const char * query);
+
+/**
+ * h_pipeline_queue_prepared
+ * Queue a prepared statement with the values bound in the pipeline
+ * The values can be bound again as soon as the function returns
+ * @param stmt the prepared statement
+ * @return H_OK on success
+ */
+int h_pipeline_queue_prepared(struct _h_statement * stmt);
+
+/**
+ * h_pipeline_sync
+ * Send a sync point in the pipeline, the server executes the queries queued and sends their results
+ * A sync point is sent automatically by h_pipeline_get_result and h_pipeline_end if needed
+ * @param conn the connection to the database
+ * @return H_OK on success
+ */
+int h_pipeline_sync(const struct _h_connection * conn);
+
+/**
+ * h_pipeline_get_result
+ * Read the result of the next query of the pipeline, in the order the queries were queued
+ * @param conn the connection to the database
+ * @param result the result of the query, may be NULL
+ * @return H_OK on success, H_ERROR_QUERY if the query has failed or wasn't executed
+ * because a previous query has failed
+ */
+int h_pipeline_get_result(const struct _h_connection * conn, struct _h_result * result);
+
+/**
+ * h_pipeline_get_result_json
+ * Read the result of the next query of the pipeline as a json array
+ * @param conn the connection to the database
+ * @param j_result the result of the query, must be free'd after use
+ * @return H_OK on success
+ */
+int h_pipeline_get_result_json(const struct _h_connection * conn, json_t ** j_result);
+
+/**
+ * h_pipeline_end
+ * Read the results left in the pipeline, exit pipeline mode and unlock the connection
+ * @param conn the connection to the database
+ * @return H_OK on success, H_ERROR_QUERY if one of the results left is an error
+ */
+int h_pipeline_end(const struct _h_connection * conn);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup transaction Transaction functions
+ * A transaction started with h_transaction_begin holds the connection lock until
+ * h_commit or h_rollback, so the queries of other threads using the same connection
+ * wait until the transaction ends instead of running inside it
+ * All the transaction functions must be called by the thread that started the transaction,
+ * the queries executed by this thread between h_transaction_begin and h_commit or h_rollback
+ * run inside the transaction
+ * Savepoints are available inside a transaction to rollback a part of it
+ * h_check_connection and h_pool_release rollback a transaction left open
+ * @{
+ */
+
+/**
+ * h_transaction_begin
+ * Start a transaction and lock the connection until the transaction ends
+ * @param conn the connection to the database
+ * @return H_OK on success, H_ERROR_PARAMS if a transaction, an asynchronous query
+ * or a pipeline is already running on the connection
+ */
+int h_transaction_begin(const struct _h_connection * conn);
+
+/**
+ * h_commit
+ * Commit the transaction and unlock the connection
+ * If the commit fails, the transaction is rolled back and the connection is unlocked
+ * @param conn the connection to the database
+ * @return H_OK on success, H_ERROR_QUERY if the transaction was rolled back,
+ * H_ERROR_PARAMS if no transaction is running
+ */
+int h_commit(const struct _h_connection * conn);
+
+/**
+ * h_rollback
+ * Rollback the transaction and unlock the connection
+ * @param conn the connection to the database
+ * @return H_OK on success, H_ERROR_PARAMS if no transaction is running
+ */
+int h_rollback(const struct _h_connection * conn);
+
+/**
+ * h_savepoint
+ * Set a savepoint in the transaction
+ * @param conn the connection to the database
+ * @param name the name of the savepoint, letters, digits and '_' only
+ * @return H_OK on success, H_ERROR_PARAMS if no transaction is running or the name is invalid
+ */
+int h_savepoint(const struct _h_connection * conn, const char * name);
+
+/**
+ * h_release_savepoint
+ * Release a savepoint of the transaction, the changes made since the savepoint are kept
+ * @param conn the connection to the database
+ * @param name the name of the savepoint, letters, digits and '_' only
+ * @return H_OK on success, H_ERROR_PARAMS if no transaction is running or the name is invalid
+ */
+int h_release_savepoint(const struct _h_connection * conn, const char * name);
+
+/**
+ * h_rollback_to_savepoint
+ * Rollback the changes made since the savepoint, the transaction and the savepoint remain open
+ * @param conn the connection to the database
+ * @param name the name of the savepoint, letters, digits and '_' only
+ * @return H_OK on success, H_ERROR_PARAMS if no transaction is running or the name is invalid
+ */
+int h_rollback_to_savepoint(const struct _h_connection * conn, const char * name);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup pool Connection pool functions
+ * A pool holds a fixed number of connections to the same database,
+ * each connection is checked out by one thread at a time,
+ * so several threads can run queries at the same time
+ * @{
+ */
+
+/**
+ * h_pool_new_sqlite
+ * Create a pool of connections to a sqlite3 db file
+ * @param db_path the path to the sqlite db file
+ * @param size the number of connections
+ * @return a pointer to a struct _h_pool * on success, NULL on error
+ */
+struct _h_pool * h_pool_new_sqlite(const char * db_path, unsigned int size);
+
+/**
+ * h_pool_new_mariadb
+ * Create a pool of connections to a mariadb server
+ * @param host the hostname of the database server
+ * @param user the username to connect to the database
+ * @param passwd the password to connect to the database
+ * @param db the database name
+ * @param port the TCP port number for the database connection, 0 means system default
+ * @param unix_socket a UNIX socket to use for the connection, optional
+ * @param size the number of connections
+ * @return a pointer to a struct _h_pool * on success, NULL on error
+ */
+struct _h_pool * h_pool_new_mariadb(const char * host, const char * user, const char * passwd, const char * db, const unsigned int port, const char * unix_socket, unsigned int size);
+
+/**
+ * h_pool_new_pgsql
+ * Create a pool of connections to a PostgreSQL server
+ * @param conninfo the connection info string
+ * @param size the number of connections
+ * @return a pointer to a struct _h_pool * on success, NULL on error
+ */
+struct _h_pool * h_pool_new_pgsql(const char * conninfo, unsigned int size);
+
+/**
+ * h_pool_close
+ * Close all the connections of a pool and free the pool
+ * All the connections must have been released
+ * @param pool the pool to close
+ * @return H_OK on success
+ */
+int h_pool_close(struct _h_pool * pool);
+
+/**
+ * h_pool_set_timeout
+ * Set the time to wait for a connection when all the connections of the pool are checked out
+ * @param pool the pool
+ * @param timeout the time in milliseconds, default is H_POOL_DEFAULT_TIMEOUT
+ * @return H_OK on success
+ */
+int h_pool_set_timeout(struct _h_pool * pool, unsigned int timeout);
+
+/**
+ * h_pool_acquire
+ * Check out a connection from the pool
+ * Waits until a connection is available or the pool timeout expires
+ * The connection must be given back with h_pool_release
+ * @param pool the pool
+ * @return a connection on success, NULL on error or timeout
+ */
+struct _h_connection * h_pool_acquire(struct _h_pool * pool);
+
+/**
+ * h_pool_release
+ * Give a connection back to the pool
+ * The connection is checked with h_check_connection, if the check fails, the connection
+ * is closed and opened again
+ * @param pool the pool
+ * @param conn the connection returned by h_pool_acquire
+ * @return H_OK on success, H_ERROR_CONNECTION if the connection couldn't be opened again,
+ * the connection will be opened on the next h_pool_acquire
+ */
+int h_pool_release(struct _h_pool * pool, struct _h_connection * conn);
+
+/**
+ * The following functions check out a connection, execute the query
+ * and give the connection back to the pool
+ * They return the same values as their connection counterpart, or
+ * H_ERROR_TIMEOUT if no connection was available before the pool timeout
+ * To run several queries on the same connection, e.g. a transaction or
+ * h_query_last_insert_id, use h_pool_acquire and h_pool_release
+ */
+int h_pool_execute_query(struct _h_pool * pool, const char * query, struct _h_result * result, int options);
+int h_pool_query_insert(struct _h_pool * pool, const char * query);
+int h_pool_query_update(struct _h_pool * pool, const char * query);
+int h_pool_query_delete(struct _h_pool * pool, const char * query);
+int h_pool_query_select(struct _h_pool * pool, const char * query, struct _h_result * result);
+int h_pool_execute_query_json(struct _h_pool * pool, const char * query, json_t ** j_result);
+int h_pool_query_select_json(struct _h_pool * pool, const char * query, json_t ** j_result);
+int h_pool_select(struct _h_pool * pool, const json_t * j_query, json_t ** j_result, char ** generated_query);
+int h_pool_insert(struct _h_pool * pool, const json_t * j_query, char ** generated_query);
+int h_pool_update(struct _h_pool * pool, const json_t * j_query, char ** generated_query);
+int h_pool_delete(struct _h_pool * pool, const json_t * j_query, char ** generated_query);
+
+/**
+ * h_pool_insert_chunks
+ * Execute an insert query like h_insert_chunks, the chunks are inserted in parallel
+ * on up to nb_connections connections of the pool, SQLite allows one writer at a time so the chunks are inserted
+ * on one connection of a SQLite pool
+ * Use it when the rows don't have to be inserted atomically: each chunk is a separate transaction,
+ * if a chunk fails, the chunks being inserted on the other connections are completed and the next chunks aren't executed
+ * @param pool the pool
+ * @param j_query the query encapsulated in a JSON object to execute
+ * @param nb_connections the maximum number of connections used, limited to the pool size
+ * @param j_report a json_t * reference set with a json array containing an object for each chunk executed,
+ * in the order of the rows, must be decref'd after use
+ * @return H_OK on success
+ */
+int h_pool_insert_chunks(struct _h_pool * pool, const json_t * j_query, unsigned int nb_connections, json_t ** j_report);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup init Initialize and cosing connection functions
+ * @{
+ */
+
+/**
+ * h_clean_connection
+ * free memory allocated by the struct _h_connection
+ * @param conn the connection to the database
+ * @return H_OK on success
+ */
+int h_clean_connection(struct _h_connection * conn);
+
+/**
+ * h_connect_sqlite
+ * Opens a database connection to a sqlite3 db file
+ * @param db_path the path to the sqlite db file
+ * @return pointer to a struct _h_connection * on sucess, NULL on error
+ */
+struct _h_connection * h_connect_sqlite(const char * db_path);
+
+/**
+ * close a sqlite3 connection
+ * @param conn the connection to the database
+ */
+void h_close_sqlite(struct _h_connection * conn);
+
+/**
+ * h_check_connection_sqlite
+ * Check a sqlite3 connection before it's used again
+ * This is an internal function, you should use h_check_connection instead
+ * @param conn the connection to the database
+ * @return H_OK on success
+ */
+int h_check_connection_sqlite(const struct _h_connection * conn);
+
+/**
+ * h_set_statement_cache_size_sqlite
+ * Set the maximum number of statements kept in the statement cache of a sqlite connection
+ * This is an internal function, you should use h_set_statement_cache_size instead
+ * @param conn the connection to the database
+ * @param size the maximum number of statements in the cache, 0 disables the cache
+ * @return H_OK on success
+ */
+int h_set_statement_cache_size_sqlite(const struct _h_connection * conn, unsigned int size);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup escape Escape string functions
+ * @{
+ */
+
+/**
+ * escape a string
+ * returned value must be h_free'd after use
+ * This is an internal function, you should use h_escape_string instead
+ * @param conn the connection to the database
+ * @param unsafe the string to escape
+ * @return a heap-allocated string
+ */
+char * h_escape_string_sqlite(const struct _h_connection * conn, const char * unsafe);
+
+/**
+ * escape a string
+ * returned value must be h_free'd after use
+ * This is an internal function, you should use h_escape_string_with_quotes instead
+ * @param conn the connection to the database
+ * @param unsafe the string to escape
+ * @return a heap-allocated string
+ */
+char * h_escape_string_with_quotes_sqlite(const struct _h_connection * conn, const char * unsafe);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup json JSON SQL query management functions
+ * SQL query management for JSON format
+ * @{
+ */
+
+/**
+ * Return the id of the last inserted value
+ * This is an internal function, you should use h_last_insert_id instead
+ * @param conn the connection to the database
+ * @return a long long int value
+ */
+long long int h_last_insert_id_sqlite(const struct _h_connection * conn);
+
+/**
+ * h_exec_query_sqlite
+ * legacy function name, didn't realize the typo until now...
+ * redirect to h_execute_query_sqlite
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @return H_OK on success
+ */
+int h_exec_query_sqlite(const struct _h_connection * conn, const char * query);
+
+/**
+ * h_execute_query_sqlite
+ * Execute a query on a sqlite connection
+ * This is an internal function, you should use h_exec_query instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * No result is returned, useful for single INSERT, UPDATE or DELETE statements
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @return H_OK on success
+ */
+int h_execute_query_sqlite(const struct _h_connection * conn, const char * query);
+
+/**
+ * h_execute_query_json_sqlite
+ * Execute a query on a sqlite connection, set the returned values in the json result
+ * This is an internal function, you should use h_execute_query_json instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param j_result a json_t * reference that will be allocated and filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_json_sqlite(const struct _h_connection * conn, const char * query, json_t ** j_result);
+
+/**
+ * h_execute_query_json_options_sqlite
+ * Execute a query on a sqlite connection, set the returned values in the json result
+ * This is an internal function, you should use h_execute_query_json or h_execute_query_json_compact instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param j_result a json_t * reference that will be allocated and filled with the result
+ * @param options H_OPTION_NONE or H_OPTION_JSON_COMPACT
+ * @return H_OK on success
+ */
+int h_execute_query_json_options_sqlite(const struct _h_connection * conn, const char * query, json_t ** j_result, int options);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup h_result _h_result SQL query management functions
+ * SQL query management for struct _h_result format
+ * @{
+ */
+
+/**
+ * h_select_query_sqlite
+ * Execute a select query on a sqlite connection, set the result structure with the returned values
+ * This is an internal function, you should use h_select_query instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * Useful for SELECT statements
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result that will be filled with the result
+ * return H_OK on success
+ */
+int h_select_query_sqlite(const struct _h_connection * conn, const char * query, struct _h_result * result);
+
+/**
+ * h_select_query_options_sqlite
+ * Execute a select query on a sqlite connection, set the result structure with the returned values
+ * This is an internal function, you should use h_execute_query instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result that will be filled with the result
+ * @param options the options passed to h_execute_query
+ * return H_OK on success
+ */
+int h_select_query_options_sqlite(const struct _h_connection * conn, const char * query, struct _h_result * result, int options);
+
+/**
+ * h_execute_query_columnar_sqlite
+ * Execute a query on a sqlite connection, set the columnar result structure with the returned values
+ * This is an internal function, you should use h_execute_query_columnar instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result_columnar that will be filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_columnar_sqlite(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result);
+
+/**
+ * h_execute_query_value_sqlite
+ * Execute a query on a sqlite connection, set the value result structure with the returned values
+ * This is an internal function, you should use h_execute_query_value instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_value_result that will be filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_value_sqlite(const struct _h_connection * conn, const char * query, struct _h_value_result * result);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup init Initialize and cosing connection functions
+ * @{
+ */
+
+/**
+ * h_connect_mariadb
+ * Opens a database connection to a mariadb server
+ * @param host the hostname of the database server
+ * @param user the username to connect to the database
+ * @param passwd the password to connect to the database
+ * @param db the database name
+ * @param port the TCP port number for the database connection, 0 means system default
+ * @param unix_socket a UNIX socket to use for the connection, optional
+ * @return pointer to a struct _h_connection * on success, NULL on error
+ */
+struct _h_connection * h_connect_mariadb(const char * host, const char * user, const char * passwd, const char * db, const unsigned int port, const char * unix_socket);
+
+/**
+ * close connection to database
+ */
+void h_close_mariadb(struct _h_connection * conn);
+
+/**
+ * h_check_connection_mariadb
+ * Check a mariadb connection before it's used again
+ * This is an internal function, you should use h_check_connection instead
+ * @param conn the connection to the database
+ * @return H_OK on success
+ */
+int h_check_connection_mariadb(const struct _h_connection * conn);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup escape Escape string functions
+ * @{
+ */
+
+/**
+ * escape a string
+ * This is an internal function, you should use h_escape_string instead
+ * returned value must be h_free'd after use
+ * @param conn the connection to the database
+ * @param unsafe the string to escape
+ * @return a heap-allocated string
+ */
+char * h_escape_string_mariadb(const struct _h_connection * conn, const char * unsafe);
+
+/**
+ * escape a string
+ * This is an internal function, you should use h_escape_string_with_quotes instead
+ * returned value must be h_free'd after use
+ * @param conn the connection to the database
+ * @param unsafe the string to escape
+ * @return a heap-allocated string
+ */
+char * h_escape_string_with_quotes_mariadb(const struct _h_connection * conn, const char * unsafe);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup json JSON SQL query management functions
+ * SQL query management for JSON format
+ * @{
+ */
+
+/**
+ * Return the id of the last inserted value
+ * This is an internal function, you should use h_last_insert_id instead
+ * @param conn the connection to the database
+ * @return a long long int value
+ */
+long long int h_last_insert_id_mariadb(const struct _h_connection * conn);
+
+/**
+ * Execute a query on a mariadb connection, set the returned values in the json result
+ * This is an internal function, you should use h_execute_query_json instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param j_result a json_t * reference that will be allocated and filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_json_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result);
+
+/**
+ * h_execute_query_json_options_mariadb
+ * Execute a query on a mariadb connection, set the returned values in the json result
+ * This is an internal function, you should use h_execute_query_json or h_execute_query_json_compact instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param j_result a json_t * reference that will be allocated and filled with the result
+ * @param options H_OPTION_NONE or H_OPTION_JSON_COMPACT
+ * @return H_OK on success
+ */
+int h_execute_query_json_options_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result, int options);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup h_result _h_result SQL query management functions
+ * SQL query management for struct _h_result format
+ * @{
+ */
+
+/**
+ * h_execute_query_mariadb
+ * Execute a select query on a mariadb connection, set the result structure with the returned values
+ * This is an internal function, you should use h_select_query instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * Useful for SELECT statements
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result that will be filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * result);
+
+/**
+ * h_execute_query_options_mariadb
+ * Execute a select query on a mariadb connection, set the result structure with the returned values
+ * This is an internal function, you should use h_execute_query instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result that will be filled with the result
+ * @param options the options passed to h_execute_query
+ * @return H_OK on success
+ */
+int h_execute_query_options_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * result, int options);
+
+/**
+ * h_execute_query_columnar_mariadb
+ * Execute a query on a mariadb connection, set the columnar result structure with the returned values
+ * This is an internal function, you should use h_execute_query_columnar instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result_columnar that will be filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_columnar_mariadb(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result);
+
+/**
+ * h_execute_query_value_mariadb
+ * Execute a query on a mariadb connection, set the value result structure with the returned values
+ * This is an internal function, you should use h_execute_query_value instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_value_result that will be filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_value_mariadb(const struct _h_connection * conn, const char * query, struct _h_value_result * result);
+
+/**
+ * h_execute_query_view_mariadb
+ * Execute a query on a mariadb connection, set the result view with the returned values
+ * This is an internal function, you should use h_execute_query_view instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param view the result view to set
+ * @return H_OK on success
+ */
+int h_execute_query_view_mariadb(const struct _h_connection * conn, const char * query, struct _h_result_view * view);
+
+/**
+ * h_result_view_free_mariadb
+ * Free the driver result of a mariadb result view
+ * This is an internal function, you should use h_result_view_free instead
+ * @param view the result view to free
+ */
+void h_result_view_free_mariadb(struct _h_result_view * view);
+
+/**
+ * h_get_mariadb_value
+ * convert value into a struct _h_data * depening on the m_type given
+ * This is an internal function, you should not use it
  * returned value must be h_free'd with h_clean_data_full after use
  * @param value the value to convert
  * @param length the length of the value
@@ -745,6 +1905,15 @@ struct _h_connection * h_connect_pgsql(const char * conninfo);
  */
 void h_close_pgsql(struct _h_connection * conn);
 
+/**
+ * h_check_connection_pgsql
+ * Check a PostgreSQL connection before it's used again
+ * This is an internal function, you should use h_check_connection instead
+ * @param conn the connection to the database
+ * @return H_OK on success
+ */
+int h_check_connection_pgsql(const struct _h_connection * conn);
+
 /**
  * @}
  */
@@ -796,6 +1965,19 @@ char * h_escape_string_with_quotes_pgsql(const struct _h_connection * conn, cons
  */
 int h_execute_query_json_pgsql(const struct _h_connection * conn, const char * query, json_t ** j_result);
 
+/**
+ * h_execute_query_json_options_pgsql
+ * Execute a query on a pgsql connection, set the returned values in the json result
+ * This is an internal function, you should use h_execute_query_json or h_execute_query_json_compact instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param j_result a json_t * reference that will be allocated and filled with the result
+ * @param options H_OPTION_NONE or H_OPTION_JSON_COMPACT
+ * @return H_OK on success
+ */
+int h_execute_query_json_options_pgsql(const struct _h_connection * conn, const char * query, json_t ** j_result, int options);
+
 /**
  * Return the id of the last inserted value
  * This is an internal function, you should use h_last_insert_id instead
@@ -828,6 +2010,64 @@ long long int h_last_insert_id_pgsql(const struct _h_connection * conn);
  */
 int h_execute_query_pgsql(const struct _h_connection * conn, const char * query, struct _h_result * result);
 
+/**
+ * h_execute_query_options_pgsql
+ * Execute a select query on a pgsql connection, set the result structure with the returned values
+ * This is an internal function, you should use h_execute_query instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result that will be filled with the result
+ * @param options the options passed to h_execute_query
+ * return H_OK on success
+ */
+int h_execute_query_options_pgsql(const struct _h_connection * conn, const char * query, struct _h_result * result, int options);
+
+/**
+ * h_execute_query_columnar_pgsql
+ * Execute a query on a pgsql connection, set the columnar result structure with the returned values
+ * This is an internal function, you should use h_execute_query_columnar instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_result_columnar that will be filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_columnar_pgsql(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result);
+
+/**
+ * h_execute_query_value_pgsql
+ * Execute a query on a pgsql connection, set the value result structure with the returned values
+ * This is an internal function, you should use h_execute_query_value instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param result a _h_value_result that will be filled with the result
+ * @return H_OK on success
+ */
+int h_execute_query_value_pgsql(const struct _h_connection * conn, const char * query, struct _h_value_result * result);
+
+/**
+ * h_execute_query_view_pgsql
+ * Execute a query on a pgsql connection, set the result view with the returned values
+ * This is an internal function, you should use h_execute_query_view instead
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * @param conn the connection to the database
+ * @param query the SQL query to execute
+ * @param view the result view to set
+ * @return H_OK on success
+ */
+int h_execute_query_view_pgsql(const struct _h_connection * conn, const char * query, struct _h_result_view * view);
+
+/**
+ * h_result_view_free_pgsql
+ * Free the driver result of a pgsql result view
+ * This is an internal function, you should use h_result_view_free instead
+ * @param view the result view to free
+ */
+void h_result_view_free_pgsql(struct _h_result_view * view);
+
 /**
  * @}
  */
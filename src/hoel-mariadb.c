@@ -28,6 +28,30 @@
 #include <mysql.h>
 #include <string.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <poll.h>
+
+/**
+ * The non-blocking API is available in MariaDB client libraries only
+ */
+#if defined(MARIADB_PACKAGE_VERSION_ID) || defined(MARIADB_BASE_VERSION)
+#define H_MARIADB_NONBLOCK
+#endif
+
+/**
+ * Array binding for prepared statements is available in MariaDB Connector/C 3 and newer
+ */
+#if defined(MARIADB_PACKAGE_VERSION_ID) && MARIADB_PACKAGE_VERSION_ID >= 30000
+#define H_MARIADB_BULK
+#endif
+
+/**
+ * Steps of an asynchronous query
+ */
+#define H_MARIADB_ASYNC_NONE  0
+#define H_MARIADB_ASYNC_QUERY 1
+#define H_MARIADB_ASYNC_STORE 2
+#define H_MARIADB_ASYNC_DONE  3
 
 /**
  * MariaDB handle
@@ -42,8 +66,65 @@ struct _h_mariadb {
   unsigned long flags;
   MYSQL * db_handle;
   pthread_mutex_t lock;
+  int transaction;
+  int async;              /* Step of the asynchronous query, H_MARIADB_ASYNC_NONE if none is running */
+  int async_status;       /* Events the current step of the asynchronous query is waiting for */
+  int async_error;
+  MYSQL_RES * async_result;
+  int nonblock;           /* MYSQL_OPT_NONBLOCK is set, the first asynchronous query sets it */
+  unsigned long max_packet; /* max_allowed_packet of the server, 0 if unknown */
+};
+
+/**
+ * Initial size of the buffers used to fetch the values of a prepared statement
+ */
+#define H_MARIADB_STMT_BUFFER_SIZE 256
+
+/**
+ * MariaDB prepared statement handle
+ * The integers, doubles and dates are fetched in their binary format in results[col].buffer,
+ * the other values are fetched as strings, then decoded like the text protocol values
+ */
+struct _h_mariadb_statement {
+  MYSQL_STMT    * stmt;
+  MYSQL_BIND    * params;
+  MYSQL_RES     * metadata;
+  MYSQL_FIELD   * fields;
+  unsigned int    nb_columns;
+  MYSQL_BIND    * results;
+  unsigned long * lengths;
+  my_bool       * is_null;
+  my_bool       * error;
+};
+
+/**
+ * MariaDB cursor handle
+ */
+struct _h_mariadb_cursor {
+  MYSQL_RES     * result;
+  MYSQL_FIELD   * fields;
+  MYSQL_ROW       row;
+  unsigned long * lengths;
 };
 
+/**
+ * Get the max_allowed_packet value of the server
+ * return 0 if the value can't be read
+ */
+static unsigned long h_mariadb_max_packet(MYSQL * db_handle) {
+  MYSQL_RES * result;
+  MYSQL_ROW row;
+  unsigned long max_packet = 0;
+  
+  if (!mysql_query(db_handle, "SELECT @@max_allowed_packet") && (result = mysql_store_result(db_handle)) != NULL) {
+    if ((row = mysql_fetch_row(result)) != NULL && row[0] != NULL) {
+      max_packet = strtoul(row[0], NULL, 10);
+    }
+    mysql_free_result(result);
+  }
+  return max_packet;
+}
+
 /**
  * h_connect_mariadb
  * Opens a database connection to a mariadb server
@@ -67,6 +148,7 @@ struct _h_connection * h_connect_mariadb(const char * host, const char * user, c
     }
 
     conn->type = HOEL_DB_TYPE_MARIADB;
+    conn->json_cache = NULL;
     conn->connection = o_malloc(sizeof(struct _h_mariadb));
     if (conn->connection == NULL) {
       y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for conn->connection");
@@ -84,6 +166,13 @@ struct _h_connection * h_connect_mariadb(const char * host, const char * user, c
       h_free(conn);
       return NULL;
     }
+    ((struct _h_mariadb *)conn->connection)->transaction = 0;
+    ((struct _h_mariadb *)conn->connection)->async = H_MARIADB_ASYNC_NONE;
+    ((struct _h_mariadb *)conn->connection)->async_status = 0;
+    ((struct _h_mariadb *)conn->connection)->async_error = H_OK;
+    ((struct _h_mariadb *)conn->connection)->async_result = NULL;
+    ((struct _h_mariadb *)conn->connection)->nonblock = 0;
+    ((struct _h_mariadb *)conn->connection)->max_packet = 0;
     if (mysql_real_connect(((struct _h_mariadb *)conn->connection)->db_handle,
                            host, user, passwd, db, port, unix_socket, CLIENT_COMPRESS) == NULL) {
       y_log_message(Y_LOG_LEVEL_ERROR, "Error connecting to mariadb database %s", db);
@@ -94,6 +183,7 @@ struct _h_connection * h_connect_mariadb(const char * host, const char * user, c
     } else {
       /* Set MYSQL_OPT_RECONNECT to true to reconnect automatically when connection is closed by the server (to avoid CR_SERVER_GONE_ERROR) */
       mysql_options(((struct _h_mariadb *)conn->connection)->db_handle, MYSQL_OPT_RECONNECT, &reconnect);
+      ((struct _h_mariadb *)conn->connection)->max_packet = h_mariadb_max_packet(((struct _h_mariadb *)conn->connection)->db_handle);
       /* Initialize MUTEX for connection */
       pthread_mutexattr_init ( &mutexattr );
       pthread_mutexattr_settype( &mutexattr, PTHREAD_MUTEX_RECURSIVE );
@@ -101,6 +191,7 @@ struct _h_connection * h_connect_mariadb(const char * host, const char * user, c
         y_log_message(Y_LOG_LEVEL_ERROR, "Impossible to initialize Mutex Lock for MariaDB connection");
       }
       pthread_mutexattr_destroy( &mutexattr );
+      h_json_cache_init(conn);
       return conn;
     }
   }
@@ -111,11 +202,163 @@ struct _h_connection * h_connect_mariadb(const char * host, const char * user, c
  * close connection to database
  */
 void h_close_mariadb(struct _h_connection * conn) {
+  if (((struct _h_mariadb *)conn->connection)->async_result != NULL) {
+    mysql_free_result(((struct _h_mariadb *)conn->connection)->async_result);
+  }
   mysql_close(((struct _h_mariadb *)conn->connection)->db_handle);
   mysql_library_end();
   pthread_mutex_destroy(&((struct _h_mariadb *)conn->connection)->lock);
 }
 
+/**
+ * Check a mariadb connection before it's used again
+ * mysql_ping reconnects if the server has closed the connection
+ * return H_OK on success
+ */
+int h_check_connection_mariadb(const struct _h_connection * conn) {
+  int res;
+  
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR;
+  }
+  if (((struct _h_mariadb *)conn->connection)->transaction) {
+    /* The transaction belongs to this thread, release the lock taken by h_transaction_begin_mariadb and rollback */
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel - Rollback transaction left open");
+    ((struct _h_mariadb *)conn->connection)->transaction = 0;
+    mysql_rollback(((struct _h_mariadb *)conn->connection)->db_handle);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  }
+  if (mysql_ping(((struct _h_mariadb *)conn->connection)->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error mariadb connection lost");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    res = H_ERROR_CONNECTION;
+  } else {
+    res = H_OK;
+  }
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  return res;
+}
+
+/**
+ * Start a transaction on a mariadb connection
+ * The connection stays locked until the transaction ends with h_transaction_end_mariadb
+ * return H_OK on success
+ */
+int h_transaction_begin_mariadb(const struct _h_connection * conn) {
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  
+  if (pthread_mutex_lock(&mariadb->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (mariadb->transaction || mariadb->async != H_MARIADB_ASYNC_NONE) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection busy, a transaction or an asynchronous query is running");
+    pthread_mutex_unlock(&mariadb->lock);
+    return H_ERROR_PARAMS;
+  }
+  if (mysql_query(mariadb->db_handle, "START TRANSACTION")) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error starting transaction");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(mariadb->db_handle));
+    pthread_mutex_unlock(&mariadb->lock);
+    return H_ERROR_QUERY;
+  }
+  mariadb->transaction = 1;
+  return H_OK;
+}
+
+/**
+ * Commit or rollback the transaction on a mariadb connection and unlock the connection
+ * If the commit fails, the transaction is rolled back
+ * return H_OK on success
+ */
+int h_transaction_end_mariadb(const struct _h_connection * conn, int commit) {
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  int ret = H_OK;
+  
+  if (pthread_mutex_lock(&mariadb->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!mariadb->transaction) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no transaction running");
+    pthread_mutex_unlock(&mariadb->lock);
+    return H_ERROR_PARAMS;
+  }
+  if (commit?mysql_commit(mariadb->db_handle):mysql_rollback(mariadb->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error ending transaction");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(mariadb->db_handle));
+    if (commit) {
+      mysql_rollback(mariadb->db_handle);
+    }
+    ret = H_ERROR_QUERY;
+  }
+  mariadb->transaction = 0;
+  /* Release the lock taken by h_transaction_begin_mariadb */
+  pthread_mutex_unlock(&mariadb->lock);
+  pthread_mutex_unlock(&mariadb->lock);
+  return ret;
+}
+
+/**
+ * Check if a transaction is open on the mariadb connection,
+ * started with h_transaction_begin_mariadb or by a query
+ * return 1 if a transaction is open, 0 otherwise
+ */
+static int h_mariadb_in_transaction(struct _h_mariadb * mariadb) {
+  unsigned int server_status = 0;
+  
+  if (mariadb->transaction) {
+    return 1;
+  }
+#ifdef H_MARIADB_BULK
+  /* mariadb_get_infov comes with Connector/C 3 too */
+  if (mariadb_get_infov(mariadb->db_handle, MARIADB_CONNECTION_SERVER_STATUS, &server_status)) {
+    return 0;
+  }
+#else
+  server_status = mariadb->db_handle->server_status;
+#endif
+  return (server_status & SERVER_STATUS_IN_TRANS)?1:0;
+}
+
+/**
+ * Check if a transaction is open on a mariadb connection, started with h_transaction_begin_mariadb or by a query
+ * return 1 if a transaction is open, 0 otherwise
+ */
+int h_in_transaction_mariadb(const struct _h_connection * conn) {
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&mariadb->lock)) {
+    return 0;
+  }
+  ret = h_mariadb_in_transaction(mariadb);
+  pthread_mutex_unlock(&mariadb->lock);
+  return ret;
+}
+
+/**
+ * Execute a savepoint query in the transaction of a mariadb connection
+ * return H_OK on success
+ */
+int h_transaction_query_mariadb(const struct _h_connection * conn, const char * query) {
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  int ret = H_OK;
+  
+  if (pthread_mutex_lock(&mariadb->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!mariadb->transaction) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no transaction running");
+    ret = H_ERROR_PARAMS;
+  } else if (mysql_query(mariadb->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(mariadb->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    ret = H_ERROR_QUERY;
+  }
+  pthread_mutex_unlock(&mariadb->lock);
+  return ret;
+}
+
 /**
  * escape a string
  * returned value must be free'd after use
@@ -167,185 +410,20 @@ long long int h_last_insert_id_mariadb(const struct _h_connection * conn) {
 }
 
 /**
- * h_execute_query_mariadb
- * Execute a query on a mariadb connection, set the result structure with the returned values
- * Should not be executed by the user because all parameters are supposed to be correct
- * if result is NULL, the query is executed but no value will be returned
- * return H_OK on success
- */
-int h_execute_query_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * h_result) {
-  MYSQL_RES * result;
-  uint num_fields, col, row;
-  MYSQL_ROW m_row;
-  MYSQL_FIELD * fields;
-  struct _h_data * data, * cur_row = NULL;
-  unsigned long * lengths;
-  int res;
-
-  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
-    return H_ERROR_QUERY;
-  }
-  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
-    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-    return H_ERROR_QUERY;
-  }
-
-  if (h_result != NULL) {
-    result = mysql_store_result(((struct _h_mariadb *)conn->connection)->db_handle);
-
-    if (result == NULL) {
-      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_store_result");
-      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
-      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-      return H_ERROR_QUERY;
-    }
-
-    num_fields = mysql_num_fields(result);
-    fields = mysql_fetch_fields(result);
-
-    h_result->nb_rows = 0;
-    h_result->nb_columns = num_fields;
-    h_result->data = NULL;
-    for (row = 0; (m_row = mysql_fetch_row(result)) != NULL; row++) {
-      cur_row = NULL;
-      lengths = mysql_fetch_lengths(result);
-      for (col=0; col<num_fields; col++) {
-        data = h_get_mariadb_value(m_row[col], lengths[col], (int)fields[col].type);
-        res = h_row_add_data(&cur_row, data, (int)col);
-        h_clean_data_full(data);
-        if (res != H_OK) {
-          mysql_free_result(result);
-          pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-          return res;
-        }
-      }
-      res = h_result_add_row(h_result, cur_row, (int)row);
-      if (res != H_OK) {
-        mysql_free_result(result);
-        pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-        return res;
-      }
-    }
-    mysql_free_result(result);
-  }
-
-  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-  return H_OK;
-}
-
-/**
- * h_execute_query_json_mariadb
- * Execute a query on a mariadb connection, set the returned values in the json result
- * Should not be executed by the user because all parameters are supposed to be correct
- * return H_OK on success
+ * Return the maximum length of a sql query on a mariadb connection, 0 if unknown
  */
-int h_execute_query_json_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result) {
-  MYSQL_RES * result;
-  uint num_fields, col;
-  MYSQL_ROW m_row;
-  MYSQL_FIELD * fields;
-  unsigned long * lengths;
-  json_t * j_data;
-  struct _h_data * h_data;
-  char date_stamp[64] = {0};
-
-  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
-    return H_ERROR_QUERY;
-  }
-
-  if (j_result == NULL) {
-    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-    return H_ERROR_PARAMS;
-  }
-
-  *j_result = json_array();
-  if (*j_result == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for *j_result");
-    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-    return H_ERROR_MEMORY;
-  }
-
-  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
-    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-    json_decref(*j_result);
-    return H_ERROR_QUERY;
-  }
-
-  result = mysql_store_result(((struct _h_mariadb *)conn->connection)->db_handle);
-
-  if (result == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_store_result");
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
-    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-    json_decref(*j_result);
-    return H_ERROR_QUERY;
-  }
-
-  num_fields = mysql_num_fields(result);
-  fields = mysql_fetch_fields(result);
-
-  while ((m_row = mysql_fetch_row(result)) != NULL) {
-    j_data = json_object();
-    if (j_data == NULL) {
-      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for j_data");
-      json_decref(*j_result);
-      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-      json_decref(*j_result);
-      return H_ERROR_MEMORY;
-    }
-    lengths = mysql_fetch_lengths(result);
-    for (col=0; col<num_fields; col++) {
-      h_data = h_get_mariadb_value(m_row[col], lengths[col], (int)fields[col].type);
-      switch (h_data->type) {
-        case HOEL_COL_TYPE_INT:
-          json_object_set_new(j_data, fields[col].name, json_integer(((struct _h_type_int *)h_data->t_data)->value));
-          break;
-        case HOEL_COL_TYPE_DOUBLE:
-          json_object_set_new(j_data, fields[col].name, json_real(((struct _h_type_double *)h_data->t_data)->value));
-          break;
-        case HOEL_COL_TYPE_TEXT:
-          json_object_set_new(j_data, fields[col].name, json_string(((struct _h_type_text *)h_data->t_data)->value));
-          break;
-        case HOEL_COL_TYPE_DATE:
-          strftime (date_stamp, sizeof(date_stamp), "%Y-%m-%dT%H:%M:%S", &((struct _h_type_datetime *)h_data->t_data)->value);
-          json_object_set_new(j_data, fields[col].name, json_string(date_stamp));
-          break;
-        case HOEL_COL_TYPE_BLOB:
-          json_object_set_new(j_data, fields[col].name, json_stringn(((struct _h_type_blob *)h_data->t_data)->value, ((struct _h_type_blob *)h_data->t_data)->length));
-          break;
-        case HOEL_COL_TYPE_NULL:
-          json_object_set_new(j_data, fields[col].name, json_null());
-          break;
-      }
-      h_clean_data_full(h_data);
-    }
-    json_array_append_new(*j_result, j_data);
-    j_data = NULL;
-  }
-  mysql_free_result(result);
-  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
-
-  return H_OK;
+size_t h_max_query_length_mariadb(const struct _h_connection * conn) {
+  return (size_t)((struct _h_mariadb *)conn->connection)->max_packet;
 }
 
 /**
- * h_get_mariadb_value
- * convert value into a struct _h_data * depening on the m_type given
- * returned value must be free'd with h_clean_data_full after use
+ * Decode a mariadb value into a struct _h_cell depending on the m_type given
+ * text and blob values are not copied
  */
-struct _h_data * h_get_mariadb_value(const char * value, const unsigned long length, const int m_type) {
-  struct _h_data * data = NULL;
-  long long int i_value;
-  double d_value;
-  struct tm tm_value;
+static void h_get_mariadb_cell(const char * value, const unsigned long length, const int m_type, struct _h_cell * cell) {
   char * endptr;
 
+  cell->type = HOEL_COL_TYPE_NULL;
   if (value != NULL) {
     switch (m_type) {
       case FIELD_TYPE_DECIMAL:
@@ -356,54 +434,50 @@ struct _h_data * h_get_mariadb_value(const char * value, const unsigned long len
       case FIELD_TYPE_LONGLONG:
       case FIELD_TYPE_INT24:
       case FIELD_TYPE_YEAR:
-        i_value = strtoll(value, &endptr, 10);
-        if (endptr != value) {
-          data = h_new_data_int(i_value);
-        } else {
-          data = h_new_data_null();
+        errno = 0;
+        cell->i_value = strtoll(value, &endptr, 10);
+        if (endptr != value && errno == ERANGE) {
+          /* BIGINT UNSIGNED and DECIMAL values out of the range of a long long are returned as text */
+          cell->type = HOEL_COL_TYPE_TEXT;
+          cell->value = value;
+          cell->length = length;
+        } else if (endptr != value) {
+          cell->type = HOEL_COL_TYPE_INT;
         }
         break;
       case FIELD_TYPE_BIT:
-        i_value = strtol(value, &endptr, 2);
+        cell->i_value = strtol(value, &endptr, 2);
         if (endptr != value) {
-          data = h_new_data_int(i_value);
-        } else {
-          data = h_new_data_null();
+          cell->type = HOEL_COL_TYPE_INT;
         }
         break;
       case FIELD_TYPE_FLOAT:
       case FIELD_TYPE_DOUBLE:
-        d_value = strtod(value, &endptr);
+        cell->d_value = strtod(value, &endptr);
         if (endptr != value) {
-          data = h_new_data_double(d_value);
-        } else {
-          data = h_new_data_null();
+          cell->type = HOEL_COL_TYPE_DOUBLE;
         }
         break;
       case FIELD_TYPE_NULL:
-        data = h_new_data_null();
         break;
       case FIELD_TYPE_DATE:
-        if (strptime(value, "%Y-%m-%d", &tm_value) == NULL) {
-          data = h_new_data_null();
-        } else {
-          data = h_new_data_datetime(&tm_value);
+        memset(&cell->dt_value, 0, sizeof(struct tm));
+        if (strptime(value, "%Y-%m-%d", &cell->dt_value) != NULL) {
+          cell->type = HOEL_COL_TYPE_DATE;
         }
         break;
       case FIELD_TYPE_TIME:
-        if (strptime(value, "%H:%M:%S", &tm_value) == NULL) {
-          data = h_new_data_null();
-        } else {
-          data = h_new_data_datetime(&tm_value);
+        memset(&cell->dt_value, 0, sizeof(struct tm));
+        if (strptime(value, "%H:%M:%S", &cell->dt_value) != NULL) {
+          cell->type = HOEL_COL_TYPE_DATE;
         }
         break;
       case FIELD_TYPE_TIMESTAMP:
       case FIELD_TYPE_DATETIME:
       case FIELD_TYPE_NEWDATE:
-        if (strptime(value, "%Y-%m-%d %H:%M:%S", &tm_value) == NULL) {
-          data = h_new_data_null();
-        } else {
-          data = h_new_data_datetime(&tm_value);
+        memset(&cell->dt_value, 0, sizeof(struct tm));
+        if (strptime(value, "%Y-%m-%d %H:%M:%S", &cell->dt_value) != NULL) {
+          cell->type = HOEL_COL_TYPE_DATE;
         }
         break;
       case FIELD_TYPE_TINY_BLOB:
@@ -411,9 +485,9 @@ struct _h_data * h_get_mariadb_value(const char * value, const unsigned long len
       case FIELD_TYPE_LONG_BLOB:
       case FIELD_TYPE_BLOB:
         if (length > 0) {
-          data = h_new_data_blob(value, length);
-        } else {
-          data = h_new_data_null();
+          cell->type = HOEL_COL_TYPE_BLOB;
+          cell->value = value;
+          cell->length = length;
         }
         break;
       case FIELD_TYPE_VAR_STRING:
@@ -421,33 +495,1643 @@ struct _h_data * h_get_mariadb_value(const char * value, const unsigned long len
       case FIELD_TYPE_SET:
       case FIELD_TYPE_GEOMETRY:
       default:
-        data = h_new_data_text(value, length);
+        cell->type = HOEL_COL_TYPE_TEXT;
+        cell->value = value;
+        cell->length = length;
         break;
     }
-  } else {
-    data = h_new_data_null();
   }
-  return data;
 }
-#else
 
 /**
- * Dummy functions when Hoel is not built with MariaDB
+ * Set the rows of a mariadb result in the result structure
+ * return H_OK on success
  */
-struct _h_connection * h_connect_mariadb(const char * host, const char * user, const char * passwd, const char * db, const unsigned int port, const char * unix_socket) {
-  UNUSED(host);
-  UNUSED(user);
-  UNUSED(passwd);
-  UNUSED(db);
-  UNUSED(port);
-  UNUSED(unix_socket);
-  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
-  return NULL;
-}
+static int h_mariadb_result_rows(MYSQL_RES * result, struct _h_result * h_result, int options) {
+  uint num_fields, col;
+  MYSQL_ROW m_row;
+  MYSQL_FIELD * fields;
+  struct _h_data * cur_row = NULL;
+  struct _h_cell cell;
+  unsigned long * lengths;
+  int res;
 
-void h_close_mariadb(struct _h_connection * conn) {
-  UNUSED(conn);
-  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  num_fields = mysql_num_fields(result);
+  fields = mysql_fetch_fields(result);
+
+  if ((res = h_result_init(h_result, num_fields, options)) != H_OK) {
+    return res;
+  }
+  while ((m_row = mysql_fetch_row(result)) != NULL) {
+    lengths = mysql_fetch_lengths(result);
+    res = h_result_new_row(h_result, &cur_row);
+    for (col=0; res == H_OK && col<num_fields; col++) {
+      h_get_mariadb_cell(m_row[col], lengths[col], (int)fields[col].type, &cell);
+      res = h_result_set_cell(h_result, &cur_row[col], &cell);
+    }
+    if (res != H_OK) {
+      h_clean_result(h_result);
+      return res;
+    }
+  }
+  return H_OK;
+}
+
+/**
+ * Execute the query as a prepared statement on a mariadb connection and set the cursor on the rows returned,
+ * so the values are received in the binary protocol
+ * The query must not have parameters, the statement must be finalized after the cursor is closed
+ * return H_OK on success
+ */
+static int h_mariadb_binary_cursor_open(const struct _h_connection * conn, const char * query, struct _h_statement * stmt, struct _h_cursor * cursor) {
+  int ret;
+  
+  memset(stmt, 0, sizeof(struct _h_statement));
+  stmt->conn = conn;
+  if ((ret = h_prepare_mariadb(conn, query, stmt)) != H_OK) {
+    return ret;
+  }
+  if (stmt->nb_params) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error query with parameters, use h_prepare instead");
+    h_finalize_mariadb(stmt);
+    return H_ERROR_PARAMS;
+  }
+  cursor->conn = conn;
+  cursor->statement = stmt;
+  cursor->nb_columns = 0;
+  cursor->end = 0;
+  cursor->handle = NULL;
+  if ((ret = h_cursor_open_prepared_mariadb(stmt, cursor)) != H_OK) {
+    h_finalize_mariadb(stmt);
+  }
+  return ret;
+}
+
+/**
+ * Execute the query on a mariadb connection with the binary protocol and set the rows in the result structure
+ * if h_result is NULL, the query is executed but no value will be returned
+ * return H_OK on success
+ */
+static int h_mariadb_binary_result_rows(const struct _h_connection * conn, const char * query, struct _h_result * h_result, int options) {
+  struct _h_statement stmt;
+  struct _h_cursor cursor;
+  struct _h_data * cur_row = NULL;
+  struct _h_cell cell;
+  unsigned int col;
+  int ret;
+  
+  if ((ret = h_mariadb_binary_cursor_open(conn, query, &stmt, &cursor)) != H_OK) {
+    return ret;
+  }
+  if (h_result != NULL) {
+    ret = h_result_init(h_result, cursor.nb_columns, options);
+  }
+  while (ret == H_OK && (ret = h_cursor_fetch_mariadb(&cursor)) == H_OK && !cursor.end) {
+    if (h_result != NULL) {
+      ret = h_result_new_row(h_result, &cur_row);
+      for (col=0; ret == H_OK && col<cursor.nb_columns; col++) {
+        h_cursor_get_cell_mariadb(&cursor, col, &cell);
+        ret = h_result_set_cell(h_result, &cur_row[col], &cell);
+      }
+    }
+  }
+  if (ret != H_OK && h_result != NULL) {
+    h_clean_result(h_result);
+  }
+  h_cursor_close_mariadb(&cursor);
+  h_finalize_mariadb(&stmt);
+  return ret;
+}
+
+/**
+ * Execute the query on a mariadb connection with the binary protocol and append the rows to the json result
+ * j_rows is the json array of the rows in j_result
+ * return H_OK on success
+ */
+static int h_mariadb_binary_result_json(const struct _h_connection * conn, const char * query, json_t * j_result, json_t * j_rows, int options) {
+  struct _h_statement stmt;
+  struct _h_cursor cursor;
+  struct _h_cell cell;
+  json_t * j_data;
+  unsigned int col;
+  int ret;
+  
+  if ((ret = h_mariadb_binary_cursor_open(conn, query, &stmt, &cursor)) != H_OK) {
+    return ret;
+  }
+  for (col=0; col<cursor.nb_columns; col++) {
+    h_json_result_add_column(j_result, h_cursor_get_name_mariadb(&cursor, col));
+  }
+  while ((ret = h_cursor_fetch_mariadb(&cursor)) == H_OK && !cursor.end) {
+    if ((j_data = h_json_row_new(options)) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for j_data");
+      ret = H_ERROR_MEMORY;
+      break;
+    }
+    for (col=0; col<cursor.nb_columns; col++) {
+      h_cursor_get_cell_mariadb(&cursor, col, &cell);
+      h_json_row_set(j_data, h_cursor_get_name_mariadb(&cursor, col), h_cell_to_json(&cell));
+    }
+    json_array_append_new(j_rows, j_data);
+  }
+  h_cursor_close_mariadb(&cursor);
+  h_finalize_mariadb(&stmt);
+  return ret;
+}
+
+/**
+ * h_execute_query_mariadb
+ * Execute a query on a mariadb connection, set the result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * return H_OK on success
+ */
+int h_execute_query_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * h_result) {
+  return h_execute_query_options_mariadb(conn, query, h_result, H_OPTION_NONE);
+}
+
+/**
+ * h_execute_query_options_mariadb
+ * Execute a query on a mariadb connection, set the result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * if options has H_OPTION_ARENA set, the result values are allocated in an arena
+ * if options has H_OPTION_BINARY set, the query is executed as a prepared statement
+ * and the values are received in the binary protocol
+ * return H_OK on success
+ */
+int h_execute_query_options_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * h_result, int options) {
+  MYSQL_RES * result;
+  int res;
+
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (options & H_OPTION_BINARY) {
+    res = h_mariadb_binary_result_rows(conn, query, h_result, options);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return res;
+  }
+  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+
+  if (h_result != NULL) {
+    result = mysql_store_result(((struct _h_mariadb *)conn->connection)->db_handle);
+
+    if (result == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_store_result");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+      return H_ERROR_QUERY;
+    }
+
+    res = h_mariadb_result_rows(result, h_result, options);
+    mysql_free_result(result);
+    if (res != H_OK) {
+      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+      return res;
+    }
+  }
+
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  return H_OK;
+}
+
+/**
+ * h_execute_query_columnar_mariadb
+ * Execute a query on a mariadb connection, set the columnar result structure with the returned values
+ * The rows are fetched one by one from the server and copied in the columns
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_columnar_mariadb(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result) {
+  MYSQL_RES * m_result;
+  uint num_fields, col;
+  MYSQL_ROW m_row;
+  MYSQL_FIELD * fields;
+  struct _h_cell cell;
+  unsigned long * lengths;
+  int res;
+
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+
+  m_result = mysql_use_result(((struct _h_mariadb *)conn->connection)->db_handle);
+  if (m_result == NULL) {
+    if (mysql_field_count(((struct _h_mariadb *)conn->connection)->db_handle)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_use_result");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+      return H_ERROR_QUERY;
+    }
+    /* The query didn't return any row */
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return h_result_columnar_init(result, 0);
+  }
+
+  num_fields = mysql_num_fields(m_result);
+  fields = mysql_fetch_fields(m_result);
+
+  res = h_result_columnar_init(result, num_fields);
+  for (col=0; res == H_OK && col<num_fields; col++) {
+    res = h_result_columnar_set_name(result, col, fields[col].name);
+  }
+  while (res == H_OK && (m_row = mysql_fetch_row(m_result)) != NULL) {
+    lengths = mysql_fetch_lengths(m_result);
+    res = h_result_columnar_new_row(result);
+    for (col=0; res == H_OK && col<num_fields; col++) {
+      h_get_mariadb_cell(m_row[col], lengths[col], (int)fields[col].type, &cell);
+      res = h_result_columnar_set_cell(result, col, &cell);
+    }
+  }
+  if (res == H_OK && mysql_errno(((struct _h_mariadb *)conn->connection)->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_fetch_row");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    res = H_ERROR_QUERY;
+  }
+  mysql_free_result(m_result);
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  if (res != H_OK) {
+    h_clean_result_columnar(result);
+  }
+  return res;
+}
+
+/**
+ * h_execute_query_value_mariadb
+ * Execute a query on a mariadb connection, set the value result structure with the returned values
+ * The rows are fetched one by one from the server and copied in the result
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_value_mariadb(const struct _h_connection * conn, const char * query, struct _h_value_result * result) {
+  MYSQL_RES * m_result;
+  uint num_fields, col;
+  MYSQL_ROW m_row;
+  MYSQL_FIELD * fields;
+  struct _h_value * cur_row = NULL;
+  struct _h_cell cell;
+  unsigned long * lengths;
+  int res;
+
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+
+  m_result = mysql_use_result(((struct _h_mariadb *)conn->connection)->db_handle);
+  if (m_result == NULL) {
+    if (mysql_field_count(((struct _h_mariadb *)conn->connection)->db_handle)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_use_result");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+      return H_ERROR_QUERY;
+    }
+    /* The query didn't return any row */
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return h_value_result_init(result, 0);
+  }
+
+  num_fields = mysql_num_fields(m_result);
+  fields = mysql_fetch_fields(m_result);
+
+  res = h_value_result_init(result, num_fields);
+  while (res == H_OK && (m_row = mysql_fetch_row(m_result)) != NULL) {
+    lengths = mysql_fetch_lengths(m_result);
+    res = h_value_result_new_row(result, &cur_row);
+    for (col=0; res == H_OK && col<num_fields; col++) {
+      h_get_mariadb_cell(m_row[col], lengths[col], (int)fields[col].type, &cell);
+      res = h_value_result_set_cell(result, &cur_row[col], &cell);
+    }
+  }
+  if (res == H_OK && mysql_errno(((struct _h_mariadb *)conn->connection)->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_fetch_row");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    res = H_ERROR_QUERY;
+  }
+  mysql_free_result(m_result);
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  if (res != H_OK) {
+    h_clean_value_result(result);
+  }
+  return res;
+}
+
+/**
+ * h_execute_query_view_mariadb
+ * Execute a query on a mariadb connection, set the result view with the returned values
+ * The MYSQL_RES is kept in the view until h_result_view_free is called
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_view_mariadb(const struct _h_connection * conn, const char * query, struct _h_result_view * view) {
+  MYSQL_RES * result;
+  uint num_fields, col;
+  MYSQL_ROW m_row;
+  MYSQL_FIELD * fields;
+  unsigned long * lengths;
+  unsigned int row;
+
+  view->type = HOEL_DB_TYPE_MARIADB;
+  view->nb_rows = 0;
+  view->nb_columns = 0;
+  view->result = NULL;
+  view->col_types = NULL;
+  view->rows = NULL;
+  view->lengths = NULL;
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+
+  result = mysql_store_result(((struct _h_mariadb *)conn->connection)->db_handle);
+  if (result == NULL) {
+    if (mysql_field_count(((struct _h_mariadb *)conn->connection)->db_handle)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_store_result");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+      return H_ERROR_QUERY;
+    }
+    /* The query didn't return any row */
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_OK;
+  }
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+
+  num_fields = mysql_num_fields(result);
+  fields = mysql_fetch_fields(result);
+  view->result = result;
+  view->nb_columns = num_fields;
+  view->nb_rows = (unsigned int)mysql_num_rows(result);
+  view->col_types = o_malloc(((size_t)num_fields+1)*sizeof(int));
+  view->rows = o_malloc(((size_t)view->nb_rows+1)*sizeof(void *));
+  view->lengths = o_malloc(((size_t)view->nb_rows*num_fields+1)*sizeof(unsigned long));
+  if (view->col_types == NULL || view->rows == NULL || view->lengths == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for view");
+    h_result_view_free(view);
+    return H_ERROR_MEMORY;
+  }
+  for (col=0; col<num_fields; col++) {
+    view->col_types[col] = (int)fields[col].type;
+  }
+  /* Only the row pointers and the lengths are kept, the values stay in the MYSQL_RES */
+  for (row=0; row<view->nb_rows && (m_row = mysql_fetch_row(result)) != NULL; row++) {
+    lengths = mysql_fetch_lengths(result);
+    view->rows[row] = m_row;
+    memcpy(view->lengths + (size_t)row*num_fields, lengths, num_fields*sizeof(unsigned long));
+  }
+  view->nb_rows = row;
+  return H_OK;
+}
+
+/**
+ * Return the value of the column col in the row row of a mariadb result view as returned by the database
+ */
+const char * h_result_view_get_value_mariadb(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length) {
+  const char * value = ((MYSQL_ROW)view->rows[row])[col];
+  if (value != NULL && length != NULL) {
+    * length = view->lengths[(size_t)row*view->nb_columns+col];
+  }
+  return value;
+}
+
+/**
+ * Decode the value of the column col in the row row of a mariadb result view
+ */
+void h_result_view_get_cell_mariadb(const struct _h_result_view * view, unsigned int row, unsigned int col, struct _h_cell * cell) {
+  h_get_mariadb_cell(((MYSQL_ROW)view->rows[row])[col], view->lengths[(size_t)row*view->nb_columns+col], view->col_types[col], cell);
+}
+
+/**
+ * h_result_view_free_mariadb
+ * Free the driver result of a mariadb result view
+ */
+void h_result_view_free_mariadb(struct _h_result_view * view) {
+  if (view->result != NULL) {
+    mysql_free_result(view->result);
+  }
+}
+
+/**
+ * Execute the query and set the mariadb cursor on the rows returned
+ * The rows are read from the server with mysql_use_result
+ * The connection is locked until the cursor is closed
+ * return H_OK on success
+ */
+int h_cursor_open_mariadb(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor) {
+  struct _h_mariadb_cursor * m_cursor;
+
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+  if ((m_cursor = o_malloc(sizeof(struct _h_mariadb_cursor))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_cursor");
+    mysql_free_result(mysql_use_result(((struct _h_mariadb *)conn->connection)->db_handle));
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_MEMORY;
+  }
+  m_cursor->fields = NULL;
+  m_cursor->row = NULL;
+  m_cursor->lengths = NULL;
+  m_cursor->result = mysql_use_result(((struct _h_mariadb *)conn->connection)->db_handle);
+  if (m_cursor->result == NULL) {
+    if (mysql_field_count(((struct _h_mariadb *)conn->connection)->db_handle)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_use_result");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+      h_free(m_cursor);
+      pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+      return H_ERROR_QUERY;
+    }
+    /* The query didn't return any row */
+    cursor->end = 1;
+  } else {
+    cursor->nb_columns = mysql_num_fields(m_cursor->result);
+    m_cursor->fields = mysql_fetch_fields(m_cursor->result);
+  }
+  cursor->handle = m_cursor;
+  return H_OK;
+}
+
+/**
+ * Set the buffer type and the buffer size of the result column bind from the type of the field
+ * The integers, doubles and dates are fetched in their binary format, so they aren't parsed,
+ * the other values are fetched as strings, like the BIGINT UNSIGNED values that may not fit in a long long,
+ * the TIME values that may be negative or longer than a day, and the FLOAT values, that would be widened
+ * to a double with the rounding error of the float, e.g. 1.100000023841858 instead of 1.1
+ * return the size of the buffer to allocate
+ */
+static unsigned long h_mariadb_statement_bind_result(const MYSQL_FIELD * field, MYSQL_BIND * bind) {
+  switch (field->type) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_YEAR:
+      /* The unsigned values of these types always fit in a long long */
+      bind->buffer_type = MYSQL_TYPE_LONGLONG;
+      bind->is_unsigned = (field->flags & UNSIGNED_FLAG)?1:0;
+      bind->buffer_length = sizeof(long long int);
+      break;
+    case MYSQL_TYPE_DOUBLE:
+      bind->buffer_type = MYSQL_TYPE_DOUBLE;
+      bind->buffer_length = sizeof(double);
+      break;
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_NEWDATE:
+      bind->buffer_type = MYSQL_TYPE_DATE;
+      bind->buffer_length = sizeof(MYSQL_TIME);
+      break;
+    case MYSQL_TYPE_TIMESTAMP:
+    case MYSQL_TYPE_DATETIME:
+      bind->buffer_type = MYSQL_TYPE_DATETIME;
+      bind->buffer_length = sizeof(MYSQL_TIME);
+      break;
+    case MYSQL_TYPE_LONGLONG:
+      if (!(field->flags & UNSIGNED_FLAG)) {
+        bind->buffer_type = MYSQL_TYPE_LONGLONG;
+        bind->buffer_length = sizeof(long long int);
+        break;
+      }
+      /* fall through */
+    default:
+      bind->buffer_type = MYSQL_TYPE_STRING;
+      bind->buffer_length = H_MARIADB_STMT_BUFFER_SIZE;
+      /* One more byte for the '\\0' written after the value */
+      return H_MARIADB_STMT_BUFFER_SIZE+1;
+  }
+  return bind->buffer_length;
+}
+
+/**
+ * Decode the value of the column col in the current row of a mariadb prepared statement
+ * text and blob values are not copied
+ */
+static void h_mariadb_statement_get_cell(const struct _h_mariadb_statement * m_stmt, unsigned int col, struct _h_cell * cell) {
+  const MYSQL_TIME * m_time;
+  
+  cell->type = HOEL_COL_TYPE_NULL;
+  if (m_stmt->is_null[col]) {
+    return;
+  }
+  switch (m_stmt->results[col].buffer_type) {
+    case MYSQL_TYPE_LONGLONG:
+      cell->type = HOEL_COL_TYPE_INT;
+      cell->i_value = *(long long int *)m_stmt->results[col].buffer;
+      break;
+    case MYSQL_TYPE_DOUBLE:
+      cell->type = HOEL_COL_TYPE_DOUBLE;
+      cell->d_value = *(double *)m_stmt->results[col].buffer;
+      break;
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_DATETIME:
+      m_time = (const MYSQL_TIME *)m_stmt->results[col].buffer;
+      if (!m_time->month || !m_time->day) {
+        /* Zero dates like 0000-00-00 aren't valid dates, the text protocol doesn't decode them either */
+        break;
+      }
+      memset(&cell->dt_value, 0, sizeof(struct tm));
+      cell->dt_value.tm_year = (int)m_time->year - 1900;
+      cell->dt_value.tm_mon = (int)m_time->month - 1;
+      cell->dt_value.tm_mday = (int)m_time->day;
+      cell->dt_value.tm_hour = (int)m_time->hour;
+      cell->dt_value.tm_min = (int)m_time->minute;
+      cell->dt_value.tm_sec = (int)m_time->second;
+      cell->type = HOEL_COL_TYPE_DATE;
+      break;
+    default:
+      h_get_mariadb_cell(m_stmt->results[col].buffer, m_stmt->lengths[col], (int)m_stmt->fields[col].type, cell);
+      break;
+  }
+}
+
+/**
+ * Read the next row of a mariadb prepared statement cursor, set cursor->end if there's no more row
+ * If a value doesn't fit in its buffer, the buffer is reallocated and the value is fetched again
+ * return H_OK on success
+ */
+static int h_cursor_fetch_prepared_mariadb(struct _h_cursor * cursor) {
+  struct _h_mariadb_statement * m_stmt = (struct _h_mariadb_statement *)cursor->handle;
+  unsigned int col;
+  int res, rebind = 0;
+  void * buffer;
+  
+  res = mysql_stmt_fetch(m_stmt->stmt);
+  if (res == MYSQL_NO_DATA) {
+    cursor->end = 1;
+    return H_OK;
+  } else if (res != 0 && res != MYSQL_DATA_TRUNCATED) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_stmt_fetch");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_stmt_error(m_stmt->stmt));
+    cursor->end = 1;
+    return H_ERROR_QUERY;
+  }
+  for (col=0; col<m_stmt->nb_columns; col++) {
+    if (m_stmt->results[col].buffer_type != MYSQL_TYPE_STRING) {
+      /* Binary values have a fixed size */
+      continue;
+    }
+    if (!m_stmt->is_null[col] && m_stmt->lengths[col] > m_stmt->results[col].buffer_length) {
+      if ((buffer = o_realloc(m_stmt->results[col].buffer, m_stmt->lengths[col]+1)) == NULL) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_stmt->results[col].buffer");
+        cursor->end = 1;
+        return H_ERROR_MEMORY;
+      }
+      m_stmt->results[col].buffer = buffer;
+      m_stmt->results[col].buffer_length = m_stmt->lengths[col];
+      if (mysql_stmt_fetch_column(m_stmt->stmt, &m_stmt->results[col], col, 0)) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_stmt_fetch_column");
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_stmt_error(m_stmt->stmt));
+        cursor->end = 1;
+        return H_ERROR_QUERY;
+      }
+      rebind = 1;
+    }
+    if (!m_stmt->is_null[col]) {
+      ((char *)m_stmt->results[col].buffer)[m_stmt->lengths[col]] = '\0';
+    }
+  }
+  if (rebind && mysql_stmt_bind_result(m_stmt->stmt, m_stmt->results)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_stmt_bind_result");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_stmt_error(m_stmt->stmt));
+    cursor->end = 1;
+    return H_ERROR_QUERY;
+  }
+  return H_OK;
+}
+
+/**
+ * Read the next row of a mariadb cursor, set cursor->end if there's no more row
+ * return H_OK on success
+ */
+int h_cursor_fetch_mariadb(struct _h_cursor * cursor) {
+  struct _h_mariadb_cursor * m_cursor = (struct _h_mariadb_cursor *)cursor->handle;
+  
+  if (cursor->statement != NULL) {
+    return h_cursor_fetch_prepared_mariadb(cursor);
+  }
+  if ((m_cursor->row = mysql_fetch_row(m_cursor->result)) != NULL) {
+    m_cursor->lengths = mysql_fetch_lengths(m_cursor->result);
+    return H_OK;
+  } else {
+    cursor->end = 1;
+    if (mysql_errno(((struct _h_mariadb *)cursor->conn->connection)->db_handle)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_fetch_row");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)cursor->conn->connection)->db_handle));
+      return H_ERROR_QUERY;
+    }
+    return H_OK;
+  }
+}
+
+/**
+ * Decode the value of the column col in the current row of a mariadb cursor
+ */
+void h_cursor_get_cell_mariadb(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell) {
+  struct _h_mariadb_cursor * m_cursor = (struct _h_mariadb_cursor *)cursor->handle;
+  struct _h_mariadb_statement * m_stmt;
+  
+  if (cursor->statement != NULL) {
+    m_stmt = (struct _h_mariadb_statement *)cursor->handle;
+    h_mariadb_statement_get_cell(m_stmt, col, cell);
+  } else {
+    h_get_mariadb_cell(m_cursor->row[col], m_cursor->lengths[col], (int)m_cursor->fields[col].type, cell);
+  }
+}
+
+/**
+ * Return the name of the column col of a mariadb cursor
+ */
+const char * h_cursor_get_name_mariadb(const struct _h_cursor * cursor, unsigned int col) {
+  if (cursor->statement != NULL) {
+    return ((struct _h_mariadb_statement *)cursor->handle)->fields[col].name;
+  } else {
+    return ((struct _h_mariadb_cursor *)cursor->handle)->fields[col].name;
+  }
+}
+
+/**
+ * Close a mariadb cursor, the rows not read are discarded by mysql_free_result
+ */
+void h_cursor_close_mariadb(struct _h_cursor * cursor) {
+  struct _h_mariadb_cursor * m_cursor = (struct _h_mariadb_cursor *)cursor->handle;
+  if (cursor->statement != NULL) {
+    mysql_stmt_free_result(((struct _h_mariadb_statement *)cursor->handle)->stmt);
+  } else {
+    if (m_cursor->result != NULL) {
+      mysql_free_result(m_cursor->result);
+    }
+    h_free(m_cursor);
+  }
+  pthread_mutex_unlock(&(((struct _h_mariadb *)cursor->conn->connection)->lock));
+}
+
+/**
+ * Free the mariadb prepared statement handle
+ */
+static void h_mariadb_statement_free(struct _h_mariadb_statement * m_stmt) {
+  unsigned int col;
+  
+  if (m_stmt->stmt != NULL) {
+    mysql_stmt_close(m_stmt->stmt);
+  }
+  if (m_stmt->metadata != NULL) {
+    mysql_free_result(m_stmt->metadata);
+  }
+  for (col=0; m_stmt->results != NULL && col<m_stmt->nb_columns; col++) {
+    h_free(m_stmt->results[col].buffer);
+  }
+  h_free(m_stmt->params);
+  h_free(m_stmt->results);
+  h_free(m_stmt->lengths);
+  h_free(m_stmt->is_null);
+  h_free(m_stmt->error);
+  h_free(m_stmt);
+}
+
+/**
+ * Prepare the query on a mariadb connection
+ * The integer, double and date result columns are bound to buffers of their binary type,
+ * the other ones to string buffers which grow if a value is truncated
+ * return H_OK on success
+ */
+int h_prepare_mariadb(const struct _h_connection * conn, const char * query, struct _h_statement * stmt) {
+  struct _h_mariadb_statement * m_stmt;
+  unsigned int col;
+  int ret = H_OK;
+  
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if ((m_stmt = o_malloc(sizeof(struct _h_mariadb_statement))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_stmt");
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_MEMORY;
+  }
+  memset(m_stmt, 0, sizeof(struct _h_mariadb_statement));
+  if ((m_stmt->stmt = mysql_stmt_init(((struct _h_mariadb *)conn->connection)->db_handle)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_stmt->stmt");
+    ret = H_ERROR_MEMORY;
+  } else if (mysql_stmt_prepare(m_stmt->stmt, query, (unsigned long)o_strlen(query))) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error preparing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_stmt_error(m_stmt->stmt));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    ret = H_ERROR_QUERY;
+  } else {
+    stmt->nb_params = (unsigned int)mysql_stmt_param_count(m_stmt->stmt);
+    if (stmt->nb_params && (m_stmt->params = o_malloc(stmt->nb_params*sizeof(MYSQL_BIND))) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_stmt->params");
+      ret = H_ERROR_MEMORY;
+    } else if ((m_stmt->metadata = mysql_stmt_result_metadata(m_stmt->stmt)) != NULL) {
+      m_stmt->nb_columns = mysql_num_fields(m_stmt->metadata);
+      m_stmt->fields = mysql_fetch_fields(m_stmt->metadata);
+      m_stmt->results = o_malloc((m_stmt->nb_columns+1)*sizeof(MYSQL_BIND));
+      m_stmt->lengths = o_malloc((m_stmt->nb_columns+1)*sizeof(unsigned long));
+      m_stmt->is_null = o_malloc((m_stmt->nb_columns+1)*sizeof(my_bool));
+      m_stmt->error = o_malloc((m_stmt->nb_columns+1)*sizeof(my_bool));
+      if (m_stmt->results != NULL && m_stmt->lengths != NULL && m_stmt->is_null != NULL && m_stmt->error != NULL) {
+        memset(m_stmt->results, 0, (m_stmt->nb_columns+1)*sizeof(MYSQL_BIND));
+        for (col=0; ret == H_OK && col<m_stmt->nb_columns; col++) {
+          m_stmt->results[col].length = &m_stmt->lengths[col];
+          m_stmt->results[col].is_null = &m_stmt->is_null[col];
+          m_stmt->results[col].error = &m_stmt->error[col];
+          if ((m_stmt->results[col].buffer = o_malloc(h_mariadb_statement_bind_result(&m_stmt->fields[col], &m_stmt->results[col]))) == NULL) {
+            y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_stmt->results[col].buffer");
+            ret = H_ERROR_MEMORY;
+          }
+        }
+      } else {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_stmt->results");
+        ret = H_ERROR_MEMORY;
+      }
+    }
+  }
+  if (ret == H_OK) {
+    stmt->handle = m_stmt;
+  } else {
+    h_mariadb_statement_free(m_stmt);
+  }
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  return ret;
+}
+
+/**
+ * Execute the mariadb prepared statement with the values bound and set the cursor on the rows returned
+ * The connection is locked until the cursor is closed
+ * return H_OK on success
+ */
+int h_cursor_open_prepared_mariadb(struct _h_statement * stmt, struct _h_cursor * cursor) {
+  struct _h_mariadb_statement * m_stmt = (struct _h_mariadb_statement *)stmt->handle;
+  unsigned int i;
+  
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)stmt->conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (stmt->nb_params) {
+    memset(m_stmt->params, 0, stmt->nb_params*sizeof(MYSQL_BIND));
+  }
+  for (i=0; i<stmt->nb_params; i++) {
+    switch (stmt->params[i].type) {
+      case HOEL_COL_TYPE_INT:
+        m_stmt->params[i].buffer_type = MYSQL_TYPE_LONGLONG;
+        m_stmt->params[i].buffer = &stmt->params[i].v.i_value;
+        break;
+      case HOEL_COL_TYPE_DOUBLE:
+        m_stmt->params[i].buffer_type = MYSQL_TYPE_DOUBLE;
+        m_stmt->params[i].buffer = &stmt->params[i].v.d_value;
+        break;
+      case HOEL_COL_TYPE_TEXT:
+      case HOEL_COL_TYPE_BLOB:
+        m_stmt->params[i].buffer_type = stmt->params[i].type==HOEL_COL_TYPE_TEXT?MYSQL_TYPE_STRING:MYSQL_TYPE_BLOB;
+        m_stmt->params[i].buffer = (void *)h_value_get_bytes(&stmt->params[i]);
+        m_stmt->params[i].buffer_length = (unsigned long)stmt->params[i].length;
+        break;
+      default:
+        m_stmt->params[i].buffer_type = MYSQL_TYPE_NULL;
+        break;
+    }
+  }
+  if ((stmt->nb_params && mysql_stmt_bind_param(m_stmt->stmt, m_stmt->params)) ||
+      mysql_stmt_execute(m_stmt->stmt) ||
+      (m_stmt->metadata != NULL && mysql_stmt_bind_result(m_stmt->stmt, m_stmt->results))) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing prepared statement");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_stmt_error(m_stmt->stmt));
+    pthread_mutex_unlock(&(((struct _h_mariadb *)stmt->conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+  cursor->handle = m_stmt;
+  if (m_stmt->metadata != NULL) {
+    cursor->nb_columns = m_stmt->nb_columns;
+  } else {
+    /* The statement doesn't return any row */
+    cursor->end = 1;
+  }
+  return H_OK;
+}
+
+/**
+ * Free the mariadb prepared statement
+ */
+void h_finalize_mariadb(struct _h_statement * stmt) {
+  if (!pthread_mutex_lock(&(((struct _h_mariadb *)stmt->conn->connection)->lock))) {
+    h_mariadb_statement_free((struct _h_mariadb_statement *)stmt->handle);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)stmt->conn->connection)->lock));
+  }
+}
+
+/**
+ * Return the thread id of the server session of the mariadb connection
+ * The id changes when the client reconnects
+ */
+unsigned long h_session_id_mariadb(const struct _h_connection * conn) {
+  return mysql_thread_id(((struct _h_mariadb *)conn->connection)->db_handle);
+}
+
+#ifdef H_MARIADB_BULK
+/**
+ * Maximum number of rows sent with each execution of the bulk insert statement
+ */
+#define H_MARIADB_BULK_CHUNK_SIZE 4096
+
+/**
+ * Room kept in max_allowed_packet for the headers of a bulk insert packet
+ */
+#define H_MARIADB_BULK_PACKET_MARGIN 1024
+
+/**
+ * Values of a column of a bulk insert, bound as arrays
+ * values is an array of long long, double or char * depending on type,
+ * texts contains the numbers written in a text column, they must be free'd
+ */
+struct _h_mariadb_bulk_column {
+  const char           * name;
+  enum enum_field_types  type;
+  size_t                 size;
+  char                 * values;
+  unsigned long        * lengths;
+  char                 * indicators;
+  char                ** texts;
+};
+
+/**
+ * Set the type of a bulk insert column from its values
+ * The column is sent as integers, doubles or strings, strings if the values have different types
+ * return H_OK on success, H_ERROR_PARAMS if a value can't be bound
+ */
+static int h_mariadb_bulk_column_type(const json_t * j_values, struct _h_mariadb_bulk_column * column) {
+  json_t * j_row, * j_value;
+  size_t index;
+  int is_int = 0, is_real = 0, is_text = 0;
+  
+  json_array_foreach(j_values, index, j_row) {
+    if (!json_is_object(j_row)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error row %zu is not a json object", index);
+      return H_ERROR_PARAMS;
+    }
+    j_value = json_object_get(j_row, column->name);
+    if (json_is_string(j_value)) {
+      is_text = 1;
+    } else if (json_is_integer(j_value) || json_is_boolean(j_value)) {
+      is_int = 1;
+    } else if (json_is_real(j_value)) {
+      is_real = 1;
+    } else if (j_value != NULL && !json_is_null(j_value)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error value type not available with array binding");
+      return H_ERROR_PARAMS;
+    }
+  }
+  if (is_text || (!is_int && !is_real)) {
+    column->type = MYSQL_TYPE_STRING;
+    column->size = sizeof(char *);
+  } else if (is_real) {
+    column->type = MYSQL_TYPE_DOUBLE;
+    column->size = sizeof(double);
+  } else {
+    column->type = MYSQL_TYPE_LONGLONG;
+    column->size = sizeof(long long);
+  }
+  return H_OK;
+}
+
+/**
+ * Fill the arrays of a bulk insert column with its values
+ * return H_OK on success
+ */
+static int h_mariadb_bulk_column_set(const json_t * j_values, struct _h_mariadb_bulk_column * column) {
+  json_t * j_row, * j_value;
+  size_t index;
+  long long l_value;
+  double d_value;
+  const char * t_value;
+  
+  json_array_foreach(j_values, index, j_row) {
+    j_value = json_object_get(j_row, column->name);
+    if (j_value == NULL || json_is_null(j_value)) {
+      column->indicators[index] = STMT_INDICATOR_NULL;
+      memset(column->values + index*column->size, 0, column->size);
+      continue;
+    }
+    column->indicators[index] = STMT_INDICATOR_NONE;
+    if (column->type == MYSQL_TYPE_LONGLONG) {
+      l_value = json_is_integer(j_value)?(long long)json_integer_value(j_value):json_is_true(j_value);
+      memcpy(column->values + index*column->size, &l_value, sizeof(long long));
+    } else if (column->type == MYSQL_TYPE_DOUBLE) {
+      d_value = json_number_value(j_value);
+      memcpy(column->values + index*column->size, &d_value, sizeof(double));
+    } else {
+      if (json_is_string(j_value)) {
+        t_value = json_string_value(j_value);
+        column->lengths[index] = (unsigned long)json_string_length(j_value);
+      } else {
+        if (json_is_integer(j_value)) {
+          column->texts[index] = msprintf("%"JSON_INTEGER_FORMAT, json_integer_value(j_value));
+        } else if (json_is_real(j_value)) {
+          column->texts[index] = msprintf("%.17g", json_real_value(j_value));
+        } else {
+          column->texts[index] = o_strdup(json_is_true(j_value)?"1":"0");
+        }
+        if (column->texts[index] == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for column->texts[index]");
+          return H_ERROR_MEMORY;
+        }
+        t_value = column->texts[index];
+        column->lengths[index] = (unsigned long)o_strlen(t_value);
+      }
+      memcpy(column->values + index*column->size, &t_value, sizeof(t_value));
+    }
+  }
+  return H_OK;
+}
+
+/**
+ * Get the size of the values of a row in a bulk insert packet
+ * Each column has an indicator byte, then its binary value or its string with a length prefix up to 9 bytes
+ */
+static size_t h_mariadb_bulk_row_size(const struct _h_mariadb_bulk_column * columns, size_t nb_columns, size_t row) {
+  size_t col, size = 0;
+  
+  for (col=0; col<nb_columns; col++) {
+    size++;
+    if (columns[col].indicators[row] == STMT_INDICATOR_NONE) {
+      size += columns[col].type==MYSQL_TYPE_STRING?(size_t)columns[col].lengths[row]+9:columns[col].size;
+    }
+  }
+  return size;
+}
+#endif
+
+/**
+ * Insert the rows of j_values in the table on a mariadb connection
+ * The INSERT query is prepared once, then the values are bound column-wise as arrays
+ * with STMT_ATTR_ARRAY_SIZE and sent in binary form by chunks of at most H_MARIADB_BULK_CHUNK_SIZE rows
+ * and max_allowed_packet bytes, in a transaction, or in a savepoint if a transaction is already open,
+ * so none of the rows is inserted on error
+ * The columns are the keys of the first row, a column missing in another row is inserted as NULL,
+ * a key missing in the first row returns H_ERROR_PARAMS
+ * Without array binding in the client library, the rows are inserted with h_insert
+ * return H_OK on success
+ */
+int h_bulk_insert_mariadb(const struct _h_connection * conn, const char * table, const json_t * j_values) {
+#ifdef H_MARIADB_BULK
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  struct _h_mariadb_bulk_column * columns;
+  struct _h_sql_buffer buffer;
+  MYSQL_STMT * m_stmt = NULL;
+  MYSQL_BIND * binds;
+  const char ** names;
+  char * query;
+  size_t nb_rows = json_array_size(j_values), nb_columns, col, row, offset, max_bytes = 0, bytes, row_size;
+  unsigned int array_size;
+  int ret = H_OK, savepoint = 0;
+  
+  if ((ret = h_bulk_insert_columns(j_values, &names, &nb_columns)) != H_OK) {
+    return ret;
+  }
+  columns = o_malloc(nb_columns*sizeof(struct _h_mariadb_bulk_column));
+  binds = o_malloc(nb_columns*sizeof(MYSQL_BIND));
+  if (columns == NULL || binds == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for columns");
+    h_free(columns);
+    h_free(binds);
+    h_free(names);
+    return H_ERROR_MEMORY;
+  }
+  memset(columns, 0, nb_columns*sizeof(struct _h_mariadb_bulk_column));
+  memset(binds, 0, nb_columns*sizeof(MYSQL_BIND));
+  h_sql_buffer_init(&buffer);
+  h_sql_buffer_appendf(&buffer, "INSERT INTO %s (", table);
+  h_sql_buffer_append_columns(&buffer, names, nb_columns);
+  h_sql_buffer_append(&buffer, ") VALUES (");
+  for (col=0; col<nb_columns; col++) {
+    columns[col].name = names[col];
+    h_sql_buffer_append(&buffer, col?",?":"?");
+  }
+  h_sql_buffer_append_len(&buffer, ")", 1);
+  if ((query = h_sql_buffer_release(&buffer)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for query");
+    ret = H_ERROR_MEMORY;
+  }
+  
+  for (col=0; ret == H_OK && col<nb_columns; col++) {
+    if ((ret = h_mariadb_bulk_column_type(j_values, &columns[col])) == H_OK) {
+      columns[col].values = o_malloc(nb_rows*columns[col].size);
+      columns[col].indicators = o_malloc(nb_rows);
+      if (columns[col].type == MYSQL_TYPE_STRING) {
+        columns[col].lengths = o_malloc(nb_rows*sizeof(unsigned long));
+        if ((columns[col].texts = o_malloc(nb_rows*sizeof(char *))) != NULL) {
+          memset(columns[col].texts, 0, nb_rows*sizeof(char *));
+        }
+      }
+      if (columns[col].values == NULL || columns[col].indicators == NULL || (columns[col].type == MYSQL_TYPE_STRING && (columns[col].lengths == NULL || columns[col].texts == NULL))) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for columns[col]");
+        ret = H_ERROR_MEMORY;
+      } else {
+        ret = h_mariadb_bulk_column_set(j_values, &columns[col]);
+      }
+    }
+  }
+  
+  if (ret == H_OK) {
+    if (mariadb->max_packet > H_MARIADB_BULK_PACKET_MARGIN + 2*nb_columns) {
+      /* The packet also contains the statement id, the flags and the types of the columns */
+      max_bytes = mariadb->max_packet - H_MARIADB_BULK_PACKET_MARGIN - 2*nb_columns;
+    }
+    if (pthread_mutex_lock(&mariadb->lock)) {
+      ret = H_ERROR_QUERY;
+    } else {
+      if (mariadb->async != H_MARIADB_ASYNC_NONE) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query is running");
+        ret = H_ERROR_PARAMS;
+      } else {
+        savepoint = h_mariadb_in_transaction(mariadb);
+        if (mysql_query(mariadb->db_handle, savepoint?"SAVEPOINT hoel_bulk_insert":"START TRANSACTION")) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Error starting bulk insert transaction");
+          y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(mariadb->db_handle));
+          ret = H_ERROR_QUERY;
+        }
+      }
+      if (ret == H_OK) {
+        if ((m_stmt = mysql_stmt_init(mariadb->db_handle)) == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for m_stmt");
+          ret = H_ERROR_MEMORY;
+        } else if (mysql_stmt_prepare(m_stmt, query, (unsigned long)o_strlen(query))) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Error preparing sql query");
+          y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_stmt_error(m_stmt));
+          y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+          ret = H_ERROR_QUERY;
+        }
+        for (offset=0; ret == H_OK && offset<nb_rows; offset+=array_size) {
+          /* A chunk has at least one row, a row larger than max_allowed_packet is rejected by the server */
+          bytes = 0;
+          for (array_size=0; offset+array_size<nb_rows && array_size<H_MARIADB_BULK_CHUNK_SIZE; array_size++) {
+            row_size = h_mariadb_bulk_row_size(columns, nb_columns, offset+array_size);
+            if (max_bytes && array_size && bytes+row_size > max_bytes) {
+              break;
+            }
+            bytes += row_size;
+          }
+          for (col=0; col<nb_columns; col++) {
+            binds[col].buffer_type = columns[col].type;
+            binds[col].buffer = columns[col].values + offset*columns[col].size;
+            binds[col].length = columns[col].lengths!=NULL?columns[col].lengths+offset:NULL;
+            binds[col].u.indicator = columns[col].indicators + offset;
+          }
+          if (mysql_stmt_attr_set(m_stmt, STMT_ATTR_ARRAY_SIZE, &array_size) ||
+              mysql_stmt_bind_param(m_stmt, binds) ||
+              mysql_stmt_execute(m_stmt)) {
+            y_log_message(Y_LOG_LEVEL_ERROR, "Error executing bulk insert");
+            y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_stmt_error(m_stmt));
+            ret = H_ERROR_QUERY;
+          }
+        }
+        if (m_stmt != NULL) {
+          mysql_stmt_close(m_stmt);
+        }
+        if (ret == H_OK && mysql_query(mariadb->db_handle, savepoint?"RELEASE SAVEPOINT hoel_bulk_insert":"COMMIT")) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Error commiting bulk insert transaction");
+          y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(mariadb->db_handle));
+          ret = H_ERROR_QUERY;
+        }
+        if (ret != H_OK) {
+          if (savepoint) {
+            mysql_query(mariadb->db_handle, "ROLLBACK TO SAVEPOINT hoel_bulk_insert");
+            mysql_query(mariadb->db_handle, "RELEASE SAVEPOINT hoel_bulk_insert");
+          } else {
+            mysql_rollback(mariadb->db_handle);
+          }
+        }
+      }
+      pthread_mutex_unlock(&mariadb->lock);
+    }
+  }
+  
+  for (col=0; col<nb_columns; col++) {
+    for (row=0; columns[col].texts != NULL && row<nb_rows; row++) {
+      h_free(columns[col].texts[row]);
+    }
+    h_free(columns[col].values);
+    h_free(columns[col].lengths);
+    h_free(columns[col].indicators);
+    h_free(columns[col].texts);
+  }
+  h_free(columns);
+  h_free(binds);
+  h_free(names);
+  h_free(query);
+  return ret;
+#else
+  json_t * j_query = json_pack("{sssO}", "table", table, "values", (json_t *)j_values);
+  int ret;
+  
+  ret = h_insert(conn, j_query, NULL);
+  json_decref(j_query);
+  return ret;
+#endif
+}
+
+/**
+ * Set the rows of a mariadb result in the json result
+ * return H_OK on success
+ */
+static int h_mariadb_result_json(MYSQL_RES * result, json_t * j_result, json_t * j_rows, int options) {
+  uint num_fields, col;
+  MYSQL_ROW m_row;
+  MYSQL_FIELD * fields;
+  unsigned long * lengths;
+  json_t * j_data;
+  struct _h_data * h_data;
+  char date_stamp[64] = {0};
+
+  num_fields = mysql_num_fields(result);
+  fields = mysql_fetch_fields(result);
+  for (col=0; col<num_fields; col++) {
+    h_json_result_add_column(j_result, fields[col].name);
+  }
+
+  while ((m_row = mysql_fetch_row(result)) != NULL) {
+    j_data = h_json_row_new(options);
+    if (j_data == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for j_data");
+      return H_ERROR_MEMORY;
+    }
+    lengths = mysql_fetch_lengths(result);
+    for (col=0; col<num_fields; col++) {
+      h_data = h_get_mariadb_value(m_row[col], lengths[col], (int)fields[col].type);
+      switch (h_data->type) {
+        case HOEL_COL_TYPE_INT:
+          h_json_row_set(j_data, fields[col].name, json_integer(((struct _h_type_int *)h_data->t_data)->value));
+          break;
+        case HOEL_COL_TYPE_DOUBLE:
+          h_json_row_set(j_data, fields[col].name, json_real(((struct _h_type_double *)h_data->t_data)->value));
+          break;
+        case HOEL_COL_TYPE_TEXT:
+          h_json_row_set(j_data, fields[col].name, json_string(((struct _h_type_text *)h_data->t_data)->value));
+          break;
+        case HOEL_COL_TYPE_DATE:
+          strftime (date_stamp, sizeof(date_stamp), "%Y-%m-%dT%H:%M:%S", &((struct _h_type_datetime *)h_data->t_data)->value);
+          h_json_row_set(j_data, fields[col].name, json_string(date_stamp));
+          break;
+        case HOEL_COL_TYPE_BLOB:
+          h_json_row_set(j_data, fields[col].name, json_stringn(((struct _h_type_blob *)h_data->t_data)->value, ((struct _h_type_blob *)h_data->t_data)->length));
+          break;
+        case HOEL_COL_TYPE_NULL:
+          h_json_row_set(j_data, fields[col].name, json_null());
+          break;
+      }
+      h_clean_data_full(h_data);
+    }
+    json_array_append_new(j_rows, j_data);
+  }
+  return H_OK;
+}
+
+/**
+ * h_execute_query_json_mariadb
+ * Execute a query on a mariadb connection, set the returned values in the json result
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_json_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result) {
+  return h_execute_query_json_options_mariadb(conn, query, j_result, H_OPTION_NONE);
+}
+
+/**
+ * h_execute_query_json_options_mariadb
+ * Execute a query on a mariadb connection, set the returned values in the json result
+ * if options has H_OPTION_JSON_COMPACT, the result has the format {"columns":[],"rows":[[]]}
+ * if options has H_OPTION_BINARY, the query is executed as a prepared statement
+ * and the values are received in the binary protocol
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_json_options_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result, int options) {
+  MYSQL_RES * result;
+  json_t * j_rows;
+  int res;
+
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+
+  if (j_result == NULL) {
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_PARAMS;
+  }
+
+  if (h_json_result_init(j_result, &j_rows, options) != H_OK) {
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    return H_ERROR_MEMORY;
+  }
+
+  if (options & H_OPTION_BINARY) {
+    res = h_mariadb_binary_result_json(conn, query, *j_result, j_rows, options);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    if (res != H_OK) {
+      json_decref(*j_result);
+      *j_result = NULL;
+    }
+    return res;
+  }
+
+  if (mysql_query(((struct _h_mariadb *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    json_decref(*j_result);
+    return H_ERROR_QUERY;
+  }
+
+  result = mysql_store_result(((struct _h_mariadb *)conn->connection)->db_handle);
+
+  if (result == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_store_result");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(((struct _h_mariadb *)conn->connection)->db_handle));
+    pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+    json_decref(*j_result);
+    return H_ERROR_QUERY;
+  }
+
+  res = h_mariadb_result_json(result, *j_result, j_rows, options);
+  mysql_free_result(result);
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  if (res != H_OK) {
+    json_decref(*j_result);
+  }
+
+  return res;
+}
+
+#ifdef H_MARIADB_NONBLOCK
+/**
+ * Move the asynchronous query to its next step when the current operation is complete
+ * status is the value returned by the last _start or _cont function, err the error returned by the query
+ */
+static void h_async_next_mariadb(struct _h_mariadb * mariadb, int status, int err) {
+  if (!status && mariadb->async == H_MARIADB_ASYNC_QUERY) {
+    if (err) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(mariadb->db_handle));
+      mariadb->async_error = H_ERROR_QUERY;
+      mariadb->async = H_MARIADB_ASYNC_DONE;
+    } else {
+      mariadb->async = H_MARIADB_ASYNC_STORE;
+      status = mysql_store_result_start(&mariadb->async_result, mariadb->db_handle);
+    }
+  }
+  if (!status && mariadb->async == H_MARIADB_ASYNC_STORE) {
+    if (mariadb->async_result == NULL && mysql_field_count(mariadb->db_handle)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing mysql_store_result");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", mysql_error(mariadb->db_handle));
+      mariadb->async_error = H_ERROR_QUERY;
+    }
+    mariadb->async = H_MARIADB_ASYNC_DONE;
+  }
+  mariadb->async_status = status;
+}
+
+/**
+ * Continue the current step of the asynchronous query with the events that occured on the socket
+ */
+static void h_async_cont_mariadb(struct _h_mariadb * mariadb, int status) {
+  int err = 0;
+  
+  if (mariadb->async == H_MARIADB_ASYNC_QUERY) {
+    status = mysql_real_query_cont(&err, mariadb->db_handle, status);
+  } else {
+    status = mysql_store_result_cont(&mariadb->async_result, mariadb->db_handle, status);
+  }
+  h_async_next_mariadb(mariadb, status, err);
+}
+
+/**
+ * Wait for the events the asynchronous query is waiting for on the socket
+ * timeout is in milliseconds, -1 to wait until an event occurs
+ * return the events that occured as MYSQL_WAIT_* flags, 0 if none
+ */
+static int h_async_wait_mariadb(struct _h_mariadb * mariadb, int timeout) {
+  struct pollfd pfd;
+  int status = 0, nfds;
+  
+  pfd.fd = mysql_get_socket(mariadb->db_handle);
+  pfd.events = (short)(((mariadb->async_status & MYSQL_WAIT_READ)?POLLIN:0) |
+                       ((mariadb->async_status & MYSQL_WAIT_WRITE)?POLLOUT:0) |
+                       ((mariadb->async_status & MYSQL_WAIT_EXCEPT)?POLLPRI:0));
+  pfd.revents = 0;
+  nfds = poll(&pfd, 1, timeout);
+  if (nfds > 0) {
+    /* Errors and hangups are reported as readable so the library reads the error */
+    if (pfd.revents & (POLLIN|POLLERR|POLLHUP)) {
+      status |= MYSQL_WAIT_READ;
+    }
+    if (pfd.revents & POLLOUT) {
+      status |= MYSQL_WAIT_WRITE;
+    }
+    if (pfd.revents & POLLPRI) {
+      status |= MYSQL_WAIT_EXCEPT;
+    }
+  } else if (!nfds && timeout > 0) {
+    status = MYSQL_WAIT_TIMEOUT;
+  }
+  return status;
+}
+
+/**
+ * Finish the asynchronous query and unlock the connection
+ * The connection must be locked by the caller
+ * return the result of the query, or NULL if the query returned no result set
+ * ret is set to H_ERROR_QUERY if the query failed
+ */
+static MYSQL_RES * h_async_end_mariadb(const struct _h_connection * conn, int * ret) {
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  MYSQL_RES * result;
+  int status, timeout;
+  
+  if (mariadb->async == H_MARIADB_ASYNC_NONE) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no asynchronous query running");
+    *ret = H_ERROR_PARAMS;
+    return NULL;
+  }
+  while (mariadb->async != H_MARIADB_ASYNC_DONE) {
+    if (mariadb->async_status & MYSQL_WAIT_TIMEOUT) {
+      timeout = (int)mysql_get_timeout_value(mariadb->db_handle)*1000;
+    } else {
+      timeout = -1;
+    }
+    if ((status = h_async_wait_mariadb(mariadb, timeout))) {
+      h_async_cont_mariadb(mariadb, status);
+    }
+  }
+  *ret = mariadb->async_error;
+  result = mariadb->async_result;
+  mariadb->async = H_MARIADB_ASYNC_NONE;
+  mariadb->async_status = 0;
+  mariadb->async_error = H_OK;
+  mariadb->async_result = NULL;
+  /* Release the lock taken by h_async_send_mariadb */
+  pthread_mutex_unlock(&mariadb->lock);
+  return result;
+}
+#endif
+
+/**
+ * Send a query on a mariadb connection without waiting for its result
+ * The query is sent with the non-blocking API of the MariaDB client library
+ * The connection stays locked until the result is read by h_async_get_result_mariadb
+ * return H_OK on success
+ */
+int h_async_send_mariadb(const struct _h_connection * conn, const char * query) {
+#ifdef H_MARIADB_NONBLOCK
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  int status, err = 0;
+  
+  if (pthread_mutex_lock(&mariadb->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (mariadb->async != H_MARIADB_ASYNC_NONE) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query is already running");
+    pthread_mutex_unlock(&mariadb->lock);
+    return H_ERROR_PARAMS;
+  }
+  if (!mariadb->nonblock) {
+    /* The non-blocking context and its stack are allocated only for the connections using the asynchronous API */
+    if (mysql_options(mariadb->db_handle, MYSQL_OPT_NONBLOCK, 0)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error enabling the non-blocking API");
+      pthread_mutex_unlock(&mariadb->lock);
+      return H_ERROR_QUERY;
+    }
+    mariadb->nonblock = 1;
+  }
+  mariadb->async = H_MARIADB_ASYNC_QUERY;
+  mariadb->async_error = H_OK;
+  mariadb->async_result = NULL;
+  status = mysql_real_query_start(&err, mariadb->db_handle, query, o_strlen(query));
+  h_async_next_mariadb(mariadb, status, err);
+  if (mariadb->async_error != H_OK) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+  }
+  return H_OK;
+#else
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error the MariaDB client library has no non-blocking API");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Continue the asynchronous query on a mariadb connection if the socket is ready
+ * return H_OK if the result of the asynchronous query is ready, H_AGAIN if it's not
+ */
+int h_async_poll_mariadb(const struct _h_connection * conn) {
+#ifdef H_MARIADB_NONBLOCK
+  struct _h_mariadb * mariadb = (struct _h_mariadb *)conn->connection;
+  int ret, status;
+  
+  if (pthread_mutex_lock(&mariadb->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (mariadb->async == H_MARIADB_ASYNC_NONE) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no asynchronous query running");
+    ret = H_ERROR_PARAMS;
+  } else {
+    if (mariadb->async != H_MARIADB_ASYNC_DONE && (status = h_async_wait_mariadb(mariadb, 0))) {
+      h_async_cont_mariadb(mariadb, status);
+    }
+    ret = mariadb->async==H_MARIADB_ASYNC_DONE?H_OK:H_AGAIN;
+  }
+  pthread_mutex_unlock(&mariadb->lock);
+  return ret;
+#else
+  UNUSED(conn);
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Read the result of the asynchronous query on a mariadb connection
+ * Blocks until the result is received if h_async_poll_mariadb hasn't returned H_OK
+ * if result is NULL, the result is read but no value will be returned
+ * return H_OK on success
+ */
+int h_async_get_result_mariadb(const struct _h_connection * conn, struct _h_result * result, int options) {
+#ifdef H_MARIADB_NONBLOCK
+  MYSQL_RES * m_result;
+  int ret;
+  
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  m_result = h_async_end_mariadb(conn, &ret);
+  if (ret == H_OK && result != NULL) {
+    if (m_result != NULL) {
+      ret = h_mariadb_result_rows(m_result, result, options);
+    } else {
+      ret = h_result_init(result, 0, options);
+    }
+  }
+  if (m_result != NULL) {
+    mysql_free_result(m_result);
+  }
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  return ret;
+#else
+  UNUSED(conn);
+  UNUSED(result);
+  UNUSED(options);
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Read the result of the asynchronous query on a mariadb connection as a json array
+ * Blocks until the result is received if h_async_poll_mariadb hasn't returned H_OK
+ * return H_OK on success
+ */
+int h_async_get_result_json_mariadb(const struct _h_connection * conn, json_t ** j_result, int options) {
+#ifdef H_MARIADB_NONBLOCK
+  MYSQL_RES * m_result;
+  json_t * j_rows;
+  int ret;
+  
+  if (pthread_mutex_lock(&(((struct _h_mariadb *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  m_result = h_async_end_mariadb(conn, &ret);
+  if (ret == H_OK) {
+    if (h_json_result_init(j_result, &j_rows, options) != H_OK) {
+      ret = H_ERROR_MEMORY;
+    } else if (m_result != NULL && (ret = h_mariadb_result_json(m_result, *j_result, j_rows, options)) != H_OK) {
+      json_decref(*j_result);
+      *j_result = NULL;
+    }
+  }
+  if (m_result != NULL) {
+    mysql_free_result(m_result);
+  }
+  pthread_mutex_unlock(&(((struct _h_mariadb *)conn->connection)->lock));
+  return ret;
+#else
+  UNUSED(conn);
+  UNUSED(j_result);
+  UNUSED(options);
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Return the socket of a mariadb connection
+ */
+int h_get_socket_fd_mariadb(const struct _h_connection * conn) {
+  return (int)mysql_get_socket(((struct _h_mariadb *)conn->connection)->db_handle);
+}
+
+/**
+ * h_get_mariadb_value
+ * convert value into a struct _h_data * depening on the m_type given
+ * returned value must be free'd with h_clean_data_full after use
+ */
+struct _h_data * h_get_mariadb_value(const char * value, const unsigned long length, const int m_type) {
+  struct _h_cell cell;
+
+  h_get_mariadb_cell(value, length, m_type, &cell);
+  switch (cell.type) {
+    case HOEL_COL_TYPE_INT:
+      return h_new_data_int(cell.i_value);
+    case HOEL_COL_TYPE_DOUBLE:
+      return h_new_data_double(cell.d_value);
+    case HOEL_COL_TYPE_DATE:
+      return h_new_data_datetime(&cell.dt_value);
+    case HOEL_COL_TYPE_BLOB:
+      return h_new_data_blob(cell.value, cell.length);
+    case HOEL_COL_TYPE_TEXT:
+      return h_new_data_text(cell.value, cell.length);
+    default:
+      return h_new_data_null();
+  }
+}
+#else
+
+/**
+ * Dummy functions when Hoel is not built with MariaDB
+ */
+struct _h_connection * h_connect_mariadb(const char * host, const char * user, const char * passwd, const char * db, const unsigned int port, const char * unix_socket) {
+  UNUSED(host);
+  UNUSED(user);
+  UNUSED(passwd);
+  UNUSED(db);
+  UNUSED(port);
+  UNUSED(unix_socket);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return NULL;
+}
+
+void h_close_mariadb(struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+}
+
+int h_check_connection_mariadb(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_transaction_begin_mariadb(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_transaction_end_mariadb(const struct _h_connection * conn, int commit) {
+  UNUSED(conn);
+  UNUSED(commit);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_transaction_query_mariadb(const struct _h_connection * conn, const char * query) {
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_in_transaction_mariadb(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return 0;
 }
 
 char * h_escape_string_mariadb(const struct _h_connection * conn, const char * unsafe) {
@@ -470,6 +2154,12 @@ long long int h_last_insert_id_mariadb(const struct _h_connection * conn) {
   return 0;
 }
 
+size_t h_max_query_length_mariadb(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return 0;
+}
+
 int h_execute_query_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * h_result) {
   UNUSED(conn);
   UNUSED(query);
@@ -478,6 +2168,128 @@ int h_execute_query_mariadb(const struct _h_connection * conn, const char * quer
   return H_ERROR;
 }
 
+int h_execute_query_options_mariadb(const struct _h_connection * conn, const char * query, struct _h_result * h_result, int options) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(h_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_execute_query_columnar_mariadb(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_execute_query_value_mariadb(const struct _h_connection * conn, const char * query, struct _h_value_result * result) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_execute_query_view_mariadb(const struct _h_connection * conn, const char * query, struct _h_result_view * view) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(view);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+const char * h_result_view_get_value_mariadb(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length) {
+  UNUSED(view);
+  UNUSED(row);
+  UNUSED(col);
+  UNUSED(length);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return NULL;
+}
+
+void h_result_view_get_cell_mariadb(const struct _h_result_view * view, unsigned int row, unsigned int col, struct _h_cell * cell) {
+  UNUSED(view);
+  UNUSED(row);
+  UNUSED(col);
+  cell->type = HOEL_COL_TYPE_NULL;
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+}
+
+void h_result_view_free_mariadb(struct _h_result_view * view) {
+  UNUSED(view);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+}
+
+int h_cursor_open_mariadb(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_cursor_fetch_mariadb(struct _h_cursor * cursor) {
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+void h_cursor_get_cell_mariadb(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell) {
+  UNUSED(cursor);
+  UNUSED(col);
+  cell->type = HOEL_COL_TYPE_NULL;
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+}
+
+const char * h_cursor_get_name_mariadb(const struct _h_cursor * cursor, unsigned int col) {
+  UNUSED(cursor);
+  UNUSED(col);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return NULL;
+}
+
+void h_cursor_close_mariadb(struct _h_cursor * cursor) {
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+}
+
+int h_prepare_mariadb(const struct _h_connection * conn, const char * query, struct _h_statement * stmt) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_cursor_open_prepared_mariadb(struct _h_statement * stmt, struct _h_cursor * cursor) {
+  UNUSED(stmt);
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+void h_finalize_mariadb(struct _h_statement * stmt) {
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+}
+
+unsigned long h_session_id_mariadb(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return 0;
+}
+
+int h_bulk_insert_mariadb(const struct _h_connection * conn, const char * table, const json_t * j_values) {
+  UNUSED(conn);
+  UNUSED(table);
+  UNUSED(j_values);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
 int h_execute_query_json_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result) {
   UNUSED(conn);
   UNUSED(query);
@@ -486,6 +2298,50 @@ int h_execute_query_json_mariadb(const struct _h_connection * conn, const char *
   return H_ERROR;
 }
 
+int h_execute_query_json_options_mariadb(const struct _h_connection * conn, const char * query, json_t ** j_result, int options) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(j_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_async_send_mariadb(const struct _h_connection * conn, const char * query) {
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_async_poll_mariadb(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_async_get_result_mariadb(const struct _h_connection * conn, struct _h_result * result, int options) {
+  UNUSED(conn);
+  UNUSED(result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_async_get_result_json_mariadb(const struct _h_connection * conn, json_t ** j_result, int options) {
+  UNUSED(conn);
+  UNUSED(j_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return H_ERROR;
+}
+
+int h_get_socket_fd_mariadb(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with MariaDB backend");
+  return -1;
+}
+
 struct _h_data * h_get_mariadb_value(const char * value, const unsigned long length, const int m_type) {
   UNUSED(value);
   UNUSED(length);
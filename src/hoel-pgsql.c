@@ -27,23 +27,317 @@
 /* PostgreSQL library includes */
 #include <libpq-fe.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
 
+/**
+ * Entry of the table of the PostgreSQL types
+ * The table is an open addressing hash table indexed by the Oid,
+ * an entry with pg_type set to InvalidOid is empty
+ */
 struct _h_pg_type {
   Oid            pg_type;
   unsigned short h_type;
 };
 
+/**
+ * Minimal number of entries of the table of the PostgreSQL types
+ */
+#define H_PGSQL_TYPE_TABLE_MIN_SIZE 64
+
+/**
+ * Types with an Oid lower than this one are built in PostgreSQL, their hoel type is known without a query
+ */
+#define H_PGSQL_FIRST_NORMAL_OID 16384
+
+/**
+ * Catalog of the types of a PostgreSQL database that are not built in
+ * A catalog is shared by all the connections to the same server and database,
+ * the types are resolved the first time they are seen in a result
+ * identity is the server, port and database of the connections, nb_ref the number of connections using the catalog
+ * list_type is the table of the types resolved, its size is type_mask+1, nb_type is the number of types in the table
+ */
+struct _h_pgsql_catalog {
+  char                    * identity;
+  unsigned int              nb_ref;
+  pthread_mutex_t           lock;
+  unsigned int              nb_type;
+  unsigned int              type_mask;
+  struct _h_pg_type       * list_type;
+  struct _h_pgsql_catalog * next;
+};
+
+/**
+ * List of the catalogs used by the pgsql connections of the process
+ */
+static struct _h_pgsql_catalog * h_pgsql_catalog_list = NULL;
+static pthread_mutex_t h_pgsql_catalog_list_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Decode plan of a column of a pgsql result
+ * The name, hoel type and format of the column are resolved once per result
+ */
+struct _h_pgsql_column {
+  const char   * name;
+  unsigned short h_type;
+  int            binary;
+};
+
 /**
  * Postgre SQL handle
+ * catalog is the catalog of the types of the database, shared with the other connections
+ * async is set while an asynchronous query is running,
+ * the connection stays locked until its result is read
+ * pipeline is set while the connection is in pipeline mode, the connection stays locked until
+ * the pipeline ends, nb_pending is the number of queries whose result hasn't been read,
+ * nb_unsynced the number of queries sent since the last sync point,
+ * nb_sync the number of sync points whose result hasn't been read
+ * cursor is set while a cursor is open, the connection stays locked until the cursor is closed
  */
 struct _h_pgsql {
-  char              * conninfo;
-  PGconn            * db_handle;
-  unsigned int        nb_type;
-  struct _h_pg_type * list_type;
-  pthread_mutex_t     lock;
+  char                    * conninfo;
+  PGconn                  * db_handle;
+  struct _h_pgsql_catalog * catalog;
+  pthread_mutex_t           lock;
+  int                       transaction;
+  int                       async;
+  int                       pipeline;
+  unsigned int              nb_pending;
+  unsigned int              nb_unsynced;
+  unsigned int              nb_sync;
+  int                       cursor;
+};
+
+/**
+ * Number of rows per result in chunked rows mode
+ */
+#define H_PGSQL_CURSOR_CHUNK_SIZE 256
+
+/**
+ * Size of the buffer used to send a numeric parameter of a prepared statement
+ */
+#define H_PGSQL_PARAM_NUMBER_SIZE 32
+
+/**
+ * PostgreSQL prepared statement handle
+ * name is the name of the prepared statement on the server
+ * values, lengths and formats are the parameters sent to PQsendQueryPrepared,
+ * numeric parameters are written in numbers
+ */
+struct _h_pgsql_statement {
+  char  * name;
+  char ** values;
+  int   * lengths;
+  int   * formats;
+  char  * numbers;
+};
+
+/**
+ * PostgreSQL cursor handle
+ * res is the current result of the query, containing one row in single row mode,
+ * or up to H_PGSQL_CURSOR_CHUNK_SIZE rows in chunked rows mode
+ */
+struct _h_pgsql_cursor {
+  PGresult       * res;
+  int              row;
+  int              nb_rows;
+  unsigned short * col_types;
 };
 
+/**
+ * Return the hoel type of a PostgreSQL type given its name
+ */
+static unsigned short h_pgsql_type_from_name(const char * type_name) {
+  if (o_strcmp(type_name, "bool") == 0) {
+    return HOEL_COL_TYPE_BOOL;
+  } else if (o_strncmp(type_name, "int", 3) == 0 || (o_strncmp(type_name+1, "id", 2) == 0 && o_strlen(type_name) == 3)) {
+    return HOEL_COL_TYPE_INT;
+  } else if (o_strcmp(type_name, "numeric") == 0 || o_strncmp(type_name, "float", 5) == 0) {
+    return HOEL_COL_TYPE_DOUBLE;
+  } else if (o_strcmp(type_name, "date") == 0 || o_strncmp(type_name, "time", 4) == 0) {
+    return HOEL_COL_TYPE_DATE;
+  } else if (o_strcmp(type_name, "bytea") == 0) {
+    return HOEL_COL_TYPE_BLOB;
+  } else {
+    return HOEL_COL_TYPE_TEXT;
+  }
+}
+
+/**
+ * Return the hoel type of a type built in PostgreSQL
+ * The Oids of the built-in types are fixed in every PostgreSQL version
+ */
+static unsigned short h_pgsql_builtin_type(Oid pg_type) {
+  switch (pg_type) {
+    case 16:   /* bool */
+      return HOEL_COL_TYPE_BOOL;
+      break;
+    case 20:   /* int8 */
+    case 21:   /* int2 */
+    case 22:   /* int2vector */
+    case 23:   /* int4 */
+    case 26:   /* oid */
+    case 28:   /* xid */
+    case 29:   /* cid */
+      return HOEL_COL_TYPE_INT;
+      break;
+    case 700:  /* float4 */
+    case 701:  /* float8 */
+    case 1700: /* numeric */
+      return HOEL_COL_TYPE_DOUBLE;
+      break;
+    case 1082: /* date */
+    case 1083: /* time */
+    case 1114: /* timestamp */
+    case 1184: /* timestamptz */
+    case 1266: /* timetz */
+      return HOEL_COL_TYPE_DATE;
+      break;
+    case 17:   /* bytea */
+      return HOEL_COL_TYPE_BLOB;
+      break;
+    default:
+      return HOEL_COL_TYPE_TEXT;
+      break;
+  }
+}
+
+/**
+ * Return the first index of an Oid in the table of the PostgreSQL types
+ */
+static unsigned int h_pgsql_type_hash(Oid pg_type, unsigned int type_mask) {
+  return ((unsigned int)pg_type * 2654435761U) & type_mask;
+}
+
+/**
+ * Add a type to a table of PostgreSQL types, the table must have an empty entry
+ */
+static void h_pgsql_type_table_add(struct _h_pg_type * list_type, unsigned int type_mask, Oid pg_type, unsigned short h_type) {
+  unsigned int i = h_pgsql_type_hash(pg_type, type_mask);
+  
+  while (list_type[i].pg_type != InvalidOid && list_type[i].pg_type != pg_type) {
+    i = (i + 1) & type_mask;
+  }
+  list_type[i].pg_type = pg_type;
+  list_type[i].h_type = h_type;
+}
+
+/**
+ * Look for a type in the table of a catalog, the catalog must be locked
+ * return 1 and set h_type if the type is found, 0 otherwise
+ */
+static int h_pgsql_catalog_get(const struct _h_pgsql_catalog * catalog, Oid pg_type, unsigned short * h_type) {
+  unsigned int i;
+  
+  if (catalog->list_type != NULL) {
+    for (i = h_pgsql_type_hash(pg_type, catalog->type_mask); catalog->list_type[i].pg_type != InvalidOid; i = (i + 1) & catalog->type_mask) {
+      if (catalog->list_type[i].pg_type == pg_type) {
+        *h_type = catalog->list_type[i].h_type;
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Add a type to the table of a catalog, the catalog must be locked
+ * The table is grown so it stays at most half full
+ * return H_OK on success
+ */
+static int h_pgsql_catalog_add(struct _h_pgsql_catalog * catalog, Oid pg_type, unsigned short h_type) {
+  struct _h_pg_type * list_type;
+  unsigned int type_mask, i;
+  
+  if (catalog->list_type == NULL || 2*(catalog->nb_type+1) > catalog->type_mask+1) {
+    type_mask = catalog->list_type==NULL?H_PGSQL_TYPE_TABLE_MIN_SIZE-1:(2*(catalog->type_mask+1))-1;
+    if ((list_type = o_malloc((type_mask+1)*sizeof(struct _h_pg_type))) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for list_type");
+      return H_ERROR_MEMORY;
+    }
+    memset(list_type, 0, (type_mask+1)*sizeof(struct _h_pg_type));
+    if (catalog->list_type != NULL) {
+      for (i = 0; i <= catalog->type_mask; i++) {
+        if (catalog->list_type[i].pg_type != InvalidOid) {
+          h_pgsql_type_table_add(list_type, type_mask, catalog->list_type[i].pg_type, catalog->list_type[i].h_type);
+        }
+      }
+      h_free(catalog->list_type);
+    }
+    catalog->list_type = list_type;
+    catalog->type_mask = type_mask;
+  }
+  h_pgsql_type_table_add(catalog->list_type, catalog->type_mask, pg_type, h_type);
+  catalog->nb_type++;
+  return H_OK;
+}
+
+/**
+ * Return the catalog of the types for the server and database of a pgsql connection
+ * The catalog is created if no other connection uses it
+ * The catalog must be released with h_pgsql_catalog_release
+ * return NULL on error
+ */
+static struct _h_pgsql_catalog * h_pgsql_catalog_acquire(PGconn * db_handle) {
+  struct _h_pgsql_catalog * catalog = NULL;
+  char * identity = msprintf("%s:%s/%s", PQhost(db_handle), PQport(db_handle), PQdb(db_handle));
+  
+  if (identity == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for identity");
+  } else if (pthread_mutex_lock(&h_pgsql_catalog_list_lock)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error locking catalog list");
+    h_free(identity);
+  } else {
+    for (catalog = h_pgsql_catalog_list; catalog != NULL && o_strcmp(catalog->identity, identity) != 0; catalog = catalog->next);
+    if (catalog != NULL) {
+      catalog->nb_ref++;
+      h_free(identity);
+    } else if ((catalog = o_malloc(sizeof(struct _h_pgsql_catalog))) != NULL) {
+      if (pthread_mutex_init(&catalog->lock, NULL) == 0) {
+        catalog->identity = identity;
+        catalog->nb_ref = 1;
+        catalog->nb_type = 0;
+        catalog->type_mask = 0;
+        catalog->list_type = NULL;
+        catalog->next = h_pgsql_catalog_list;
+        h_pgsql_catalog_list = catalog;
+      } else {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error initializing catalog lock");
+        h_free(catalog);
+        h_free(identity);
+        catalog = NULL;
+      }
+    } else {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for catalog");
+      h_free(identity);
+    }
+    pthread_mutex_unlock(&h_pgsql_catalog_list_lock);
+  }
+  return catalog;
+}
+
+/**
+ * Release a catalog of types, the catalog is freed when no connection uses it anymore
+ */
+static void h_pgsql_catalog_release(struct _h_pgsql_catalog * catalog) {
+  struct _h_pgsql_catalog ** cur;
+  
+  if (catalog != NULL && !pthread_mutex_lock(&h_pgsql_catalog_list_lock)) {
+    if (!--catalog->nb_ref) {
+      for (cur = &h_pgsql_catalog_list; *cur != NULL && *cur != catalog; cur = &(*cur)->next);
+      if (*cur != NULL) {
+        *cur = catalog->next;
+      }
+      pthread_mutex_destroy(&catalog->lock);
+      h_free(catalog->identity);
+      h_free(catalog->list_type);
+      h_free(catalog);
+    }
+    pthread_mutex_unlock(&h_pgsql_catalog_list_lock);
+  }
+}
+
 /**
  * h_connect_pgsql
  * Opens a database connection to a PostgreSQL server
@@ -51,8 +345,6 @@ struct _h_pgsql {
  */
 struct _h_connection * h_connect_pgsql(const char * conninfo) {
   struct _h_connection * conn = NULL;
-  int ntuples, i;
-  PGresult *res;
   pthread_mutexattr_t mutexattr;
   o_malloc_t malloc_fn;
   o_free_t free_fn;
@@ -68,6 +360,7 @@ struct _h_connection * h_connect_pgsql(const char * conninfo) {
     }
     
     conn->type = HOEL_DB_TYPE_PGSQL;
+    conn->json_cache = NULL;
     conn->connection = o_malloc(sizeof(struct _h_pgsql));
     if (conn->connection == NULL) {
       y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for conn->connection");
@@ -75,8 +368,14 @@ struct _h_connection * h_connect_pgsql(const char * conninfo) {
       return NULL;
     }
     ((struct _h_pgsql *)conn->connection)->db_handle = PQconnectdb(conninfo);
-    ((struct _h_pgsql *)conn->connection)->nb_type = 0;
-    ((struct _h_pgsql *)conn->connection)->list_type = NULL;
+    ((struct _h_pgsql *)conn->connection)->catalog = NULL;
+    ((struct _h_pgsql *)conn->connection)->transaction = 0;
+    ((struct _h_pgsql *)conn->connection)->async = 0;
+    ((struct _h_pgsql *)conn->connection)->pipeline = 0;
+    ((struct _h_pgsql *)conn->connection)->nb_pending = 0;
+    ((struct _h_pgsql *)conn->connection)->nb_unsynced = 0;
+    ((struct _h_pgsql *)conn->connection)->nb_sync = 0;
+    ((struct _h_pgsql *)conn->connection)->cursor = 0;
     
     if (PQstatus(((struct _h_pgsql *)conn->connection)->db_handle) != CONNECTION_OK) {
       y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connecting to PostgreSQL Database");
@@ -85,64 +384,21 @@ struct _h_connection * h_connect_pgsql(const char * conninfo) {
       h_free(conn->connection);
       h_free(conn);
       conn = NULL;
+    } else if ((((struct _h_pgsql *)conn->connection)->catalog = h_pgsql_catalog_acquire(((struct _h_pgsql *)conn->connection)->db_handle)) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error getting the catalog of types");
+      PQfinish(((struct _h_pgsql *)conn->connection)->db_handle);
+      h_free(conn->connection);
+      h_free(conn);
+      conn = NULL;
     } else {
-      res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, "select oid, typname from pg_type");
-      if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK && PQnfields(res) == 2) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
-        y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
-        y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"select oid, typname from pg_type\"");
-        PQfinish(((struct _h_pgsql *)conn->connection)->db_handle);
-        h_free(conn->connection);
-        h_free(conn);
-        conn = NULL;
-      } else {
-        ntuples = PQntuples(res);
-        if (ntuples >= 0) {
-          ((struct _h_pgsql *)conn->connection)->list_type = o_malloc(((size_t)ntuples+1)*sizeof(struct _h_pg_type));
-          if (((struct _h_pgsql *)conn->connection)->list_type != NULL) {
-            ((struct _h_pgsql *)conn->connection)->nb_type = (unsigned int)ntuples;
-            for(i = 0; i < ntuples; i++) {
-              char * cur_type_name = PQgetvalue(res, i, 1);
-              ((struct _h_pgsql *)conn->connection)->list_type[i].pg_type = (Oid)strtol(PQgetvalue(res, i, 0), NULL, 10);
-              if (o_strcmp(cur_type_name, "bool") == 0) {
-                ((struct _h_pgsql *)conn->connection)->list_type[i].h_type = HOEL_COL_TYPE_BOOL;
-              } else if (o_strncmp(cur_type_name, "int", 3) == 0 || (o_strncmp(cur_type_name+1, "id", 2) == 0 && o_strlen(cur_type_name) == 3)) {
-                ((struct _h_pgsql *)conn->connection)->list_type[i].h_type = HOEL_COL_TYPE_INT;
-              } else if (o_strcmp(cur_type_name, "numeric") == 0 || o_strncmp(cur_type_name, "float", 5) == 0) {
-                ((struct _h_pgsql *)conn->connection)->list_type[i].h_type = HOEL_COL_TYPE_DOUBLE;
-              } else if (o_strcmp(cur_type_name, "date") == 0 || o_strncmp(cur_type_name, "time", 4) == 0) {
-                ((struct _h_pgsql *)conn->connection)->list_type[i].h_type = HOEL_COL_TYPE_DATE;
-              } else if (o_strcmp(cur_type_name, "bytea") == 0) {
-                ((struct _h_pgsql *)conn->connection)->list_type[i].h_type = HOEL_COL_TYPE_BLOB;
-              } else if (o_strcmp(cur_type_name, "bool") == 0) {
-                ((struct _h_pgsql *)conn->connection)->list_type[i].h_type = HOEL_COL_TYPE_BOOL;
-              } else {
-                ((struct _h_pgsql *)conn->connection)->list_type[i].h_type = HOEL_COL_TYPE_TEXT;
-              }
-            }
-            /* Initialize MUTEX for connection */
-            pthread_mutexattr_init ( &mutexattr );
-            pthread_mutexattr_settype( &mutexattr, PTHREAD_MUTEX_RECURSIVE );
-            if (pthread_mutex_init(&(((struct _h_pgsql *)conn->connection)->lock), &mutexattr) != 0) {
-              y_log_message(Y_LOG_LEVEL_ERROR, "Impossible to initialize Mutex Lock for PostgreSQL connection");
-            }
-            pthread_mutexattr_destroy( &mutexattr );
-          } else {
-            y_log_message(Y_LOG_LEVEL_ERROR, "Error allocating resources for list_type");
-            PQfinish(((struct _h_pgsql *)conn->connection)->db_handle);
-            h_free(conn->connection);
-            h_free(conn);
-            conn = NULL;
-          }
-        } else {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Error PQntuples");
-          PQfinish(((struct _h_pgsql *)conn->connection)->db_handle);
-          h_free(conn->connection);
-          h_free(conn);
-          conn = NULL;
-        }
-        PQclear(res);
+      /* Initialize MUTEX for connection */
+      pthread_mutexattr_init ( &mutexattr );
+      pthread_mutexattr_settype( &mutexattr, PTHREAD_MUTEX_RECURSIVE );
+      if (pthread_mutex_init(&(((struct _h_pgsql *)conn->connection)->lock), &mutexattr) != 0) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Impossible to initialize Mutex Lock for PostgreSQL connection");
       }
+      pthread_mutexattr_destroy( &mutexattr );
+      h_json_cache_init(conn);
     }
   }
   return conn;
@@ -153,144 +409,2263 @@ struct _h_connection * h_connect_pgsql(const char * conninfo) {
  */
 void h_close_pgsql(struct _h_connection * conn) {
   PQfinish(((struct _h_pgsql *)conn->connection)->db_handle);
-  h_free(((struct _h_pgsql *)conn->connection)->list_type);
-  ((struct _h_pgsql *)conn->connection)->list_type = NULL;
-  ((struct _h_pgsql *)conn->connection)->nb_type = 0;
+  h_pgsql_catalog_release(((struct _h_pgsql *)conn->connection)->catalog);
+  ((struct _h_pgsql *)conn->connection)->catalog = NULL;
   pthread_mutex_destroy(&((struct _h_pgsql *)conn->connection)->lock);
 }
 
 /**
- * escape a string
- * returned value must be free'd after use
+ * Check a PostgreSQL connection before it's used again
+ * A broken connection is reset, a transaction left open is rolled back
+ * return H_OK on success
+ */
+int h_check_connection_pgsql(const struct _h_connection * conn) {
+  PGconn * db_handle = ((struct _h_pgsql *)conn->connection)->db_handle;
+  PGresult * res;
+  int ret = H_OK;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    return H_ERROR;
+  }
+  if (((struct _h_pgsql *)conn->connection)->transaction) {
+    /* The transaction belongs to this thread, release the lock taken by h_transaction_begin_pgsql, the transaction is rolled back below */
+    ((struct _h_pgsql *)conn->connection)->transaction = 0;
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  }
+  if (PQstatus(db_handle) != CONNECTION_OK) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel - Reset PostgreSQL connection");
+    PQreset(db_handle);
+    if (PQstatus(db_handle) != CONNECTION_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error PostgreSQL connection lost");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(db_handle));
+      ret = H_ERROR_CONNECTION;
+    }
+  } else if (PQtransactionStatus(db_handle) == PQTRANS_INTRANS || PQtransactionStatus(db_handle) == PQTRANS_INERROR) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel - Rollback transaction left open");
+    res = PQexec(db_handle, "ROLLBACK");
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error rollback transaction");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(db_handle));
+      ret = H_ERROR_CONNECTION;
+    }
+    PQclear(res);
+  } else if (PQtransactionStatus(db_handle) != PQTRANS_IDLE) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error PostgreSQL connection busy");
+    ret = H_ERROR_CONNECTION;
+  }
+  pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  return ret;
+}
+
+/**
+ * Check if an asynchronous query, a pipeline or a cursor is running on the pgsql connection
+ * The connection must be locked
+ */
+static int h_pgsql_busy(const struct _h_pgsql * pgsql) {
+  return pgsql->async || pgsql->pipeline || pgsql->cursor;
+}
+
+/**
+ * Check if an asynchronous query, a pipeline or a cursor is running on the pgsql connection
+ * return 1 if the connection is busy, 0 otherwise
+ */
+int h_connection_busy_pgsql(const struct _h_connection * conn) {
+  int busy;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    return 1;
+  }
+  busy = h_pgsql_busy((struct _h_pgsql *)conn->connection);
+  pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  return busy;
+}
+
+/**
+ * Return the process id of the server backend of the pgsql connection
+ * The id changes when the connection is reset
+ */
+unsigned long h_session_id_pgsql(const struct _h_connection * conn) {
+  return (unsigned long)PQbackendPID(((struct _h_pgsql *)conn->connection)->db_handle);
+}
+
+/**
+ * Execute a transaction control query on a pgsql connection
+ * When commit is set, a COMMIT on a failed transaction is reported as an error
+ * return H_OK on success
+ */
+static int h_transaction_exec_pgsql(const struct _h_connection * conn, const char * query, int commit) {
+  PGconn * db_handle = ((struct _h_pgsql *)conn->connection)->db_handle;
+  PGresult * res = PQexec(db_handle, query);
+  int ret = H_OK;
+  
+  if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    ret = H_ERROR_QUERY;
+  } else if (commit && 0 == o_strcmp(PQcmdStatus(res), "ROLLBACK")) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error transaction aborted, rolled back instead of committed");
+    ret = H_ERROR_QUERY;
+  }
+  PQclear(res);
+  return ret;
+}
+
+/**
+ * Start a transaction on a pgsql connection
+ * The connection stays locked until the transaction ends with h_transaction_end_pgsql
+ * return H_OK on success
+ */
+int h_transaction_begin_pgsql(const struct _h_connection * conn) {
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (pgsql->transaction || pgsql->async || pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection busy, a transaction, an asynchronous query or a pipeline is running");
+    pthread_mutex_unlock(&pgsql->lock);
+    return H_ERROR_PARAMS;
+  }
+  if (h_transaction_exec_pgsql(conn, "BEGIN", 0) != H_OK) {
+    pthread_mutex_unlock(&pgsql->lock);
+    return H_ERROR_QUERY;
+  }
+  pgsql->transaction = 1;
+  return H_OK;
+}
+
+/**
+ * Commit or rollback the transaction on a pgsql connection and unlock the connection
+ * If the commit fails, the transaction is rolled back
+ * return H_OK on success
+ */
+int h_transaction_end_pgsql(const struct _h_connection * conn, int commit) {
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!pgsql->transaction) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no transaction running");
+    pthread_mutex_unlock(&pgsql->lock);
+    return H_ERROR_PARAMS;
+  }
+  ret = h_transaction_exec_pgsql(conn, commit?"COMMIT":"ROLLBACK", commit);
+  if (ret != H_OK && PQtransactionStatus(pgsql->db_handle) != PQTRANS_IDLE) {
+    h_transaction_exec_pgsql(conn, "ROLLBACK", 0);
+  }
+  pgsql->transaction = 0;
+  /* Release the lock taken by h_transaction_begin_pgsql */
+  pthread_mutex_unlock(&pgsql->lock);
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+}
+
+/**
+ * Execute a savepoint query in the transaction of a pgsql connection
+ * return H_OK on success
+ */
+int h_transaction_query_pgsql(const struct _h_connection * conn, const char * query) {
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!pgsql->transaction) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no transaction running");
+    ret = H_ERROR_PARAMS;
+  } else {
+    ret = h_transaction_exec_pgsql(conn, query, 0);
+  }
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+}
+
+/**
+ * Check if a transaction is open on a pgsql connection, started with h_transaction_begin_pgsql or by a query
+ * return 1 if a transaction is open, 0 otherwise
+ */
+int h_in_transaction_pgsql(const struct _h_connection * conn) {
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return 0;
+  }
+  ret = pgsql->transaction || PQtransactionStatus(pgsql->db_handle) == PQTRANS_INTRANS || PQtransactionStatus(pgsql->db_handle) == PQTRANS_INERROR;
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+}
+
+/**
+ * escape a string
+ * returned value must be free'd after use
+ */
+char * h_escape_string_pgsql(const struct _h_connection * conn, const char * unsafe) {
+  char * escaped = PQescapeLiteral(((struct _h_pgsql *)conn->connection)->db_handle, unsafe, o_strlen(unsafe)), * to_return = NULL;
+  if (escaped != NULL) {
+    if (escaped[0] == '\'' && escaped[o_strlen(escaped)-1] == '\'') {
+      to_return = o_strndup((escaped+1), o_strlen((escaped+1))-1);
+    }
+    PQfreemem(escaped);
+  }
+  return to_return;
+}
+
+/**
+ * Escapes a string and returns it ready to be inserted in the query
+ * returned value must be free'd after use
+ */
+char * h_escape_string_with_quotes_pgsql(const struct _h_connection * conn, const char * unsafe) {
+  char * escaped = PQescapeLiteral(((struct _h_pgsql *)conn->connection)->db_handle, unsafe, o_strlen(unsafe)), * to_return = NULL;
+  if (escaped != NULL) {
+    to_return = o_strdup(escaped);
+    PQfreemem(escaped);
+  }
+  return to_return;
+}
+
+/**
+ * Resolve the hoel type of a type that is not built in PostgreSQL
+ * The type is read in pg_type only if the connection is idle, i.e. no result is being read and no pipeline is running,
+ * otherwise HOEL_COL_TYPE_TEXT is returned and the type will be resolved the next time it's seen
+ * The connection must be locked
+ */
+static unsigned short h_pgsql_resolve_type(const struct _h_connection * conn, Oid pg_type) {
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  PGresult * res;
+  char oid_str[H_PGSQL_PARAM_NUMBER_SIZE];
+  const char * values[1] = {oid_str};
+  unsigned short h_type = HOEL_COL_TYPE_TEXT, cur_type;
+  
+  if (!pgsql->pipeline && PQtransactionStatus(pgsql->db_handle) != PQTRANS_ACTIVE) {
+    snprintf(oid_str, H_PGSQL_PARAM_NUMBER_SIZE, "%u", pg_type);
+    res = PQexecParams(pgsql->db_handle, "SELECT typname FROM pg_type WHERE oid = $1::oid", 1, NULL, values, NULL, NULL, 0);
+    if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+      if (PQntuples(res) == 1) {
+        h_type = h_pgsql_type_from_name(PQgetvalue(res, 0, 0));
+      }
+      if (!pthread_mutex_lock(&pgsql->catalog->lock)) {
+        /* Another connection may have resolved the type in the meantime */
+        if (!h_pgsql_catalog_get(pgsql->catalog, pg_type, &cur_type)) {
+          h_pgsql_catalog_add(pgsql->catalog, pg_type, h_type);
+        }
+        pthread_mutex_unlock(&pgsql->catalog->lock);
+      }
+    } else {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel - Error resolving type %u: \"%s\"", pg_type, PQerrorMessage(pgsql->db_handle));
+    }
+    PQclear(res);
+  }
+  return h_type;
+}
+
+/**
+ * Return the hoel type of a column given its Oid
+ * The built-in types are known, the other types are looked for in the catalog of the connection,
+ * and resolved if they aren't in the catalog yet
+ * If type is not found, return HOEL_COL_TYPE_TEXT
+ */
+static unsigned short h_get_type_from_oid(const struct _h_connection * conn, Oid pg_type) {
+  struct _h_pgsql_catalog * catalog = ((struct _h_pgsql *)conn->connection)->catalog;
+  unsigned short h_type = HOEL_COL_TYPE_TEXT;
+  int found = 0;
+  
+  if (pg_type < H_PGSQL_FIRST_NORMAL_OID) {
+    return h_pgsql_builtin_type(pg_type);
+  }
+  if (!pthread_mutex_lock(&catalog->lock)) {
+    found = h_pgsql_catalog_get(catalog, pg_type, &h_type);
+    pthread_mutex_unlock(&catalog->lock);
+  }
+  if (!found) {
+    h_type = h_pgsql_resolve_type(conn, pg_type);
+  }
+  return h_type;
+}
+
+/**
+ * Oids of the built-in PostgreSQL types decoded from the binary format
+ */
+#define H_PGSQL_OID_BOOL        16
+#define H_PGSQL_OID_BYTEA       17
+#define H_PGSQL_OID_CHAR        18
+#define H_PGSQL_OID_NAME        19
+#define H_PGSQL_OID_INT8        20
+#define H_PGSQL_OID_INT2        21
+#define H_PGSQL_OID_INT4        23
+#define H_PGSQL_OID_TEXT        25
+#define H_PGSQL_OID_OID         26
+#define H_PGSQL_OID_JSON        114
+#define H_PGSQL_OID_XML         142
+#define H_PGSQL_OID_FLOAT4      700
+#define H_PGSQL_OID_FLOAT8      701
+#define H_PGSQL_OID_UNKNOWN     705
+#define H_PGSQL_OID_BPCHAR      1042
+#define H_PGSQL_OID_VARCHAR     1043
+#define H_PGSQL_OID_DATE        1082
+#define H_PGSQL_OID_TIME        1083
+#define H_PGSQL_OID_TIMESTAMP   1114
+#define H_PGSQL_OID_TIMESTAMPTZ 1184
+#define H_PGSQL_OID_NUMERIC     1700
+#define H_PGSQL_OID_UUID        2950
+#define H_PGSQL_OID_JSONB       3802
+
+/**
+ * Size of the buffer used to format a binary value as text
+ */
+#define H_PGSQL_BINARY_BUFFER_SIZE 40
+
+/**
+ * Number of days between 1970-01-01 and 2000-01-01, the epoch of the PostgreSQL binary dates
+ */
+#define H_PGSQL_EPOCH_DAYS 10957LL
+
+#define H_PGSQL_USEC_PER_DAY 86400000000LL
+
+/**
+ * Read an unsigned integer of size bytes in network byte order
+ */
+static unsigned long long int h_pgsql_read_uint(const char * val, int size) {
+  const unsigned char * bytes = (const unsigned char *)val;
+  unsigned long long int value = 0;
+  int i;
+  
+  for (i=0; i<size; i++) {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+/**
+ * Set the date of tm from the number of days since 1970-01-01
+ */
+static void h_pgsql_days_to_tm(long long int days, struct tm * tm) {
+  long long int z = days + 719468, era, doe, yoe, doy, mp;
+  
+  era = (z >= 0 ? z : z - 146096) / 146097;
+  doe = z - era * 146097;
+  yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+  doy = doe - (365*yoe + yoe/4 - yoe/100);
+  mp = (5*doy + 2)/153;
+  tm->tm_mday = (int)(doy - (153*mp + 2)/5 + 1);
+  tm->tm_mon = (int)(mp < 10 ? mp + 2 : mp - 10);
+  tm->tm_year = (int)(yoe + era*400 + (tm->tm_mon < 2) - 1900);
+  tm->tm_wday = (int)(((days % 7) + 11) % 7);
+}
+
+/**
+ * Format a time of day given in microseconds like the server does: HH:MM:SS followed by the
+ * fractional seconds without their trailing zeros
+ * return the number of characters written in buffer
+ */
+static int h_pgsql_format_time(long long int usec, char * buffer, size_t size) {
+  long long int sec = usec / 1000000;
+  int len, frac = (int)(usec % 1000000);
+  
+  len = snprintf(buffer, size, "%02lld:%02lld:%02lld", sec / 3600, (sec / 60) % 60, sec % 60);
+  if (frac) {
+    len += snprintf(buffer+len, size-(size_t)len, ".%06d", frac);
+    while (buffer[len-1] == '0') {
+      buffer[--len] = '\0';
+    }
+  }
+  return len;
+}
+
+/**
+ * Format a timestamp given in microseconds since 2000-01-01 like the server does with the ISO
+ * DateStyle, the years before 1 are suffixed with BC
+ * if tz is set, the timestamp is formatted in UTC with the offset +00
+ * return the number of characters written in buffer
+ */
+static int h_pgsql_format_timestamp(long long int usec, int tz, char * buffer, size_t size) {
+  struct tm tm;
+  long long int days = usec / H_PGSQL_USEC_PER_DAY;
+  int len, year;
+  
+  usec %= H_PGSQL_USEC_PER_DAY;
+  if (usec < 0) {
+    usec += H_PGSQL_USEC_PER_DAY;
+    days--;
+  }
+  memset(&tm, 0, sizeof(struct tm));
+  h_pgsql_days_to_tm(days + H_PGSQL_EPOCH_DAYS, &tm);
+  year = tm.tm_year + 1900;
+  len = snprintf(buffer, size, "%04d-%02d-%02d ", year>0?year:1-year, tm.tm_mon + 1, tm.tm_mday);
+  len += h_pgsql_format_time(usec, buffer+len, size-(size_t)len);
+  len += snprintf(buffer+len, size-(size_t)len, "%s%s", tz?"+00":"", year>0?"":" BC");
+  return len;
+}
+
+/**
+ * Convert a numeric in binary format to a double
+ * The binary numeric is a header of 4 int16: ndigits, weight, sign and dscale,
+ * followed by ndigits base 10000 digits
+ */
+static double h_pgsql_numeric_to_double(const char * val, int length) {
+  int ndigits, weight, exponent, i;
+  unsigned int sign;
+  double value = 0.0, scale = 1.0;
+  
+  if (length < 8) {
+    return 0.0;
+  }
+  ndigits = (int)h_pgsql_read_uint(val, 2);
+  weight = (int)(short)h_pgsql_read_uint(val+2, 2);
+  sign = (unsigned int)h_pgsql_read_uint(val+4, 2);
+  if (sign == 0xC000) {
+    return NAN;
+  } else if (sign == 0xD000) {
+    return HUGE_VAL;
+  } else if (sign == 0xF000) {
+    return -HUGE_VAL;
+  }
+  if (length < 8 + 2*ndigits) {
+    return 0.0;
+  }
+  for (i=0; i<ndigits; i++) {
+    value = value * 10000.0 + (double)h_pgsql_read_uint(val + 8 + 2*i, 2);
+  }
+  exponent = weight - ndigits + 1;
+  for (i=exponent<0?-exponent:exponent; i>0; i--) {
+    scale *= 10000.0;
+  }
+  /* A single multiplication or division, so the decimal fractions are rounded like strtod does */
+  value = exponent<0?value/scale:value*scale;
+  return sign==0x4000?-value:value;
+}
+
+/**
+ * Decode the value of the column col in the row row of a result in binary format
+ * The value is decoded according to the type Oid of the column, the values of the types not
+ * decoded are returned as blob in their binary representation
+ * buffer is used to format uuid, time and timestamp values, if buffer is NULL, these values are returned as blob
+ * timestamptz values are formatted in UTC because their binary format has no time zone
+ * text and blob values are not copied
+ */
+static void h_get_pgsql_binary_cell(const PGresult * res, int row, int col, char * buffer, struct _h_cell * cell) {
+  const char * val = PQgetvalue(res, row, col);
+  static const char hex[] = "0123456789abcdef";
+  int length = PQgetlength(res, row, col), i, j;
+  unsigned long long int u_value;
+  unsigned int f_bits;
+  float f_value;
+  double d_value;
+  
+  cell->type = HOEL_COL_TYPE_BLOB;
+  cell->value = val;
+  cell->length = (size_t)length;
+  switch (PQftype(res, col)) {
+    case H_PGSQL_OID_BOOL:
+      if (length == 1) {
+        cell->type = HOEL_COL_TYPE_INT;
+        cell->i_value = val[0]!=0;
+      }
+      break;
+    case H_PGSQL_OID_INT2:
+      if (length == 2) {
+        cell->type = HOEL_COL_TYPE_INT;
+        cell->i_value = (short)h_pgsql_read_uint(val, 2);
+      }
+      break;
+    case H_PGSQL_OID_INT4:
+      if (length == 4) {
+        cell->type = HOEL_COL_TYPE_INT;
+        cell->i_value = (int)h_pgsql_read_uint(val, 4);
+      }
+      break;
+    case H_PGSQL_OID_OID:
+      if (length == 4) {
+        cell->type = HOEL_COL_TYPE_INT;
+        cell->i_value = (long long int)h_pgsql_read_uint(val, 4);
+      }
+      break;
+    case H_PGSQL_OID_INT8:
+      if (length == 8) {
+        cell->type = HOEL_COL_TYPE_INT;
+        cell->i_value = (long long int)h_pgsql_read_uint(val, 8);
+      }
+      break;
+    case H_PGSQL_OID_FLOAT4:
+      if (length == 4) {
+        f_bits = (unsigned int)h_pgsql_read_uint(val, 4);
+        memcpy(&f_value, &f_bits, sizeof(float));
+        cell->type = HOEL_COL_TYPE_DOUBLE;
+        cell->d_value = (double)f_value;
+      }
+      break;
+    case H_PGSQL_OID_FLOAT8:
+      if (length == 8) {
+        u_value = h_pgsql_read_uint(val, 8);
+        memcpy(&d_value, &u_value, sizeof(double));
+        cell->type = HOEL_COL_TYPE_DOUBLE;
+        cell->d_value = d_value;
+      }
+      break;
+    case H_PGSQL_OID_NUMERIC:
+      cell->type = HOEL_COL_TYPE_DOUBLE;
+      cell->d_value = h_pgsql_numeric_to_double(val, length);
+      break;
+    case H_PGSQL_OID_DATE:
+      if (length == 4) {
+        i = (int)h_pgsql_read_uint(val, 4);
+        if (i == INT_MAX || i == INT_MIN) {
+          cell->type = HOEL_COL_TYPE_TEXT;
+          cell->value = i==INT_MAX?"infinity":"-infinity";
+          cell->length = o_strlen(cell->value);
+        } else {
+          memset(&cell->dt_value, 0, sizeof(struct tm));
+          h_pgsql_days_to_tm(i + H_PGSQL_EPOCH_DAYS, &cell->dt_value);
+          cell->type = HOEL_COL_TYPE_DATE;
+        }
+      }
+      break;
+    case H_PGSQL_OID_TIME:
+      /* A time has no date, it's returned as text like the text format does */
+      if (length == 8 && buffer != NULL) {
+        cell->type = HOEL_COL_TYPE_TEXT;
+        cell->length = (size_t)h_pgsql_format_time((long long int)h_pgsql_read_uint(val, 8), buffer, H_PGSQL_BINARY_BUFFER_SIZE);
+        cell->value = buffer;
+      }
+      break;
+    case H_PGSQL_OID_TIMESTAMP:
+    case H_PGSQL_OID_TIMESTAMPTZ:
+      /* The timestamps are returned as text to keep their fractional seconds */
+      if (length == 8) {
+        u_value = h_pgsql_read_uint(val, 8);
+        if ((long long int)u_value == LLONG_MAX || (long long int)u_value == LLONG_MIN) {
+          cell->type = HOEL_COL_TYPE_TEXT;
+          cell->value = (long long int)u_value==LLONG_MAX?"infinity":"-infinity";
+          cell->length = o_strlen(cell->value);
+        } else if (buffer != NULL) {
+          cell->type = HOEL_COL_TYPE_TEXT;
+          cell->length = (size_t)h_pgsql_format_timestamp((long long int)u_value, PQftype(res, col) == H_PGSQL_OID_TIMESTAMPTZ, buffer, H_PGSQL_BINARY_BUFFER_SIZE);
+          cell->value = buffer;
+        }
+      }
+      break;
+    case H_PGSQL_OID_UUID:
+      if (length == 16 && buffer != NULL) {
+        for (i=0, j=0; i<16; i++) {
+          if (i == 4 || i == 6 || i == 8 || i == 10) {
+            buffer[j++] = '-';
+          }
+          buffer[j++] = hex[((const unsigned char *)val)[i] >> 4];
+          buffer[j++] = hex[((const unsigned char *)val)[i] & 0x0f];
+        }
+        buffer[j] = '\0';
+        cell->type = HOEL_COL_TYPE_TEXT;
+        cell->value = buffer;
+        cell->length = (size_t)j;
+      }
+      break;
+    case H_PGSQL_OID_JSONB:
+      /* The first byte is the version of the jsonb binary format, the json text follows */
+      if (length >= 1 && val[0] == 1) {
+        cell->type = HOEL_COL_TYPE_TEXT;
+        cell->value = val+1;
+        cell->length = (size_t)length-1;
+      }
+      break;
+    case H_PGSQL_OID_CHAR:
+    case H_PGSQL_OID_NAME:
+    case H_PGSQL_OID_TEXT:
+    case H_PGSQL_OID_JSON:
+    case H_PGSQL_OID_XML:
+    case H_PGSQL_OID_UNKNOWN:
+    case H_PGSQL_OID_BPCHAR:
+    case H_PGSQL_OID_VARCHAR:
+      /* The binary format of the text types is the text itself */
+      cell->type = HOEL_COL_TYPE_TEXT;
+      break;
+    case H_PGSQL_OID_BYTEA:
+    default:
+      break;
+  }
+}
+
+/**
+ * Return the json value of a cell of a binary result
+ * blob values are hex-encoded like bytea values in text format
+ */
+static json_t * h_pgsql_cell_json(const struct _h_cell * cell) {
+  static const char hex[] = "0123456789abcdef";
+  char * encoded;
+  json_t * j_value;
+  size_t i;
+  
+  if (cell->type != HOEL_COL_TYPE_BLOB) {
+    return h_cell_to_json(cell);
+  }
+  if ((encoded = o_malloc(2*cell->length + 3)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for encoded");
+    return NULL;
+  }
+  encoded[0] = '\\';
+  encoded[1] = 'x';
+  for (i=0; i<cell->length; i++) {
+    encoded[2+2*i] = hex[((const unsigned char *)cell->value)[i] >> 4];
+    encoded[3+2*i] = hex[((const unsigned char *)cell->value)[i] & 0x0f];
+  }
+  j_value = json_stringn(encoded, 2*cell->length + 2);
+  h_free(encoded);
+  return j_value;
+}
+
+/**
+ * Decode the value of the column col in the row row of res, h_type is the hoel type of the column
+ * buffer is used to format the values of a binary result, its size must be H_PGSQL_BINARY_BUFFER_SIZE, it may be NULL
+ * text and blob values are not copied
+ */
+static void h_get_pgsql_cell(const PGresult * res, int row, int col, unsigned short h_type, char * buffer, struct _h_cell * cell) {
+  char * val = PQgetvalue(res, row, col);
+  int nlength;
+  
+  cell->type = HOEL_COL_TYPE_NULL;
+  if (val != NULL && !PQgetisnull(res, row, col)) {
+    if (PQfformat(res, col) == 1) {
+      h_get_pgsql_binary_cell(res, row, col, buffer, cell);
+      return;
+    }
+    switch (h_type) {
+      case HOEL_COL_TYPE_INT:
+        cell->type = HOEL_COL_TYPE_INT;
+        cell->i_value = strtoll(val, NULL, 10);
+        break;
+      case HOEL_COL_TYPE_DOUBLE:
+        cell->type = HOEL_COL_TYPE_DOUBLE;
+        cell->d_value = strtod(val, NULL);
+        break;
+      case HOEL_COL_TYPE_BLOB:
+        if ((nlength = PQgetlength(res, row, col)) >= 0) {
+          cell->type = HOEL_COL_TYPE_BLOB;
+          cell->value = val;
+          cell->length = (size_t)nlength;
+        }
+        break;
+      case HOEL_COL_TYPE_BOOL:
+        if (o_strcasecmp(val, "t") == 0) {
+          cell->type = HOEL_COL_TYPE_INT;
+          cell->i_value = 1;
+        } else if (o_strcasecmp(val, "f") == 0) {
+          cell->type = HOEL_COL_TYPE_INT;
+          cell->i_value = 0;
+        }
+        break;
+      case HOEL_COL_TYPE_DATE:
+      case HOEL_COL_TYPE_TEXT:
+      default:
+        if ((nlength = PQgetlength(res, row, col)) >= 0) {
+          cell->type = HOEL_COL_TYPE_TEXT;
+          cell->value = val;
+          cell->length = (size_t)nlength;
+        }
+        break;
+    }
+  }
+}
+
+/**
+ * Build the decode plan of the columns of a pgsql result
+ * The returned array must be freed after use
+ * return NULL on error
+ */
+static struct _h_pgsql_column * h_pgsql_decode_plan(const struct _h_connection * conn, const PGresult * res) {
+  int nfields = PQnfields(res), j;
+  struct _h_pgsql_column * columns;
+  
+  if ((columns = o_malloc(((size_t)nfields+1)*sizeof(struct _h_pgsql_column))) != NULL) {
+    for (j = 0; j < nfields; j++) {
+      columns[j].name = PQfname(res, j);
+      columns[j].h_type = h_get_type_from_oid(conn, PQftype(res, j));
+      columns[j].binary = (PQfformat(res, j) == 1);
+    }
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for columns");
+  }
+  return columns;
+}
+
+/**
+ * Set the rows of a pgsql result in the result structure
+ * return H_OK on success
+ */
+static int h_pgsql_result_rows(const struct _h_connection * conn, const PGresult * res, struct _h_result * result, int options) {
+  int nfields = PQnfields(res), ntuples = PQntuples(res), i, j, ret;
+  struct _h_data * cur_row = NULL;
+  struct _h_pgsql_column * columns;
+  struct _h_cell cell;
+  char buffer[H_PGSQL_BINARY_BUFFER_SIZE];
+  
+  if ((columns = h_pgsql_decode_plan(conn, res)) == NULL) {
+    ret = H_ERROR_MEMORY;
+  } else {
+    if ((ret = h_result_init(result, (unsigned int)nfields, options)) == H_OK) {
+      for(i = 0; ret == H_OK && i < ntuples; i++) {
+        ret = h_result_new_row(result, &cur_row);
+        for(j = 0; ret == H_OK && j < nfields; j++) {
+          h_get_pgsql_cell(res, i, j, columns[j].h_type, buffer, &cell);
+          ret = h_result_set_cell(result, &cur_row[j], &cell);
+        }
+      }
+      if (ret != H_OK) {
+        h_clean_result(result);
+      }
+    }
+    h_free(columns);
+  }
+  return ret;
+}
+
+/**
+ * Append the rows of a pgsql result to the json result
+ * j_rows is the json array of the rows in j_result
+ * return H_OK on success
+ */
+static int h_pgsql_result_json(const struct _h_connection * conn, const PGresult * res, json_t * j_result, json_t * j_rows, int options) {
+  int nfields = PQnfields(res), ntuples = PQntuples(res), i, j, nlength, ret = H_OK;
+  json_t * j_data;
+  struct _h_pgsql_column * columns;
+  struct _h_cell cell;
+  char buffer[H_PGSQL_BINARY_BUFFER_SIZE];
+  
+  if ((columns = h_pgsql_decode_plan(conn, res)) == NULL) {
+    return H_ERROR_MEMORY;
+  }
+  
+  for (j = 0; j < nfields; j++) {
+    h_json_result_add_column(j_result, columns[j].name);
+  }
+  
+  for(i = 0; ret == H_OK && i < ntuples; i++) {
+    j_data = h_json_row_new(options);
+    if (j_data == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for j_data");
+      ret = H_ERROR_MEMORY;
+    } else {
+      for(j = 0; j < nfields; j++) {
+        char * val = PQgetvalue(res, i, j);
+        if (val == NULL || PQgetisnull(res, i, j)) {
+          h_json_row_set(j_data, columns[j].name, json_null());
+        } else if (columns[j].binary) {
+          h_get_pgsql_binary_cell(res, i, j, buffer, &cell);
+          h_json_row_set(j_data, columns[j].name, h_pgsql_cell_json(&cell));
+        } else {
+          switch (columns[j].h_type) {
+            case HOEL_COL_TYPE_INT:
+              h_json_row_set(j_data, columns[j].name, json_integer(strtoll(val, NULL, 10)));
+              break;
+            case HOEL_COL_TYPE_DOUBLE:
+              h_json_row_set(j_data, columns[j].name, json_real(strtod(val, NULL)));
+              break;
+            case HOEL_COL_TYPE_BLOB:
+              if ((nlength = PQgetlength(res, i, j)) >= 0) {
+                h_json_row_set(j_data, columns[j].name, json_stringn(val, (size_t)nlength));
+              }
+              break;
+            case HOEL_COL_TYPE_BOOL:
+              if (o_strcasecmp(val, "t") == 0) {
+                h_json_row_set(j_data, columns[j].name, json_integer(1));
+              } else if (o_strcasecmp(val, "f") == 0) {
+                h_json_row_set(j_data, columns[j].name, json_integer(0));
+              } else {
+                h_json_row_set(j_data, columns[j].name, json_null());
+              }
+              break;
+            case HOEL_COL_TYPE_DATE:
+            case HOEL_COL_TYPE_TEXT:
+            default:
+              h_json_row_set(j_data, columns[j].name, json_string(val));
+              break;
+          }
+        }
+      }
+      json_array_append_new(j_rows, j_data);
+    }
+  }
+  h_free(columns);
+  return ret;
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+/**
+ * Queue a query in the pipeline of a locked pgsql connection
+ * return H_OK on success
+ */
+static int h_pipeline_send_pgsql(struct _h_pgsql * pgsql, const char * query) {
+  if (!PQsendQueryParams(pgsql->db_handle, query, 0, NULL, NULL, NULL, NULL, 0)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error queuing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    return H_ERROR_QUERY;
+  }
+  pgsql->nb_pending++;
+  pgsql->nb_unsynced++;
+  return H_OK;
+}
+#endif
+
+/**
+ * h_execute_query_pgsql
+ * Execute a query on a pgsql connection, set the result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * return H_OK on success
+ */
+int h_execute_query_pgsql(const struct _h_connection * conn, const char * query, struct _h_result * result) {
+  return h_execute_query_options_pgsql(conn, query, result, H_OPTION_NONE);
+}
+
+/**
+ * h_execute_query_options_pgsql
+ * Execute a query on a pgsql connection, set the result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * if options has H_OPTION_ARENA set, the result values are allocated in an arena
+ * if options has H_OPTION_BINARY set, the values are received in binary format
+ * return H_OK on success
+ */
+int h_execute_query_options_pgsql(const struct _h_connection * conn, const char * query, struct _h_result * result, int options) {
+  PGresult * res;
+  int ret = H_OK;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    ret = H_ERROR_QUERY;
+  } else if (((struct _h_pgsql *)conn->connection)->pipeline) {
+    /* In pipeline mode, the query is queued and its result is read by h_pipeline_get_result */
+    if (result != NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection is in pipeline mode, use h_pipeline_queue to execute a select query");
+      ret = H_ERROR_PARAMS;
+    } else {
+#ifdef LIBPQ_HAS_PIPELINING
+      ret = h_pipeline_send_pgsql((struct _h_pgsql *)conn->connection, query);
+#endif
+    }
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  } else {
+    if (options & H_OPTION_BINARY) {
+      res = PQexecParams(((struct _h_pgsql *)conn->connection)->db_handle, query, 0, NULL, NULL, NULL, NULL, 1);
+    } else {
+      res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, query);
+    }
+    if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+      ret = H_ERROR_QUERY;
+    } else if (result != NULL) {
+      ret = h_pgsql_result_rows(conn, res, result, options);
+    }
+    PQclear(res);
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  }
+  return ret;
+}
+
+/**
+ * h_execute_query_columnar_pgsql
+ * Execute a query on a pgsql connection, set the columnar result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_columnar_pgsql(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result) {
+  PGresult * res;
+  int nfields, ntuples, i, j, ret = H_OK;
+  struct _h_pgsql_column * columns;
+  struct _h_cell cell;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    ret = H_ERROR_QUERY;
+  } else {
+    res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, query);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+      ret = H_ERROR_QUERY;
+    } else {
+      nfields = PQnfields(res);
+      ntuples = PQntuples(res);
+      if ((columns = h_pgsql_decode_plan(conn, res)) == NULL) {
+        ret = H_ERROR_MEMORY;
+      } else {
+        ret = h_result_columnar_init(result, (unsigned int)nfields);
+        for (j = 0; ret == H_OK && j < nfields; j++) {
+          ret = h_result_columnar_set_name(result, (unsigned int)j, columns[j].name);
+        }
+        for (i = 0; ret == H_OK && i < ntuples; i++) {
+          ret = h_result_columnar_new_row(result);
+          for (j = 0; ret == H_OK && j < nfields; j++) {
+            h_get_pgsql_cell(res, i, j, columns[j].h_type, NULL, &cell);
+            ret = h_result_columnar_set_cell(result, (unsigned int)j, &cell);
+          }
+        }
+        if (ret != H_OK) {
+          h_clean_result_columnar(result);
+        }
+        h_free(columns);
+      }
+    }
+    PQclear(res);
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  }
+  return ret;
+}
+
+/**
+ * h_execute_query_value_pgsql
+ * Execute a query on a pgsql connection, set the value result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_value_pgsql(const struct _h_connection * conn, const char * query, struct _h_value_result * result) {
+  PGresult * res;
+  int nfields, ntuples, i, j, ret = H_OK;
+  struct _h_value * cur_row = NULL;
+  struct _h_pgsql_column * columns;
+  struct _h_cell cell;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    ret = H_ERROR_QUERY;
+  } else {
+    res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, query);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+      ret = H_ERROR_QUERY;
+    } else {
+      nfields = PQnfields(res);
+      ntuples = PQntuples(res);
+      if ((columns = h_pgsql_decode_plan(conn, res)) == NULL) {
+        ret = H_ERROR_MEMORY;
+      } else {
+        ret = h_value_result_init(result, (unsigned int)nfields);
+        for (i = 0; ret == H_OK && i < ntuples; i++) {
+          ret = h_value_result_new_row(result, &cur_row);
+          for (j = 0; ret == H_OK && j < nfields; j++) {
+            h_get_pgsql_cell(res, i, j, columns[j].h_type, NULL, &cell);
+            ret = h_value_result_set_cell(result, &cur_row[j], &cell);
+          }
+        }
+        if (ret != H_OK) {
+          h_clean_value_result(result);
+        }
+        h_free(columns);
+      }
+    }
+    PQclear(res);
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  }
+  return ret;
+}
+
+/**
+ * h_execute_query_view_pgsql
+ * Execute a query on a pgsql connection, set the result view with the returned values
+ * The PGresult is kept in the view until h_result_view_free is called
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_view_pgsql(const struct _h_connection * conn, const char * query, struct _h_result_view * view) {
+  PGresult * res;
+  int nfields, j, ret = H_OK;
+  
+  view->type = HOEL_DB_TYPE_PGSQL;
+  view->nb_rows = 0;
+  view->nb_columns = 0;
+  view->result = NULL;
+  view->col_types = NULL;
+  view->rows = NULL;
+  view->lengths = NULL;
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    ret = H_ERROR_QUERY;
+  } else {
+    res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, query);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+      PQclear(res);
+      ret = H_ERROR_QUERY;
+    } else {
+      nfields = PQnfields(res);
+      view->nb_rows = (unsigned int)PQntuples(res);
+      view->nb_columns = (unsigned int)nfields;
+      view->result = res;
+      if ((view->col_types = o_malloc(((size_t)nfields+1)*sizeof(int))) != NULL) {
+        for (j = 0; j < nfields; j++) {
+          view->col_types[j] = h_get_type_from_oid(conn, PQftype(res, j));
+        }
+      } else {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for view->col_types");
+        PQclear(res);
+        view->result = NULL;
+        view->nb_rows = 0;
+        view->nb_columns = 0;
+        ret = H_ERROR_MEMORY;
+      }
+    }
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  }
+  return ret;
+}
+
+/**
+ * Return the value of the column col in the row row of a pgsql result view as returned by the database
+ */
+const char * h_result_view_get_value_pgsql(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length) {
+  if (PQgetisnull(view->result, (int)row, (int)col)) {
+    return NULL;
+  } else {
+    if (length != NULL) {
+      * length = (size_t)PQgetlength(view->result, (int)row, (int)col);
+    }
+    return PQgetvalue(view->result, (int)row, (int)col);
+  }
+}
+
+/**
+ * Decode the value of the column col in the row row of a pgsql result view
+ */
+void h_result_view_get_cell_pgsql(const struct _h_result_view * view, unsigned int row, unsigned int col, struct _h_cell * cell) {
+  h_get_pgsql_cell(view->result, (int)row, (int)col, (unsigned short)view->col_types[col], NULL, cell);
+}
+
+/**
+ * h_result_view_free_pgsql
+ * Free the driver result of a pgsql result view
+ */
+void h_result_view_free_pgsql(struct _h_result_view * view) {
+  PQclear(view->result);
+}
+
+/**
+ * Read the next result of the query of a pgsql cursor
+ * set cursor->end when the last result has been read
+ * return H_OK on success
+ */
+static int h_cursor_next_result_pgsql(struct _h_cursor * cursor) {
+  struct _h_pgsql_cursor * pg_cursor = (struct _h_pgsql_cursor *)cursor->handle;
+  PGresult * res;
+  int ret = H_OK;
+  
+  PQclear(pg_cursor->res);
+  pg_cursor->res = PQgetResult(((struct _h_pgsql *)cursor->conn->connection)->db_handle);
+  pg_cursor->row = -1;
+  pg_cursor->nb_rows = 0;
+  switch (PQresultStatus(pg_cursor->res)) {
+    case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    case PGRES_TUPLES_CHUNK:
+#endif
+      pg_cursor->nb_rows = PQntuples(pg_cursor->res);
+      return H_OK;
+      break;
+    case PGRES_TUPLES_OK:
+    case PGRES_COMMAND_OK:
+      break;
+    default:
+      if (pg_cursor->res != NULL) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)cursor->conn->connection)->db_handle));
+        ret = H_ERROR_QUERY;
+      }
+      break;
+  }
+  /* The last result has been read, PQgetResult must be called until it returns NULL */
+  cursor->end = 1;
+  while ((res = PQgetResult(((struct _h_pgsql *)cursor->conn->connection)->db_handle)) != NULL) {
+    PQclear(res);
+  }
+  return ret;
+}
+
+/**
+ * Set the pgsql cursor on the rows returned by the query sent
+ * The rows are read in single row mode, or in chunked rows mode if available
+ * The connection must be locked, it stays locked until the cursor is closed, or is unlocked on error
+ * return H_OK on success
+ */
+static int h_cursor_start_pgsql(const struct _h_connection * conn, struct _h_cursor * cursor) {
+  struct _h_pgsql_cursor * pg_cursor;
+  PGresult * res;
+  unsigned int col;
+  int ret;
+  
+#ifdef LIBPQ_HAS_CHUNK_MODE
+  PQsetChunkedRowsMode(((struct _h_pgsql *)conn->connection)->db_handle, H_PGSQL_CURSOR_CHUNK_SIZE);
+#else
+  PQsetSingleRowMode(((struct _h_pgsql *)conn->connection)->db_handle);
+#endif
+  if ((pg_cursor = o_malloc(sizeof(struct _h_pgsql_cursor))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for pg_cursor");
+    ret = H_ERROR_MEMORY;
+  } else {
+    pg_cursor->res = NULL;
+    pg_cursor->col_types = NULL;
+    cursor->handle = pg_cursor;
+    if ((ret = h_cursor_next_result_pgsql(cursor)) == H_OK) {
+      cursor->nb_columns = (unsigned int)PQnfields(pg_cursor->res);
+      if ((pg_cursor->col_types = o_malloc((cursor->nb_columns+1)*sizeof(unsigned short))) != NULL) {
+        for (col=0; col<cursor->nb_columns; col++) {
+          pg_cursor->col_types[col] = h_get_type_from_oid(conn, PQftype(pg_cursor->res, (int)col));
+        }
+      } else {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for pg_cursor->col_types");
+        ret = H_ERROR_MEMORY;
+      }
+    }
+    if (ret != H_OK) {
+      PQclear(pg_cursor->res);
+      h_free(pg_cursor);
+      cursor->handle = NULL;
+    }
+  }
+  if (ret != H_OK) {
+    if (!cursor->end) {
+      while ((res = PQgetResult(((struct _h_pgsql *)conn->connection)->db_handle)) != NULL) {
+        PQclear(res);
+      }
+    }
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  } else {
+    ((struct _h_pgsql *)conn->connection)->cursor = 1;
+  }
+  return ret;
+}
+
+/**
+ * Execute the query and set the pgsql cursor on the rows returned
+ * The query is sent in single row mode, or in chunked rows mode if available
+ * The connection is locked until the cursor is closed
+ * return H_OK on success
+ */
+int h_cursor_open_pgsql(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor) {
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (!PQsendQuery(((struct _h_pgsql *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+  return h_cursor_start_pgsql(conn, cursor);
+}
+
+/**
+ * Read the next row of a pgsql cursor, set cursor->end if there's no more row
+ * return H_OK on success
+ */
+int h_cursor_fetch_pgsql(struct _h_cursor * cursor) {
+  struct _h_pgsql_cursor * pg_cursor = (struct _h_pgsql_cursor *)cursor->handle;
+  int ret = H_OK;
+  
+  pg_cursor->row++;
+  while (ret == H_OK && !cursor->end && pg_cursor->row >= pg_cursor->nb_rows) {
+    if ((ret = h_cursor_next_result_pgsql(cursor)) == H_OK) {
+      pg_cursor->row = 0;
+    }
+  }
+  return ret;
+}
+
+/**
+ * Decode the value of the column col in the current row of a pgsql cursor
+ */
+void h_cursor_get_cell_pgsql(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell) {
+  struct _h_pgsql_cursor * pg_cursor = (struct _h_pgsql_cursor *)cursor->handle;
+  h_get_pgsql_cell(pg_cursor->res, pg_cursor->row, (int)col, pg_cursor->col_types[col], NULL, cell);
+}
+
+/**
+ * Return the name of the column col of a pgsql cursor
+ */
+const char * h_cursor_get_name_pgsql(const struct _h_cursor * cursor, unsigned int col) {
+  return PQfname(((struct _h_pgsql_cursor *)cursor->handle)->res, (int)col);
+}
+
+/**
+ * Close a pgsql cursor, if the rows are not all read, the query is cancelled
+ */
+void h_cursor_close_pgsql(struct _h_cursor * cursor) {
+  struct _h_pgsql_cursor * pg_cursor = (struct _h_pgsql_cursor *)cursor->handle;
+  PGcancel * cancel;
+  PGresult * res;
+  char errbuf[256];
+  
+  if (!cursor->end) {
+    if ((cancel = PQgetCancel(((struct _h_pgsql *)cursor->conn->connection)->db_handle)) != NULL) {
+      PQcancel(cancel, errbuf, sizeof(errbuf));
+      PQfreeCancel(cancel);
+    }
+    while ((res = PQgetResult(((struct _h_pgsql *)cursor->conn->connection)->db_handle)) != NULL) {
+      PQclear(res);
+    }
+  }
+  PQclear(pg_cursor->res);
+  h_free(pg_cursor->col_types);
+  h_free(pg_cursor);
+  ((struct _h_pgsql *)cursor->conn->connection)->cursor = 0;
+  pthread_mutex_unlock(&(((struct _h_pgsql *)cursor->conn->connection)->lock));
+}
+
+/**
+ * Return the length of the dollar quote tag starting at query, e.g. $$ or $tag$, 0 if there is none
+ */
+static size_t h_pgsql_dollar_tag_length(const char * query) {
+  size_t len = 1;
+  
+  if (query[len] >= '0' && query[len] <= '9') {
+    return 0;
+  }
+  while (isalnum((unsigned char)query[len]) || query[len] == '_' || (unsigned char)query[len] >= 0x80) {
+    len++;
+  }
+  return query[len]=='$'?len+1:0;
+}
+
+/**
+ * Convert the ? parameters of a query to $1, $2, etc.
+ * The ? characters in quoted strings or identifiers, in dollar quoted strings and in comments
+ * are not converted, the backslash escapes of the E'...' strings are skipped
+ * Every other ? is a parameter, so the jsonb operators ?, ?| and ?& can't be used
+ * return the converted query, must be h_free'd after use
+ */
+static char * h_pgsql_convert_placeholders(const char * query) {
+  size_t len = o_strlen(query), i, nb_params = 0, out = 0, tag_len = 0;
+  unsigned int index = 0, depth;
+  char * converted;
+  const char * tag;
+  int escape;
+  
+  for (i=0; i<len; i++) {
+    if (query[i] == '?') {
+      nb_params++;
+    }
+  }
+  if ((converted = o_malloc(len+(nb_params*10)+1)) != NULL) {
+    i = 0;
+    while (i<len) {
+      if (query[i] == '\'' || query[i] == '"') {
+        /* A string or an identifier, the backslashes escape the next character in E'...' strings only */
+        escape = query[i] == '\'' && i && (query[i-1] == 'E' || query[i-1] == 'e') && (i == 1 || !(isalnum((unsigned char)query[i-2]) || query[i-2] == '_'));
+        tag = query+i;
+        converted[out++] = query[i++];
+        while (i<len && (query[i] != *tag || query[i+1] == *tag)) {
+          if ((escape && query[i] == '\\' && i+1<len) || query[i] == *tag) {
+            converted[out++] = query[i++];
+          }
+          converted[out++] = query[i++];
+        }
+        if (i<len) {
+          converted[out++] = query[i++];
+        }
+      } else if (query[i] == '-' && query[i+1] == '-') {
+        while (i<len && query[i] != '\n') {
+          converted[out++] = query[i++];
+        }
+      } else if (query[i] == '/' && query[i+1] == '*') {
+        /* Block comments can be nested */
+        depth = 0;
+        do {
+          if (query[i] == '/' && query[i+1] == '*') {
+            depth++;
+            converted[out++] = query[i++];
+          } else if (query[i] == '*' && query[i+1] == '/') {
+            depth--;
+            converted[out++] = query[i++];
+          }
+          converted[out++] = query[i++];
+        } while (i<len && depth);
+      } else if (query[i] == '$' && (!i || !(isalnum((unsigned char)query[i-1]) || query[i-1] == '_')) && (tag_len = h_pgsql_dollar_tag_length(query+i))) {
+        tag = query+i;
+        memcpy(converted+out, query+i, tag_len);
+        out += tag_len;
+        i += tag_len;
+        while (i<len && o_strncmp(query+i, tag, tag_len)) {
+          converted[out++] = query[i++];
+        }
+        if (i<len) {
+          memcpy(converted+out, query+i, tag_len);
+          out += tag_len;
+          i += tag_len;
+        }
+      } else if (query[i] == '?') {
+        out += (size_t)snprintf(converted+out, 12, "$%u", ++index);
+        i++;
+      } else {
+        converted[out++] = query[i++];
+      }
+    }
+    converted[out] = '\0';
+  }
+  return converted;
+}
+
+/**
+ * Free the pgsql prepared statement handle
+ */
+static void h_pgsql_statement_free(struct _h_pgsql_statement * pg_stmt) {
+  h_free(pg_stmt->name);
+  h_free(pg_stmt->values);
+  h_free(pg_stmt->lengths);
+  h_free(pg_stmt->formats);
+  h_free(pg_stmt->numbers);
+  h_free(pg_stmt);
+}
+
+/**
+ * Prepare the query on a pgsql connection
+ * The ? parameters are converted to $1, $2, etc.
+ * The statement is named after the address of its handle, so the name is unique in the connection
+ * return H_OK on success
+ */
+int h_prepare_pgsql(const struct _h_connection * conn, const char * query, struct _h_statement * stmt) {
+  struct _h_pgsql_statement * pg_stmt;
+  char * converted;
+  PGresult * res;
+  int ret = H_OK, prepared = 0;
+  
+  if ((converted = h_pgsql_convert_placeholders(query)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for converted");
+    return H_ERROR_MEMORY;
+  }
+  if ((pg_stmt = o_malloc(sizeof(struct _h_pgsql_statement))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for pg_stmt");
+    h_free(converted);
+    return H_ERROR_MEMORY;
+  }
+  memset(pg_stmt, 0, sizeof(struct _h_pgsql_statement));
+  if ((pg_stmt->name = msprintf("hoel_stmt_%p", (void *)pg_stmt)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for pg_stmt->name");
+    h_free(converted);
+    h_pgsql_statement_free(pg_stmt);
+    return H_ERROR_MEMORY;
+  }
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    h_free(converted);
+    h_pgsql_statement_free(pg_stmt);
+    return H_ERROR_QUERY;
+  }
+  if (h_pgsql_busy((struct _h_pgsql *)conn->connection)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query, a pipeline or a cursor is running");
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+    h_free(converted);
+    h_pgsql_statement_free(pg_stmt);
+    return H_ERROR_PARAMS;
+  }
+  res = PQprepare(((struct _h_pgsql *)conn->connection)->db_handle, pg_stmt->name, converted, 0, NULL);
+  if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error preparing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", converted);
+    ret = H_ERROR_QUERY;
+  } else {
+    prepared = 1;
+    PQclear(res);
+    res = PQdescribePrepared(((struct _h_pgsql *)conn->connection)->db_handle, pg_stmt->name);
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error describing prepared statement");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+      ret = H_ERROR_QUERY;
+    } else {
+      stmt->nb_params = (unsigned int)PQnparams(res);
+      pg_stmt->values = o_malloc((stmt->nb_params+1)*sizeof(char *));
+      pg_stmt->lengths = o_malloc((stmt->nb_params+1)*sizeof(int));
+      pg_stmt->formats = o_malloc((stmt->nb_params+1)*sizeof(int));
+      pg_stmt->numbers = o_malloc((stmt->nb_params+1)*H_PGSQL_PARAM_NUMBER_SIZE);
+      if (pg_stmt->values == NULL || pg_stmt->lengths == NULL || pg_stmt->formats == NULL || pg_stmt->numbers == NULL) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for pg_stmt->values");
+        ret = H_ERROR_MEMORY;
+      }
+    }
+  }
+  PQclear(res);
+  pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  h_free(converted);
+  if (ret == H_OK) {
+    stmt->handle = pg_stmt;
+  } else if (prepared) {
+    stmt->handle = pg_stmt;
+    h_finalize_pgsql(stmt);
+    stmt->handle = NULL;
+  } else {
+    h_pgsql_statement_free(pg_stmt);
+  }
+  return ret;
+}
+
+/**
+ * Set the parameters sent to PQsendQueryPrepared with the values bound
+ * The text values are sent in text format, the blob values in binary format
+ */
+static void h_pgsql_statement_set_values(struct _h_statement * stmt) {
+  struct _h_pgsql_statement * pg_stmt = (struct _h_pgsql_statement *)stmt->handle;
+  char * number;
+  unsigned int i;
+  
+  for (i=0; i<stmt->nb_params; i++) {
+    number = pg_stmt->numbers+(i*H_PGSQL_PARAM_NUMBER_SIZE);
+    pg_stmt->formats[i] = 0;
+    pg_stmt->lengths[i] = 0;
+    switch (stmt->params[i].type) {
+      case HOEL_COL_TYPE_INT:
+        snprintf(number, H_PGSQL_PARAM_NUMBER_SIZE, "%lld", stmt->params[i].v.i_value);
+        pg_stmt->values[i] = number;
+        break;
+      case HOEL_COL_TYPE_DOUBLE:
+        snprintf(number, H_PGSQL_PARAM_NUMBER_SIZE, "%.17g", stmt->params[i].v.d_value);
+        pg_stmt->values[i] = number;
+        break;
+      case HOEL_COL_TYPE_TEXT:
+        pg_stmt->values[i] = (char *)h_value_get_bytes(&stmt->params[i]);
+        break;
+      case HOEL_COL_TYPE_BLOB:
+        pg_stmt->values[i] = (char *)h_value_get_bytes(&stmt->params[i]);
+        pg_stmt->lengths[i] = (int)stmt->params[i].length;
+        pg_stmt->formats[i] = 1;
+        break;
+      default:
+        pg_stmt->values[i] = NULL;
+        break;
+    }
+  }
+}
+
+/**
+ * Execute the pgsql prepared statement with the values bound and set the cursor on the rows returned
+ * The connection is locked until the cursor is closed
+ * return H_OK on success
+ */
+int h_cursor_open_prepared_pgsql(struct _h_statement * stmt, struct _h_cursor * cursor) {
+  struct _h_pgsql_statement * pg_stmt = (struct _h_pgsql_statement *)stmt->handle;
+  
+  h_pgsql_statement_set_values(stmt);
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)stmt->conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (h_pgsql_busy((struct _h_pgsql *)stmt->conn->connection)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query, a pipeline or a cursor is running");
+    pthread_mutex_unlock(&(((struct _h_pgsql *)stmt->conn->connection)->lock));
+    return H_ERROR_PARAMS;
+  }
+  if (!PQsendQueryPrepared(((struct _h_pgsql *)stmt->conn->connection)->db_handle, pg_stmt->name, (int)stmt->nb_params, (const char * const *)pg_stmt->values, pg_stmt->lengths, pg_stmt->formats, 0)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing prepared statement");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)stmt->conn->connection)->db_handle));
+    pthread_mutex_unlock(&(((struct _h_pgsql *)stmt->conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+  return h_cursor_start_pgsql(stmt->conn, cursor);
+}
+
+/**
+ * Free the pgsql prepared statement and deallocate it on the server
+ */
+void h_finalize_pgsql(struct _h_statement * stmt) {
+  struct _h_pgsql_statement * pg_stmt = (struct _h_pgsql_statement *)stmt->handle;
+  PGresult * res;
+#ifndef LIBPQ_HAS_CLOSE_PREPARED
+  char * query;
+#endif
+  
+  if (!pthread_mutex_lock(&(((struct _h_pgsql *)stmt->conn->connection)->lock))) {
+#ifdef LIBPQ_HAS_CLOSE_PREPARED
+    res = PQclosePrepared(((struct _h_pgsql *)stmt->conn->connection)->db_handle, pg_stmt->name);
+#else
+    query = msprintf("DEALLOCATE %s", pg_stmt->name);
+    res = PQexec(((struct _h_pgsql *)stmt->conn->connection)->db_handle, query);
+    h_free(query);
+#endif
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error deallocating prepared statement");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)stmt->conn->connection)->db_handle));
+    }
+    PQclear(res);
+    pthread_mutex_unlock(&(((struct _h_pgsql *)stmt->conn->connection)->lock));
+  }
+  h_pgsql_statement_free(pg_stmt);
+}
+
+/**
+ * Put the pgsql connection in nonblocking mode before an asynchronous query is sent,
+ * so sending a large query doesn't wait for the socket to be writable
+ * The connection must be locked by the caller
+ * return H_OK on success
+ */
+static int h_async_nonblocking_pgsql(struct _h_pgsql * pgsql) {
+  if (PQsetnonblocking(pgsql->db_handle, 1)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error setting the connection in nonblocking mode");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+    return H_ERROR_CONNECTION;
+  }
+  return H_OK;
+}
+
+/**
+ * Flush the data of the asynchronous query not sent yet, then set the async flag
+ * if the query can't be sent, the connection is set back in blocking mode
+ * The connection must be locked by the caller
+ * return H_OK on success
+ */
+static int h_async_sent_pgsql(struct _h_pgsql * pgsql) {
+  if (PQflush(pgsql->db_handle) < 0) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error sending sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+    PQsetnonblocking(pgsql->db_handle, 0);
+    return H_ERROR_CONNECTION;
+  }
+  pgsql->async = 1;
+  return H_OK;
+}
+
+/**
+ * Send a query on a pgsql connection without waiting for its result
+ * The connection is in nonblocking mode and stays locked until the result is read by h_async_get_result_pgsql
+ * return H_OK on success
+ */
+int h_async_send_pgsql(const struct _h_connection * conn, const char * query) {
+  int ret;
+  
+
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (((struct _h_pgsql *)conn->connection)->async) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query is already running");
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+    return H_ERROR_PARAMS;
+  }
+  if ((ret = h_async_nonblocking_pgsql((struct _h_pgsql *)conn->connection)) != H_OK) {
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+    return ret;
+  }
+  if (!PQsendQuery(((struct _h_pgsql *)conn->connection)->db_handle, query)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error sending sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    PQsetnonblocking(((struct _h_pgsql *)conn->connection)->db_handle, 0);
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+  if ((ret = h_async_sent_pgsql((struct _h_pgsql *)conn->connection)) != H_OK) {
+    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  }
+  return ret;
+}
+
+/**
+ * Send the pgsql prepared statement with the values bound without waiting for its result
+ * The connection is in nonblocking mode and stays locked until the result is read by h_async_get_result_pgsql
+ * return H_OK on success
+ */
+int h_async_send_prepared_pgsql(struct _h_statement * stmt) {
+  struct _h_pgsql_statement * pg_stmt = (struct _h_pgsql_statement *)stmt->handle;
+  int ret;
+  
+  h_pgsql_statement_set_values(stmt);
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)stmt->conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (((struct _h_pgsql *)stmt->conn->connection)->async) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query is already running");
+    pthread_mutex_unlock(&(((struct _h_pgsql *)stmt->conn->connection)->lock));
+    return H_ERROR_PARAMS;
+  }
+  if ((ret = h_async_nonblocking_pgsql((struct _h_pgsql *)stmt->conn->connection)) != H_OK) {
+    pthread_mutex_unlock(&(((struct _h_pgsql *)stmt->conn->connection)->lock));
+    return ret;
+  }
+  if (!PQsendQueryPrepared(((struct _h_pgsql *)stmt->conn->connection)->db_handle, pg_stmt->name, (int)stmt->nb_params, (const char * const *)pg_stmt->values, pg_stmt->lengths, pg_stmt->formats, 0)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error sending prepared statement");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)stmt->conn->connection)->db_handle));
+    PQsetnonblocking(((struct _h_pgsql *)stmt->conn->connection)->db_handle, 0);
+    pthread_mutex_unlock(&(((struct _h_pgsql *)stmt->conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+  if ((ret = h_async_sent_pgsql((struct _h_pgsql *)stmt->conn->connection)) != H_OK) {
+    pthread_mutex_unlock(&(((struct _h_pgsql *)stmt->conn->connection)->lock));
+  }
+  return ret;
+}
+
+/**
+ * Read the data available on the socket of a pgsql connection,
+ * then send the data of the query not sent yet
+ * return H_OK if the result of the asynchronous query is ready, H_AGAIN if it's not
+ */
+int h_async_poll_pgsql(const struct _h_connection * conn) {
+  int ret, flush;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (!((struct _h_pgsql *)conn->connection)->async) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no asynchronous query running");
+    ret = H_ERROR_PARAMS;
+  } else if (!PQconsumeInput(((struct _h_pgsql *)conn->connection)->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error reading query result");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+    ret = H_ERROR_CONNECTION;
+  } else if ((flush = PQflush(((struct _h_pgsql *)conn->connection)->db_handle)) < 0) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error sending sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+    ret = H_ERROR_CONNECTION;
+  } else if (flush || PQisBusy(((struct _h_pgsql *)conn->connection)->db_handle)) {
+    ret = H_AGAIN;
+  } else {
+    ret = H_OK;
+  }
+  pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  return ret;
+}
+
+/**
+ * Read all the results of the asynchronous query, set the connection back in blocking mode and unlock it
+ * Setting the blocking mode sends the data of the query not sent yet
+ * The connection must be locked by the caller
+ * return the last result, or NULL if no asynchronous query is running
+ * ret is set to H_ERROR_QUERY if one of the results is an error
+ */
+static PGresult * h_async_end_pgsql(const struct _h_connection * conn, int * ret) {
+  PGresult * res, * last = NULL;
+  
+  if (!((struct _h_pgsql *)conn->connection)->async) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no asynchronous query running");
+    *ret = H_ERROR_PARAMS;
+    return NULL;
+  }
+  *ret = H_OK;
+  if (PQsetnonblocking(((struct _h_pgsql *)conn->connection)->db_handle, 0)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error setting the connection in blocking mode");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+  }
+  while ((res = PQgetResult(((struct _h_pgsql *)conn->connection)->db_handle)) != NULL) {
+    if (*ret == H_OK && PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQresultErrorMessage(res));
+      *ret = H_ERROR_QUERY;
+    }
+    PQclear(last);
+    last = res;
+  }
+  ((struct _h_pgsql *)conn->connection)->async = 0;
+  /* Release the lock taken by h_async_send_pgsql */
+  pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  return last;
+}
+
+/**
+ * Read the result of the asynchronous query on a pgsql connection
+ * Blocks until the result is received if h_async_poll_pgsql hasn't returned H_OK
+ * if result is NULL, the result is read but no value will be returned
+ * return H_OK on success
+ */
+int h_async_get_result_pgsql(const struct _h_connection * conn, struct _h_result * result, int options) {
+  PGresult * res;
+  int ret;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  res = h_async_end_pgsql(conn, &ret);
+  if (ret == H_OK && result != NULL) {
+    ret = h_pgsql_result_rows(conn, res, result, options);
+  }
+  PQclear(res);
+  pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  return ret;
+}
+
+/**
+ * Read the result of the asynchronous query on a pgsql connection as a json array
+ * Blocks until the result is received if h_async_poll_pgsql hasn't returned H_OK
+ * return H_OK on success
+ */
+int h_async_get_result_json_pgsql(const struct _h_connection * conn, json_t ** j_result, int options) {
+  PGresult * res;
+  json_t * j_rows;
+  int ret;
+  
+  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  res = h_async_end_pgsql(conn, &ret);
+  if (ret == H_OK) {
+    if (h_json_result_init(j_result, &j_rows, options) != H_OK) {
+      ret = H_ERROR_MEMORY;
+    } else if ((ret = h_pgsql_result_json(conn, res, *j_result, j_rows, options)) != H_OK) {
+      json_decref(*j_result);
+      *j_result = NULL;
+    }
+  }
+  PQclear(res);
+  pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
+  return ret;
+}
+
+/**
+ * Return the socket of a pgsql connection
+ */
+int h_get_socket_fd_pgsql(const struct _h_connection * conn) {
+  return PQsocket(((struct _h_pgsql *)conn->connection)->db_handle);
+}
+
+/**
+ * Enter pipeline mode on a pgsql connection
+ * The connection stays locked until h_pipeline_end_pgsql
+ * return H_OK on success
+ */
+int h_pipeline_begin_pgsql(const struct _h_connection * conn) {
+#ifdef LIBPQ_HAS_PIPELINING
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (pgsql->async || pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query or a pipeline is already running");
+    pthread_mutex_unlock(&pgsql->lock);
+    return H_ERROR_PARAMS;
+  }
+  if (!PQenterPipelineMode(pgsql->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error entering pipeline mode");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+    pthread_mutex_unlock(&pgsql->lock);
+    return H_ERROR_QUERY;
+  }
+  pgsql->pipeline = 1;
+  pgsql->nb_pending = 0;
+  pgsql->nb_unsynced = 0;
+  pgsql->nb_sync = 0;
+  return H_OK;
+#else
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error libpq has no pipeline mode");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+/**
+ * Send a sync point if queries have been queued since the last one,
+ * so the server executes them and sends their results
+ * return H_OK on success
+ */
+static int h_pipeline_send_sync_pgsql(struct _h_pgsql * pgsql) {
+  if (pgsql->nb_unsynced) {
+    if (!PQpipelineSync(pgsql->db_handle)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error sending pipeline sync");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+      return H_ERROR_QUERY;
+    }
+    pgsql->nb_unsynced = 0;
+    pgsql->nb_sync++;
+  }
+  return H_OK;
+}
+
+/**
+ * Read the result of the next query of the pipeline, the sync points results are skipped
+ * return the result, or NULL on error
+ */
+static PGresult * h_pipeline_next_pgsql(struct _h_pgsql * pgsql) {
+  PGresult * res, * next;
+  int after_sync = 0;
+  
+  while (1) {
+    res = PQgetResult(pgsql->db_handle);
+    if (res != NULL && PQresultStatus(res) == PGRES_PIPELINE_SYNC) {
+      PQclear(res);
+      pgsql->nb_sync--;
+      after_sync = 1;
+    } else if (res == NULL && after_sync) {
+      after_sync = 0;
+    } else {
+      break;
+    }
+  }
+  if (res != NULL) {
+    /* Read the end of the results of the query */
+    while ((next = PQgetResult(pgsql->db_handle)) != NULL) {
+      PQclear(next);
+    }
+    pgsql->nb_pending--;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error reading pipeline result");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+  }
+  return res;
+}
+#endif
+
+/**
+ * Queue a query in the pipeline of a pgsql connection
+ * return H_OK on success
+ */
+int h_pipeline_queue_pgsql(const struct _h_connection * conn, const char * query) {
+#ifdef LIBPQ_HAS_PIPELINING
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection is not in pipeline mode");
+    ret = H_ERROR_PARAMS;
+  } else {
+    ret = h_pipeline_send_pgsql(pgsql, query);
+  }
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+#else
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error libpq has no pipeline mode");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Queue the pgsql prepared statement with the values bound in the pipeline of its connection
+ * return H_OK on success
+ */
+int h_pipeline_queue_prepared_pgsql(struct _h_statement * stmt) {
+#ifdef LIBPQ_HAS_PIPELINING
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)stmt->conn->connection;
+  struct _h_pgsql_statement * pg_stmt = (struct _h_pgsql_statement *)stmt->handle;
+  int ret = H_OK;
+  
+  h_pgsql_statement_set_values(stmt);
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection is not in pipeline mode");
+    ret = H_ERROR_PARAMS;
+  } else if (!PQsendQueryPrepared(pgsql->db_handle, pg_stmt->name, (int)stmt->nb_params, (const char * const *)pg_stmt->values, pg_stmt->lengths, pg_stmt->formats, 0)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error queuing prepared statement");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+    ret = H_ERROR_QUERY;
+  } else {
+    pgsql->nb_pending++;
+    pgsql->nb_unsynced++;
+  }
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+#else
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error libpq has no pipeline mode");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Send a sync point in the pipeline of a pgsql connection
+ * return H_OK on success
+ */
+int h_pipeline_sync_pgsql(const struct _h_connection * conn) {
+#ifdef LIBPQ_HAS_PIPELINING
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection is not in pipeline mode");
+    ret = H_ERROR_PARAMS;
+  } else {
+    ret = h_pipeline_send_sync_pgsql(pgsql);
+  }
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+#else
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error libpq has no pipeline mode");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+#ifdef LIBPQ_HAS_PIPELINING
+/**
+ * Read the result of the next query of the pipeline of a locked pgsql connection
+ * return the result, or NULL on error, ret is set to the status
+ */
+static PGresult * h_pipeline_result_pgsql(struct _h_pgsql * pgsql, int * ret) {
+  PGresult * res = NULL;
+  
+  if (!pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection is not in pipeline mode");
+    *ret = H_ERROR_PARAMS;
+  } else if (!pgsql->nb_pending) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no query result to read in the pipeline");
+    *ret = H_ERROR_PARAMS;
+  } else if ((*ret = h_pipeline_send_sync_pgsql(pgsql)) == H_OK) {
+    if ((res = h_pipeline_next_pgsql(pgsql)) == NULL) {
+      *ret = H_ERROR_QUERY;
+    } else if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+      if (PQresultStatus(res) == PGRES_PIPELINE_ABORTED) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Error query not executed, a previous query of the pipeline has failed");
+      } else {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQresultErrorMessage(res));
+      }
+      *ret = H_ERROR_QUERY;
+    }
+  }
+  return res;
+}
+#endif
+
+/**
+ * Read the result of the next query of the pipeline of a pgsql connection
+ * if result is NULL, the result is read but no value will be returned
+ * return H_OK on success
+ */
+int h_pipeline_get_result_pgsql(const struct _h_connection * conn, struct _h_result * result, int options) {
+#ifdef LIBPQ_HAS_PIPELINING
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  PGresult * res;
+  int ret;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  res = h_pipeline_result_pgsql(pgsql, &ret);
+  if (ret == H_OK && result != NULL) {
+    ret = h_pgsql_result_rows(conn, res, result, options);
+  }
+  PQclear(res);
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+#else
+  UNUSED(conn);
+  UNUSED(result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error libpq has no pipeline mode");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Read the result of the next query of the pipeline of a pgsql connection as a json array
+ * return H_OK on success
+ */
+int h_pipeline_get_result_json_pgsql(const struct _h_connection * conn, json_t ** j_result, int options) {
+#ifdef LIBPQ_HAS_PIPELINING
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  PGresult * res;
+  json_t * j_rows;
+  int ret;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  res = h_pipeline_result_pgsql(pgsql, &ret);
+  if (ret == H_OK) {
+    if (h_json_result_init(j_result, &j_rows, options) != H_OK) {
+      ret = H_ERROR_MEMORY;
+    } else if ((ret = h_pgsql_result_json(conn, res, *j_result, j_rows, options)) != H_OK) {
+      json_decref(*j_result);
+      *j_result = NULL;
+    }
+  }
+  PQclear(res);
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+#else
+  UNUSED(conn);
+  UNUSED(j_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error libpq has no pipeline mode");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Read the results left in the pipeline, exit pipeline mode and unlock the pgsql connection
+ * return H_OK on success, H_ERROR_QUERY if one of the results left is an error
+ */
+int h_pipeline_end_pgsql(const struct _h_connection * conn) {
+#ifdef LIBPQ_HAS_PIPELINING
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  PGresult * res;
+  int ret = H_OK, res_ret, nb_null = 0;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection is not in pipeline mode");
+    pthread_mutex_unlock(&pgsql->lock);
+    return H_ERROR_PARAMS;
+  }
+  while (pgsql->nb_pending) {
+    res = h_pipeline_result_pgsql(pgsql, &res_ret);
+    PQclear(res);
+    if (res_ret != H_OK) {
+      ret = res_ret;
+      if (res == NULL) {
+        break;
+      }
+    }
+  }
+  /* Read the sync points results left */
+  while (pgsql->nb_sync && nb_null < 2) {
+    if ((res = PQgetResult(pgsql->db_handle)) == NULL) {
+      nb_null++;
+    } else {
+      nb_null = 0;
+      if (PQresultStatus(res) == PGRES_PIPELINE_SYNC) {
+        pgsql->nb_sync--;
+      }
+      PQclear(res);
+    }
+  }
+  if (!PQexitPipelineMode(pgsql->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error exiting pipeline mode");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+    ret = H_ERROR_QUERY;
+  }
+  pgsql->pipeline = 0;
+  pgsql->nb_pending = 0;
+  pgsql->nb_unsynced = 0;
+  pgsql->nb_sync = 0;
+  /* Release the lock taken by h_pipeline_begin_pgsql */
+  pthread_mutex_unlock(&pgsql->lock);
+  pthread_mutex_unlock(&pgsql->lock);
+  return ret;
+#else
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error libpq has no pipeline mode");
+  return H_ERROR_PARAMS;
+#endif
+}
+
+/**
+ * Size of the buffer sent with each PQputCopyData call
+ */
+#define H_PGSQL_COPY_BUFFER_SIZE 65536
+
+/**
+ * Data sent to the server during a COPY FROM STDIN
+ * error is set if PQputCopyData failed
+ */
+struct _h_pgsql_copy {
+  PGconn * db_handle;
+  char   * buffer;
+  size_t   len;
+  int      error;
+};
+
+/**
+ * Send the data in the COPY buffer to the server
  */
-char * h_escape_string_pgsql(const struct _h_connection * conn, const char * unsafe) {
-  char * escaped = PQescapeLiteral(((struct _h_pgsql *)conn->connection)->db_handle, unsafe, o_strlen(unsafe)), * to_return = NULL;
-  if (escaped != NULL) {
-    if (escaped[0] == '\'' && escaped[o_strlen(escaped)-1] == '\'') {
-      to_return = o_strndup((escaped+1), o_strlen((escaped+1))-1);
+static void h_pgsql_copy_flush(struct _h_pgsql_copy * copy) {
+  if (!copy->error && copy->len) {
+    if (PQputCopyData(copy->db_handle, copy->buffer, (int)copy->len) != 1) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error sending COPY data");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(copy->db_handle));
+      copy->error = 1;
     }
-    PQfreemem(escaped);
   }
-  return to_return;
+  copy->len = 0;
 }
 
 /**
- * Escapes a string and returns it ready to be inserted in the query
- * returned value must be free'd after use
+ * Append data to the COPY buffer, the buffer is sent to the server when it's full
  */
-char * h_escape_string_with_quotes_pgsql(const struct _h_connection * conn, const char * unsafe) {
-  char * escaped = PQescapeLiteral(((struct _h_pgsql *)conn->connection)->db_handle, unsafe, o_strlen(unsafe)), * to_return = NULL;
-  if (escaped != NULL) {
-    to_return = o_strdup(escaped);
-    PQfreemem(escaped);
+static void h_pgsql_copy_write(struct _h_pgsql_copy * copy, const char * data, size_t len) {
+  size_t to_copy;
+  
+  while (len && !copy->error) {
+    to_copy = H_PGSQL_COPY_BUFFER_SIZE - copy->len;
+    if (to_copy > len) {
+      to_copy = len;
+    }
+    memcpy(copy->buffer + copy->len, data, to_copy);
+    copy->len += to_copy;
+    data += to_copy;
+    len -= to_copy;
+    if (copy->len == H_PGSQL_COPY_BUFFER_SIZE) {
+      h_pgsql_copy_flush(copy);
+    }
   }
-  return to_return;
 }
 
 /**
- * Return the hoel type of a column given its Oid
- * If type is not found, return HOEL_COL_TYPE_TEXT
+ * Append a string to the COPY buffer in text format
+ * backslashes and the characters separating the columns and the rows are escaped
  */
-static unsigned short h_get_type_from_oid(const struct _h_connection * conn, Oid pg_type) {
-  unsigned int i;
+static void h_pgsql_copy_write_text(struct _h_pgsql_copy * copy, const char * value, size_t len) {
+  size_t i, start = 0;
+  const char * escaped;
   
-  for (i = 0; i < ((struct _h_pgsql *)conn->connection)->nb_type; i++) {
-    if (((struct _h_pgsql *)conn->connection)->list_type[i].pg_type == pg_type) {
-      return ((struct _h_pgsql *)conn->connection)->list_type[i].h_type;
+  for (i=0; i<len; i++) {
+    switch (value[i]) {
+      case '\\':
+        escaped = "\\\\";
+        break;
+      case '\t':
+        escaped = "\\t";
+        break;
+      case '\n':
+        escaped = "\\n";
+        break;
+      case '\r':
+        escaped = "\\r";
+        break;
+      default:
+        escaped = NULL;
+        break;
+    }
+    if (escaped != NULL) {
+      h_pgsql_copy_write(copy, value+start, i-start);
+      h_pgsql_copy_write(copy, escaped, 2);
+      start = i+1;
     }
   }
-  return HOEL_COL_TYPE_TEXT;
+  h_pgsql_copy_write(copy, value+start, len-start);
 }
 
 /**
- * h_execute_query_pgsql
- * Execute a query on a pgsql connection, set the result structure with the returned values
- * Should not be executed by the user because all parameters are supposed to be correct
- * if result is NULL, the query is executed but no value will be returned
+ * Append a json value to the COPY buffer in text format
+ * return H_OK on success, H_ERROR_PARAMS if the value can't be sent with COPY
+ */
+static int h_pgsql_copy_write_value(struct _h_pgsql_copy * copy, const json_t * value) {
+  char number[64];
+  int len;
+  
+  switch (json_typeof(value)) {
+    case JSON_STRING:
+      h_pgsql_copy_write_text(copy, json_string_value(value), json_string_length(value));
+      break;
+    case JSON_INTEGER:
+      len = snprintf(number, sizeof(number), "%"JSON_INTEGER_FORMAT, json_integer_value(value));
+      h_pgsql_copy_write(copy, number, (size_t)len);
+      break;
+    case JSON_REAL:
+      len = snprintf(number, sizeof(number), "%.17g", json_real_value(value));
+      h_pgsql_copy_write(copy, number, (size_t)len);
+      break;
+    case JSON_TRUE:
+      h_pgsql_copy_write(copy, "1", 1);
+      break;
+    case JSON_FALSE:
+      h_pgsql_copy_write(copy, "0", 1);
+      break;
+    case JSON_NULL:
+      h_pgsql_copy_write(copy, "\\N", 2);
+      break;
+    default:
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error value type not available with COPY");
+      return H_ERROR_PARAMS;
+  }
+  return H_OK;
+}
+
+/**
+ * Insert the rows of j_values in the table with COPY FROM STDIN on a pgsql connection
+ * The columns are the keys of the first row, a column missing in another row is inserted as NULL,
+ * a key missing in the first row returns H_ERROR_PARAMS
+ * The rows are sent in text format by chunks of H_PGSQL_COPY_BUFFER_SIZE bytes
  * return H_OK on success
  */
-int h_execute_query_pgsql(const struct _h_connection * conn, const char * query, struct _h_result * result) {
+int h_bulk_insert_pgsql(const struct _h_connection * conn, const char * table, const json_t * j_values) {
+  struct _h_pgsql * pgsql = (struct _h_pgsql *)conn->connection;
+  struct _h_pgsql_copy copy;
+  struct _h_sql_buffer buffer;
   PGresult * res;
-  int nfields, ntuples, i, j, h_res, ret = H_OK, nlength;
-  struct _h_data * data = NULL, * cur_row = NULL;
+  const char ** columns;
+  char * query;
+  json_t * j_row, * j_value;
+  size_t index, nb_columns, col;
+  int ret = H_OK;
   
-  if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
-    ret = H_ERROR_QUERY;
+  if ((ret = h_bulk_insert_columns(j_values, &columns, &nb_columns)) != H_OK) {
+    return ret;
+  }
+  h_sql_buffer_init(&buffer);
+  h_sql_buffer_appendf(&buffer, "COPY %s (", table);
+  h_sql_buffer_append_columns(&buffer, columns, nb_columns);
+  h_sql_buffer_append(&buffer, ") FROM STDIN");
+  if ((query = h_sql_buffer_release(&buffer)) == NULL || (copy.buffer = o_malloc(H_PGSQL_COPY_BUFFER_SIZE)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for COPY");
+    h_free(query);
+    h_free(columns);
+    return H_ERROR_MEMORY;
+  }
+  copy.db_handle = pgsql->db_handle;
+  copy.len = 0;
+  copy.error = 0;
+  
+  if (pthread_mutex_lock(&pgsql->lock)) {
+    h_free(copy.buffer);
+    h_free(query);
+    h_free(columns);
+    return H_ERROR_QUERY;
+  }
+  if (pgsql->async || pgsql->pipeline) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error an asynchronous query or a pipeline is running");
+    ret = H_ERROR_PARAMS;
   } else {
-    res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, query);
-    if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
-      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
-      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
+    res = PQexec(pgsql->db_handle, query);
+    if (PQresultStatus(res) != PGRES_COPY_IN) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing COPY query");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
       y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
-      PQclear(res);
       ret = H_ERROR_QUERY;
-    } else {
-      nfields = PQnfields(res);
-      ntuples = PQntuples(res);
-
-      if (result != NULL) {
-        result->nb_rows = 0;
-        result->nb_columns = (unsigned int)nfields;
-        result->data = NULL;
-        for(i = 0; ret == H_OK && i < ntuples; i++) {
-          cur_row = NULL;
-          for(j = 0; ret == H_OK && j < nfields; j++) {
-            char * val = PQgetvalue(res, i, j);
-            if (val == NULL) {
-              data = h_new_data_null();
-            } else {
-              switch (h_get_type_from_oid(conn, PQftype(res, j))) {
-                case HOEL_COL_TYPE_INT:
-                  data = h_new_data_int(strtol(val, NULL, 10));
-                  break;
-                case HOEL_COL_TYPE_DOUBLE:
-                  data = h_new_data_double(strtod(val, NULL));
-                  break;
-                case HOEL_COL_TYPE_BLOB:
-                  if ((nlength = PQgetlength(res, i, j)) >= 0) {
-                    data = h_new_data_blob(val, (size_t)nlength);
-                  }
-                  break;
-                case HOEL_COL_TYPE_BOOL:
-                  if (o_strcasecmp(val, "t") == 0) {
-                    data = h_new_data_int(1);
-                  } else if (o_strcasecmp(val, "f") == 0) {
-                    data = h_new_data_int(0);
-                  } else {
-                    data = h_new_data_null();
-                  }
-                  break;
-                case HOEL_COL_TYPE_DATE:
-                case HOEL_COL_TYPE_TEXT:
-                default:
-                  if ((nlength = PQgetlength(res, i, j)) >= 0) {
-                    data = h_new_data_text(val, (size_t)nlength);
-                  }
-                  break;
-              }
-            }
-            if (data != NULL) {
-              h_res = h_row_add_data(&cur_row, data, j);
-              h_clean_data_full(data);
-            } else {
-              h_res = H_ERROR_PARAMS;
-            }
-            if (h_res != H_OK) {
-              PQclear(res);
-              ret = h_res;
-            }
+    }
+    PQclear(res);
+    if (ret == H_OK) {
+      json_array_foreach(j_values, index, j_row) {
+        for (col=0; ret == H_OK && col<nb_columns; col++) {
+          if (col) {
+            h_pgsql_copy_write(&copy, "\t", 1);
           }
-          h_res = h_result_add_row(result, cur_row, i);
-          if (h_res != H_OK) {
-            PQclear(res);
-            ret = h_res;
+          if ((j_value = json_object_get(j_row, columns[col])) == NULL) {
+            h_pgsql_copy_write(&copy, "\\N", 2);
+          } else {
+            ret = h_pgsql_copy_write_value(&copy, j_value);
           }
         }
+        h_pgsql_copy_write(&copy, "\n", 1);
+        if (ret != H_OK || copy.error) {
+          break;
+        }
+      }
+      h_pgsql_copy_flush(&copy);
+      if (copy.error && ret == H_OK) {
+        ret = H_ERROR_QUERY;
+      }
+      /* An error message aborts the COPY, so none of the rows is inserted */
+      if (PQputCopyEnd(pgsql->db_handle, ret==H_OK?NULL:"Hoel bulk insert aborted") != 1) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Error ending COPY");
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(pgsql->db_handle));
+        ret = H_ERROR_QUERY;
+      }
+      while ((res = PQgetResult(pgsql->db_handle)) != NULL) {
+        if (ret == H_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Error executing COPY query");
+          y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQresultErrorMessage(res));
+          ret = H_ERROR_QUERY;
+        }
+        PQclear(res);
       }
-      PQclear(res);
     }
-    pthread_mutex_unlock(&(((struct _h_pgsql *)conn->connection)->lock));
   }
+  pthread_mutex_unlock(&pgsql->lock);
+  h_free(copy.buffer);
+  h_free(query);
+  h_free(columns);
   return ret;
 }
 
@@ -301,9 +2676,21 @@ int h_execute_query_pgsql(const struct _h_connection * conn, const char * query,
  * return H_OK on success
  */
 int h_execute_query_json_pgsql(const struct _h_connection * conn, const char * query, json_t ** j_result) {
+  return h_execute_query_json_options_pgsql(conn, query, j_result, H_OPTION_NONE);
+}
+
+/**
+ * h_execute_query_json_options_pgsql
+ * Execute a query on a pgsql connection, set the returned values in the json result
+ * if options has H_OPTION_JSON_COMPACT, the result has the format {"columns":[],"rows":[[]]}
+ * if options has H_OPTION_BINARY, the values are received in binary format
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_json_options_pgsql(const struct _h_connection * conn, const char * query, json_t ** j_result, int options) {
   PGresult *res;
-  int nfields, ntuples, i, j, ret = H_OK, nlength;
-  json_t * j_data;
+  int ret = H_OK;
+  json_t * j_rows;
   
   if (pthread_mutex_lock(&(((struct _h_pgsql *)conn->connection)->lock))) {
     ret = H_ERROR_QUERY;
@@ -311,67 +2698,21 @@ int h_execute_query_json_pgsql(const struct _h_connection * conn, const char * q
     if (j_result == NULL) {
       ret = H_ERROR_PARAMS;
     } else {
-      *j_result = json_array();
-      if (*j_result == NULL) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for *j_result");
+      if (h_json_result_init(j_result, &j_rows, options) != H_OK) {
         ret = H_ERROR_MEMORY;
       } else {
-        res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, query);
+        if (options & H_OPTION_BINARY) {
+          res = PQexecParams(((struct _h_pgsql *)conn->connection)->db_handle, query, 0, NULL, NULL, NULL, NULL, 1);
+        } else {
+          res = PQexec(((struct _h_pgsql *)conn->connection)->db_handle, query);
+        }
         if (PQresultStatus(res) != PGRES_TUPLES_OK && PQresultStatus(res) != PGRES_COMMAND_OK) {
           y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
           y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", PQerrorMessage(((struct _h_pgsql *)conn->connection)->db_handle));
           y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
-          PQclear(res);
           ret = H_ERROR_QUERY;
         } else {
-          nfields = PQnfields(res);
-          ntuples = PQntuples(res);
-
-          for(i = 0; ret == H_OK && i < ntuples; i++) {
-            j_data = json_object();
-            if (j_data == NULL) {
-              y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for j_data");
-              PQclear(res);
-              ret = H_ERROR_MEMORY;
-            } else {
-              for(j = 0; ret == H_OK && j < nfields; j++) {
-                char * val = PQgetvalue(res, i, j);
-                if (val == NULL || PQgetisnull(res, i, j)) {
-                  json_object_set_new(j_data, PQfname(res, j), json_null());
-                } else {
-                  switch (h_get_type_from_oid(conn, PQftype(res, j))) {
-                    case HOEL_COL_TYPE_INT:
-                      json_object_set_new(j_data, PQfname(res, j), json_integer(strtoll(PQgetvalue(res, i, j), NULL, 10)));
-                      break;
-                    case HOEL_COL_TYPE_DOUBLE:
-                      json_object_set_new(j_data, PQfname(res, j), json_real(strtod(PQgetvalue(res, i, j), NULL)));
-                      break;
-                    case HOEL_COL_TYPE_BLOB:
-                      if ((nlength = PQgetlength(res, i, j)) >= 0) {
-                        json_object_set_new(j_data, PQfname(res, j), json_stringn(PQgetvalue(res, i, j), (size_t)nlength));
-                      }
-                      break;
-                    case HOEL_COL_TYPE_BOOL:
-                      if (o_strcasecmp(PQgetvalue(res, i, j), "t") == 0) {
-                        json_object_set_new(j_data, PQfname(res, j), json_integer(1));
-                      } else if (o_strcasecmp(PQgetvalue(res, i, j), "f") == 0) {
-                        json_object_set_new(j_data, PQfname(res, j), json_integer(0));
-                      } else {
-                        json_object_set_new(j_data, PQfname(res, j), json_null());
-                      }
-                      break;
-                    case HOEL_COL_TYPE_DATE:
-                    case HOEL_COL_TYPE_TEXT:
-                    default:
-                      json_object_set_new(j_data, PQfname(res, j), json_string(PQgetvalue(res, i, j)));
-                      break;
-                  }
-                }
-              }
-            }
-            json_array_append_new(*j_result, j_data);
-            j_data = NULL;
-          }
+          ret = h_pgsql_result_json(conn, res, *j_result, j_rows, options);
         }
         PQclear(res);
       }
@@ -436,6 +2777,38 @@ void h_close_pgsql(struct _h_connection * conn) {
   y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
 }
 
+int h_check_connection_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_transaction_begin_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_transaction_end_pgsql(const struct _h_connection * conn, int commit) {
+  UNUSED(conn);
+  UNUSED(commit);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_transaction_query_pgsql(const struct _h_connection * conn, const char * query) {
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_in_transaction_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return 0;
+}
+
 char * h_escape_string_pgsql(const struct _h_connection * conn, const char * unsafe) {
   UNUSED(conn);
   UNUSED(unsafe);
@@ -464,6 +2837,222 @@ int h_execute_query_pgsql(const struct _h_connection * conn, const char * query,
   return H_ERROR;
 }
 
+int h_execute_query_options_pgsql(const struct _h_connection * conn, const char * query, struct _h_result * h_result, int options) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(h_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_execute_query_columnar_pgsql(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_execute_query_value_pgsql(const struct _h_connection * conn, const char * query, struct _h_value_result * result) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_execute_query_view_pgsql(const struct _h_connection * conn, const char * query, struct _h_result_view * view) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(view);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+const char * h_result_view_get_value_pgsql(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length) {
+  UNUSED(view);
+  UNUSED(row);
+  UNUSED(col);
+  UNUSED(length);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return NULL;
+}
+
+void h_result_view_get_cell_pgsql(const struct _h_result_view * view, unsigned int row, unsigned int col, struct _h_cell * cell) {
+  UNUSED(view);
+  UNUSED(row);
+  UNUSED(col);
+  cell->type = HOEL_COL_TYPE_NULL;
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+}
+
+void h_result_view_free_pgsql(struct _h_result_view * view) {
+  UNUSED(view);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+}
+
+int h_cursor_open_pgsql(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_cursor_fetch_pgsql(struct _h_cursor * cursor) {
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+void h_cursor_get_cell_pgsql(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell) {
+  UNUSED(cursor);
+  UNUSED(col);
+  cell->type = HOEL_COL_TYPE_NULL;
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+}
+
+const char * h_cursor_get_name_pgsql(const struct _h_cursor * cursor, unsigned int col) {
+  UNUSED(cursor);
+  UNUSED(col);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return NULL;
+}
+
+void h_cursor_close_pgsql(struct _h_cursor * cursor) {
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+}
+
+int h_prepare_pgsql(const struct _h_connection * conn, const char * query, struct _h_statement * stmt) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_cursor_open_prepared_pgsql(struct _h_statement * stmt, struct _h_cursor * cursor) {
+  UNUSED(stmt);
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+void h_finalize_pgsql(struct _h_statement * stmt) {
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+}
+
+int h_connection_busy_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return 1;
+}
+
+unsigned long h_session_id_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return 0;
+}
+
+int h_async_send_pgsql(const struct _h_connection * conn, const char * query) {
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_async_send_prepared_pgsql(struct _h_statement * stmt) {
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_async_poll_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_async_get_result_pgsql(const struct _h_connection * conn, struct _h_result * result, int options) {
+  UNUSED(conn);
+  UNUSED(result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_async_get_result_json_pgsql(const struct _h_connection * conn, json_t ** j_result, int options) {
+  UNUSED(conn);
+  UNUSED(j_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_get_socket_fd_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return -1;
+}
+
+int h_pipeline_begin_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_pipeline_queue_pgsql(const struct _h_connection * conn, const char * query) {
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_pipeline_queue_prepared_pgsql(struct _h_statement * stmt) {
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_pipeline_sync_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_pipeline_get_result_pgsql(const struct _h_connection * conn, struct _h_result * result, int options) {
+  UNUSED(conn);
+  UNUSED(result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_pipeline_get_result_json_pgsql(const struct _h_connection * conn, json_t ** j_result, int options) {
+  UNUSED(conn);
+  UNUSED(j_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_pipeline_end_pgsql(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
+int h_bulk_insert_pgsql(const struct _h_connection * conn, const char * table, const json_t * j_values) {
+  UNUSED(conn);
+  UNUSED(table);
+  UNUSED(j_values);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
 int h_execute_query_json_pgsql(const struct _h_connection * conn, const char * query, json_t ** j_result) {
   UNUSED(conn);
   UNUSED(query);
@@ -472,4 +3061,13 @@ int h_execute_query_json_pgsql(const struct _h_connection * conn, const char * q
   return H_ERROR;
 }
 
+int h_execute_query_json_options_pgsql(const struct _h_connection * conn, const char * query, json_t ** j_result, int options) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(j_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with PostgreSQL backend");
+  return H_ERROR;
+}
+
 #endif
@@ -0,0 +1,724 @@
+/**
+ * 
+ * Hoel database abstraction library
+ * 
+ * hoel-pool.c: connection pool functions
+ * 
+ * Copyright 2015-2020 Nicolas Mora <mail@babelouest.org>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation;
+ * version 2.1 of the License.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU GENERAL PUBLIC LICENSE for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+#include <errno.h>
+#include <string.h>
+
+#include "hoel.h"
+#include "h-private.h"
+
+/**
+ * Number of connection parameters kept by the pool
+ * sqlite: db_path
+ * mariadb: host, user, passwd, db, unix_socket
+ * pgsql: conninfo
+ */
+#define H_POOL_NB_PARAMS 5
+
+/**
+ * Parameter of the threads opening the connections of a new pool
+ */
+struct _h_pool_connect_arg {
+  struct _h_pool * pool;
+  unsigned int     index;
+};
+
+/**
+ * Shared state of the threads inserting the chunks of h_pool_insert_chunks
+ * The next chunk starts at offset, the chunks are built and their reports appended with lock held
+ */
+struct _h_pool_insert_arg {
+  struct _h_pool * pool;
+  const json_t   * j_query;
+  const json_t   * j_values;
+  const char     * table;
+  json_t         * j_report;
+  size_t           offset;
+  int              result;
+  pthread_mutex_t  lock;
+};
+
+/**
+ * Open a new connection with the pool parameters
+ * return a new connection on success, NULL on error
+ */
+static struct _h_connection * h_pool_connect(const struct _h_pool * pool) {
+  switch (pool->type) {
+    case HOEL_DB_TYPE_SQLITE:
+      return h_connect_sqlite(pool->params[0]);
+    case HOEL_DB_TYPE_MARIADB:
+      return h_connect_mariadb(pool->params[0], pool->params[1], pool->params[2], pool->params[3], pool->port, pool->params[4]);
+    case HOEL_DB_TYPE_PGSQL:
+      return h_connect_pgsql(pool->params[0]);
+    default:
+      return NULL;
+  }
+}
+
+/**
+ * Thread function opening one connection of a new pool
+ */
+static void * h_pool_connect_thread(void * args) {
+  struct _h_pool_connect_arg * arg = (struct _h_pool_connect_arg *)args;
+  
+  arg->pool->connections[arg->index] = h_pool_connect(arg->pool);
+  return NULL;
+}
+
+/**
+ * Close a connection of the pool
+ */
+static void h_pool_disconnect(struct _h_connection * conn) {
+  if (conn != NULL) {
+    h_close_db(conn);
+    h_clean_connection(conn);
+  }
+}
+
+/**
+ * Free the pool and its connections
+ */
+static void h_pool_free(struct _h_pool * pool) {
+  unsigned int i;
+  
+  if (pool != NULL) {
+    if (pool->connections != NULL) {
+      for (i=0; i<pool->size; i++) {
+        h_pool_disconnect(pool->connections[i]);
+      }
+    }
+    if (pool->params != NULL) {
+      for (i=0; i<H_POOL_NB_PARAMS; i++) {
+        h_free(pool->params[i]);
+      }
+    }
+    h_free(pool->params);
+    h_free(pool->connections);
+    h_free(pool->available);
+    h_free(pool);
+  }
+}
+
+/**
+ * Create a new pool and open its connections
+ * The first connection is opened before the others, so the client library is initialized
+ * by one thread only and a wrong parameter fails fast,
+ * the other connections are opened in parallel
+ * return a pointer to a struct _h_pool * on success, NULL on error
+ */
+static struct _h_pool * h_pool_new(int type, const char ** params, unsigned int port, unsigned int size) {
+  struct _h_pool * pool;
+  struct _h_pool_connect_arg * args = NULL;
+  pthread_t * threads = NULL;
+  unsigned int i, nb_threads = 0;
+  int ret = H_OK;
+  
+  if (!size) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error pool size must be at least 1");
+    return NULL;
+  }
+  if ((pool = o_malloc(sizeof(struct _h_pool))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for pool");
+    return NULL;
+  }
+  pool->type = type;
+  pool->port = port;
+  pool->size = size;
+  pool->nb_available = 0;
+  pool->timeout = H_POOL_DEFAULT_TIMEOUT;
+  pool->params = o_malloc(H_POOL_NB_PARAMS*sizeof(char *));
+  pool->connections = o_malloc(size*sizeof(struct _h_connection *));
+  pool->available = o_malloc(size*sizeof(unsigned int));
+  if (pool->params == NULL || pool->connections == NULL || pool->available == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for pool members");
+    h_free(pool->connections);
+    pool->connections = NULL;
+    h_free(pool->params);
+    pool->params = NULL;
+    h_pool_free(pool);
+    return NULL;
+  }
+  for (i=0; i<H_POOL_NB_PARAMS; i++) {
+    pool->params[i] = o_strdup(params[i]);
+  }
+  for (i=0; i<size; i++) {
+    pool->connections[i] = NULL;
+  }
+  
+  if ((pool->connections[0] = h_pool_connect(pool)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error opening the first connection of the pool");
+    ret = H_ERROR_CONNECTION;
+  } else if (size > 1) {
+    threads = o_malloc((size-1)*sizeof(pthread_t));
+    args = o_malloc((size-1)*sizeof(struct _h_pool_connect_arg));
+    if (threads != NULL && args != NULL) {
+      for (i=1; i<size; i++) {
+        args[nb_threads].pool = pool;
+        args[nb_threads].index = i;
+        if (pthread_create(&threads[nb_threads], NULL, h_pool_connect_thread, &args[nb_threads])) {
+          /* Open the connection in this thread instead */
+          pool->connections[i] = h_pool_connect(pool);
+        } else {
+          nb_threads++;
+        }
+      }
+      for (i=0; i<nb_threads; i++) {
+        pthread_join(threads[i], NULL);
+      }
+      for (i=1; i<size; i++) {
+        if (pool->connections[i] == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error opening connection %u of the pool", i);
+          ret = H_ERROR_CONNECTION;
+        }
+      }
+    } else {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for threads");
+      ret = H_ERROR_MEMORY;
+    }
+    h_free(threads);
+    h_free(args);
+  }
+  
+  if (ret == H_OK) {
+    if (pthread_mutex_init(&pool->lock, NULL)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error initializing pool lock");
+      ret = H_ERROR;
+    } else if (pthread_cond_init(&pool->cond, NULL)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error initializing pool condition");
+      pthread_mutex_destroy(&pool->lock);
+      ret = H_ERROR;
+    }
+  }
+  if (ret != H_OK) {
+    h_pool_free(pool);
+    return NULL;
+  }
+  /* The stack is filled backwards so the first connection is checked out first */
+  for (i=size; i>0; i--) {
+    pool->available[pool->nb_available++] = i-1;
+  }
+  return pool;
+}
+
+/**
+ * Check out a connection, waits for pool->timeout if none is available
+ * A connection which couldn't be opened again when it was released is opened now
+ * return H_OK on success, H_ERROR_TIMEOUT if no connection was available in time
+ */
+static int h_pool_checkout(struct _h_pool * pool, struct _h_connection ** conn) {
+  struct timespec deadline;
+  struct _h_connection * new_conn;
+  unsigned int index = 0;
+  int ret = H_OK, res = 0;
+  
+  if (pool == NULL || conn == NULL) {
+    return H_ERROR_PARAMS;
+  }
+  if (pthread_mutex_lock(&pool->lock)) {
+    return H_ERROR;
+  }
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += (time_t)(pool->timeout/1000);
+  deadline.tv_nsec += (long)(pool->timeout%1000)*1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+  while (!pool->nb_available && !res) {
+    res = pthread_cond_timedwait(&pool->cond, &pool->lock, &deadline);
+  }
+  if (pool->nb_available) {
+    index = pool->available[--pool->nb_available];
+    *conn = pool->connections[index];
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no connection available in the pool");
+    ret = res==ETIMEDOUT?H_ERROR_TIMEOUT:H_ERROR;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  
+  if (ret == H_OK && *conn == NULL) {
+    new_conn = h_pool_connect(pool);
+    pthread_mutex_lock(&pool->lock);
+    if (new_conn != NULL) {
+      pool->connections[index] = new_conn;
+      *conn = new_conn;
+    } else {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error opening connection %u of the pool", index);
+      pool->available[pool->nb_available++] = index;
+      pthread_cond_signal(&pool->cond);
+      ret = H_ERROR_CONNECTION;
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_new_sqlite
+ * Create a pool of connections to a sqlite3 db file
+ * return a pointer to a struct _h_pool * on success, NULL on error
+ */
+struct _h_pool * h_pool_new_sqlite(const char * db_path, unsigned int size) {
+  const char * params[H_POOL_NB_PARAMS] = {db_path, NULL, NULL, NULL, NULL};
+  
+  if (db_path == NULL) {
+    return NULL;
+  }
+  return h_pool_new(HOEL_DB_TYPE_SQLITE, params, 0, size);
+}
+
+/**
+ * h_pool_new_mariadb
+ * Create a pool of connections to a mariadb server
+ * return a pointer to a struct _h_pool * on success, NULL on error
+ */
+struct _h_pool * h_pool_new_mariadb(const char * host, const char * user, const char * passwd, const char * db, const unsigned int port, const char * unix_socket, unsigned int size) {
+  const char * params[H_POOL_NB_PARAMS] = {host, user, passwd, db, unix_socket};
+  
+  return h_pool_new(HOEL_DB_TYPE_MARIADB, params, port, size);
+}
+
+/**
+ * h_pool_new_pgsql
+ * Create a pool of connections to a PostgreSQL server
+ * return a pointer to a struct _h_pool * on success, NULL on error
+ */
+struct _h_pool * h_pool_new_pgsql(const char * conninfo, unsigned int size) {
+  const char * params[H_POOL_NB_PARAMS] = {conninfo, NULL, NULL, NULL, NULL};
+  
+  if (conninfo == NULL) {
+    return NULL;
+  }
+  return h_pool_new(HOEL_DB_TYPE_PGSQL, params, 0, size);
+}
+
+/**
+ * h_pool_close
+ * Close all the connections of a pool and free the pool
+ * return H_OK on success
+ */
+int h_pool_close(struct _h_pool * pool) {
+  if (pool == NULL) {
+    return H_ERROR_PARAMS;
+  }
+  if (pthread_mutex_lock(&pool->lock)) {
+    return H_ERROR;
+  }
+  if (pool->nb_available != pool->size) {
+    pthread_mutex_unlock(&pool->lock);
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error closing pool, %u connections are still checked out", pool->size-pool->nb_available);
+    return H_ERROR_PARAMS;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->lock);
+  h_pool_free(pool);
+  return H_OK;
+}
+
+/**
+ * h_pool_set_timeout
+ * Set the time to wait for a connection when all the connections of the pool are checked out
+ * return H_OK on success
+ */
+int h_pool_set_timeout(struct _h_pool * pool, unsigned int timeout) {
+  if (pool == NULL) {
+    return H_ERROR_PARAMS;
+  }
+  if (pthread_mutex_lock(&pool->lock)) {
+    return H_ERROR;
+  }
+  pool->timeout = timeout;
+  pthread_mutex_unlock(&pool->lock);
+  return H_OK;
+}
+
+/**
+ * h_pool_acquire
+ * Check out a connection from the pool
+ * return a connection on success, NULL on error or timeout
+ */
+struct _h_connection * h_pool_acquire(struct _h_pool * pool) {
+  struct _h_connection * conn = NULL;
+  
+  if (h_pool_checkout(pool, &conn) == H_OK) {
+    return conn;
+  } else {
+    return NULL;
+  }
+}
+
+/**
+ * h_pool_release
+ * Give a connection back to the pool
+ * return H_OK on success
+ */
+int h_pool_release(struct _h_pool * pool, struct _h_connection * conn) {
+  struct _h_connection * new_conn = conn;
+  unsigned int index, i;
+  int ret = H_OK;
+  
+  if (pool == NULL || conn == NULL) {
+    return H_ERROR_PARAMS;
+  }
+  if (pthread_mutex_lock(&pool->lock)) {
+    return H_ERROR;
+  }
+  for (index=0; index<pool->size && pool->connections[index] != conn; index++);
+  for (i=0; index<pool->size && i<pool->nb_available; i++) {
+    if (pool->available[i] == index) {
+      /* Released twice */
+      index = pool->size;
+    }
+  }
+  if (index < pool->size) {
+    /* Claim the slot while the connection is checked, so a concurrent release of the same connection fails */
+    pool->connections[index] = NULL;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  if (index == pool->size) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error connection is not checked out from this pool");
+    return H_ERROR_PARAMS;
+  }
+  
+  if (h_check_connection(conn) != H_OK) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel - Open connection %u of the pool again", index);
+    h_pool_disconnect(conn);
+    if ((new_conn = h_pool_connect(pool)) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error opening connection %u of the pool", index);
+      ret = H_ERROR_CONNECTION;
+    }
+  }
+  
+  pthread_mutex_lock(&pool->lock);
+  pool->connections[index] = new_conn;
+  pool->available[pool->nb_available++] = index;
+  pthread_cond_signal(&pool->cond);
+  pthread_mutex_unlock(&pool->lock);
+  return ret;
+}
+
+/**
+ * h_pool_execute_query
+ * Execute a query on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_execute_query(struct _h_pool * pool, const char * query, struct _h_result * result, int options) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_execute_query(conn, query, result, options);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_query_insert
+ * Execute an insert query on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_query_insert(struct _h_pool * pool, const char * query) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_query_insert(conn, query);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_query_update
+ * Execute an update query on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_query_update(struct _h_pool * pool, const char * query) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_query_update(conn, query);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_query_delete
+ * Execute a delete query on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_query_delete(struct _h_pool * pool, const char * query) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_query_delete(conn, query);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_query_select
+ * Execute a select query on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_query_select(struct _h_pool * pool, const char * query, struct _h_result * result) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_query_select(conn, query, result);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_execute_query_json
+ * Execute a query on a connection of the pool, set the result structure with the returned values
+ * return H_OK on success
+ */
+int h_pool_execute_query_json(struct _h_pool * pool, const char * query, json_t ** j_result) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_execute_query_json(conn, query, j_result);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_query_select_json
+ * Execute a select query on a connection of the pool, set the result structure with the returned values
+ * return H_OK on success
+ */
+int h_pool_query_select_json(struct _h_pool * pool, const char * query, json_t ** j_result) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_query_select_json(conn, query, j_result);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_select
+ * Execute a select query as a json_t on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_select(struct _h_pool * pool, const json_t * j_query, json_t ** j_result, char ** generated_query) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_select(conn, j_query, j_result, generated_query);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_insert
+ * Execute an insert query as a json_t on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_insert(struct _h_pool * pool, const json_t * j_query, char ** generated_query) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_insert(conn, j_query, generated_query);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_update
+ * Execute an update query as a json_t on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_update(struct _h_pool * pool, const json_t * j_query, char ** generated_query) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_update(conn, j_query, generated_query);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * h_pool_delete
+ * Execute a delete query as a json_t on a connection of the pool
+ * return H_OK on success
+ */
+int h_pool_delete(struct _h_pool * pool, const json_t * j_query, char ** generated_query) {
+  struct _h_connection * conn = NULL;
+  int ret;
+  
+  if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+    ret = h_delete(conn, j_query, generated_query);
+    h_pool_release(pool, conn);
+  }
+  return ret;
+}
+
+/**
+ * Thread function inserting chunks on one connection of the pool until all the rows are inserted
+ * or a chunk has failed
+ */
+static void * h_pool_insert_thread(void * args) {
+  struct _h_pool_insert_arg * arg = (struct _h_pool_insert_arg *)args;
+  struct _h_connection * conn = NULL;
+  size_t max_rows, max_bytes, offset, nb_rows;
+  json_t * j_chunk;
+  char * query;
+  int ret;
+  
+  if (h_pool_checkout(arg->pool, &conn) != H_OK) {
+    /* The other threads insert the rows */
+    return NULL;
+  }
+  h_insert_chunk_limits(conn, arg->j_query, 1, &max_rows, &max_bytes);
+  while (1) {
+    pthread_mutex_lock(&arg->lock);
+    if (arg->result != H_OK || arg->offset >= json_array_size(arg->j_values)) {
+      pthread_mutex_unlock(&arg->lock);
+      break;
+    }
+    offset = arg->offset;
+    if ((query = h_get_insert_query_chunk(conn, arg->j_values, arg->table, offset, max_rows, max_bytes, &nb_rows)) == NULL) {
+      arg->result = H_ERROR_MEMORY;
+      pthread_mutex_unlock(&arg->lock);
+      break;
+    }
+    arg->offset += nb_rows;
+    j_chunk = NULL;
+    if (arg->j_report != NULL) {
+      j_chunk = h_insert_chunk_report(offset, nb_rows, H_OK);
+      json_array_append(arg->j_report, j_chunk);
+    }
+    pthread_mutex_unlock(&arg->lock);
+    
+    ret = h_query_insert(conn, query);
+    h_free(query);
+    
+    pthread_mutex_lock(&arg->lock);
+    if (ret != H_OK) {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_pool_insert_chunks - Error executing chunk at offset %zu", offset);
+      if (arg->result == H_OK) {
+        arg->result = H_ERROR_QUERY;
+      }
+    }
+    if (j_chunk != NULL) {
+      json_object_set_new(j_chunk, "result", json_integer(ret));
+      json_decref(j_chunk);
+    }
+    pthread_mutex_unlock(&arg->lock);
+  }
+  h_pool_release(arg->pool, conn);
+  return NULL;
+}
+
+/**
+ * h_pool_insert_chunks
+ * Execute an insert query as a json_t, the chunks are inserted in parallel on several connections of the pool
+ * return H_OK on success
+ */
+int h_pool_insert_chunks(struct _h_pool * pool, const json_t * j_query, unsigned int nb_connections, json_t ** j_report) {
+  struct _h_pool_insert_arg arg;
+  struct _h_connection * conn = NULL;
+  pthread_t * threads;
+  unsigned int i, nb_threads = 0;
+  int ret;
+  
+  if (pool == NULL || j_report == NULL || j_query == NULL || !json_is_object(j_query) || !json_is_string(json_object_get(j_query, "table"))) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_pool_insert_chunks - Error null input parameters");
+    return H_ERROR_PARAMS;
+  }
+  if (nb_connections > pool->size) {
+    nb_connections = pool->size;
+  }
+  if (pool->type == HOEL_DB_TYPE_SQLITE) {
+    /* SQLite allows one writer at a time, the other connections would fail with SQLITE_BUSY */
+    nb_connections = 1;
+  }
+  if (nb_connections <= 1 || !json_is_array(json_object_get(j_query, "values"))) {
+    if ((ret = h_pool_checkout(pool, &conn)) == H_OK) {
+      ret = h_insert_chunks(conn, j_query, j_report);
+      h_pool_release(pool, conn);
+    }
+    return ret;
+  }
+  
+  arg.pool = pool;
+  arg.j_query = j_query;
+  arg.j_values = json_object_get(j_query, "values");
+  arg.table = json_string_value(json_object_get(j_query, "table"));
+  arg.offset = 0;
+  if ((*j_report = arg.j_report = json_array()) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_pool_insert_chunks - Error allocating memory for j_report");
+    return H_ERROR_MEMORY;
+  }
+  if ((arg.result = h_insert_check_values(arg.j_values)) != H_OK) {
+    return arg.result;
+  }
+  if ((threads = o_malloc(nb_connections*sizeof(pthread_t))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_pool_insert_chunks - Error allocating memory for threads");
+    return H_ERROR_MEMORY;
+  }
+  if (pthread_mutex_init(&arg.lock, NULL)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_pool_insert_chunks - Error initializing lock");
+    h_free(threads);
+    return H_ERROR;
+  }
+  for (i=0; i<nb_connections; i++) {
+    if (!pthread_create(&threads[nb_threads], NULL, h_pool_insert_thread, &arg)) {
+      nb_threads++;
+    }
+  }
+  if (!nb_threads) {
+    /* Insert the chunks in this thread instead */
+    h_pool_insert_thread(&arg);
+  }
+  for (i=0; i<nb_threads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  h_free(threads);
+  pthread_mutex_destroy(&arg.lock);
+  if (arg.result == H_OK && arg.offset < json_array_size(arg.j_values)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_pool_insert_chunks - Error no connection available in the pool");
+    arg.result = H_ERROR_TIMEOUT;
+  }
+  return arg.result;
+}
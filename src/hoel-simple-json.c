@@ -23,117 +23,219 @@
 
 #include <string.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
 
 #include "hoel.h"
 #include "h-private.h"
 
-static char * h_get_insert_values_from_json_object(const struct _h_connection * conn, json_t * data) {
-  char * new_data = NULL, * escape, * insert_data = NULL, * tmp;
+/**
+ * Initial size of the buffer of a sql query
+ */
+#define H_SQL_BUFFER_INITIAL_SIZE 256
+
+/**
+ * Default maximum number of rows of an insert query built by h_insert_chunks
+ */
+#define H_INSERT_CHUNK_ROWS 1000
+
+/**
+ * Default maximum length of an insert query built by h_insert_chunks
+ */
+#define H_INSERT_CHUNK_BYTES 4194304
+
+/**
+ * Room kept for the protocol headers when the length of an insert query is limited by the database
+ */
+#define H_INSERT_CHUNK_MARGIN 1024
+
+/**
+ * Transaction of the chunks of an insert
+ */
+#define H_INSERT_TRANSACTION_NONE      0
+#define H_INSERT_TRANSACTION_BEGIN     1
+#define H_INSERT_TRANSACTION_SAVEPOINT 2
+
+void h_sql_buffer_init(struct _h_sql_buffer * buffer) {
+  buffer->str = NULL;
+  buffer->len = 0;
+  buffer->size = 0;
+  buffer->error = 0;
+}
+
+void h_sql_buffer_clean(struct _h_sql_buffer * buffer) {
+  h_free(buffer->str);
+  h_sql_buffer_init(buffer);
+}
+
+/**
+ * Make sure the buffer can receive len more characters
+ * return 1 on success, 0 on error
+ */
+static int h_sql_buffer_reserve(struct _h_sql_buffer * buffer, size_t len) {
+  size_t size;
+  char * str;
+  
+  if (buffer->error) {
+    return 0;
+  }
+  if (buffer->len + len + 1 > buffer->size) {
+    size = buffer->size?buffer->size:H_SQL_BUFFER_INITIAL_SIZE;
+    while (size < buffer->len + len + 1) {
+      size *= 2;
+    }
+    if ((str = o_realloc(buffer->str, size)) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_sql_buffer_reserve - Error allocating memory for buffer");
+      buffer->error = 1;
+      return 0;
+    }
+    buffer->str = str;
+    buffer->size = size;
+  }
+  return 1;
+}
+
+void h_sql_buffer_append_len(struct _h_sql_buffer * buffer, const char * str, size_t len) {
+  if (h_sql_buffer_reserve(buffer, len)) {
+    memcpy(buffer->str + buffer->len, str, len);
+    buffer->len += len;
+    buffer->str[buffer->len] = '\0';
+  }
+}
+
+void h_sql_buffer_append(struct _h_sql_buffer * buffer, const char * str) {
+  h_sql_buffer_append_len(buffer, str, o_strlen(str));
+}
+
+/**
+ * Append a formatted string to the buffer
+ * The string is written in the free space of the buffer, the buffer is grown only if it's too small
+ */
+void h_sql_buffer_appendf(struct _h_sql_buffer * buffer, const char * format, ...) {
+  va_list args;
+  int len;
+  
+  if (!buffer->error) {
+    va_start(args, format);
+    len = vsnprintf(buffer->str!=NULL?buffer->str + buffer->len:NULL, buffer->size - buffer->len, format, args);
+    va_end(args);
+    if (len < 0) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_sql_buffer_appendf - Error formatting string");
+      buffer->error = 1;
+    } else if (buffer->str != NULL && (size_t)len < buffer->size - buffer->len) {
+      buffer->len += (size_t)len;
+    } else if (h_sql_buffer_reserve(buffer, (size_t)len)) {
+      va_start(args, format);
+      vsnprintf(buffer->str + buffer->len, buffer->size - buffer->len, format, args);
+      va_end(args);
+      buffer->len += (size_t)len;
+    }
+  }
+}
+
+/**
+ * Append a string value escaped and quoted for the database of the connection to the buffer
+ */
+void h_sql_buffer_append_escaped(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const char * value) {
+  char * escape;
+  
+  if (!buffer->error) {
+    if ((escape = h_escape_string_with_quotes(conn, value)) != NULL) {
+      h_sql_buffer_append(buffer, escape);
+      h_free(escape);
+    } else {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_sql_buffer_append_escaped - Error escape");
+      buffer->error = 1;
+    }
+  }
+}
+
+/**
+ * Return the string built in the buffer, must be h_free'd after use
+ * return NULL if an error occured while building the string, the buffer is then cleaned
+ */
+char * h_sql_buffer_release(struct _h_sql_buffer * buffer) {
+  char * str = NULL;
+  
+  if (!buffer->error) {
+    str = buffer->str!=NULL?buffer->str:o_strdup("");
+    h_sql_buffer_init(buffer);
+  } else {
+    h_sql_buffer_clean(buffer);
+  }
+  return str;
+}
+
+/**
+ * Append the values of a json object to the buffer as an insert row
+ * (value1,value2)
+ */
+static void h_sql_buffer_append_insert_values(const struct _h_connection * conn, struct _h_sql_buffer * buffer, json_t * data) {
   const char * key = NULL;
   json_t * value = NULL, * raw;
+  char * tmp;
   int i = 0;
 
+  h_sql_buffer_append_len(buffer, "(", 1);
   json_object_foreach((json_t *)data, key, value) {
+    if (i) {
+      h_sql_buffer_append_len(buffer, ",", 1);
+    }
+    i = 1;
     switch (json_typeof(value)) {
       case JSON_STRING:
-        escape = h_escape_string_with_quotes(conn, json_string_value(value));
-        if (escape == NULL) {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_values_from_json_object - Error escape");
-          h_free(new_data);
-          new_data = NULL;
-        } else {
-          new_data = o_strdup(escape);
-          h_free(escape);
-        }
+        h_sql_buffer_append_escaped(conn, buffer, json_string_value(value));
         break;
       case JSON_INTEGER:
-        new_data = msprintf("%"JSON_INTEGER_FORMAT, json_integer_value(value));
+        h_sql_buffer_appendf(buffer, "%"JSON_INTEGER_FORMAT, json_integer_value(value));
         break;
       case JSON_REAL:
-        new_data = msprintf("%f", json_real_value(value));
+        h_sql_buffer_appendf(buffer, "%f", json_real_value(value));
         break;
       case JSON_TRUE:
-        new_data = o_strdup("1");
+        h_sql_buffer_append_len(buffer, "1", 1);
         break;
       case JSON_FALSE:
-        new_data = o_strdup("0");
+        h_sql_buffer_append_len(buffer, "0", 1);
         break;
       case JSON_NULL:
-        new_data = o_strdup("NULL");
+        h_sql_buffer_append(buffer, "NULL");
         break;
       case JSON_OBJECT:
         raw = json_object_get(value, "raw");
         if (raw != NULL && json_is_string(raw)) {
-          new_data = o_strdup(json_string_value(raw));
+          h_sql_buffer_append(buffer, json_string_value(raw));
         } else {
-          new_data = o_strdup("NULL");
+          h_sql_buffer_append(buffer, "NULL");
         }
         break;
       default:
         tmp = json_dumps(value, JSON_ENCODE_ANY);
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_values_from_json_object - Error decoding value %s, inserting NULL value", tmp);
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_sql_buffer_append_insert_values - Error decoding value %s, inserting NULL value", tmp);
         h_free(tmp);
-        new_data = o_strdup("NULL");
+        h_sql_buffer_append(buffer, "NULL");
         break;
     }
-    if (new_data == NULL) {
-      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_values_from_json_object - Error allocating memory for new_data");
-      return NULL;
-    }
-    if (i == 0) {
-      insert_data = msprintf("(%s", new_data);
-      if (insert_data == NULL) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_values_from_json_object - Error allocating insert_data");
-      }
-      i = 1;
-      h_free(new_data);
-    } else {
-      tmp = msprintf("%s,%s", insert_data, new_data);
-      if (tmp == NULL) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_values_from_json_object - Error allocating tmp");
-        h_free(insert_data);
-        h_free(new_data);
-        return NULL;
-      }
-      h_free(insert_data);
-      h_free(new_data);
-      insert_data = tmp;
-    }
-  }
-  tmp = msprintf("%s)", insert_data);
-  h_free(insert_data);
-  if (tmp == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_values_from_json_object - Error final allocation for tmp");
   }
-  return tmp;
+  h_sql_buffer_append_len(buffer, ")", 1);
 }
 
-static char * h_get_insert_columns_from_json_object(json_t * data) {
-  char * insert_cols = NULL, * tmp;
+/**
+ * Append the keys of a json object to the buffer as an insert columns list
+ * col1,col2
+ */
+static void h_sql_buffer_append_insert_columns(struct _h_sql_buffer * buffer, json_t * data) {
   const char * key = NULL;
   json_t * value = NULL;
   int i = 0;
 
   json_object_foreach((json_t *)data, key, value) {
-    if (i == 0) {
-      insert_cols = msprintf("%s", key);
-      if (insert_cols == NULL) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_columns_from_json_object - Error allocating insert_cols");
-        return NULL;
-      }
-      i = 1;
-    } else {
-      tmp = msprintf("%s,%s", insert_cols, key);
-      h_free(insert_cols);
-      if (tmp == NULL) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_columns_from_json_object - Error allocating insert_cols");
-        return NULL;
-      }
-      insert_cols = tmp;
+    if (i) {
+      h_sql_buffer_append_len(buffer, ",", 1);
     }
+    i = 1;
+    h_sql_buffer_append(buffer, key);
   }
-
-  return insert_cols;
 }
 
 /**
@@ -141,60 +243,705 @@ static char * h_get_insert_columns_from_json_object(json_t * data) {
  * Returned value must be h_free'd after use
  */
 static char * h_get_insert_query_from_json_object(const struct _h_connection * conn, json_t * data, const char * table) {
-  char * to_return = NULL, * insert_cols, * insert_data;
+  struct _h_sql_buffer buffer;
+  char * to_return;
 
-  insert_cols = h_get_insert_columns_from_json_object(data);
-  insert_data = h_get_insert_values_from_json_object(conn, data);
-  if (insert_cols == NULL || insert_data == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_query_from_json_object - Error h_get_insert_columns_from_json_object or h_get_insert_values_from_json_object");
-  } else {
-    to_return = msprintf("INSERT INTO %s (%s) VALUES %s", table, insert_cols, insert_data);
+  if (!json_is_object(data) || !json_object_size(data)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_query_from_json_object - Error values must be a non empty json object");
+    return NULL;
   }
-  h_free(insert_cols);
-  h_free(insert_data);
-  if (to_return == NULL) {
+  h_sql_buffer_init(&buffer);
+  h_sql_buffer_appendf(&buffer, "INSERT INTO %s (", table);
+  h_sql_buffer_append_insert_columns(&buffer, data);
+  h_sql_buffer_append(&buffer, ") VALUES ");
+  h_sql_buffer_append_insert_values(conn, &buffer, data);
+  if ((to_return = h_sql_buffer_release(&buffer)) == NULL) {
     y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_query_from_json_object - Error allocating memory for h_get_insert_query_from_json_object");
   }
   return to_return;
 }
 
 /**
- * Builds an insert query from a json object and a table name
- * Returned value must be h_free'd after use
+ * Return the maximum length of a query accepted by the database, 0 if there's no known limit
+ */
+static size_t h_max_query_length(const struct _h_connection * conn) {
+  if (0) {
+    /* Not happening */
+#ifdef _HOEL_SQLITE
+  } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+    return h_max_query_length_sqlite(conn);
+#endif
+#ifdef _HOEL_MARIADB
+  } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+    return h_max_query_length_mariadb(conn);
+#endif
+  } else {
+    UNUSED(conn);
+    return 0;
+  }
+}
+
+/**
+ * Check if an asynchronous query, a pipeline or a cursor is running on a pgsql connection
+ * The json statement cache isn't used and no transaction is started on a busy connection
+ */
+static int h_connection_busy(const struct _h_connection * conn) {
+  if (0) {
+    /* Not happening */
+#ifdef _HOEL_PGSQL
+  } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+    return h_connection_busy_pgsql(conn);
+#endif
+  } else {
+    UNUSED(conn);
+    return 0;
+  }
+}
+
+/**
+ * Check if a transaction is open on the connection, started with h_transaction_begin or by a query
  */
-static char * h_get_insert_query_from_json_array(const struct _h_connection * conn, json_t * j_array, const char * table) {
+static int h_in_transaction(const struct _h_connection * conn) {
+  if (0) {
+    /* Not happening */
+#ifdef _HOEL_SQLITE
+  } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+    return h_in_transaction_sqlite(conn);
+#endif
+#ifdef _HOEL_MARIADB
+  } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+    return h_in_transaction_mariadb(conn);
+#endif
+#ifdef _HOEL_PGSQL
+  } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+    return h_in_transaction_pgsql(conn);
+#endif
+  } else {
+    UNUSED(conn);
+    return 0;
+  }
+}
+
+/**
+ * Check that the values of an insert query are a non empty json array of non empty json objects
+ * return H_OK on success
+ */
+int h_insert_check_values(const json_t * j_values) {
   json_t * j_row = NULL;
   size_t index = 0;
-  char * to_return = NULL, * insert_cols, * insert_data, * tmp;
-
-  json_array_foreach(j_array, index, j_row) {
-    insert_data = h_get_insert_values_from_json_object(conn, j_row);
-    if (!index) {
-      insert_cols = h_get_insert_columns_from_json_object(j_row);
-      to_return = msprintf("INSERT INTO %s (%s) VALUES %s", table, insert_cols, insert_data);
-      h_free(insert_cols);
-      if (to_return == NULL) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_query_from_json_array - Error allocating to_return");
-        h_free(insert_data);
-        return NULL;
+
+  if (!json_is_array(j_values) || !json_array_size(j_values)) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert_check_values - Error no values to insert");
+    return H_ERROR_QUERY;
+  }
+  json_array_foreach(j_values, index, j_row) {
+    if (!json_is_object(j_row) || !json_object_size(j_row)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_insert_check_values - Error values must be non empty json objects");
+      return H_ERROR_PARAMS;
+    }
+  }
+  return H_OK;
+}
+
+/**
+ * Get the maximum number of rows and bytes of the insert queries of j_query
+ * The limits are set by "chunk_rows" and "chunk_bytes" in j_query,
+ * otherwise by the default values if chunks is set, or aren't limited if chunks is 0,
+ * the number of bytes can't exceed the maximum length of a query accepted by the database
+ */
+void h_insert_chunk_limits(const struct _h_connection * conn, const json_t * j_query, int chunks, size_t * max_rows, size_t * max_bytes) {
+  json_int_t chunk_rows = json_integer_value(json_object_get(j_query, "chunk_rows")),
+             chunk_bytes = json_integer_value(json_object_get(j_query, "chunk_bytes"));
+  size_t max_length = h_max_query_length(conn);
+
+  *max_rows = chunk_rows>0?(size_t)chunk_rows:(chunks?H_INSERT_CHUNK_ROWS:SIZE_MAX);
+  *max_bytes = chunk_bytes>0?(size_t)chunk_bytes:(chunks?H_INSERT_CHUNK_BYTES:SIZE_MAX);
+  if (max_length > H_INSERT_CHUNK_MARGIN && *max_bytes > max_length - H_INSERT_CHUNK_MARGIN) {
+    *max_bytes = max_length - H_INSERT_CHUNK_MARGIN;
+  }
+}
+
+/**
+ * Append an insert query with the rows of j_values from offset to the buffer, j_values must be checked with h_insert_check_values
+ * The query has at most max_rows rows and max_bytes bytes, but at least one row
+ * The columns are the keys of the first object of j_values
+ * return the number of rows in the query
+ */
+static size_t h_sql_buffer_append_insert_chunk(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const json_t * j_values, const char * table, size_t offset, size_t max_rows, size_t max_bytes) {
+  size_t index, len;
+
+  h_sql_buffer_appendf(buffer, "INSERT INTO %s (", table);
+  h_sql_buffer_append_insert_columns(buffer, json_array_get(j_values, 0));
+  h_sql_buffer_append(buffer, ") VALUES ");
+  for (index = offset; index < json_array_size(j_values) && index - offset < max_rows; index++) {
+    len = buffer->len;
+    if (index > offset) {
+      h_sql_buffer_append_len(buffer, ",", 1);
+    }
+    h_sql_buffer_append_insert_values(conn, buffer, json_array_get(j_values, index));
+    if (index > offset && !buffer->error && buffer->len > max_bytes) {
+      buffer->len = len;
+      buffer->str[len] = '\0';
+      break;
+    }
+  }
+  return index - offset;
+}
+
+/**
+ * Builds an insert query with the rows of j_values from offset, j_values must be checked with h_insert_check_values
+ * The query has at most max_rows rows and max_bytes bytes, but at least one row
+ * The columns are the keys of the first object of j_values
+ * nb_rows is set to the number of rows in the query
+ * Returned value must be h_free'd after use
+ */
+char * h_get_insert_query_chunk(const struct _h_connection * conn, const json_t * j_values, const char * table, size_t offset, size_t max_rows, size_t max_bytes, size_t * nb_rows) {
+  struct _h_sql_buffer buffer;
+  char * to_return;
+
+  h_sql_buffer_init(&buffer);
+  *nb_rows = h_sql_buffer_append_insert_chunk(conn, &buffer, j_values, table, offset, max_rows, max_bytes);
+  if ((to_return = h_sql_buffer_release(&buffer)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_query_chunk - Error allocating to_return");
+  }
+  return to_return;
+}
+
+/**
+ * Create the report of an insert chunk
+ * {"offset": offset, "rows": nb_rows, "result": result}
+ */
+json_t * h_insert_chunk_report(size_t offset, size_t nb_rows, int result) {
+  return json_pack("{sIsIsi}", "offset", (json_int_t)offset, "rows", (json_int_t)nb_rows, "result", result);
+}
+
+/**
+ * Start the transaction of the chunks of an insert, or a savepoint if a transaction is already open
+ * No transaction is started on a busy pgsql connection, the queries of a pipeline run in its implicit transaction
+ * transaction is set to the H_INSERT_TRANSACTION_* started
+ * return H_OK on success
+ */
+static int h_insert_transaction_begin(const struct _h_connection * conn, int * transaction) {
+  int res = H_OK;
+
+  *transaction = H_INSERT_TRANSACTION_NONE;
+  if (h_connection_busy(conn)) {
+    return H_OK;
+  } else if (h_in_transaction(conn)) {
+    if ((res = h_execute_query(conn, "SAVEPOINT hoel_insert", NULL, H_OPTION_EXEC)) == H_OK) {
+      *transaction = H_INSERT_TRANSACTION_SAVEPOINT;
+    }
+  } else if ((res = h_transaction_begin(conn)) == H_OK) {
+    *transaction = H_INSERT_TRANSACTION_BEGIN;
+  }
+  if (res != H_OK) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error starting transaction");
+  }
+  return res;
+}
+
+/**
+ * End the transaction of the chunks of an insert, commit or release the savepoint if commit is set,
+ * rollback otherwise
+ * return H_OK on success
+ */
+static int h_insert_transaction_end(const struct _h_connection * conn, int transaction, int commit) {
+  int res = H_OK;
+
+  if (transaction == H_INSERT_TRANSACTION_BEGIN) {
+    res = commit?h_commit(conn):h_rollback(conn);
+  } else if (transaction == H_INSERT_TRANSACTION_SAVEPOINT) {
+    if (!commit || (res = h_execute_query(conn, "RELEASE SAVEPOINT hoel_insert", NULL, H_OPTION_EXEC)) != H_OK) {
+      h_execute_query(conn, "ROLLBACK TO SAVEPOINT hoel_insert", NULL, H_OPTION_EXEC);
+      h_execute_query(conn, "RELEASE SAVEPOINT hoel_insert", NULL, H_OPTION_EXEC);
+    }
+  }
+  return res==H_OK?H_OK:H_ERROR_QUERY;
+}
+
+/**
+ * Insert the rows of j_values, the next chunks aren't executed if a chunk fails
+ * If j_report is NULL, the rows are inserted with a single query, unless "chunk_rows" or "chunk_bytes" are set
+ * or the query would exceed the maximum length of the database, the chunks are then inserted
+ * in a transaction, or in a savepoint if a transaction is already open, so none of the rows is inserted on error
+ * If j_report isn't NULL, the rows are inserted by chunks with the default limits, each chunk is committed
+ * on its own, and the report of each chunk executed is appended to j_report
+ * If suffix isn't NULL, it's appended to the query of each chunk
+ * Duplicate the queries executed in generated_query if specified, separated by ";\n"
+ * return H_OK on success
+ */
+static int h_insert_rows(const struct _h_connection * conn, const json_t * j_query, const json_t * j_values, const char * suffix, char ** generated_query, json_t * j_report) {
+  const char * table = json_string_value(json_object_get(j_query, "table"));
+  struct _h_sql_buffer buffer, generated;
+  size_t max_rows, max_bytes, offset, nb_rows;
+  char * query;
+  int res, transaction = H_INSERT_TRANSACTION_NONE;
+
+  if ((res = h_insert_check_values(j_values)) != H_OK) {
+    return res;
+  }
+  h_insert_chunk_limits(conn, j_query, j_report != NULL, &max_rows, &max_bytes);
+  if (o_strlen(suffix) < max_bytes) {
+    max_bytes -= o_strlen(suffix);
+  }
+  h_sql_buffer_init(&generated);
+  for (offset = 0; res == H_OK && offset < json_array_size(j_values); offset += nb_rows) {
+    h_sql_buffer_init(&buffer);
+    nb_rows = h_sql_buffer_append_insert_chunk(conn, &buffer, j_values, table, offset, max_rows, max_bytes);
+    if (suffix != NULL) {
+      h_sql_buffer_append(&buffer, suffix);
+    }
+    if ((query = h_sql_buffer_release(&buffer)) == NULL) {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error allocating query (2)");
+      res = H_ERROR_MEMORY;
+      break;
+    }
+    if (!offset && j_report == NULL && nb_rows < json_array_size(j_values)) {
+      /* The rows don't fit in one query */
+      res = h_insert_transaction_begin(conn, &transaction);
+    }
+    if (res == H_OK) {
+      if (generated_query != NULL) {
+        if (offset) {
+          h_sql_buffer_append(&generated, ";\n");
+        }
+        h_sql_buffer_append(&generated, query);
+      }
+      res = h_query_insert(conn, query);
+      if (j_report != NULL) {
+        json_array_append_new(j_report, h_insert_chunk_report(offset, nb_rows, res));
+      }
+      if (res != H_OK) {
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error executing query (2)");
+        res = H_ERROR_QUERY;
       }
+    }
+    h_free(query);
+  }
+  if (transaction != H_INSERT_TRANSACTION_NONE) {
+    if (h_insert_transaction_end(conn, transaction, res == H_OK) != H_OK && res == H_OK) {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error ending transaction");
+      res = H_ERROR_QUERY;
+    }
+  }
+  if (generated_query != NULL && generated.len) {
+    *generated_query = h_sql_buffer_release(&generated);
+  } else {
+    h_sql_buffer_clean(&generated);
+  }
+  return res;
+}
+
+/**
+ * Default number of prepared statements kept in the json statement cache of a connection
+ */
+#define H_JSON_CACHE_SIZE 16
+
+/**
+ * Maximum number of placeholders in a cached query, larger queries, like long IN lists, are rarely executed again
+ * so their values are inlined
+ */
+#define H_JSON_CACHE_MAX_PARAMS 999
+
+/**
+ * Json statement cache entry, the key is the sql query of the statement, written with placeholders
+ * session is the id of the server session where the statement was prepared
+ */
+struct _h_json_cache_entry {
+  char                       * query;
+  unsigned long                hash;
+  unsigned long                session;
+  struct _h_statement          stmt;
+  struct _h_json_cache_entry * prev;
+  struct _h_json_cache_entry * next;
+};
+
+/**
+ * Cache of the prepared statements of h_select, h_update and h_delete
+ * The queries are written with placeholders, so the queries with the same shape and different values
+ * use the same prepared statement
+ * The statements are kept in a LRU list, first is the most recently used statement, last the least recently used
+ * A statement is removed from the cache while it's used, so it can't be used twice at the same time
+ * nb_hits is the number of statements reused from the cache, nb_prepared the number of statements prepared
+ */
+struct _h_json_cache {
+  pthread_mutex_t              lock;
+  unsigned int                 size;
+  unsigned int                 count;
+  unsigned long                nb_hits;
+  unsigned long                nb_prepared;
+  struct _h_json_cache_entry * first;
+  struct _h_json_cache_entry * last;
+};
+
+/**
+ * Hash of a sql query used as the json statement cache key
+ */
+static unsigned long h_json_cache_hash(const char * query) {
+  unsigned long hash = 5381;
+  
+  while (*query) {
+    hash = ((hash << 5) + hash) + (unsigned char)(*query++);
+  }
+  return hash;
+}
+
+/**
+ * Remove an entry from the json statement cache, the cache must be locked
+ */
+static void h_json_cache_remove(struct _h_json_cache * cache, struct _h_json_cache_entry * entry) {
+  if (entry->prev != NULL) {
+    entry->prev->next = entry->next;
+  } else {
+    cache->first = entry->next;
+  }
+  if (entry->next != NULL) {
+    entry->next->prev = entry->prev;
+  } else {
+    cache->last = entry->prev;
+  }
+  entry->prev = entry->next = NULL;
+  cache->count--;
+}
+
+/**
+ * Finalize the statement of the entry and free the entry
+ */
+static void h_json_cache_entry_free(struct _h_json_cache_entry * entry) {
+  if (entry != NULL) {
+    h_finalize(&entry->stmt);
+    h_free(entry->query);
+    h_free(entry);
+  }
+}
+
+/**
+ * Remove the least recently used entries until the cache has size entries at most, the cache must be locked
+ * return the list of the entries removed, linked by next
+ * The entries must be freed once the cache is unlocked, because h_finalize may lock the connection
+ */
+static struct _h_json_cache_entry * h_json_cache_shrink(struct _h_json_cache * cache, unsigned int size) {
+  struct _h_json_cache_entry * removed = NULL, * entry;
+  
+  while (cache->count > size) {
+    entry = cache->last;
+    h_json_cache_remove(cache, entry);
+    entry->next = removed;
+    removed = entry;
+  }
+  return removed;
+}
+
+/**
+ * Free a list of entries removed from the cache
+ */
+static void h_json_cache_free_list(struct _h_json_cache_entry * entry) {
+  struct _h_json_cache_entry * next;
+  
+  while (entry != NULL) {
+    next = entry->next;
+    h_json_cache_entry_free(entry);
+    entry = next;
+  }
+}
+
+/**
+ * Initialize the json statement cache of a connection
+ * If the cache can't be allocated, the json queries are executed with the values inlined
+ */
+void h_json_cache_init(struct _h_connection * conn) {
+  if ((conn->json_cache = o_malloc(sizeof(struct _h_json_cache))) != NULL) {
+    if (!pthread_mutex_init(&conn->json_cache->lock, NULL)) {
+      conn->json_cache->size = H_JSON_CACHE_SIZE;
+      conn->json_cache->count = 0;
+      conn->json_cache->nb_hits = 0;
+      conn->json_cache->nb_prepared = 0;
+      conn->json_cache->first = NULL;
+      conn->json_cache->last = NULL;
     } else {
-      tmp = msprintf("%s,%s", to_return, insert_data);
-      if (tmp == NULL) {
-        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_get_insert_query_from_json_array - Error allocating tmp");
-        h_free(insert_data);
-        return NULL;
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_json_cache_init - Error initializing lock");
+      h_free(conn->json_cache);
+      conn->json_cache = NULL;
+    }
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_json_cache_init - Error allocating memory for json_cache");
+  }
+}
+
+/**
+ * Set the maximum number of statements kept in the json statement cache of a connection
+ * 0 disables the cache
+ * return H_OK on success
+ */
+int h_json_cache_set_size(const struct _h_connection * conn, unsigned int size) {
+  struct _h_json_cache_entry * removed;
+  
+  if (conn->json_cache == NULL) {
+    return H_OK;
+  }
+  if (pthread_mutex_lock(&conn->json_cache->lock)) {
+    return H_ERROR;
+  }
+  conn->json_cache->size = size;
+  removed = h_json_cache_shrink(conn->json_cache, size);
+  pthread_mutex_unlock(&conn->json_cache->lock);
+  h_json_cache_free_list(removed);
+  return H_OK;
+}
+
+/**
+ * Get the number of statements reused from the json statement cache of a connection
+ * and the number of statements prepared
+ * return H_OK on success
+ */
+int h_json_cache_get_stats(const struct _h_connection * conn, unsigned long * nb_hits, unsigned long * nb_prepared) {
+  *nb_hits = *nb_prepared = 0;
+  if (conn->json_cache == NULL) {
+    return H_OK;
+  }
+  if (pthread_mutex_lock(&conn->json_cache->lock)) {
+    return H_ERROR;
+  }
+  *nb_hits = conn->json_cache->nb_hits;
+  *nb_prepared = conn->json_cache->nb_prepared;
+  pthread_mutex_unlock(&conn->json_cache->lock);
+  return H_OK;
+}
+
+/**
+ * Finalize the statements of the json statement cache of a connection and free the cache
+ * Must be called before the connection is closed
+ */
+void h_json_cache_clean(struct _h_connection * conn) {
+  if (conn->json_cache != NULL) {
+    h_json_cache_set_size(conn, 0);
+    pthread_mutex_destroy(&conn->json_cache->lock);
+    h_free(conn->json_cache);
+    conn->json_cache = NULL;
+  }
+}
+
+/**
+ * Return the id of the server session of the connection, the prepared statements are lost when it changes
+ * sqlite connections have no server session, so their id is always 0
+ */
+static unsigned long h_json_cache_session(const struct _h_connection * conn) {
+  if (0) {
+    /* Not happening */
+#ifdef _HOEL_MARIADB
+  } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+    return h_session_id_mariadb(conn);
+#endif
+#ifdef _HOEL_PGSQL
+  } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+    return h_session_id_pgsql(conn);
+#endif
+  } else {
+    UNUSED(conn);
+    return 0;
+  }
+}
+
+/**
+ * Get the prepared statement of the query from the json statement cache, or prepare it if it isn't cached
+ * A cached statement prepared in another server session is dropped and prepared again
+ * reused is set to 1 if the statement comes from the cache
+ * The entry must be given back with h_json_cache_release after use
+ * return H_OK on success, H_ERROR_QUERY if the query is invalid,
+ * H_AGAIN if the cache is disabled or if the statement can't be prepared for another reason
+ */
+static int h_json_cache_acquire(const struct _h_connection * conn, const char * query, unsigned long session, struct _h_json_cache_entry ** entry, int * reused) {
+  struct _h_json_cache * cache = conn->json_cache;
+  struct _h_json_cache_entry * cur = NULL;
+  unsigned long hash = h_json_cache_hash(query);
+  int ret;
+  
+  *entry = NULL;
+  *reused = 0;
+  if (pthread_mutex_lock(&cache->lock)) {
+    return H_AGAIN;
+  }
+  if (!cache->size) {
+    pthread_mutex_unlock(&cache->lock);
+    return H_AGAIN;
+  }
+  for (cur = cache->first; cur != NULL; cur = cur->next) {
+    if (cur->hash == hash && 0 == o_strcmp(cur->query, query)) {
+      h_json_cache_remove(cache, cur);
+      break;
+    }
+  }
+  if (cur != NULL && cur->session == session) {
+    cache->nb_hits++;
+    pthread_mutex_unlock(&cache->lock);
+    *entry = cur;
+    *reused = 1;
+    return H_OK;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  h_json_cache_entry_free(cur);
+  if ((cur = o_malloc(sizeof(struct _h_json_cache_entry))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_json_cache_acquire - Error allocating memory for entry");
+    return H_AGAIN;
+  }
+  if ((cur->query = o_strdup(query)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_json_cache_acquire - Error allocating memory for entry->query");
+    h_free(cur);
+    return H_AGAIN;
+  }
+  if ((ret = h_prepare(conn, query, &cur->stmt)) != H_OK) {
+    h_free(cur->query);
+    h_free(cur);
+    return ret==H_ERROR_QUERY?H_ERROR_QUERY:H_AGAIN;
+  }
+  if (!pthread_mutex_lock(&cache->lock)) {
+    cache->nb_prepared++;
+    pthread_mutex_unlock(&cache->lock);
+  }
+  cur->hash = hash;
+  cur->session = session;
+  cur->prev = cur->next = NULL;
+  *entry = cur;
+  return H_OK;
+}
+
+/**
+ * Put the entry in the json statement cache as the most recently used statement
+ * The entry is freed if keep is 0, if the cache is disabled or if the same query is already cached
+ */
+static void h_json_cache_release(const struct _h_connection * conn, struct _h_json_cache_entry * entry, int keep) {
+  struct _h_json_cache * cache = conn->json_cache;
+  struct _h_json_cache_entry * cur, * removed = NULL;
+  
+  if (keep && !pthread_mutex_lock(&cache->lock)) {
+    for (cur = cache->first; cur != NULL; cur = cur->next) {
+      if (cur->hash == entry->hash && 0 == o_strcmp(cur->query, entry->query)) {
+        break;
       }
-      h_free(to_return);
-      to_return = tmp;
     }
-    h_free(insert_data);
+    if (cache->size && cur == NULL) {
+      entry->next = cache->first;
+      if (cache->first != NULL) {
+        cache->first->prev = entry;
+      } else {
+        cache->last = entry;
+      }
+      cache->first = entry;
+      cache->count++;
+      removed = h_json_cache_shrink(cache, cache->size);
+      entry = NULL;
+    }
+    pthread_mutex_unlock(&cache->lock);
   }
-  return to_return;
+  h_json_cache_entry_free(entry);
+  h_json_cache_free_list(removed);
 }
 
 /**
- * Generates a where clause based on a json object
+ * Bind the values of j_params to the parameters of the statement
+ * return H_OK on success
+ */
+static int h_json_cache_bind(struct _h_statement * stmt, json_t * j_params) {
+  json_t * j_param = NULL;
+  size_t index = 0;
+  int ret = H_OK;
+  
+  json_array_foreach(j_params, index, j_param) {
+    switch (json_typeof(j_param)) {
+      case JSON_STRING:
+        ret = h_bind_text(stmt, (unsigned int)index+1, json_string_value(j_param));
+        break;
+      case JSON_INTEGER:
+        ret = h_bind_int(stmt, (unsigned int)index+1, json_integer_value(j_param));
+        break;
+      case JSON_REAL:
+        ret = h_bind_double(stmt, (unsigned int)index+1, json_real_value(j_param));
+        break;
+      case JSON_TRUE:
+        ret = h_bind_int(stmt, (unsigned int)index+1, 1);
+        break;
+      case JSON_FALSE:
+        ret = h_bind_int(stmt, (unsigned int)index+1, 0);
+        break;
+      default:
+        ret = h_bind_null(stmt, (unsigned int)index+1);
+        break;
+    }
+    if (ret != H_OK) {
+      break;
+    }
+  }
+  return ret;
+}
+
+/**
+ * Bind the values of j_params to the statement of the entry and execute it
+ * if j_result isn't NULL, it's set with the rows returned by the query
+ * return H_OK on success, H_AGAIN if the values can't be bound, the error of the query otherwise
+ */
+static int h_json_cache_run(struct _h_json_cache_entry * entry, json_t * j_params, json_t ** j_result) {
+  if (entry->stmt.nb_params != json_array_size(j_params) || h_json_cache_bind(&entry->stmt, j_params) != H_OK) {
+    return H_AGAIN;
+  } else if (j_result != NULL) {
+    return h_execute_prepared_json(&entry->stmt, j_result);
+  } else {
+    return h_execute_prepared(&entry->stmt, NULL);
+  }
+}
+
+/**
+ * Execute a query written with placeholders with the prepared statement from the json statement cache
+ * j_params are the values of the placeholders
+ * if j_result isn't NULL, it's set with the rows returned by the query
+ * A cached statement may be invalid after a schema change, e.g. PostgreSQL fails with
+ * "cached plan must not change result type" after an ALTER TABLE, so if a cached statement fails
+ * outside a transaction, it's dropped, prepared again and executed once more
+ * The query is executed with the values inlined only if the statement can't be used:
+ * the cache is disabled or the values can't be bound
+ * return H_OK on success, H_AGAIN if the query must be executed with the values inlined,
+ * the error of the query otherwise
+ */
+static int h_json_cache_execute(const struct _h_connection * conn, const char * query, json_t * j_params, json_t ** j_result) {
+  struct _h_json_cache_entry * entry;
+  int ret, reused;
+  
+  if ((ret = h_json_cache_acquire(conn, query, h_json_cache_session(conn), &entry, &reused)) != H_OK) {
+    return ret;
+  }
+  ret = h_json_cache_run(entry, j_params, j_result);
+  if (ret != H_OK && ret != H_AGAIN && reused && !h_in_transaction(conn)) {
+    h_json_cache_release(conn, entry, 0);
+    if ((ret = h_json_cache_acquire(conn, query, h_json_cache_session(conn), &entry, &reused)) != H_OK) {
+      return ret;
+    }
+    ret = h_json_cache_run(entry, j_params, j_result);
+  }
+  h_json_cache_release(conn, entry, ret == H_OK);
+  return ret;
+}
+
+/**
+ * Append a value to the buffer
+ * If j_params isn't NULL, the value is written as a placeholder and appended to j_params,
+ * otherwise the value is inlined, escaped if it's a string
+ */
+static void h_sql_buffer_append_value(const struct _h_connection * conn, struct _h_sql_buffer * buffer, json_t * value, json_t * j_params) {
+  if (j_params != NULL) {
+    h_sql_buffer_append_len(buffer, "?", 1);
+    if (json_array_append(j_params, value)) {
+      buffer->error = 1;
+    }
+  } else if (json_is_string(value)) {
+    h_sql_buffer_append_escaped(conn, buffer, json_string_value(value));
+  } else if (json_is_real(value)) {
+    h_sql_buffer_appendf(buffer, "%f", json_real_value(value));
+  } else {
+    h_sql_buffer_appendf(buffer, "%" JSON_INTEGER_FORMAT, json_integer_value(value));
+  }
+}
+
+/**
+ * Append a where clause based on a json object to the buffer
  * the where object is a simple object like
  * {
  *   col1: "value1",
@@ -202,385 +949,329 @@ static char * h_get_insert_query_from_json_array(const struct _h_connection * co
  * }
  * the output is a WHERE query will use only '=' and 'AND' keywords
  * col1='value1' AND col2='value2'
- * return a char * containing the WHERE clause, NULL on error
- * the returned value must be h_free'd after use
+ * If j_params isn't NULL, the values are written as placeholders and appended to j_params,
+ * the raw values may contain placeholders, so H_AGAIN is returned if there's one
+ * return H_OK on success
  */
-static char * h_get_where_clause_from_json_object(const struct _h_connection * conn, const json_t * where) {
+static int h_sql_buffer_append_where_clause(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const json_t * where, json_t * j_params) {
   const char * key = NULL;
   json_t * value = NULL, * ope, * val, * j_element;
-  char * where_clause = NULL, * dump = NULL, * escape = NULL, * tmp, * clause = NULL, * dump2 = NULL;
+  char * dump = NULL, * dump2 = NULL;
   int i = 0;
   size_t index = 0;
 
   if (conn == NULL) {
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_where_clause_from_json_object - Error conn is NULL");
-    return NULL;
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_sql_buffer_append_where_clause - Error conn is NULL");
+    return H_ERROR_PARAMS;
   } else if (where == NULL || (json_is_object(where) && json_object_size(where) == 0)) {
-    return o_strdup("1=1");
+    h_sql_buffer_append(buffer, "1=1");
+  } else if (!json_is_object(where)) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_sql_buffer_append_where_clause - Error where must be a json object");
+    return H_ERROR_PARAMS;
   } else {
     json_object_foreach((json_t *)where, key, value) {
       if (!json_is_string(value) && !json_is_real(value) && !json_is_integer(value) && !json_is_object(value) && !json_is_null(value) && !json_is_boolean(value)) {
         dump = json_dumps(value, JSON_ENCODE_ANY);
-        y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_where_clause_from_json_object - Error where value is invalid: %s", dump);
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_sql_buffer_append_where_clause - Error where value is invalid: %s", dump);
         h_free(dump);
-        return NULL;
-      } else {
-        if (json_is_object(value)) {
-          ope = json_object_get(value, "operator");
-          val = json_object_get(value, "value");
-          if (ope == NULL ||
-              !json_is_string(ope) ||
-              (val == NULL && 0 != o_strcasecmp("NOT NULL", json_string_value(ope))) ||
-              (!json_is_string(val) && !json_is_real(val) && !json_is_integer(val) && 0 != o_strcasecmp("NOT NULL", json_string_value(ope)) && 0 != o_strcasecmp("IN", json_string_value(ope)))) {
-            dump = json_dumps(val, JSON_ENCODE_ANY);
-            dump2 = json_dumps(ope, JSON_ENCODE_ANY);
-            y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_where_clause_from_json_object - Error where object value is invalid: %s %s", dump, dump2);
-            h_free(dump);
-            h_free(dump2);
-            h_free(where_clause);
-            return NULL;
-          } else {
-            if (0 == o_strcasecmp("NOT NULL", json_string_value(ope))) {
-              clause = msprintf("%s IS NOT NULL", key);
-            } else if (0 == o_strcasecmp("raw", json_string_value(ope)) && json_is_string(val)) {
-              clause = msprintf("%s %s", key, json_string_value(val));
-            } else if (0 == o_strcasecmp("IN", json_string_value(ope))) {
-              if (json_is_array(val) && json_array_size(val) > 0) {
-                clause = NULL, tmp = NULL;
-                json_array_foreach(val, index, j_element) {
-                  if (!json_is_string(j_element) && !json_is_real(j_element) && !json_is_integer(j_element)) {
-                    h_free(clause);
-                    h_free(where_clause);
-                    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error element value in IN statement array must be real, integer or string");
-                    return NULL;
-                  } else {
-                    if (json_is_string(j_element)) {
-                      escape = h_escape_string_with_quotes(conn, json_string_value(j_element));
-                      if (escape == NULL) {
-                        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error escape");
-                        h_free(clause);
-                        h_free(where_clause);
-                        return NULL;
-                      }
-                      dump = msprintf("%s", escape);
-                      h_free(escape);
-                    } else if (json_is_real(j_element)) {
-                      dump = msprintf("%f", json_real_value(j_element));
-                    } else {
-                      dump = msprintf("%" JSON_INTEGER_FORMAT, json_integer_value(j_element));
-                    }
-                    if (clause == NULL) {
-                      clause = msprintf("%s IN (%s", key, dump);
-                    } else {
-                      tmp = msprintf("%s,%s", clause, dump);
-                      h_free(clause);
-                      clause = tmp;
-                    }
-                    h_free(dump);
-                  }
-                }
-                tmp = msprintf("%s)", clause);
-                h_free(clause);
-                clause = tmp;
-              } else {
-                h_free(where_clause);
-                y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error value in IN statement must be a non empty JSON array");
-                return NULL;
-              }
-            } else {
-              if (json_is_real(val)) {
-                clause = msprintf("%s %s %f", key, json_string_value(ope), json_real_value(val));
-              } else if (json_is_integer(val)) {
-                clause = msprintf("%s %s %" JSON_INTEGER_FORMAT, key, json_string_value(ope), json_integer_value(val));
-              } else {
-                escape = h_escape_string_with_quotes(conn, json_string_value(val));
-                if (escape == NULL) {
-                  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error escape");
-                  h_free(where_clause);
-                  return NULL;
-                }
-                clause = msprintf("%s %s %s", key, json_string_value(ope), escape);
-                h_free(escape);
-              }
-            }
-            if (clause == NULL) {
-              y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for clause");
-              h_free(where_clause);
-              return NULL;
-            }
-          }
-        } else {
-          if (json_is_null(value)) {
-            clause = msprintf("%s IS NULL", key);
-          } else if (json_is_string(value)) {
-            escape = h_escape_string_with_quotes(conn, json_string_value(value));
-            if (escape == NULL) {
-              y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error escape");
-              h_free(where_clause);
-              return NULL;
-            }
-            clause = msprintf("%s=%s", key, escape);
-            h_free(escape);
-          } else if (json_is_integer(value)) {
-            clause = msprintf("%s='%"JSON_INTEGER_FORMAT"'", key, json_integer_value(value));
-          } else if (json_is_real(value)) {
-            clause = msprintf("%s='%f'", key, json_real_value(value));
-          } else if (json_is_true(value)) {
-            clause = msprintf("%s=1", key);
-          } else if (json_is_false(value)) {
-            clause = msprintf("%s=0", key);
+        return H_ERROR_PARAMS;
+      }
+      if (i) {
+        h_sql_buffer_append(buffer, " AND ");
+      }
+      i = 1;
+      if (json_is_object(value)) {
+        ope = json_object_get(value, "operator");
+        val = json_object_get(value, "value");
+        if (ope == NULL ||
+            !json_is_string(ope) ||
+            (val == NULL && 0 != o_strcasecmp("NOT NULL", json_string_value(ope))) ||
+            (!json_is_string(val) && !json_is_real(val) && !json_is_integer(val) && 0 != o_strcasecmp("NOT NULL", json_string_value(ope)) && 0 != o_strcasecmp("IN", json_string_value(ope)))) {
+          dump = json_dumps(val, JSON_ENCODE_ANY);
+          dump2 = json_dumps(ope, JSON_ENCODE_ANY);
+          y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_sql_buffer_append_where_clause - Error where object value is invalid: %s %s", dump, dump2);
+          h_free(dump);
+          h_free(dump2);
+          return H_ERROR_PARAMS;
+        } else if (0 == o_strcasecmp("NOT NULL", json_string_value(ope))) {
+          h_sql_buffer_appendf(buffer, "%s IS NOT NULL", key);
+        } else if (0 == o_strcasecmp("raw", json_string_value(ope)) && json_is_string(val)) {
+          if (j_params != NULL) {
+            return H_AGAIN;
           }
-          if (clause == NULL) {
-            y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for clause");
-            h_free(where_clause);
-            return NULL;
+          h_sql_buffer_appendf(buffer, "%s %s", key, json_string_value(val));
+        } else if (0 == o_strcasecmp("IN", json_string_value(ope))) {
+          if (!json_is_array(val) || !json_array_size(val)) {
+            y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error value in IN statement must be a non empty JSON array");
+            return H_ERROR_PARAMS;
           }
-        }
-        if (i == 0) {
-          where_clause = o_strdup(clause);
-          if (where_clause == NULL) {
-            y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_where_clause_from_json_object - Error where_clause");
-            h_free(clause);
-            h_free(where_clause);
-            return NULL;
+          h_sql_buffer_appendf(buffer, "%s IN (", key);
+          json_array_foreach(val, index, j_element) {
+            if (!json_is_string(j_element) && !json_is_real(j_element) && !json_is_integer(j_element)) {
+              y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error element value in IN statement array must be real, integer or string");
+              return H_ERROR_PARAMS;
+            }
+            if (index) {
+              h_sql_buffer_append_len(buffer, ",", 1);
+            }
+            h_sql_buffer_append_value(conn, buffer, j_element, j_params);
           }
-          h_free(clause);
-          i = 1;
+          h_sql_buffer_append_len(buffer, ")", 1);
         } else {
-          tmp = msprintf("%s AND %s", where_clause, clause);
-          h_free(where_clause);
-          if (tmp == NULL) {
-            y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_where_clause_from_json_object - Error tmp where_clause");
-            h_free(clause);
-            h_free(where_clause);
-            return NULL;
-          }
-          h_free(clause);
-          where_clause = tmp;
+          h_sql_buffer_appendf(buffer, "%s %s ", key, json_string_value(ope));
+          h_sql_buffer_append_value(conn, buffer, val, j_params);
         }
+      } else if (json_is_null(value)) {
+        h_sql_buffer_appendf(buffer, "%s IS NULL", key);
+      } else if (json_is_true(value)) {
+        h_sql_buffer_appendf(buffer, "%s=1", key);
+      } else if (json_is_false(value)) {
+        h_sql_buffer_appendf(buffer, "%s=0", key);
+      } else if (j_params != NULL || json_is_string(value)) {
+        h_sql_buffer_appendf(buffer, "%s=", key);
+        h_sql_buffer_append_value(conn, buffer, value, j_params);
+      } else if (json_is_integer(value)) {
+        h_sql_buffer_appendf(buffer, "%s='%"JSON_INTEGER_FORMAT"'", key, json_integer_value(value));
+      } else {
+        h_sql_buffer_appendf(buffer, "%s='%f'", key, json_real_value(value));
       }
     }
-    return where_clause;
   }
+  if (buffer->error) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for clause");
+    return H_ERROR_MEMORY;
+  }
+  return H_OK;
 }
 
 /**
- * Generates a set clause based on a json object
- * the where object is a simple object like
+ * Append a set clause based on a json object to the buffer
+ * the set object is a simple object like
  * {
  *   col1: "value1",
  *   col2: "value2"
  * }
- * the output is a WHERE query will use only '=' and 'AND' keywords
+ * the output is
  * col1='value1', col2='value2'
- * return a char * containing the WHERE clause, NULL on error
- * the returned value must be h_free'd after use
+ * If j_params isn't NULL, the values are written as placeholders and appended to j_params,
+ * the raw values may contain placeholders, so H_AGAIN is returned if there's one
+ * return H_OK on success
  */
-static char * h_get_set_clause_from_json_object(const struct _h_connection * conn, const json_t * set) {
+static int h_sql_buffer_append_set_clause(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const json_t * set, json_t * j_params) {
   const char * key = NULL;
   json_t * value = NULL, * raw;
-  char * where_clause = NULL, * escape = NULL, * tmp;
-  int i = 0;
-
-  if (conn == NULL || set == NULL || !json_is_object(set)) {
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_set_clause_from_json_object - Error null input parameters");
-    return NULL;
-  } else {
-    json_object_foreach((json_t *)set, key, value) {
-      if (!json_is_string(value) && !json_is_real(value) && !json_is_integer(value) && !json_is_null(value) && !json_is_object(value)) {
-        tmp = json_dumps(value, JSON_ENCODE_ANY);
-        y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_set_clause_from_json_object - Error value invalid: %s", tmp);
-        h_free(tmp);
-        h_free(where_clause);
-        return NULL;
-      } else {
-        if (json_is_string(value)) {
-          tmp = h_escape_string_with_quotes(conn, json_string_value(value));
-          escape = msprintf("%s", tmp);
-          h_free(tmp);
-        } else if (json_is_real(value)) {
-          escape = msprintf("%f", json_real_value(value));
-        } else if (json_is_integer(value)) {
-          escape = msprintf("%" JSON_INTEGER_FORMAT, json_integer_value(value));
-        } else if (json_is_object(value)) {
-          raw = json_object_get(value, "raw");
-          if (raw != NULL && json_is_string(raw)) {
-            escape = o_strdup(json_string_value(raw));
-          } else {
-            escape = o_strdup("NULL");
-          }
-        } else {
-          escape = o_strdup("");
-        }
-        if (escape == NULL) {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error escape");
-          return NULL;
-        }
-        if (i == 0) {
-          if (!json_is_null(value)) {
-            where_clause = msprintf("%s=%s", key, escape);
-          } else {
-            where_clause = msprintf("%s=NULL", key);
-          }
-          if (where_clause == NULL) {
-            y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_set_clause_from_json_object - Error where_clause");
-            return NULL;
-          }
-          i = 1;
-        } else {
-          if (!json_is_null(value)) {
-            tmp = msprintf("%s, %s=%s", where_clause, key, escape);
-          } else {
-            tmp = msprintf("%s, %s=NULL", where_clause, key);
-          }
-          h_free(where_clause);
-          if (tmp == NULL) {
-            y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_get_set_clause_from_json_object - Error tmp where_clause");
-            return NULL;
-          }
-          where_clause = tmp;
+  char * tmp;
+  int i = 0;
+
+  if (conn == NULL || set == NULL || !json_is_object(set) || !json_object_size(set)) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_sql_buffer_append_set_clause - Error null input parameters");
+    return H_ERROR_PARAMS;
+  }
+  json_object_foreach((json_t *)set, key, value) {
+    if (!json_is_string(value) && !json_is_real(value) && !json_is_integer(value) && !json_is_null(value) && !json_is_object(value)) {
+      tmp = json_dumps(value, JSON_ENCODE_ANY);
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_sql_buffer_append_set_clause - Error value invalid: %s", tmp);
+      h_free(tmp);
+      return H_ERROR_PARAMS;
+    }
+    h_sql_buffer_appendf(buffer, i?", %s=":"%s=", key);
+    i = 1;
+    if (json_is_object(value)) {
+      raw = json_object_get(value, "raw");
+      if (raw != NULL && json_is_string(raw)) {
+        if (j_params != NULL) {
+          return H_AGAIN;
         }
-        h_free(escape);
+        h_sql_buffer_append(buffer, json_string_value(raw));
+      } else {
+        h_sql_buffer_append(buffer, "NULL");
       }
+    } else if (json_is_null(value)) {
+      h_sql_buffer_append(buffer, "NULL");
+    } else {
+      h_sql_buffer_append_value(conn, buffer, value, j_params);
     }
-    return where_clause;
   }
+  if (buffer->error) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_sql_buffer_append_set_clause - Error where_clause");
+    return H_ERROR_MEMORY;
+  }
+  return H_OK;
 }
 
 /**
- * h_select
- * Execute a select query
- * Uses a json_t * parameter for the query parameters
- * Store the result of the query in j_result if specified. j_result must be decref'd after use
- * Duplicate the generated query in generated_query if specified, must be h_free'd after use
+ * Build the select query of j_query in the buffer
+ * If j_params isn't NULL, the values are written as placeholders and appended to j_params
  * return H_OK on success
  */
-int h_select(const struct _h_connection * conn, const json_t * j_query, json_t ** j_result, char ** generated_query) {
-  const char * table;
-  const json_t * cols, * where, * order_by, * group_by;
+static int h_sql_buffer_append_select(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const json_t * j_query, json_t * j_params) {
+  const json_t * cols = json_object_get(j_query, "columns"), * order_by = json_object_get(j_query, "order_by"), * group_by = json_object_get(j_query, "group_by");
   json_int_t limit, offset;
-  char * query = NULL, * columns = NULL, * where_clause = NULL, * tmp = NULL, * str_where_limit = NULL, * str_order_by = NULL, * str_group_by = NULL;
-  const char * col;
   size_t index = 0;
   json_t * value;
-  int res;
-
-  if (conn == NULL || j_result == NULL || j_query == NULL || !json_is_object(j_query) || json_object_get(j_query, "table") == NULL || !json_is_string(json_object_get(j_query, "table")) || o_strnullempty(json_string_value(json_object_get(j_query, "table")))) {
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error invalid input parameters");
-    return H_ERROR_PARAMS;
-  }
+  int ret;
 
-  table = json_string_value((const json_t *)json_object_get(j_query, "table"));
-  cols = json_object_get(j_query, "columns");
-  where = json_object_get(j_query, "where");
-  order_by = json_object_get(j_query, "order_by");
-  group_by = json_object_get(j_query, "group_by");
   limit = json_is_integer(json_object_get(j_query, "limit"))?json_integer_value(json_object_get(j_query, "limit")):0;
   offset = json_is_integer(json_object_get(j_query, "offset"))?json_integer_value(json_object_get(j_query, "offset")):0;
 
-  where_clause = h_get_where_clause_from_json_object(conn, (json_t *)where);
-  if (where_clause == NULL) {
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error where_clause construction");
+  if (cols != NULL && !json_is_array(cols)) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error cols not array");
     return H_ERROR_PARAMS;
   }
+  json_array_foreach(cols, index, value) {
+    if (!json_is_string(value)) {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error column not string");
+      return H_ERROR_PARAMS;
+    }
+  }
+  if (cols != NULL && !json_array_size(cols)) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for columns");
+    return H_ERROR_MEMORY;
+  }
 
+  h_sql_buffer_append(buffer, "SELECT ");
   if (cols == NULL) {
-    columns = o_strdup("*");
-  } else if (json_is_array(cols)) {
+    h_sql_buffer_append_len(buffer, "*", 1);
+  } else {
     json_array_foreach(cols, index, value) {
-      if (json_is_string(value)) {
-        col = json_string_value(value);
-        if (col == NULL) {
-          y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error col");
-          h_free(where_clause);
-          h_free(columns);
-          return H_ERROR_MEMORY;
-        }
-      } else {
-        y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error column not string");
-        h_free(where_clause);
-        return H_ERROR_PARAMS;
-      }
-      if (index == 0) {
-        columns = o_strdup(col);
-        if (columns == NULL) {
-          y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error allocating columns");
-          h_free(where_clause);
-          return H_ERROR_MEMORY;
-        }
-      } else {
-        tmp = msprintf("%s, %s", columns, col);
-        if (tmp == NULL) {
-          y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error allocating clause");
-          h_free(where_clause);
-          h_free(columns);
-          return H_ERROR_MEMORY;
-        }
-        h_free(columns);
-        columns = tmp;
+      if (index) {
+        h_sql_buffer_append(buffer, ", ");
       }
+      h_sql_buffer_append(buffer, json_string_value(value));
     }
-  } else {
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error cols not array");
-    h_free(where_clause);
-    return H_ERROR_PARAMS;
   }
-
-  if (columns == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for columns");
-    h_free(where_clause);
-    return H_ERROR_MEMORY;
+  h_sql_buffer_appendf(buffer, " FROM %s WHERE ", json_string_value(json_object_get(j_query, "table")));
+  if ((ret = h_sql_buffer_append_where_clause(conn, buffer, json_object_get(j_query, "where"), j_params)) != H_OK) {
+    if (ret != H_AGAIN) {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error where_clause construction");
+    }
+    return ret==H_AGAIN?H_AGAIN:H_ERROR_PARAMS;
+  }
+  if (group_by != NULL && json_is_string(group_by) && !o_strnullempty(json_string_value(group_by))) {
+    h_sql_buffer_appendf(buffer, " GROUP BY %s", json_string_value(group_by));
+  }
+  if (order_by != NULL && json_is_string(order_by) && !o_strnullempty(json_string_value(order_by))) {
+    h_sql_buffer_appendf(buffer, " ORDER BY %s", json_string_value(order_by));
   }
-
   if (limit > 0) {
+    h_sql_buffer_append(buffer, " LIMIT ");
+    h_sql_buffer_append_value(conn, buffer, json_object_get(j_query, "limit"), j_params);
     if (offset > 0) {
-      str_where_limit = msprintf(" LIMIT %" JSON_INTEGER_FORMAT " OFFSET %" JSON_INTEGER_FORMAT, limit, offset);
-    } else {
-      str_where_limit = msprintf(" LIMIT %" JSON_INTEGER_FORMAT, limit);
+      h_sql_buffer_append(buffer, " OFFSET ");
+      h_sql_buffer_append_value(conn, buffer, json_object_get(j_query, "offset"), j_params);
     }
-  } else {
-    str_where_limit = o_strdup("");
-  }
-  if (str_where_limit == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for str_where_limit");
-    h_free(columns);
-    h_free(where_clause);
-    return H_ERROR_MEMORY;
   }
+  return buffer->error?H_ERROR_MEMORY:H_OK;
+}
 
-  if (order_by != NULL && json_is_string(order_by) && !o_strnullempty(json_string_value(order_by))) {
-    str_order_by = msprintf(" ORDER BY %s", json_string_value(order_by));
-  } else {
-    str_order_by = o_strdup("");
+/**
+ * Build the update query of j_query in the buffer
+ * If j_params isn't NULL, the values are written as placeholders and appended to j_params
+ * return H_OK on success
+ */
+static int h_sql_buffer_append_update(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const json_t * j_query, json_t * j_params) {
+  json_t * where = json_object_get(j_query, "where");
+  int ret;
+
+  h_sql_buffer_appendf(buffer, "UPDATE %s SET ", json_string_value(json_object_get(j_query, "table")));
+  if ((ret = h_sql_buffer_append_set_clause(conn, buffer, json_object_get(j_query, "set"), j_params)) != H_OK) {
+    if (ret != H_AGAIN) {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_update - Error generating set clause");
+    }
+    return ret==H_AGAIN?H_AGAIN:H_ERROR_PARAMS;
   }
-  if (str_order_by == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for str_order_by");
-    h_free(columns);
-    h_free(where_clause);
-    h_free(str_where_limit);
-    return H_ERROR_MEMORY;
+  if (json_is_object(where) && json_object_size(where) > 0) {
+    h_sql_buffer_append(buffer, " WHERE ");
+    if ((ret = h_sql_buffer_append_where_clause(conn, buffer, where, j_params)) != H_OK) {
+      if (ret != H_AGAIN) {
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_update - Error generating where clause");
+      }
+      return ret==H_AGAIN?H_AGAIN:H_ERROR_PARAMS;
+    }
   }
+  return buffer->error?H_ERROR_MEMORY:H_OK;
+}
 
-  if (group_by != NULL && json_is_string(group_by) && !o_strnullempty(json_string_value(group_by))) {
-    str_group_by = msprintf(" GROUP BY %s", json_string_value(group_by));
+/**
+ * Build the delete query of j_query in the buffer
+ * If j_params isn't NULL, the values are written as placeholders and appended to j_params
+ * return H_OK on success
+ */
+static int h_sql_buffer_append_delete(const struct _h_connection * conn, struct _h_sql_buffer * buffer, const json_t * j_query, json_t * j_params) {
+  json_t * where = json_object_get(j_query, "where");
+  int ret;
+
+  h_sql_buffer_appendf(buffer, "DELETE FROM %s", json_string_value(json_object_get(j_query, "table")));
+  if (json_is_object(where) && json_object_size(where) > 0) {
+    h_sql_buffer_append(buffer, " WHERE ");
+    if ((ret = h_sql_buffer_append_where_clause(conn, buffer, where, j_params)) != H_OK) {
+      if (ret != H_AGAIN) {
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_delete - Error invalid input parameters");
+      }
+      return ret==H_AGAIN?H_AGAIN:H_ERROR_PARAMS;
+    }
+  }
+  return buffer->error?H_ERROR_MEMORY:H_OK;
+}
+
+/**
+ * Build a query with j_build, written with placeholders, and execute it with the json statement cache
+ * if j_result isn't NULL, it's set with the rows returned by the query
+ * The cache isn't used while the connection is busy, so the query is queued in a running pipeline
+ * return H_OK on success, H_AGAIN if the query must be executed with the values inlined,
+ * the error of the query otherwise
+ */
+static int h_json_cache_query(const struct _h_connection * conn, const json_t * j_query, json_t ** j_result,
+                              int (* j_build)(const struct _h_connection *, struct _h_sql_buffer *, const json_t *, json_t *)) {
+  struct _h_sql_buffer buffer;
+  json_t * j_params;
+  char * query;
+  int ret = H_AGAIN;
+
+  if (conn->json_cache == NULL || h_connection_busy(conn) || (j_params = json_array()) == NULL) {
+    return H_AGAIN;
+  }
+  h_sql_buffer_init(&buffer);
+  if (j_build(conn, &buffer, j_query, j_params) == H_OK && json_array_size(j_params) <= H_JSON_CACHE_MAX_PARAMS && (query = h_sql_buffer_release(&buffer)) != NULL) {
+    ret = h_json_cache_execute(conn, query, j_params, j_result);
+    h_free(query);
   } else {
-    str_group_by = o_strdup("");
+    h_sql_buffer_clean(&buffer);
   }
-  if (str_group_by == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for str_order_by");
-    h_free(columns);
-    h_free(where_clause);
-    h_free(str_where_limit);
-    h_free(str_order_by);
-    return H_ERROR_MEMORY;
+  json_decref(j_params);
+  return ret;
+}
+
+/**
+ * h_select
+ * Execute a select query
+ * Uses a json_t * parameter for the query parameters
+ * Store the result of the query in j_result if specified. j_result must be decref'd after use
+ * Duplicate the generated query in generated_query if specified, must be h_free'd after use
+ * return H_OK on success
+ */
+int h_select(const struct _h_connection * conn, const json_t * j_query, json_t ** j_result, char ** generated_query) {
+  struct _h_sql_buffer buffer;
+  char * query = NULL;
+  int res;
+
+  if (conn == NULL || j_result == NULL || j_query == NULL || !json_is_object(j_query) || json_object_get(j_query, "table") == NULL || !json_is_string(json_object_get(j_query, "table")) || o_strnullempty(json_string_value(json_object_get(j_query, "table")))) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error invalid input parameters");
+    return H_ERROR_PARAMS;
+  }
+
+  if (generated_query == NULL && !json_is_true(json_object_get(j_query, "compact"))) {
+    if ((res = h_json_cache_query(conn, j_query, j_result, h_sql_buffer_append_select)) != H_AGAIN) {
+      return res;
+    }
   }
 
-  query = msprintf("SELECT %s FROM %s WHERE %s%s%s%s", columns, table, where_clause, str_group_by, str_order_by, str_where_limit);
-  h_free(columns);
-  h_free(where_clause);
-  h_free(str_where_limit);
-  h_free(str_order_by);
-  h_free(str_group_by);
+  h_sql_buffer_init(&buffer);
+  if ((res = h_sql_buffer_append_select(conn, &buffer, j_query, NULL)) != H_OK) {
+    h_sql_buffer_clean(&buffer);
+    return res;
+  }
+  query = h_sql_buffer_release(&buffer);
   if (query == NULL) {
     y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_select Error allocating query");
     return H_ERROR_MEMORY;
@@ -588,7 +1279,11 @@ int h_select(const struct _h_connection * conn, const json_t * j_query, json_t *
     if (generated_query != NULL) {
       *generated_query = o_strdup(query);
     }
-    res = h_query_select_json(conn, query, j_result);
+    if (json_is_true(json_object_get(j_query, "compact"))) {
+      res = h_execute_query_json_compact(conn, query, j_result);
+    } else {
+      res = h_query_select_json(conn, query, j_result);
+    }
     h_free(query);
     return res;
   }
@@ -631,28 +1326,7 @@ int h_insert(const struct _h_connection * conn, const json_t * j_query, char **
         }
         break;
       case JSON_ARRAY:
-        if (json_array_size(values)) {
-          query = h_get_insert_query_from_json_array(conn, values, table);
-          if (query != NULL) {
-            if (generated_query != NULL) {
-              /* Export just the first query */
-              *generated_query = o_strdup(query);
-            }
-            res = h_query_insert(conn, query);
-            h_free(query);
-            if (res != H_OK) {
-              y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error executing query (2)");
-              return H_ERROR_QUERY;
-            }
-            return res;
-          } else {
-            y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error allocating query (2)");
-            return H_ERROR_MEMORY;
-          }
-        } else {
-          y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error no values to insert");
-          return H_ERROR_QUERY;
-        }
+        return h_insert_rows(conn, j_query, values, NULL, generated_query, NULL);
         break;
       default:
         y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert - Error unknown object type for values");
@@ -665,6 +1339,240 @@ int h_insert(const struct _h_connection * conn, const json_t * j_query, char **
   }
 }
 
+/**
+ * h_insert_chunks
+ * Execute an insert query by chunks and report the result of each chunk
+ * Set j_report with a json array containing the report of each chunk executed, must be decref'd after use
+ * return H_OK on success
+ */
+int h_insert_chunks(const struct _h_connection * conn, const json_t * j_query, json_t ** j_report) {
+  int res;
+
+  if (conn == NULL || j_report == NULL || j_query == NULL || !json_is_object(j_query) || !json_is_string(json_object_get(j_query, "table")) || (!json_is_object(json_object_get(j_query, "values")) && !json_is_array(json_object_get(j_query, "values")))) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_insert_chunks - Error null input parameters");
+    return H_ERROR_PARAMS;
+  }
+  if ((*j_report = json_array()) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_insert_chunks - Error allocating memory for j_report");
+    return H_ERROR_MEMORY;
+  }
+  if (json_is_object(json_object_get(j_query, "values"))) {
+    res = h_insert(conn, j_query, NULL);
+    json_array_append_new(*j_report, h_insert_chunk_report(0, 1, res));
+    return res;
+  } else {
+    return h_insert_rows(conn, j_query, json_object_get(j_query, "values"), NULL, NULL, *j_report);
+  }
+}
+
+/**
+ * Check that j_columns is a json array of strings
+ * return H_OK on success
+ */
+static int h_upsert_check_columns(const json_t * j_columns) {
+  json_t * j_column = NULL;
+  size_t index = 0;
+
+  if (!json_is_array(j_columns)) {
+    return H_ERROR_PARAMS;
+  }
+  json_array_foreach(j_columns, index, j_column) {
+    if (!json_is_string(j_column) || o_strnullempty(json_string_value(j_column))) {
+      return H_ERROR_PARAMS;
+    }
+  }
+  return H_OK;
+}
+
+/**
+ * Builds the conflict clause of an upsert query
+ * j_conflict is the json array of the conflict target columns, j_update the json array of the columns updated
+ * With SQLite and PostgreSQL: ON CONFLICT (col1) DO UPDATE SET col2=excluded.col2, or DO NOTHING if j_update is empty
+ * With MariaDB: ON DUPLICATE KEY UPDATE col2=VALUES(col2), or col1=col1 if j_update is empty,
+ * the conflict target is the unique key violated
+ * Returned value must be h_free'd after use
+ */
+static char * h_get_upsert_clause(const struct _h_connection * conn, const json_t * j_conflict, const json_t * j_update) {
+  struct _h_sql_buffer buffer;
+  json_t * j_column = NULL;
+  size_t index = 0;
+
+  h_sql_buffer_init(&buffer);
+  if (conn->type == HOEL_DB_TYPE_MARIADB) {
+    h_sql_buffer_append(&buffer, " ON DUPLICATE KEY UPDATE ");
+    if (json_array_size(j_update)) {
+      json_array_foreach(j_update, index, j_column) {
+        h_sql_buffer_appendf(&buffer, index?", %s=VALUES(%s)":"%s=VALUES(%s)", json_string_value(j_column), json_string_value(j_column));
+      }
+    } else {
+      h_sql_buffer_appendf(&buffer, "%s=%s", json_string_value(json_array_get(j_conflict, 0)), json_string_value(json_array_get(j_conflict, 0)));
+    }
+  } else {
+    h_sql_buffer_append(&buffer, " ON CONFLICT (");
+    json_array_foreach(j_conflict, index, j_column) {
+      if (index) {
+        h_sql_buffer_append_len(&buffer, ",", 1);
+      }
+      h_sql_buffer_append(&buffer, json_string_value(j_column));
+    }
+    if (json_array_size(j_update)) {
+      h_sql_buffer_append(&buffer, ") DO UPDATE SET ");
+      json_array_foreach(j_update, index, j_column) {
+        h_sql_buffer_appendf(&buffer, index?", %s=excluded.%s":"%s=excluded.%s", json_string_value(j_column), json_string_value(j_column));
+      }
+    } else {
+      h_sql_buffer_append(&buffer, ") DO NOTHING");
+    }
+  }
+  return h_sql_buffer_release(&buffer);
+}
+
+/**
+ * h_upsert
+ * Execute an insert query, the rows conflicting with an existing row update it instead
+ * Uses a json_t * parameter for the query parameters
+ * Duplicate the generated query in generated_query if specified, must be h_free'd after use
+ * return H_OK on success
+ */
+int h_upsert(const struct _h_connection * conn, const json_t * j_query, char ** generated_query) {
+  const json_t * j_conflict, * j_update;
+  json_t * j_values, * j_columns = NULL, * j_value = NULL, * j_column = NULL;
+  const char * key = NULL;
+  char * clause;
+  size_t index = 0;
+  int res;
+
+  if (conn == NULL || j_query == NULL || !json_is_object(j_query) || !json_is_string(json_object_get(j_query, "table")) || (!json_is_object(json_object_get(j_query, "values")) && !json_is_array(json_object_get(j_query, "values")))) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_upsert - Error null input parameters");
+    return H_ERROR_PARAMS;
+  }
+  j_conflict = json_object_get(j_query, "conflict");
+  j_update = json_object_get(j_query, "update");
+  if (h_upsert_check_columns(j_conflict) != H_OK || !json_array_size(j_conflict) || (j_update != NULL && h_upsert_check_columns(j_update) != H_OK)) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_upsert - Error conflict must be a non empty json array of strings, update a json array of strings");
+    return H_ERROR_PARAMS;
+  }
+  if (json_is_object(json_object_get(j_query, "values"))) {
+    j_values = json_pack("[O]", json_object_get(j_query, "values"));
+  } else {
+    j_values = json_incref(json_object_get(j_query, "values"));
+  }
+  if ((res = h_insert_check_values(j_values)) != H_OK) {
+    json_decref(j_values);
+    return res;
+  }
+  if (j_update == NULL) {
+    /* Update all the columns inserted except the conflict target */
+    if ((j_columns = json_array()) != NULL) {
+      json_object_foreach(json_array_get(j_values, 0), key, j_value) {
+        json_array_foreach(j_conflict, index, j_column) {
+          if (0 == o_strcmp(key, json_string_value(j_column))) {
+            break;
+          }
+        }
+        if (index == json_array_size(j_conflict)) {
+          json_array_append_new(j_columns, json_string(key));
+        }
+      }
+    }
+    j_update = j_columns;
+  }
+  if (j_update == NULL || (clause = h_get_upsert_clause(conn, j_conflict, j_update)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_upsert - Error allocating clause");
+    json_decref(j_columns);
+    json_decref(j_values);
+    return H_ERROR_MEMORY;
+  }
+  res = h_insert_rows(conn, j_query, j_values, clause, generated_query, NULL);
+  h_free(clause);
+  json_decref(j_columns);
+  json_decref(j_values);
+  return res;
+}
+
+/**
+ * Get the columns of a bulk insert, the keys of the first row of j_values
+ * A key missing in the first row would be silently dropped, so the insert is rejected
+ * columns must be h_free'd after use
+ * return H_OK on success
+ */
+int h_bulk_insert_columns(const json_t * j_values, const char *** columns, size_t * nb_columns) {
+  json_t * j_first = json_array_get(j_values, 0), * j_row, * j_value;
+  const char * key;
+  size_t index, col = 0;
+
+  json_array_foreach(j_values, index, j_row) {
+    if (!json_is_object(j_row)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_bulk_insert_columns - Error row %zu is not a json object", index);
+      return H_ERROR_PARAMS;
+    }
+    json_object_foreach(j_row, key, j_value) {
+      if (json_object_get(j_first, key) == NULL) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_bulk_insert_columns - Error column '%s' of row %zu is missing in the first row", key, index);
+        return H_ERROR_PARAMS;
+      }
+    }
+  }
+  *nb_columns = json_object_size(j_first);
+  if ((*columns = o_malloc(*nb_columns*sizeof(char *))) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel/h_bulk_insert_columns - Error allocating memory for columns");
+    return H_ERROR_MEMORY;
+  }
+  json_object_foreach(j_first, key, j_value) {
+    (*columns)[col++] = key;
+  }
+  return H_OK;
+}
+
+void h_sql_buffer_append_columns(struct _h_sql_buffer * buffer, const char ** columns, size_t nb_columns) {
+  size_t col;
+
+  for (col=0; col<nb_columns; col++) {
+    if (col) {
+      h_sql_buffer_append_len(buffer, ",", 1);
+    }
+    h_sql_buffer_append(buffer, columns[col]);
+  }
+}
+
+/**
+ * h_bulk_insert
+ * Insert a large number of rows
+ * Uses a json_t * parameter for the query parameters, values must be a json array of json objects
+ * return H_OK on success
+ */
+int h_bulk_insert(const struct _h_connection * conn, const json_t * j_query) {
+  json_t * values;
+
+  if (conn != NULL && conn->connection != NULL && j_query != NULL && json_is_object(j_query) && json_is_string(json_object_get(j_query, "table")) && json_is_array(json_object_get(j_query, "values"))) {
+    values = json_object_get(j_query, "values");
+    if (!json_array_size(values) || !json_is_object(json_array_get(values, 0)) || !json_object_size(json_array_get(values, 0))) {
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_bulk_insert - Error no values to insert");
+      return H_ERROR_PARAMS;
+    }
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_bulk_insert_sqlite(conn, json_string_value(json_object_get(j_query, "table")), values);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_bulk_insert_mariadb(conn, json_string_value(json_object_get(j_query, "table")), values);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_bulk_insert_pgsql(conn, json_string_value(json_object_get(j_query, "table")), values);
+#endif
+    } else {
+      return h_insert(conn, j_query, NULL);
+    }
+  } else {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_bulk_insert - Error null input parameters");
+    return H_ERROR_PARAMS;
+  }
+}
+
 /**
  * h_last_insert_id
  * return the id of the last inserted value
@@ -710,36 +1618,27 @@ json_t * h_last_insert_id(const struct _h_connection * conn) {
  * return H_OK on success
  */
 int h_update(const struct _h_connection * conn, const json_t * j_query, char ** generated_query) {
-  char * set_clause, * where_clause, * query;
-  const char * table;
+  struct _h_sql_buffer buffer;
+  char * query;
   int res;
-  json_t * set, * where;
 
-  if (j_query == NULL || !json_is_object(j_query) || !json_is_string(json_object_get(j_query, "table")) || !json_is_object(json_object_get(j_query, "set"))) {
+  if (conn == NULL || j_query == NULL || !json_is_object(j_query) || !json_is_string(json_object_get(j_query, "table")) || !json_is_object(json_object_get(j_query, "set"))) {
     y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_update - Error invalid input parameters");
     return H_ERROR_PARAMS;
   }
 
-  table = json_string_value((const json_t *)json_object_get(j_query, "table"));
-
-  set = json_object_get(j_query, "set");
-  set_clause = h_get_set_clause_from_json_object(conn, set);
-
-  if (set_clause == NULL) {
-    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_update - Error generating set clause");
-    return H_ERROR_PARAMS;
+  if (generated_query == NULL) {
+    if ((res = h_json_cache_query(conn, j_query, NULL, h_sql_buffer_append_update)) != H_AGAIN) {
+      return res;
+    }
   }
 
-  if (json_is_object(json_object_get(j_query, "where")) && json_object_size(json_object_get(j_query, "where")) > 0) {
-    where = json_object_get(j_query, "where");
-    where_clause = h_get_where_clause_from_json_object(conn, where);
-    query = msprintf("UPDATE %s SET %s WHERE %s", table, set_clause, where_clause);
-    h_free(where_clause);
-  } else {
-    query = msprintf("UPDATE %s SET %s", table, set_clause);
+  h_sql_buffer_init(&buffer);
+  if ((res = h_sql_buffer_append_update(conn, &buffer, j_query, NULL)) != H_OK) {
+    h_sql_buffer_clean(&buffer);
+    return res;
   }
-
-  h_free(set_clause);
+  query = h_sql_buffer_release(&buffer);
   if (query == NULL) {
     y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_update - Error allocating query");
     return H_ERROR_MEMORY;
@@ -760,32 +1659,27 @@ int h_update(const struct _h_connection * conn, const json_t * j_query, char **
  * return H_OK on success
  */
 int h_delete(const struct _h_connection * conn, const json_t * j_query, char ** generated_query) {
-  char * where_clause, * query;
-  const char * table;
+  struct _h_sql_buffer buffer;
+  char * query;
   int res;
-  json_t * where;
 
-  if (j_query == NULL || !json_is_object(j_query) || !json_is_string(json_object_get(j_query, "table"))) {
+  if (conn == NULL || j_query == NULL || !json_is_object(j_query) || !json_is_string(json_object_get(j_query, "table"))) {
     y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_delete - Error invalid input parameters");
     return H_ERROR_PARAMS;
   }
 
-  table = json_string_value((json_t *)json_object_get(j_query, "table"));
-
-  if (json_is_object(json_object_get(j_query, "where")) && json_object_size(json_object_get(j_query, "where")) > 0) {
-    where = json_object_get(j_query, "where");
-    where_clause = h_get_where_clause_from_json_object(conn, where);
-
-    if (where_clause == NULL) {
-      y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_delete - Error invalid input parameters");
-      return H_ERROR_PARAMS;
+  if (generated_query == NULL) {
+    if ((res = h_json_cache_query(conn, j_query, NULL, h_sql_buffer_append_delete)) != H_AGAIN) {
+      return res;
     }
-    query = msprintf("DELETE FROM %s WHERE %s", table, where_clause);
-    h_free(where_clause);
-  } else {
-    query = msprintf("DELETE FROM %s", table);
   }
 
+  h_sql_buffer_init(&buffer);
+  if ((res = h_sql_buffer_append_delete(conn, &buffer, j_query, NULL)) != H_OK) {
+    h_sql_buffer_clean(&buffer);
+    return res;
+  }
+  query = h_sql_buffer_release(&buffer);
   if (query == NULL) {
     y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel/h_delete - Error allocating query");
     return H_ERROR_MEMORY;
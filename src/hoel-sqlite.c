@@ -28,11 +28,39 @@
 #include <sqlite3.h>
 #include <string.h>
 
+/**
+ * Default number of statements kept in the statement cache of a connection
+ */
+#define H_SQLITE_STATEMENT_CACHE_SIZE 16
+
+/**
+ * Statement cache entry, the key is the query given by the caller and its hash
+ */
+struct _h_sqlite_cache_entry {
+  sqlite3_stmt                 * stmt;
+  char                         * query;
+  unsigned long                  hash;
+  struct _h_sqlite_cache_entry * prev;
+  struct _h_sqlite_cache_entry * next;
+};
+
 /**
  * SQLite handle
+ * The prepared statements of the queries are kept in a LRU cache,
+ * cache_first is the most recently used statement, cache_last the least recently used
+ * A statement is removed from the cache while it's used, so it can't be used twice at the same time
+ * lock is held while a query runs, while a cursor is open and from h_transaction_begin_sqlite
+ * until the transaction ends, so queries from other threads can't run inside a transaction
  */
 struct _h_sqlite {
-  sqlite3 * db_handle;
+  sqlite3                      * db_handle;
+  pthread_mutex_t                lock;
+  int                            transaction;
+  pthread_mutex_t                cache_lock;
+  unsigned int                   cache_size;
+  unsigned int                   cache_count;
+  struct _h_sqlite_cache_entry * cache_first;
+  struct _h_sqlite_cache_entry * cache_last;
 };
 
 /**
@@ -42,6 +70,7 @@ struct _h_sqlite {
  */
 struct _h_connection * h_connect_sqlite(const char * db_path) {
   struct _h_connection * conn = NULL;
+  pthread_mutexattr_t mutexattr;
   o_malloc_t malloc_fn;
   o_free_t free_fn;
   
@@ -56,6 +85,7 @@ struct _h_connection * h_connect_sqlite(const char * db_path) {
     }
     
     conn->type = HOEL_DB_TYPE_SQLITE;
+    conn->json_cache = NULL;
     conn->connection = o_malloc(sizeof(struct _h_sqlite));
     if (conn->connection == NULL) {
       y_log_message(Y_LOG_LEVEL_ERROR, "h_connect_sqlite - Error allocating resources");
@@ -72,19 +102,216 @@ struct _h_connection * h_connect_sqlite(const char * db_path) {
       h_free(conn);
       return NULL;
     } else {
+      ((struct _h_sqlite *)conn->connection)->cache_size = H_SQLITE_STATEMENT_CACHE_SIZE;
+      ((struct _h_sqlite *)conn->connection)->cache_count = 0;
+      ((struct _h_sqlite *)conn->connection)->cache_first = NULL;
+      ((struct _h_sqlite *)conn->connection)->cache_last = NULL;
+      pthread_mutex_init(&((struct _h_sqlite *)conn->connection)->cache_lock, NULL);
+      ((struct _h_sqlite *)conn->connection)->transaction = 0;
+      /* Initialize MUTEX for connection */
+      pthread_mutexattr_init ( &mutexattr );
+      pthread_mutexattr_settype( &mutexattr, PTHREAD_MUTEX_RECURSIVE );
+      if (pthread_mutex_init(&(((struct _h_sqlite *)conn->connection)->lock), &mutexattr) != 0) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Impossible to initialize Mutex Lock for SQLite connection");
+      }
+      pthread_mutexattr_destroy( &mutexattr );
+      h_json_cache_init(conn);
       return conn;
     }
   }
   return conn;
 }
 
+/**
+ * Remove an entry from the statement cache and free it
+ * The cache must be locked
+ * return the statement of the entry
+ */
+static sqlite3_stmt * h_sqlite_cache_remove(struct _h_sqlite * sqlite, struct _h_sqlite_cache_entry * entry) {
+  sqlite3_stmt * stmt = entry->stmt;
+  
+  if (entry->prev != NULL) {
+    entry->prev->next = entry->next;
+  } else {
+    sqlite->cache_first = entry->next;
+  }
+  if (entry->next != NULL) {
+    entry->next->prev = entry->prev;
+  } else {
+    sqlite->cache_last = entry->prev;
+  }
+  sqlite->cache_count--;
+  h_free(entry->query);
+  h_free(entry);
+  return stmt;
+}
+
+/**
+ * Remove the least recently used statements from the cache until it has at most size statements
+ * The cache must be locked
+ */
+static void h_sqlite_cache_shrink(struct _h_sqlite * sqlite, unsigned int size) {
+  while (sqlite->cache_count > size) {
+    sqlite3_finalize(h_sqlite_cache_remove(sqlite, sqlite->cache_last));
+  }
+}
+
+/**
+ * Hash of a sql query used as the statement cache key
+ */
+static unsigned long h_sqlite_cache_hash(const char * query) {
+  unsigned long hash = 5381;
+  
+  while (*query) {
+    hash = ((hash << 5) + hash) + (unsigned char)(*query++);
+  }
+  return hash;
+}
+
+/**
+ * Get the prepared statement of the query from the cache, or prepare it if it isn't cached
+ * The connection is locked while *stmt isn't NULL,
+ * the statement must be given back with h_sqlite_statement_release after use
+ * return the sqlite3_prepare_v3 result
+ */
+static int h_sqlite_statement_acquire(const struct _h_connection * conn, const char * query, sqlite3_stmt ** stmt) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  struct _h_sqlite_cache_entry * entry;
+  unsigned long hash = h_sqlite_cache_hash(query);
+  int res;
+  
+  *stmt = NULL;
+  if (pthread_mutex_lock(&sqlite->lock)) {
+    return SQLITE_ERROR;
+  }
+  if (!pthread_mutex_lock(&sqlite->cache_lock)) {
+    for (entry = sqlite->cache_first; entry != NULL; entry = entry->next) {
+      if (entry->hash == hash && 0 == o_strcmp(entry->query, query)) {
+        *stmt = h_sqlite_cache_remove(sqlite, entry);
+        break;
+      }
+    }
+    pthread_mutex_unlock(&sqlite->cache_lock);
+  }
+  if (*stmt != NULL) {
+    return SQLITE_OK;
+  } else {
+    res = sqlite3_prepare_v3(sqlite->db_handle, query, (int)o_strlen(query)+1, sqlite->cache_size?SQLITE_PREPARE_PERSISTENT:0, stmt, NULL);
+    if (*stmt == NULL) {
+      pthread_mutex_unlock(&sqlite->lock);
+    }
+    return res;
+  }
+}
+
+/**
+ * Reset the statement of the query and put it in the cache as the most recently used statement,
+ * then unlock the connection
+ * query must be the query given to h_sqlite_statement_acquire
+ * The statement is finalized if the cache is disabled or if the same query is already cached
+ */
+static void h_sqlite_statement_release(const struct _h_connection * conn, const char * query, sqlite3_stmt * stmt) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  struct _h_sqlite_cache_entry * entry = NULL, * cur;
+  unsigned long hash;
+  
+  if (stmt == NULL) {
+    return;
+  }
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (!pthread_mutex_lock(&sqlite->cache_lock)) {
+    if (sqlite->cache_size) {
+      hash = h_sqlite_cache_hash(query);
+      for (cur = sqlite->cache_first; cur != NULL; cur = cur->next) {
+        if (cur->hash == hash && 0 == o_strcmp(cur->query, query)) {
+          break;
+        }
+      }
+      if (cur == NULL && (entry = o_malloc(sizeof(struct _h_sqlite_cache_entry))) != NULL && (entry->query = o_strdup(query)) == NULL) {
+        h_free(entry);
+        entry = NULL;
+      }
+      if (entry != NULL) {
+        entry->stmt = stmt;
+        entry->hash = hash;
+        entry->prev = NULL;
+        entry->next = sqlite->cache_first;
+        if (sqlite->cache_first != NULL) {
+          sqlite->cache_first->prev = entry;
+        } else {
+          sqlite->cache_last = entry;
+        }
+        sqlite->cache_first = entry;
+        sqlite->cache_count++;
+        h_sqlite_cache_shrink(sqlite, sqlite->cache_size);
+      }
+    }
+    pthread_mutex_unlock(&sqlite->cache_lock);
+  }
+  if (entry == NULL) {
+    sqlite3_finalize(stmt);
+  }
+  pthread_mutex_unlock(&sqlite->lock);
+}
+
+/**
+ * Set the maximum number of statements kept in the statement cache of a sqlite connection
+ * 0 disables the cache
+ * return H_OK on success
+ */
+int h_set_statement_cache_size_sqlite(const struct _h_connection * conn, unsigned int size) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  
+  if (pthread_mutex_lock(&sqlite->cache_lock)) {
+    return H_ERROR;
+  }
+  sqlite->cache_size = size;
+  h_sqlite_cache_shrink(sqlite, size);
+  pthread_mutex_unlock(&sqlite->cache_lock);
+  return H_OK;
+}
+
 /**
  * close a sqlite3 connection
+ * The cached statements are finalized first, otherwise sqlite3_close fails
  */
 void h_close_sqlite(struct _h_connection * conn) {
+  h_set_statement_cache_size_sqlite(conn, 0);
+  pthread_mutex_destroy(&((struct _h_sqlite *)conn->connection)->cache_lock);
+  pthread_mutex_destroy(&((struct _h_sqlite *)conn->connection)->lock);
   sqlite3_close(((struct _h_sqlite *)conn->connection)->db_handle);
 }
 
+/**
+ * Check a sqlite3 connection before it's used again
+ * A transaction left open is rolled back
+ * return H_OK on success
+ */
+int h_check_connection_sqlite(const struct _h_connection * conn) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  int ret = H_OK;
+  
+  if (pthread_mutex_lock(&sqlite->lock)) {
+    return H_ERROR;
+  }
+  if (sqlite->transaction) {
+    /* The transaction belongs to this thread, release the lock taken by h_transaction_begin_sqlite, the transaction is rolled back below */
+    sqlite->transaction = 0;
+    pthread_mutex_unlock(&sqlite->lock);
+  }
+  if (!sqlite3_get_autocommit(sqlite->db_handle)) {
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Hoel - Rollback transaction left open");
+    if (sqlite3_exec(sqlite->db_handle, "ROLLBACK", NULL, NULL, NULL) != SQLITE_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error rollback transaction");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error message: \"%s\"", sqlite3_errmsg(sqlite->db_handle));
+      ret = H_ERROR_CONNECTION;
+    }
+  }
+  pthread_mutex_unlock(&sqlite->lock);
+  return ret;
+}
+
 /**
  * escape a string
  * returned value must be free'd after use
@@ -130,6 +357,65 @@ long long int h_last_insert_id_sqlite(const struct _h_connection * conn) {
   return sqlite3_last_insert_rowid(((struct _h_sqlite *)conn->connection)->db_handle);
 }
 
+/**
+ * Return the maximum length of a sql query on a sqlite connection
+ */
+size_t h_max_query_length_sqlite(const struct _h_connection * conn) {
+  return (size_t)sqlite3_limit(((struct _h_sqlite *)conn->connection)->db_handle, SQLITE_LIMIT_SQL_LENGTH, -1);
+}
+
+/**
+ * Decode the value of the column col in the current row of stmt
+ * text and blob values are not copied
+ */
+static void h_sqlite_get_cell(sqlite3_stmt * stmt, int col, struct _h_cell * cell) {
+  int col_bytes;
+  
+  cell->type = HOEL_COL_TYPE_NULL;
+  switch (sqlite3_column_type(stmt, col)) {
+    case SQLITE_INTEGER:
+      cell->type = HOEL_COL_TYPE_INT;
+      cell->i_value = sqlite3_column_int64(stmt, col);
+      break;
+    case SQLITE_FLOAT:
+      cell->type = HOEL_COL_TYPE_DOUBLE;
+      cell->d_value = sqlite3_column_double(stmt, col);
+      break;
+    case SQLITE_BLOB:
+      cell->type = HOEL_COL_TYPE_BLOB;
+      cell->value = sqlite3_column_blob(stmt, col);
+      col_bytes = sqlite3_column_bytes(stmt, col);
+      cell->length = col_bytes>0?(size_t)col_bytes:0;
+      break;
+    case SQLITE3_TEXT:
+      cell->type = HOEL_COL_TYPE_TEXT;
+      cell->value = sqlite3_column_text(stmt, col);
+      col_bytes = sqlite3_column_bytes(stmt, col);
+      cell->length = col_bytes>0?(size_t)col_bytes:0;
+      break;
+    case SQLITE_NULL:
+    default:
+      break;
+  }
+}
+
+/**
+ * Check that all the rows of a statement have been read
+ * return H_OK if the last sqlite3_step result is SQLITE_DONE, H_ERROR_QUERY otherwise
+ */
+static int h_sqlite_check_done(const struct _h_connection * conn, const char * query, int row_result) {
+  if (row_result == SQLITE_DONE) {
+    return H_OK;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sqlite3_step");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", 
+                                   sqlite3_errcode(((struct _h_sqlite *)conn->connection)->db_handle), 
+                                   sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    return H_ERROR_QUERY;
+  }
+}
+
 /**
  * h_select_query_sqlite
  * Execute a select query on a sqlite connection, set the result structure with the returned values
@@ -139,70 +425,176 @@ long long int h_last_insert_id_sqlite(const struct _h_connection * conn) {
  * return H_OK on success
  */
 int h_select_query_sqlite(const struct _h_connection * conn, const char * query, struct _h_result * result) {
+  return h_select_query_options_sqlite(conn, query, result, H_OPTION_NONE);
+}
+
+/**
+ * h_select_query_options_sqlite
+ * Execute a select query on a sqlite connection, set the result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * if result is NULL, the query is executed but no value will be returned
+ * if options has H_OPTION_ARENA set, the result values are allocated in an arena
+ * return H_OK on success
+ */
+int h_select_query_options_sqlite(const struct _h_connection * conn, const char * query, struct _h_result * result, int options) {
   sqlite3_stmt *stmt;
-  int sql_result, row_result, nb_columns, col, row, res, col_bytes;
-  struct _h_data * data = NULL, * cur_row = NULL;
+  int sql_result, row_result, nb_columns, col, res;
+  struct _h_data * cur_row = NULL;
+  struct _h_cell cell;
   
-  sql_result = sqlite3_prepare_v2(((struct _h_sqlite *)conn->connection)->db_handle, query, (int)o_strlen(query)+1, &stmt, NULL);
+  sql_result = h_sqlite_statement_acquire(conn, query, &stmt);
   
   if (sql_result == SQLITE_OK) {
-    nb_columns = sqlite3_column_count(stmt);
-    row = 0;
     if (result != NULL) {
+      /* The first step prepares the statement again if the schema has changed since it was cached */
       row_result = sqlite3_step(stmt);
+      nb_columns = sqlite3_column_count(stmt);
       /* Filling result object with results in array format */
-      result->nb_rows = 0;
-      result->nb_columns = (unsigned int)nb_columns;
-      result->data = NULL;
+      if ((res = h_result_init(result, (unsigned int)nb_columns, options)) != H_OK) {
+        h_sqlite_statement_release(conn, query, stmt);
+        return res;
+      }
       while (row_result == SQLITE_ROW) {
-        cur_row = NULL;
+        if ((res = h_result_new_row(result, &cur_row)) != H_OK) {
+          h_sqlite_statement_release(conn, query, stmt);
+          h_clean_result(result);
+          return res;
+        }
         for (col = 0; col < nb_columns; col++) {
-          data = NULL;
-          switch (sqlite3_column_type(stmt, col)) {
-            case SQLITE_INTEGER:
-              data = h_new_data_int(sqlite3_column_int64(stmt, col));
-              break;
-            case SQLITE_FLOAT:
-              data = h_new_data_double(sqlite3_column_double(stmt, col));
-              break;
-            case SQLITE_BLOB:
-              if ((col_bytes = sqlite3_column_bytes(stmt, col)) >= 0) {
-                data = h_new_data_blob(sqlite3_column_blob(stmt, col), (size_t)col_bytes);
-              }
-              break;
-            case SQLITE3_TEXT:
-              if ((col_bytes = sqlite3_column_bytes(stmt, col)) >= 0) {
-                data = h_new_data_text((char*)sqlite3_column_text(stmt, col), (size_t)col_bytes);
-              }
-              break;
-            case SQLITE_NULL:
-              data = h_new_data_null();
-            default:
-              break;
-          }
-          if (data == NULL) {
-            sqlite3_finalize(stmt);
-            h_clean_data_full(data);
-            return H_ERROR_MEMORY;
-          }
-          res = h_row_add_data(&cur_row, data, col);
-          h_clean_data_full(data);
-          if (res != H_OK) {
-            sqlite3_finalize(stmt);
+          h_sqlite_get_cell(stmt, col, &cell);
+          if ((res = h_result_set_cell(result, &cur_row[col], &cell)) != H_OK) {
+            h_sqlite_statement_release(conn, query, stmt);
+            h_clean_result(result);
             return res;
           }
         }
-        res = h_result_add_row(result, cur_row, row);
-        cur_row = NULL;
-        if (res != H_OK) {
-          sqlite3_finalize(stmt);
-          return res;
-        }
         row_result = sqlite3_step(stmt);
-        row++;
+      }
+      if ((res = h_sqlite_check_done(conn, query, row_result)) != H_OK) {
+        h_sqlite_statement_release(conn, query, stmt);
+        h_clean_result(result);
+        return res;
       }
     }
-    sqlite3_finalize(stmt);
+    h_sqlite_statement_release(conn, query, stmt);
+    return H_OK;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", 
+                                   sqlite3_errcode(((struct _h_sqlite *)conn->connection)->db_handle), 
+                                   sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    h_sqlite_statement_release(conn, query, stmt);
+    return H_ERROR_QUERY;
+  }
+}
+
+/**
+ * h_execute_query_columnar_sqlite
+ * Execute a query on a sqlite connection, set the columnar result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_columnar_sqlite(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result) {
+  sqlite3_stmt *stmt;
+  int sql_result, row_result, nb_columns, col, res;
+  struct _h_cell cell;
+  
+  sql_result = h_sqlite_statement_acquire(conn, query, &stmt);
+  
+  if (sql_result == SQLITE_OK) {
+    row_result = sqlite3_step(stmt);
+    nb_columns = sqlite3_column_count(stmt);
+    res = h_result_columnar_init(result, (unsigned int)nb_columns);
+    for (col = 0; res == H_OK && col < nb_columns; col++) {
+      res = h_result_columnar_set_name(result, (unsigned int)col, sqlite3_column_name(stmt, col));
+    }
+    while (res == H_OK && row_result == SQLITE_ROW) {
+      res = h_result_columnar_new_row(result);
+      for (col = 0; res == H_OK && col < nb_columns; col++) {
+        h_sqlite_get_cell(stmt, col, &cell);
+        res = h_result_columnar_set_cell(result, (unsigned int)col, &cell);
+      }
+      row_result = sqlite3_step(stmt);
+    }
+    if (res == H_OK) {
+      res = h_sqlite_check_done(conn, query, row_result);
+    }
+    h_sqlite_statement_release(conn, query, stmt);
+    if (res != H_OK) {
+      h_clean_result_columnar(result);
+    }
+    return res;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", 
+                                   sqlite3_errcode(((struct _h_sqlite *)conn->connection)->db_handle), 
+                                   sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    h_sqlite_statement_release(conn, query, stmt);
+    return H_ERROR_QUERY;
+  }
+}
+
+/**
+ * h_execute_query_value_sqlite
+ * Execute a query on a sqlite connection, set the value result structure with the returned values
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_value_sqlite(const struct _h_connection * conn, const char * query, struct _h_value_result * result) {
+  sqlite3_stmt *stmt;
+  int sql_result, row_result, nb_columns, col, res;
+  struct _h_value * cur_row = NULL;
+  struct _h_cell cell;
+  
+  sql_result = h_sqlite_statement_acquire(conn, query, &stmt);
+  
+  if (sql_result == SQLITE_OK) {
+    row_result = sqlite3_step(stmt);
+    nb_columns = sqlite3_column_count(stmt);
+    res = h_value_result_init(result, (unsigned int)nb_columns);
+    while (res == H_OK && row_result == SQLITE_ROW) {
+      res = h_value_result_new_row(result, &cur_row);
+      for (col = 0; res == H_OK && col < nb_columns; col++) {
+        h_sqlite_get_cell(stmt, col, &cell);
+        res = h_value_result_set_cell(result, &cur_row[col], &cell);
+      }
+      row_result = sqlite3_step(stmt);
+    }
+    if (res == H_OK) {
+      res = h_sqlite_check_done(conn, query, row_result);
+    }
+    h_sqlite_statement_release(conn, query, stmt);
+    if (res != H_OK) {
+      h_clean_value_result(result);
+    }
+    return res;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", 
+                                   sqlite3_errcode(((struct _h_sqlite *)conn->connection)->db_handle), 
+                                   sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    h_sqlite_statement_release(conn, query, stmt);
+    return H_ERROR_QUERY;
+  }
+}
+
+/**
+ * Execute the query and set the sqlite cursor on the rows returned
+ * The connection is locked until the cursor is closed
+ * return H_OK on success
+ */
+int h_cursor_open_sqlite(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor) {
+  sqlite3_stmt * stmt;
+  
+  if (pthread_mutex_lock(&(((struct _h_sqlite *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  if (sqlite3_prepare_v2(((struct _h_sqlite *)conn->connection)->db_handle, query, (int)o_strlen(query)+1, &stmt, NULL) == SQLITE_OK) {
+    cursor->handle = stmt;
+    cursor->nb_columns = (unsigned int)sqlite3_column_count(stmt);
     return H_OK;
   } else {
     y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
@@ -211,10 +603,361 @@ int h_select_query_sqlite(const struct _h_connection * conn, const char * query,
                                    sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
     y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
     sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&(((struct _h_sqlite *)conn->connection)->lock));
+    return H_ERROR_QUERY;
+  }
+}
+
+/**
+ * Read the next row of a sqlite cursor, set cursor->end if there's no more row
+ * return H_OK on success
+ */
+int h_cursor_fetch_sqlite(struct _h_cursor * cursor) {
+  switch (sqlite3_step(cursor->handle)) {
+    case SQLITE_ROW:
+      /* The statement is prepared again by the first step if the schema has changed, so the columns may have changed */
+      cursor->nb_columns = (unsigned int)sqlite3_column_count(cursor->handle);
+      return H_OK;
+      break;
+    case SQLITE_DONE:
+      cursor->end = 1;
+      return H_OK;
+      break;
+    default:
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sqlite3_step");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", 
+                                     sqlite3_errcode(((struct _h_sqlite *)cursor->conn->connection)->db_handle), 
+                                     sqlite3_errmsg(((struct _h_sqlite *)cursor->conn->connection)->db_handle));
+      cursor->end = 1;
+      return H_ERROR_QUERY;
+      break;
+  }
+}
+
+/**
+ * Decode the value of the column col in the current row of a sqlite cursor
+ */
+void h_cursor_get_cell_sqlite(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell) {
+  h_sqlite_get_cell(cursor->handle, (int)col, cell);
+}
+
+/**
+ * Return the name of the column col of a sqlite cursor
+ */
+const char * h_cursor_get_name_sqlite(const struct _h_cursor * cursor, unsigned int col) {
+  return sqlite3_column_name(cursor->handle, (int)col);
+}
+
+/**
+ * Close a sqlite cursor and unlock the connection
+ */
+void h_cursor_close_sqlite(struct _h_cursor * cursor) {
+  if (cursor->handle != NULL) {
+    if (cursor->statement != NULL) {
+      sqlite3_reset(cursor->handle);
+    } else {
+      sqlite3_finalize(cursor->handle);
+    }
+    pthread_mutex_unlock(&(((struct _h_sqlite *)cursor->conn->connection)->lock));
+  }
+}
+
+/**
+ * Prepare the query on a sqlite connection
+ * The statement is prepared with SQLITE_PREPARE_PERSISTENT because it's meant to be reused
+ * return H_OK on success
+ */
+int h_prepare_sqlite(const struct _h_connection * conn, const char * query, struct _h_statement * stmt) {
+  sqlite3_stmt * sqlite_stmt = NULL;
+  
+  if (sqlite3_prepare_v3(((struct _h_sqlite *)conn->connection)->db_handle, query, (int)o_strlen(query)+1, SQLITE_PREPARE_PERSISTENT, &sqlite_stmt, NULL) == SQLITE_OK) {
+    stmt->handle = sqlite_stmt;
+    stmt->nb_params = (unsigned int)sqlite3_bind_parameter_count(sqlite_stmt);
+    return H_OK;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error preparing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", 
+                                   sqlite3_errcode(((struct _h_sqlite *)conn->connection)->db_handle), 
+                                   sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    sqlite3_finalize(sqlite_stmt);
+    return H_ERROR_QUERY;
+  }
+}
+
+/**
+ * Execute the sqlite prepared statement with the values bound and set the cursor on the rows returned
+ * The values are bound with SQLITE_STATIC because they are owned by stmt until they are bound again
+ * The connection is locked until the cursor is closed
+ * return H_OK on success
+ */
+int h_cursor_open_prepared_sqlite(struct _h_statement * stmt, struct _h_cursor * cursor) {
+  sqlite3_stmt * sqlite_stmt = (sqlite3_stmt *)stmt->handle;
+  unsigned int i;
+  int res = SQLITE_OK;
+  
+  if (pthread_mutex_lock(&(((struct _h_sqlite *)stmt->conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
+  sqlite3_reset(sqlite_stmt);
+  for (i=0; res == SQLITE_OK && i<stmt->nb_params; i++) {
+    switch (stmt->params[i].type) {
+      case HOEL_COL_TYPE_INT:
+        res = sqlite3_bind_int64(sqlite_stmt, (int)i+1, stmt->params[i].v.i_value);
+        break;
+      case HOEL_COL_TYPE_DOUBLE:
+        res = sqlite3_bind_double(sqlite_stmt, (int)i+1, stmt->params[i].v.d_value);
+        break;
+      case HOEL_COL_TYPE_TEXT:
+        res = sqlite3_bind_text(sqlite_stmt, (int)i+1, h_value_get_bytes(&stmt->params[i]), (int)stmt->params[i].length, SQLITE_STATIC);
+        break;
+      case HOEL_COL_TYPE_BLOB:
+        res = sqlite3_bind_blob(sqlite_stmt, (int)i+1, h_value_get_bytes(&stmt->params[i]), (int)stmt->params[i].length, SQLITE_STATIC);
+        break;
+      default:
+        res = sqlite3_bind_null(sqlite_stmt, (int)i+1);
+        break;
+    }
+  }
+  if (res == SQLITE_OK) {
+    cursor->handle = sqlite_stmt;
+    cursor->nb_columns = (unsigned int)sqlite3_column_count(sqlite_stmt);
+    return H_OK;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error binding sql parameters");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", 
+                                   sqlite3_errcode(((struct _h_sqlite *)stmt->conn->connection)->db_handle), 
+                                   sqlite3_errmsg(((struct _h_sqlite *)stmt->conn->connection)->db_handle));
+    pthread_mutex_unlock(&(((struct _h_sqlite *)stmt->conn->connection)->lock));
     return H_ERROR_QUERY;
   }
 }
 
+/**
+ * Free the sqlite prepared statement
+ */
+void h_finalize_sqlite(struct _h_statement * stmt) {
+  sqlite3_finalize(stmt->handle);
+}
+
+/**
+ * Bind the value of a column of a bulk insert row
+ * The strings are bound with SQLITE_STATIC because j_value lives until the row is inserted
+ * return the sqlite3_bind_* result, SQLITE_MISUSE if the value can't be bound
+ */
+static int h_sqlite_bulk_bind(sqlite3_stmt * stmt, int index, const json_t * j_value) {
+  switch (json_typeof(j_value)) {
+    case JSON_STRING:
+      return sqlite3_bind_text(stmt, index, json_string_value(j_value), (int)json_string_length(j_value), SQLITE_STATIC);
+    case JSON_INTEGER:
+      return sqlite3_bind_int64(stmt, index, (sqlite3_int64)json_integer_value(j_value));
+    case JSON_REAL:
+      return sqlite3_bind_double(stmt, index, json_real_value(j_value));
+    case JSON_TRUE:
+      return sqlite3_bind_int(stmt, index, 1);
+    case JSON_FALSE:
+      return sqlite3_bind_int(stmt, index, 0);
+    case JSON_NULL:
+      return sqlite3_bind_null(stmt, index);
+    default:
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error value type not available with bulk insert");
+      return SQLITE_MISUSE;
+  }
+}
+
+/**
+ * Insert the rows of j_values in the table on a sqlite connection
+ * The INSERT query is prepared once, then the values of each row are bound and the statement
+ * is stepped and reset, in a BEGIN IMMEDIATE transaction, or in a savepoint if a transaction is already open,
+ * so the journal is synced once and none of the rows is inserted on error
+ * The columns are the keys of the first row, a column missing in another row is inserted as NULL,
+ * a key missing in the first row returns H_ERROR_PARAMS
+ * return H_OK on success
+ */
+int h_bulk_insert_sqlite(const struct _h_connection * conn, const char * table, const json_t * j_values) {
+  sqlite3 * db_handle = ((struct _h_sqlite *)conn->connection)->db_handle;
+  sqlite3_stmt * stmt = NULL;
+  struct _h_sql_buffer buffer;
+  const char ** columns;
+  char * query;
+  json_t * j_row, * j_value;
+  size_t index, nb_columns, col;
+  int ret = H_OK, res = SQLITE_OK, savepoint;
+  
+  if ((ret = h_bulk_insert_columns(j_values, &columns, &nb_columns)) != H_OK) {
+    return ret;
+  }
+  h_sql_buffer_init(&buffer);
+  h_sql_buffer_appendf(&buffer, "INSERT INTO %s (", table);
+  h_sql_buffer_append_columns(&buffer, columns, nb_columns);
+  h_sql_buffer_append(&buffer, ") VALUES (");
+  for (col=0; col<nb_columns; col++) {
+    h_sql_buffer_append(&buffer, col?",?":"?");
+  }
+  h_sql_buffer_append_len(&buffer, ")", 1);
+  if ((query = h_sql_buffer_release(&buffer)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for query");
+    h_free(columns);
+    return H_ERROR_MEMORY;
+  }
+  
+  if (pthread_mutex_lock(&(((struct _h_sqlite *)conn->connection)->lock))) {
+    h_free(query);
+    h_free(columns);
+    return H_ERROR_QUERY;
+  }
+  savepoint = !sqlite3_get_autocommit(db_handle);
+  if (sqlite3_exec(db_handle, savepoint?"SAVEPOINT hoel_bulk_insert":"BEGIN IMMEDIATE", NULL, NULL, NULL) != SQLITE_OK) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error starting bulk insert transaction");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", sqlite3_errcode(db_handle), sqlite3_errmsg(db_handle));
+    pthread_mutex_unlock(&(((struct _h_sqlite *)conn->connection)->lock));
+    h_free(query);
+    h_free(columns);
+    return H_ERROR_QUERY;
+  }
+  if (h_sqlite_statement_acquire(conn, query, &stmt) != SQLITE_OK) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error preparing sql query");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", sqlite3_errcode(db_handle), sqlite3_errmsg(db_handle));
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
+    ret = H_ERROR_QUERY;
+  } else {
+    json_array_foreach(j_values, index, j_row) {
+      for (col=0; res == SQLITE_OK && col<nb_columns; col++) {
+        if ((j_value = json_object_get(j_row, columns[col])) == NULL) {
+          res = sqlite3_bind_null(stmt, (int)col+1);
+        } else {
+          res = h_sqlite_bulk_bind(stmt, (int)col+1, j_value);
+        }
+      }
+      if (res == SQLITE_OK) {
+        res = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+      }
+      if (res == SQLITE_MISUSE) {
+        ret = H_ERROR_PARAMS;
+        break;
+      } else if (res != SQLITE_OK && res != SQLITE_DONE) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Error executing bulk insert");
+        y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", sqlite3_errcode(db_handle), sqlite3_errmsg(db_handle));
+        ret = H_ERROR_QUERY;
+        break;
+      }
+      res = SQLITE_OK;
+    }
+  }
+  h_sqlite_statement_release(conn, query, stmt);
+  
+  if (ret == H_OK) {
+    if (sqlite3_exec(db_handle, savepoint?"RELEASE hoel_bulk_insert":"COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Error commiting bulk insert transaction");
+      y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", sqlite3_errcode(db_handle), sqlite3_errmsg(db_handle));
+      ret = H_ERROR_QUERY;
+    }
+  }
+  if (ret != H_OK) {
+    sqlite3_exec(db_handle, savepoint?"ROLLBACK TO hoel_bulk_insert; RELEASE hoel_bulk_insert":"ROLLBACK", NULL, NULL, NULL);
+  }
+  pthread_mutex_unlock(&(((struct _h_sqlite *)conn->connection)->lock));
+  h_free(query);
+  h_free(columns);
+  return ret;
+}
+
+/**
+ * Start a transaction on a sqlite connection
+ * The connection stays locked until the transaction ends with h_transaction_end_sqlite
+ * return H_OK on success
+ */
+int h_transaction_begin_sqlite(const struct _h_connection * conn) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  
+  if (pthread_mutex_lock(&sqlite->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (sqlite->transaction) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error a transaction is already running");
+    pthread_mutex_unlock(&sqlite->lock);
+    return H_ERROR_PARAMS;
+  }
+  if (sqlite3_exec(sqlite->db_handle, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error starting transaction");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", sqlite3_errcode(sqlite->db_handle), sqlite3_errmsg(sqlite->db_handle));
+    pthread_mutex_unlock(&sqlite->lock);
+    return H_ERROR_QUERY;
+  }
+  sqlite->transaction = 1;
+  return H_OK;
+}
+
+/**
+ * Commit or rollback the transaction on a sqlite connection and unlock the connection
+ * If the commit fails, the transaction is rolled back
+ * return H_OK on success
+ */
+int h_transaction_end_sqlite(const struct _h_connection * conn, int commit) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  int ret = H_OK;
+  
+  if (pthread_mutex_lock(&sqlite->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!sqlite->transaction) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no transaction running");
+    pthread_mutex_unlock(&sqlite->lock);
+    return H_ERROR_PARAMS;
+  }
+  if (sqlite3_exec(sqlite->db_handle, commit?"COMMIT":"ROLLBACK", NULL, NULL, NULL) != SQLITE_OK) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Error ending transaction");
+    y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"", sqlite3_errcode(sqlite->db_handle), sqlite3_errmsg(sqlite->db_handle));
+    if (!sqlite3_get_autocommit(sqlite->db_handle)) {
+      sqlite3_exec(sqlite->db_handle, "ROLLBACK", NULL, NULL, NULL);
+    }
+    ret = H_ERROR_QUERY;
+  }
+  sqlite->transaction = 0;
+  /* Release the lock taken by h_transaction_begin_sqlite */
+  pthread_mutex_unlock(&sqlite->lock);
+  pthread_mutex_unlock(&sqlite->lock);
+  return ret;
+}
+
+/**
+ * Execute a savepoint query in the transaction of a sqlite connection
+ * return H_OK on success
+ */
+int h_transaction_query_sqlite(const struct _h_connection * conn, const char * query) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&sqlite->lock)) {
+    return H_ERROR_QUERY;
+  }
+  if (!sqlite->transaction) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error no transaction running");
+    ret = H_ERROR_PARAMS;
+  } else {
+    ret = h_execute_query_sqlite(conn, query);
+  }
+  pthread_mutex_unlock(&sqlite->lock);
+  return ret;
+}
+
+/**
+ * Check if a transaction is open on a sqlite connection, started with h_transaction_begin_sqlite or by a query
+ * return 1 if a transaction is open, 0 otherwise
+ */
+int h_in_transaction_sqlite(const struct _h_connection * conn) {
+  struct _h_sqlite * sqlite = (struct _h_sqlite *)conn->connection;
+  int ret;
+  
+  if (pthread_mutex_lock(&sqlite->lock)) {
+    return 0;
+  }
+  ret = !sqlite3_get_autocommit(sqlite->db_handle);
+  pthread_mutex_unlock(&sqlite->lock);
+  return ret;
+}
+
 /**
  * h_execute_query_sqlite
  * Execute a query on a sqlite connection
@@ -226,16 +969,23 @@ int h_select_query_sqlite(const struct _h_connection * conn, const char * query,
  * @return H_OK on success
  */
 int h_execute_query_sqlite(const struct _h_connection * conn, const char * query) {
+  int ret;
+  
+  if (pthread_mutex_lock(&(((struct _h_sqlite *)conn->connection)->lock))) {
+    return H_ERROR_QUERY;
+  }
   if (sqlite3_exec(((struct _h_sqlite *)conn->connection)->db_handle, query, NULL, NULL, NULL) == SQLITE_OK) {
-    return H_OK;
+    ret = H_OK;
   } else {
     y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
     y_log_message(Y_LOG_LEVEL_DEBUG, "Error code: %d, message: \"%s\"",
                                    sqlite3_errcode(((struct _h_sqlite *)conn->connection)->db_handle),
                                    sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
     y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
-    return H_ERROR_QUERY;
+    ret = H_ERROR_QUERY;
   }
+  pthread_mutex_unlock(&(((struct _h_sqlite *)conn->connection)->lock));
+  return ret;
 }
 
 /**
@@ -257,60 +1007,79 @@ int h_exec_query_sqlite(const struct _h_connection * conn, const char * query) {
  * return H_OK on success
  */
 int h_execute_query_json_sqlite(const struct _h_connection * conn, const char * query, json_t ** j_result) {
+  return h_execute_query_json_options_sqlite(conn, query, j_result, H_OPTION_NONE);
+}
+
+/**
+ * h_execute_query_json_options_sqlite
+ * Execute a query on a sqlite connection, set the returned values in the json result
+ * if options has H_OPTION_JSON_COMPACT, the result has the format {"columns":[],"rows":[[]]}
+ * Should not be executed by the user because all parameters are supposed to be correct
+ * return H_OK on success
+ */
+int h_execute_query_json_options_sqlite(const struct _h_connection * conn, const char * query, json_t ** j_result, int options) {
   sqlite3_stmt *stmt;
   int sql_result, row_result, nb_columns, col, col_bytes;
-  json_t * j_data;
+  json_t * j_data, * j_rows;
   
   if (j_result == NULL) {
     return H_ERROR_PARAMS;
   }
   
-  sql_result = sqlite3_prepare_v2(((struct _h_sqlite *)conn->connection)->db_handle, query, (int)o_strlen(query)+1, &stmt, NULL);
+  sql_result = h_sqlite_statement_acquire(conn, query, &stmt);
   
   if (sql_result == SQLITE_OK) {
+    row_result = sqlite3_step(stmt);
     nb_columns = sqlite3_column_count(stmt);
     /* Filling j_result with results in json format */
-    *j_result = json_array();
-    if (*j_result == NULL) {
-      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for *j_result");
-      sqlite3_finalize(stmt);
+    if (h_json_result_init(j_result, &j_rows, options) != H_OK) {
+      h_sqlite_statement_release(conn, query, stmt);
       return H_ERROR_MEMORY;
     }
-    row_result = sqlite3_step(stmt);
+    for (col = 0; col < nb_columns; col++) {
+      h_json_result_add_column(*j_result, sqlite3_column_name(stmt, col));
+    }
     while (row_result == SQLITE_ROW) {
-      j_data = json_object();
+      j_data = h_json_row_new(options);
       if (j_data == NULL) {
         y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for j_data");
         json_decref(*j_result);
+        h_sqlite_statement_release(conn, query, stmt);
         return H_ERROR_MEMORY;
       }
       for (col = 0; col < nb_columns; col++) {
         switch (sqlite3_column_type(stmt, col)) {
           case SQLITE_INTEGER:
-            json_object_set_new(j_data, sqlite3_column_name(stmt, col), json_integer(sqlite3_column_int64(stmt, col)));
+            h_json_row_set(j_data, sqlite3_column_name(stmt, col), json_integer(sqlite3_column_int64(stmt, col)));
             break;
           case SQLITE_FLOAT:
-            json_object_set_new(j_data, sqlite3_column_name(stmt, col), json_real(sqlite3_column_double(stmt, col)));
+            h_json_row_set(j_data, sqlite3_column_name(stmt, col), json_real(sqlite3_column_double(stmt, col)));
             break;
           case SQLITE_BLOB:
             if ((col_bytes = sqlite3_column_bytes(stmt, col)) >= 0) {
-              json_object_set_new(j_data, sqlite3_column_name(stmt, col), json_stringn(sqlite3_column_blob(stmt, col), (size_t)col_bytes));
+              h_json_row_set(j_data, sqlite3_column_name(stmt, col), json_stringn(sqlite3_column_blob(stmt, col), (size_t)col_bytes));
             }
             break;
           case SQLITE3_TEXT:
-            json_object_set_new(j_data, sqlite3_column_name(stmt, col), json_string((char*)sqlite3_column_text(stmt, col)));
+            h_json_row_set(j_data, sqlite3_column_name(stmt, col), json_string((char*)sqlite3_column_text(stmt, col)));
             break;
           case SQLITE_NULL:
-            json_object_set_new(j_data, sqlite3_column_name(stmt, col), json_null());
           default:
+            h_json_row_set(j_data, sqlite3_column_name(stmt, col), json_null());
             break;
         }
       }
-      json_array_append_new(*j_result, j_data);
+      json_array_append_new(j_rows, j_data);
       j_data = NULL;
       row_result = sqlite3_step(stmt);
     }
-    sqlite3_finalize(stmt);
+    if (h_sqlite_check_done(conn, query, row_result) != H_OK) {
+      h_sqlite_statement_release(conn, query, stmt);
+      json_decref(*j_result);
+      *j_result = NULL;
+      return H_ERROR_QUERY;
+    }
+    h_sqlite_statement_release(conn, query, stmt);
     return H_OK;
   } else {
     y_log_message(Y_LOG_LEVEL_ERROR, "Error executing sql query");
@@ -318,7 +1087,7 @@ int h_execute_query_json_sqlite(const struct _h_connection * conn, const char *
                                    sqlite3_errcode(((struct _h_sqlite *)conn->connection)->db_handle), 
                                    sqlite3_errmsg(((struct _h_sqlite *)conn->connection)->db_handle));
     y_log_message(Y_LOG_LEVEL_DEBUG, "Query: \"%s\"", query);
-    sqlite3_finalize(stmt);
+    h_sqlite_statement_release(conn, query, stmt);
     return H_ERROR_QUERY;
   }
 }
@@ -338,6 +1107,19 @@ void h_close_sqlite(struct _h_connection * conn) {
   y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
 }
 
+int h_set_statement_cache_size_sqlite(const struct _h_connection * conn, unsigned int size) {
+  UNUSED(conn);
+  UNUSED(size);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_check_connection_sqlite(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
 char * h_escape_string_sqlite(const struct _h_connection * conn, const char * unsafe) {
   UNUSED(conn);
   UNUSED(unsafe);
@@ -358,6 +1140,132 @@ long long int h_last_insert_id_sqlite(const struct _h_connection * conn) {
   return 0;
 }
 
+size_t h_max_query_length_sqlite(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return 0;
+}
+
+int h_select_query_sqlite(const struct _h_connection * conn, const char * query, struct _h_result * result) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_select_query_options_sqlite(const struct _h_connection * conn, const char * query, struct _h_result * result, int options) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_execute_query_columnar_sqlite(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_execute_query_value_sqlite(const struct _h_connection * conn, const char * query, struct _h_value_result * result) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(result);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_cursor_open_sqlite(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_cursor_fetch_sqlite(struct _h_cursor * cursor) {
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+void h_cursor_get_cell_sqlite(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell) {
+  UNUSED(cursor);
+  UNUSED(col);
+  cell->type = HOEL_COL_TYPE_NULL;
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+}
+
+const char * h_cursor_get_name_sqlite(const struct _h_cursor * cursor, unsigned int col) {
+  UNUSED(cursor);
+  UNUSED(col);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return NULL;
+}
+
+void h_cursor_close_sqlite(struct _h_cursor * cursor) {
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+}
+
+int h_prepare_sqlite(const struct _h_connection * conn, const char * query, struct _h_statement * stmt) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_cursor_open_prepared_sqlite(struct _h_statement * stmt, struct _h_cursor * cursor) {
+  UNUSED(stmt);
+  UNUSED(cursor);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+void h_finalize_sqlite(struct _h_statement * stmt) {
+  UNUSED(stmt);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+}
+
+int h_bulk_insert_sqlite(const struct _h_connection * conn, const char * table, const json_t * j_values) {
+  UNUSED(conn);
+  UNUSED(table);
+  UNUSED(j_values);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_transaction_begin_sqlite(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_transaction_end_sqlite(const struct _h_connection * conn, int commit) {
+  UNUSED(conn);
+  UNUSED(commit);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_transaction_query_sqlite(const struct _h_connection * conn, const char * query) {
+  UNUSED(conn);
+  UNUSED(query);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
+int h_in_transaction_sqlite(const struct _h_connection * conn) {
+  UNUSED(conn);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return 0;
+}
+
 int h_execute_query_sqlite(const struct _h_connection * conn, const char * query) {
   UNUSED(conn);
   UNUSED(query);
@@ -373,4 +1281,13 @@ int h_execute_query_json_sqlite(const struct _h_connection * conn, const char *
   return H_ERROR;
 }
 
+int h_execute_query_json_options_sqlite(const struct _h_connection * conn, const char * query, json_t ** j_result, int options) {
+  UNUSED(conn);
+  UNUSED(query);
+  UNUSED(j_result);
+  UNUSED(options);
+  y_log_message(Y_LOG_LEVEL_ERROR, "Hoel was not compiled with SQLite backend");
+  return H_ERROR;
+}
+
 #endif
@@ -22,6 +22,10 @@
  */
 #include <ctype.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <unistd.h>
 
 #include "hoel.h"
 #include "h-private.h"
@@ -39,6 +43,7 @@ void h_free(void * data) {
  */
 int h_close_db(struct _h_connection * conn) {
   if (conn != NULL && conn->connection != NULL) {
+    h_json_cache_clean(conn);
     if (0) {
       /* Not happening */
       return H_ERROR_PARAMS;
@@ -65,6 +70,75 @@ int h_close_db(struct _h_connection * conn) {
   }
 }
 
+/**
+ * h_set_statement_cache_size
+ * Set the maximum number of prepared statements kept in the statement cache of the connection
+ * and in the cache of the statements prepared by h_select, h_update and h_delete
+ * return H_OK on success
+ */
+int h_set_statement_cache_size(const struct _h_connection * conn, unsigned int size) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      if (h_set_statement_cache_size_sqlite(conn, size) != H_OK) {
+        return H_ERROR;
+      }
+      return h_json_cache_set_size(conn, size);
+#endif
+    } else {
+      return h_json_cache_set_size(conn, size);
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_get_statement_cache_stats
+ * Get the number of statements reused from the cache of the statements prepared by h_select, h_update and h_delete,
+ * and the number of statements prepared for this cache
+ * return H_OK on success
+ */
+int h_get_statement_cache_stats(const struct _h_connection * conn, unsigned long * nb_hits, unsigned long * nb_prepared) {
+  if (conn != NULL && conn->connection != NULL && nb_hits != NULL && nb_prepared != NULL) {
+    return h_json_cache_get_stats(conn, nb_hits, nb_prepared);
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_check_connection
+ * Check a database connection before it's used again
+ * return H_OK on success
+ */
+int h_check_connection(const struct _h_connection * conn) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_check_connection_sqlite(conn);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_check_connection_mariadb(conn);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_check_connection_pgsql(conn);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
 /**
  * h_escape_string
  * Escapes a string
@@ -133,6 +207,8 @@ char * h_escape_string_with_quotes(const struct _h_connection * conn, const char
  * H_OPTION_NONE (0): no option
  * H_OPTION_SELECT: Execute a prepare statement (sqlite only)
  * H_OPTION_EXEC: Execute an exec statement (sqlite only)
+ * H_OPTION_ARENA: Allocate the rows and values of the result in an arena
+ * H_OPTION_BINARY: Receive the values in binary format (PostgreSQL and MariaDB only)
  * return H_OK on success
  */
 int h_execute_query(const struct _h_connection * conn, const char * query, struct _h_result * result, int options) {
@@ -146,18 +222,18 @@ int h_execute_query(const struct _h_connection * conn, const char * query, struc
       if (options & H_OPTION_EXEC) {
         return h_execute_query_sqlite(conn, query);
       } else {
-        return h_select_query_sqlite(conn, query, result);
+        return h_select_query_options_sqlite(conn, query, result, options);
       }
 #else
       UNUSED(options);
 #endif
 #ifdef _HOEL_MARIADB
     } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
-      return h_execute_query_mariadb(conn, query, result);
+      return h_execute_query_options_mariadb(conn, query, result, options);
 #endif
 #ifdef _HOEL_PGSQL
     } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
-      return h_execute_query_pgsql(conn, query, result);
+      return h_execute_query_options_pgsql(conn, query, result, options);
 #endif
     } else {
       return H_ERROR_PARAMS;
@@ -168,26 +244,25 @@ int h_execute_query(const struct _h_connection * conn, const char * query, struc
 }
 
 /**
- * h_execute_query_json
- * Execute a query, set the returned values in the json result
+ * h_execute_query_columnar
+ * Execute a query, set the columnar result structure with the returned values
  * return H_OK on success
  */
-int h_execute_query_json(const struct _h_connection * conn, const char * query, json_t ** j_result) {
-  if (conn != NULL && conn->connection != NULL && query != NULL && j_result != NULL) {
+int h_execute_query_columnar(const struct _h_connection * conn, const char * query, struct _h_result_columnar * result) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && result != NULL) {
     if (0) {
       /* Not happening */
-      return H_ERROR_PARAMS;
 #ifdef _HOEL_SQLITE
     } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
-      return h_execute_query_json_sqlite(conn, query, j_result);
+      return h_execute_query_columnar_sqlite(conn, query, result);
 #endif
 #ifdef _HOEL_MARIADB
     } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
-      return h_execute_query_json_mariadb(conn, query, j_result);
+      return h_execute_query_columnar_mariadb(conn, query, result);
 #endif
 #ifdef _HOEL_PGSQL
     } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
-      return h_execute_query_json_pgsql(conn, query, j_result);
+      return h_execute_query_columnar_pgsql(conn, query, result);
 #endif
     } else {
       return H_ERROR_PARAMS;
@@ -198,212 +273,2290 @@ int h_execute_query_json(const struct _h_connection * conn, const char * query,
 }
 
 /**
- * Add a new struct _h_data * to an array of struct _h_data *, which already has cols columns
+ * h_execute_query_value
+ * Execute a query, set the value result structure with the returned values
  * return H_OK on success
  */
-int h_row_add_data(struct _h_data ** row, struct _h_data * data, int cols) {
-  struct _h_data * tmp = o_realloc(*row, ((size_t)cols+1)*sizeof(struct _h_data));
-  * row = tmp;
-  if (tmp == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for h_row_add_data");
-    return H_ERROR_MEMORY;
-  } else {
-    switch (data->type) {
-      case HOEL_COL_TYPE_INT:
-        tmp[cols].type = HOEL_COL_TYPE_INT;
-        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_int));
-        if (tmp[cols].t_data == NULL) {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
-          return H_ERROR_MEMORY;
-        } else {
-          ((struct _h_type_int *)tmp[cols].t_data)->value = ((struct _h_type_int *)data->t_data)->value;
-          return H_OK;
-        }
-        break;
-      case HOEL_COL_TYPE_DOUBLE:
-        tmp[cols].type = HOEL_COL_TYPE_DOUBLE;
-        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_double));
-        if (tmp[cols].t_data == NULL) {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
-          return H_ERROR_MEMORY;
-        } else {
-          ((struct _h_type_double *)tmp[cols].t_data)->value = ((struct _h_type_double *)data->t_data)->value;
-          return H_OK;
-        }
-        break;
-      case HOEL_COL_TYPE_TEXT:
-        tmp[cols].type = HOEL_COL_TYPE_TEXT;
-        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_text));
-        if (tmp[cols].t_data == NULL) {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
-          return H_ERROR_MEMORY;
-        } else {
-          ((struct _h_type_text *)tmp[cols].t_data)->value = o_malloc(((struct _h_type_text *)data->t_data)->length+sizeof(char));
-          if (((struct _h_type_text *)tmp[cols].t_data)->value == NULL) {
-            y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for ((struct _h_type_text *)tmp[cols].t_data)->value");
-            h_free(tmp[cols].t_data);
-            return H_ERROR_MEMORY;
-          }
-          memcpy(((struct _h_type_text *)tmp[cols].t_data)->value, ((struct _h_type_text *)data->t_data)->value, (((struct _h_type_text *)data->t_data)->length+1));
-          ((struct _h_type_text *)tmp[cols].t_data)->length = ((struct _h_type_text *)data->t_data)->length;
-          return H_OK;
-        }
-        break;
-      case HOEL_COL_TYPE_BLOB:
-        tmp[cols].type = HOEL_COL_TYPE_BLOB;
-        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_blob));
-        if (tmp[cols].t_data == NULL) {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
-          return H_ERROR_MEMORY;
-        } else {
-          ((struct _h_type_blob *)tmp[cols].t_data)->length = ((struct _h_type_blob *)data->t_data)->length;
-          ((struct _h_type_blob *)tmp[cols].t_data)->value = o_malloc(((struct _h_type_blob *)data->t_data)->length);
-          if (((struct _h_type_blob *)tmp[cols].t_data)->value == NULL) {
-            y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for ((struct _h_type_blob *)tmp[cols].t_data)->value");
-            h_free(tmp[cols].t_data);
-            return H_ERROR_MEMORY;
-          }
-          memcpy(((struct _h_type_blob *)tmp[cols].t_data)->value, ((struct _h_type_blob *)data->t_data)->value, ((struct _h_type_blob *)data->t_data)->length);
-          return H_OK;
-        }
-        break;
-      case HOEL_COL_TYPE_DATE:
-        tmp[cols].type = HOEL_COL_TYPE_DATE;
-        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_datetime));
-        if (tmp[cols].t_data == NULL) {
-          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
-          return H_ERROR_MEMORY;
-        } else {
-          ((struct _h_type_datetime *)tmp[cols].t_data)->value = ((struct _h_type_datetime *)data->t_data)->value;
-          return H_OK;
-        }
-        break;
-      case HOEL_COL_TYPE_NULL:
-        tmp[cols].type = HOEL_COL_TYPE_NULL;
-        tmp[cols].t_data = NULL;
-        break;
-      default:
-        return H_ERROR_PARAMS;
-        break;
+int h_execute_query_value(const struct _h_connection * conn, const char * query, struct _h_value_result * result) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && result != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_execute_query_value_sqlite(conn, query, result);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_execute_query_value_mariadb(conn, query, result);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_execute_query_value_pgsql(conn, query, result);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
     }
-    return H_OK;
-  }
-}
-
-/**
- * Add a new row of struct _h_data * in a struct _h_result *
- * return H_OK on success
- */
-int h_result_add_row(struct _h_result * result, struct _h_data * row, int rows) {
-  result->data = o_realloc(result->data, ((size_t)rows+1)*sizeof(struct _h_data *));
-  if (result->data == NULL) {
-    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for result->data");
-    return H_ERROR_MEMORY;
   } else {
-    result->data[rows] = row;
-    result->nb_rows++;
-    return H_OK;
+    return H_ERROR_PARAMS;
   }
 }
 
 /**
- * h_query_insert
- * Execute an insert query
+ * h_execute_query_view
+ * Execute a query, set the result view with the returned values
  * return H_OK on success
  */
-int h_query_insert(const struct _h_connection * conn, const char * query) {
-  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "insert") != NULL) {
-    return h_execute_query(conn, query, NULL, H_OPTION_EXEC);
+int h_execute_query_view(const struct _h_connection * conn, const char * query, struct _h_result_view * view) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && view != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_execute_query_view_mariadb(conn, query, view);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_execute_query_view_pgsql(conn, query, view);
+#endif
+    } else {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - h_execute_query_view - Result views are not available for this database type");
+      return H_ERROR_PARAMS;
+    }
   } else {
     return H_ERROR_PARAMS;
   }
 }
 
 /**
- * h_query_last_insert_id
- * return the id of the last inserted value
+ * h_cursor_open
+ * Execute a query and open a cursor on the rows returned
  * return H_OK on success
  */
-struct _h_data * h_query_last_insert_id(const struct _h_connection * conn) {
-  struct _h_data * data = NULL;
-  if (conn != NULL && conn->connection != NULL) {
+int h_cursor_open(const struct _h_connection * conn, const char * query, struct _h_cursor * cursor) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && cursor != NULL) {
+    cursor->conn = conn;
+    cursor->statement = NULL;
+    cursor->nb_columns = 0;
+    cursor->end = 0;
+    cursor->handle = NULL;
     if (0) {
       /* Not happening */
 #ifdef _HOEL_SQLITE
     } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
-      long long int last_id = h_last_insert_id_sqlite(conn);
-      if (last_id > 0) {
-        data = h_new_data_int(last_id);
-      } else {
-        data = h_new_data_null();
-      }
+      return h_cursor_open_sqlite(conn, query, cursor);
 #endif
 #ifdef _HOEL_MARIADB
     } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
-      long long int last_id = h_last_insert_id_mariadb(conn);
-      if (last_id > 0) {
-        data = h_new_data_int(last_id);
-      } else {
-        data = h_new_data_null();
-      }
+      return h_cursor_open_mariadb(conn, query, cursor);
 #endif
 #ifdef _HOEL_PGSQL
     } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
-      long long int last_id = h_last_insert_id_pgsql(conn);
-      if (last_id > 0) {
-        data = h_new_data_int(last_id);
-      } else {
-        data = h_new_data_null();
-      }
+      return h_cursor_open_pgsql(conn, query, cursor);
 #endif
     } else {
-      data = h_new_data_null();
+      return H_ERROR_PARAMS;
     }
+  } else {
+    return H_ERROR_PARAMS;
   }
-  return data;
 }
 
 /**
- * h_query_update
- * Execute an update query
- * return H_OK on success
+ * Read the next row of the cursor
+ * return H_OK on success, cursor->end is set if there's no more row
  */
-int h_query_update(const struct _h_connection * conn, const char * query) {
-  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "update") != NULL) {
-    return h_execute_query(conn, query, NULL, H_OPTION_EXEC);
+static int h_cursor_fetch(struct _h_cursor * cursor) {
+  if (cursor->end) {
+    return H_OK;
+#ifdef _HOEL_SQLITE
+  } else if (cursor->conn->type == HOEL_DB_TYPE_SQLITE) {
+    return h_cursor_fetch_sqlite(cursor);
+#endif
+#ifdef _HOEL_MARIADB
+  } else if (cursor->conn->type == HOEL_DB_TYPE_MARIADB) {
+    return h_cursor_fetch_mariadb(cursor);
+#endif
+#ifdef _HOEL_PGSQL
+  } else if (cursor->conn->type == HOEL_DB_TYPE_PGSQL) {
+    return h_cursor_fetch_pgsql(cursor);
+#endif
   } else {
     return H_ERROR_PARAMS;
   }
 }
 
 /**
- * h_query_delete
- * Execute an delete query
- * return H_OK on success
+ * Decode the value of the column col in the current row of the cursor
  */
-int h_query_delete(const struct _h_connection * conn, const char * query) {
-  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "delete") != NULL) {
-    return h_execute_query(conn, query, NULL, H_OPTION_EXEC);
+static void h_cursor_get_cell(const struct _h_cursor * cursor, unsigned int col, struct _h_cell * cell) {
+  cell->type = HOEL_COL_TYPE_NULL;
+  if (0) {
+    /* Not happening */
+#ifdef _HOEL_SQLITE
+  } else if (cursor->conn->type == HOEL_DB_TYPE_SQLITE) {
+    h_cursor_get_cell_sqlite(cursor, col, cell);
+#endif
+#ifdef _HOEL_MARIADB
+  } else if (cursor->conn->type == HOEL_DB_TYPE_MARIADB) {
+    h_cursor_get_cell_mariadb(cursor, col, cell);
+#endif
+#ifdef _HOEL_PGSQL
+  } else if (cursor->conn->type == HOEL_DB_TYPE_PGSQL) {
+    h_cursor_get_cell_pgsql(cursor, col, cell);
+#endif
   } else {
-    return H_ERROR_PARAMS;
+    UNUSED(cursor);
+    UNUSED(col);
   }
 }
 
 /**
- * h_query_select
- * Execute a select query, set the result structure with the returned values
- * return H_OK on success
+ * Return the name of the column col of the cursor
  */
-int h_query_select(const struct _h_connection * conn, const char * query, struct _h_result * result) {
-  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "select") != NULL) {
-    return h_execute_query(conn, query, result, H_OPTION_SELECT);
+static const char * h_cursor_get_name(const struct _h_cursor * cursor, unsigned int col) {
+  if (0) {
+    /* Not happening */
+#ifdef _HOEL_SQLITE
+  } else if (cursor->conn->type == HOEL_DB_TYPE_SQLITE) {
+    return h_cursor_get_name_sqlite(cursor, col);
+#endif
+#ifdef _HOEL_MARIADB
+  } else if (cursor->conn->type == HOEL_DB_TYPE_MARIADB) {
+    return h_cursor_get_name_mariadb(cursor, col);
+#endif
+#ifdef _HOEL_PGSQL
+  } else if (cursor->conn->type == HOEL_DB_TYPE_PGSQL) {
+    return h_cursor_get_name_pgsql(cursor, col);
+#endif
   } else {
-    return H_ERROR_PARAMS;
+    UNUSED(cursor);
+    UNUSED(col);
   }
+  return NULL;
 }
 
 /**
- * h_query_select_json
+ * h_cursor_next
+ * Read the next rows of the cursor in a struct _h_result
+ * return H_OK on success
+ */
+int h_cursor_next(struct _h_cursor * cursor, struct _h_result * result, unsigned int max_rows) {
+  struct _h_data * cur_row = NULL;
+  struct _h_cell cell;
+  unsigned int col, row;
+  int ret;
+  
+  if (cursor != NULL && cursor->conn != NULL && result != NULL && max_rows) {
+    if ((ret = h_result_init(result, cursor->nb_columns, H_OPTION_NONE)) != H_OK) {
+      return ret;
+    }
+    for (row=0; ret == H_OK && row<max_rows; row++) {
+      if ((ret = h_cursor_fetch(cursor)) != H_OK || cursor->end) {
+        break;
+      }
+      ret = h_result_new_row(result, &cur_row);
+      for (col=0; ret == H_OK && col<cursor->nb_columns; col++) {
+        h_cursor_get_cell(cursor, col, &cell);
+        ret = h_result_set_cell(result, &cur_row[col], &cell);
+      }
+    }
+    if (ret != H_OK) {
+      h_clean_result(result);
+    }
+    return ret;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_cursor_next_json
+ * Read the next rows of the cursor in a json array
+ * return H_OK on success
+ */
+int h_cursor_next_json(struct _h_cursor * cursor, json_t ** j_result, unsigned int max_rows) {
+  struct _h_cell cell;
+  unsigned int col, row;
+  json_t * j_data;
+  int ret = H_OK;
+  
+  if (cursor != NULL && cursor->conn != NULL && j_result != NULL && max_rows) {
+    if ((* j_result = json_array()) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for *j_result");
+      return H_ERROR_MEMORY;
+    }
+    for (row=0; ret == H_OK && row<max_rows; row++) {
+      if ((ret = h_cursor_fetch(cursor)) != H_OK || cursor->end) {
+        break;
+      }
+      if ((j_data = json_object()) == NULL) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for j_data");
+        ret = H_ERROR_MEMORY;
+      } else {
+        for (col=0; col<cursor->nb_columns; col++) {
+          h_cursor_get_cell(cursor, col, &cell);
+          json_object_set_new(j_data, h_cursor_get_name(cursor, col), h_cell_to_json(&cell));
+        }
+        json_array_append_new(* j_result, j_data);
+      }
+    }
+    if (ret != H_OK) {
+      json_decref(* j_result);
+      * j_result = NULL;
+    }
+    return ret;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_cursor_close
+ * Close the cursor, the rows not read are discarded
+ * return H_OK on success
+ */
+int h_cursor_close(struct _h_cursor * cursor) {
+  if (cursor != NULL && cursor->conn != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_SQLITE
+    } else if (cursor->conn->type == HOEL_DB_TYPE_SQLITE) {
+      h_cursor_close_sqlite(cursor);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (cursor->conn->type == HOEL_DB_TYPE_MARIADB) {
+      h_cursor_close_mariadb(cursor);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (cursor->conn->type == HOEL_DB_TYPE_PGSQL) {
+      h_cursor_close_pgsql(cursor);
+#endif
+    }
+    cursor->conn = NULL;
+    cursor->statement = NULL;
+    cursor->handle = NULL;
+    cursor->end = 1;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_prepare
+ * Prepare a query on the database
+ * return H_OK on success
+ */
+int h_prepare(const struct _h_connection * conn, const char * query, struct _h_statement * stmt) {
+  unsigned int i;
+  int ret;
+  
+  if (conn != NULL && conn->connection != NULL && query != NULL && stmt != NULL) {
+    stmt->conn = conn;
+    stmt->nb_params = 0;
+    stmt->params = NULL;
+    stmt->handle = NULL;
+    if (0) {
+      /* Not happening */
+      ret = H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      ret = h_prepare_sqlite(conn, query, stmt);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      ret = h_prepare_mariadb(conn, query, stmt);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      ret = h_prepare_pgsql(conn, query, stmt);
+#endif
+    } else {
+      ret = H_ERROR_PARAMS;
+    }
+    if (ret == H_OK && stmt->nb_params) {
+      if ((stmt->params = o_malloc(stmt->nb_params*sizeof(struct _h_value))) != NULL) {
+        memset(stmt->params, 0, stmt->nb_params*sizeof(struct _h_value));
+        for (i=0; i<stmt->nb_params; i++) {
+          stmt->params[i].type = HOEL_COL_TYPE_NULL;
+        }
+      } else {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for stmt->params");
+        h_finalize(stmt);
+        ret = H_ERROR_MEMORY;
+      }
+    }
+    if (ret != H_OK) {
+      stmt->conn = NULL;
+    }
+    return ret;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * Return the parameter index of the statement, after freeing its previous value
+ * return NULL if index is out of range
+ */
+static struct _h_value * h_statement_get_param(struct _h_statement * stmt, unsigned int index) {
+  struct _h_value * param;
+  
+  if (stmt != NULL && stmt->conn != NULL && index > 0 && index <= stmt->nb_params) {
+    param = &stmt->params[index-1];
+    if ((param->type == HOEL_COL_TYPE_TEXT || param->type == HOEL_COL_TYPE_BLOB) && param->length > H_VALUE_INLINE_LENGTH) {
+      h_free(param->v.ptr);
+    }
+    param->type = HOEL_COL_TYPE_NULL;
+    param->length = 0;
+    return param;
+  } else {
+    return NULL;
+  }
+}
+
+/**
+ * Copy a text or blob value in the parameter
+ * return H_OK on success
+ */
+static int h_statement_set_param_bytes(struct _h_value * param, int type, const void * value, size_t length) {
+  char * dest;
+  
+  if (length > H_VALUE_INLINE_LENGTH) {
+    if ((param->v.ptr = o_malloc(length+1)) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for param->v.ptr");
+      return H_ERROR_MEMORY;
+    }
+    dest = param->v.ptr;
+  } else {
+    dest = param->v.text;
+  }
+  if (length) {
+    memcpy(dest, value, length);
+  }
+  dest[length] = '\0';
+  param->type = type;
+  param->length = length;
+  return H_OK;
+}
+
+/**
+ * h_bind_int
+ * Bind an integer value to the parameter index of the statement
+ * return H_OK on success
+ */
+int h_bind_int(struct _h_statement * stmt, unsigned int index, long long int value) {
+  struct _h_value * param = h_statement_get_param(stmt, index);
+  
+  if (param != NULL) {
+    param->type = HOEL_COL_TYPE_INT;
+    param->v.i_value = value;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_bind_double
+ * Bind a double value to the parameter index of the statement
+ * return H_OK on success
+ */
+int h_bind_double(struct _h_statement * stmt, unsigned int index, double value) {
+  struct _h_value * param = h_statement_get_param(stmt, index);
+  
+  if (param != NULL) {
+    param->type = HOEL_COL_TYPE_DOUBLE;
+    param->v.d_value = value;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_bind_text
+ * Bind a text value to the parameter index of the statement, a NULL value binds null
+ * return H_OK on success
+ */
+int h_bind_text(struct _h_statement * stmt, unsigned int index, const char * value) {
+  struct _h_value * param = h_statement_get_param(stmt, index);
+  
+  if (param != NULL) {
+    if (value != NULL) {
+      return h_statement_set_param_bytes(param, HOEL_COL_TYPE_TEXT, value, o_strlen(value));
+    } else {
+      return H_OK;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_bind_blob
+ * Bind a blob value to the parameter index of the statement, a NULL value binds null
+ * return H_OK on success
+ */
+int h_bind_blob(struct _h_statement * stmt, unsigned int index, const void * value, size_t length) {
+  struct _h_value * param = h_statement_get_param(stmt, index);
+  
+  if (param != NULL) {
+    if (value != NULL) {
+      return h_statement_set_param_bytes(param, HOEL_COL_TYPE_BLOB, value, length);
+    } else {
+      return H_OK;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_bind_null
+ * Bind a null value to the parameter index of the statement
+ * return H_OK on success
+ */
+int h_bind_null(struct _h_statement * stmt, unsigned int index) {
+  if (h_statement_get_param(stmt, index) != NULL) {
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_cursor_open_prepared
+ * Execute a prepared statement with the values bound and open a cursor on the rows returned
+ * return H_OK on success
+ */
+int h_cursor_open_prepared(struct _h_statement * stmt, struct _h_cursor * cursor) {
+  if (stmt != NULL && stmt->conn != NULL && cursor != NULL) {
+    cursor->conn = stmt->conn;
+    cursor->statement = stmt;
+    cursor->nb_columns = 0;
+    cursor->end = 0;
+    cursor->handle = NULL;
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_SQLITE
+    } else if (stmt->conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_cursor_open_prepared_sqlite(stmt, cursor);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (stmt->conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_cursor_open_prepared_mariadb(stmt, cursor);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (stmt->conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_cursor_open_prepared_pgsql(stmt, cursor);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_execute_prepared
+ * Execute a prepared statement with the values bound, set the result structure with the returned values
+ * return H_OK on success
+ */
+int h_execute_prepared(struct _h_statement * stmt, struct _h_result * result) {
+  struct _h_cursor cursor;
+  int ret;
+  
+  if ((ret = h_cursor_open_prepared(stmt, &cursor)) == H_OK) {
+    if (result != NULL) {
+      ret = h_cursor_next(&cursor, result, UINT_MAX);
+    } else {
+      do {
+        ret = h_cursor_fetch(&cursor);
+      } while (ret == H_OK && !cursor.end);
+    }
+    h_cursor_close(&cursor);
+  }
+  return ret;
+}
+
+/**
+ * h_execute_prepared_json
+ * Execute a prepared statement with the values bound, set the returned values in the json result
+ * return H_OK on success
+ */
+int h_execute_prepared_json(struct _h_statement * stmt, json_t ** j_result) {
+  struct _h_cursor cursor;
+  int ret;
+  
+  if (j_result == NULL) {
+    return H_ERROR_PARAMS;
+  } else if ((ret = h_cursor_open_prepared(stmt, &cursor)) == H_OK) {
+    ret = h_cursor_next_json(&cursor, j_result, UINT_MAX);
+    h_cursor_close(&cursor);
+  }
+  return ret;
+}
+
+/**
+ * h_finalize
+ * Free the prepared statement and the values bound
+ * return H_OK on success
+ */
+int h_finalize(struct _h_statement * stmt) {
+  unsigned int i;
+  
+  if (stmt != NULL && stmt->conn != NULL) {
+    if (stmt->handle != NULL) {
+      if (0) {
+        /* Not happening */
+#ifdef _HOEL_SQLITE
+      } else if (stmt->conn->type == HOEL_DB_TYPE_SQLITE) {
+        h_finalize_sqlite(stmt);
+#endif
+#ifdef _HOEL_MARIADB
+      } else if (stmt->conn->type == HOEL_DB_TYPE_MARIADB) {
+        h_finalize_mariadb(stmt);
+#endif
+#ifdef _HOEL_PGSQL
+      } else if (stmt->conn->type == HOEL_DB_TYPE_PGSQL) {
+        h_finalize_pgsql(stmt);
+#endif
+      }
+    }
+    for (i=1; i<=stmt->nb_params && stmt->params != NULL; i++) {
+      h_statement_get_param(stmt, i);
+    }
+    h_free(stmt->params);
+    stmt->conn = NULL;
+    stmt->nb_params = 0;
+    stmt->params = NULL;
+    stmt->handle = NULL;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * Size of the buffer used to write the json stream
+ */
+#define H_JSON_STREAM_BUFFER_SIZE 4096
+
+/**
+ * Buffered json text writer
+ * ret is set to H_ERROR if the write callback has failed
+ */
+struct _h_json_stream {
+  h_json_stream_write write_cb;
+  void              * user_data;
+  char                buffer[H_JSON_STREAM_BUFFER_SIZE];
+  size_t              length;
+  int                 ret;
+};
+
+/**
+ * Send the buffered data to the write callback
+ */
+static void h_json_stream_flush(struct _h_json_stream * stream) {
+  if (stream->ret == H_OK && stream->length) {
+    if (stream->write_cb(stream->buffer, stream->length, stream->user_data)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error write_cb");
+      stream->ret = H_ERROR;
+    }
+  }
+  stream->length = 0;
+}
+
+/**
+ * Append data to the json stream
+ */
+static void h_json_stream_append(struct _h_json_stream * stream, const char * data, size_t length) {
+  if (stream->length + length > H_JSON_STREAM_BUFFER_SIZE) {
+    h_json_stream_flush(stream);
+  }
+  if (length >= H_JSON_STREAM_BUFFER_SIZE) {
+    if (stream->ret == H_OK && stream->write_cb(data, length, stream->user_data)) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error write_cb");
+      stream->ret = H_ERROR;
+    }
+  } else {
+    memcpy(stream->buffer + stream->length, data, length);
+    stream->length += length;
+  }
+}
+
+/**
+ * Append a json string to the json stream
+ * value is escaped, the bytes are written as is, so they must be valid UTF-8
+ */
+static void h_json_stream_append_string(struct _h_json_stream * stream, const char * value, size_t length) {
+  static const char hex[] = "0123456789abcdef";
+  char escaped[6] = {'\\', 'u', '0', '0', '0', '0'};
+  size_t i, start = 0;
+  unsigned char c;
+  
+  h_json_stream_append(stream, "\"", 1);
+  for (i=0; i<length; i++) {
+    c = (unsigned char)value[i];
+    if (c < 0x20 || c == '"' || c == '\\') {
+      h_json_stream_append(stream, value+start, i-start);
+      switch (c) {
+        case '"':
+          h_json_stream_append(stream, "\\\"", 2);
+          break;
+        case '\\':
+          h_json_stream_append(stream, "\\\\", 2);
+          break;
+        case '\b':
+          h_json_stream_append(stream, "\\b", 2);
+          break;
+        case '\f':
+          h_json_stream_append(stream, "\\f", 2);
+          break;
+        case '\n':
+          h_json_stream_append(stream, "\\n", 2);
+          break;
+        case '\r':
+          h_json_stream_append(stream, "\\r", 2);
+          break;
+        case '\t':
+          h_json_stream_append(stream, "\\t", 2);
+          break;
+        default:
+          escaped[4] = hex[c >> 4];
+          escaped[5] = hex[c & 0x0f];
+          h_json_stream_append(stream, escaped, 6);
+          break;
+      }
+      start = i+1;
+    }
+  }
+  h_json_stream_append(stream, value+start, length-start);
+  h_json_stream_append(stream, "\"", 1);
+}
+
+/**
+ * Append a blob to the json stream as a json string, hex-encoded with the prefix \x
+ * like the PostgreSQL bytea values in text format
+ */
+static void h_json_stream_append_blob(struct _h_json_stream * stream, const unsigned char * value, size_t length) {
+  static const char hex[] = "0123456789abcdef";
+  char encoded[128];
+  size_t i, len = 0;
+  
+  h_json_stream_append(stream, "\"\\\\x", 4);
+  for (i=0; i<length; i++) {
+    encoded[len++] = hex[value[i] >> 4];
+    encoded[len++] = hex[value[i] & 0x0f];
+    if (len == sizeof(encoded)) {
+      h_json_stream_append(stream, encoded, len);
+      len = 0;
+    }
+  }
+  h_json_stream_append(stream, encoded, len);
+  h_json_stream_append(stream, "\"", 1);
+}
+
+/**
+ * Append a decoded column value to the json stream
+ * the values are written the same way as h_cell_to_json,
+ * except the blob values which are hex-encoded if hex_blob is set
+ */
+static void h_json_stream_append_cell(struct _h_json_stream * stream, const struct _h_cell * cell, int hex_blob) {
+  char str_value[64] = {0};
+  int len;
+  
+  switch (cell->type) {
+    case HOEL_COL_TYPE_INT:
+      len = snprintf(str_value, sizeof(str_value), "%lld", cell->i_value);
+      h_json_stream_append(stream, str_value, (size_t)len);
+      break;
+    case HOEL_COL_TYPE_DOUBLE:
+      if (isfinite(cell->d_value)) {
+        len = snprintf(str_value, sizeof(str_value), "%.17g", cell->d_value);
+        h_json_stream_append(stream, str_value, (size_t)len);
+        if (strpbrk(str_value, ".e") == NULL) {
+          h_json_stream_append(stream, ".0", 2);
+        }
+      } else {
+        h_json_stream_append(stream, "null", 4);
+      }
+      break;
+    case HOEL_COL_TYPE_BLOB:
+      if (hex_blob) {
+        h_json_stream_append_blob(stream, (const unsigned char *)cell->value, cell->length);
+      } else {
+        h_json_stream_append_string(stream, cell->value, cell->length);
+      }
+      break;
+    case HOEL_COL_TYPE_TEXT:
+      h_json_stream_append_string(stream, cell->value, cell->length);
+      break;
+    case HOEL_COL_TYPE_DATE:
+      strftime(str_value, sizeof(str_value), "%Y-%m-%dT%H:%M:%S", &cell->dt_value);
+      h_json_stream_append_string(stream, str_value, o_strlen(str_value));
+      break;
+    default:
+      h_json_stream_append(stream, "null", 4);
+      break;
+  }
+}
+
+/**
+ * h_query_select_json_stream
+ * Execute a select query and write the rows returned as a json array to the write callback
+ * return H_OK on success
+ */
+int h_query_select_json_stream(const struct _h_connection * conn, const char * query, h_json_stream_write write_cb, void * user_data) {
+  struct _h_json_stream stream;
+  struct _h_cursor cursor;
+  struct _h_cell cell;
+  const char * name;
+  unsigned int col, row = 0;
+  int ret, hex_blob;
+  
+  if (conn != NULL && conn->connection != NULL && query != NULL && write_cb != NULL) {
+    /* The pgsql cursors read the bytea values in text format, so they're already hex-encoded */
+    hex_blob = conn->type != HOEL_DB_TYPE_PGSQL;
+    if ((ret = h_cursor_open(conn, query, &cursor)) == H_OK) {
+      stream.write_cb = write_cb;
+      stream.user_data = user_data;
+      stream.length = 0;
+      stream.ret = H_OK;
+      h_json_stream_append(&stream, "[", 1);
+      while (stream.ret == H_OK && (ret = h_cursor_fetch(&cursor)) == H_OK && !cursor.end) {
+        if (row++) {
+          h_json_stream_append(&stream, ",", 1);
+        }
+        h_json_stream_append(&stream, "{", 1);
+        for (col=0; col<cursor.nb_columns; col++) {
+          if (col) {
+            h_json_stream_append(&stream, ",", 1);
+          }
+          name = h_cursor_get_name(&cursor, col);
+          h_json_stream_append_string(&stream, name, o_strlen(name));
+          h_json_stream_append(&stream, ":", 1);
+          h_cursor_get_cell(&cursor, col, &cell);
+          h_json_stream_append_cell(&stream, &cell, hex_blob);
+        }
+        h_json_stream_append(&stream, "}", 1);
+      }
+      if (ret == H_OK) {
+        h_json_stream_append(&stream, "]", 1);
+        h_json_stream_flush(&stream);
+        ret = stream.ret;
+      }
+      h_cursor_close(&cursor);
+    }
+    return ret;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * Write callback to a file descriptor
+ */
+static int h_json_stream_write_fd(const char * buffer, size_t size, void * user_data) {
+  int fd = *(int *)user_data;
+  ssize_t written;
+  
+  while (size) {
+    if ((written = write(fd, buffer, size)) < 0) {
+      if (errno != EINTR) {
+        return -1;
+      }
+    } else {
+      buffer += written;
+      size -= (size_t)written;
+    }
+  }
+  return 0;
+}
+
+/**
+ * h_query_select_json_fd
+ * Execute a select query and write the rows returned as a json array to the file descriptor fd
+ * return H_OK on success
+ */
+int h_query_select_json_fd(const struct _h_connection * conn, const char * query, int fd) {
+  if (fd >= 0) {
+    return h_query_select_json_stream(conn, query, h_json_stream_write_fd, &fd);
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_async_send
+ * Send a query without waiting for its result
+ * return H_OK on success
+ */
+int h_async_send(const struct _h_connection * conn, const char * query) {
+  if (conn != NULL && conn->connection != NULL && query != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_async_send_mariadb(conn, query);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_async_send_pgsql(conn, query);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_async_send_prepared
+ * Send a prepared statement with the values bound without waiting for its result
+ * return H_OK on success
+ */
+int h_async_send_prepared(struct _h_statement * stmt) {
+  if (stmt != NULL && stmt->conn != NULL && stmt->handle != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_PGSQL
+    } else if (stmt->conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_async_send_prepared_pgsql(stmt);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_async_poll
+ * Read the data available for the asynchronous query
+ * return H_OK if the result is ready, H_AGAIN if it's not
+ */
+int h_async_poll(const struct _h_connection * conn) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_async_poll_mariadb(conn);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_async_poll_pgsql(conn);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_async_get_result
+ * Read the result of the asynchronous query
+ * if result is NULL, the result is read but no value will be returned
+ * return H_OK on success
+ */
+int h_async_get_result(const struct _h_connection * conn, struct _h_result * result) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_async_get_result_mariadb(conn, result, H_OPTION_NONE);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_async_get_result_pgsql(conn, result, H_OPTION_NONE);
+#endif
+    } else {
+      UNUSED(result);
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_async_get_result_json
+ * Read the result of the asynchronous query as a json array
+ * return H_OK on success
+ */
+int h_async_get_result_json(const struct _h_connection * conn, json_t ** j_result) {
+  if (conn != NULL && conn->connection != NULL && j_result != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_async_get_result_json_mariadb(conn, j_result, H_OPTION_NONE);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_async_get_result_json_pgsql(conn, j_result, H_OPTION_NONE);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_pipeline_begin
+ * Enter pipeline mode
+ * return H_OK on success
+ */
+int h_pipeline_begin(const struct _h_connection * conn) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_pipeline_begin_pgsql(conn);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_pipeline_queue
+ * Queue a query in the pipeline
+ * return H_OK on success
+ */
+int h_pipeline_queue(const struct _h_connection * conn, const char * query) {
+  if (conn != NULL && conn->connection != NULL && query != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_pipeline_queue_pgsql(conn, query);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_pipeline_queue_prepared
+ * Queue a prepared statement with the values bound in the pipeline
+ * return H_OK on success
+ */
+int h_pipeline_queue_prepared(struct _h_statement * stmt) {
+  if (stmt != NULL && stmt->conn != NULL && stmt->handle != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_PGSQL
+    } else if (stmt->conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_pipeline_queue_prepared_pgsql(stmt);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_pipeline_sync
+ * Send a sync point in the pipeline
+ * return H_OK on success
+ */
+int h_pipeline_sync(const struct _h_connection * conn) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_pipeline_sync_pgsql(conn);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_pipeline_get_result
+ * Read the result of the next query of the pipeline
+ * if result is NULL, the result is read but no value will be returned
+ * return H_OK on success
+ */
+int h_pipeline_get_result(const struct _h_connection * conn, struct _h_result * result) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_pipeline_get_result_pgsql(conn, result, H_OPTION_NONE);
+#endif
+    } else {
+      UNUSED(result);
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_pipeline_get_result_json
+ * Read the result of the next query of the pipeline as a json array
+ * return H_OK on success
+ */
+int h_pipeline_get_result_json(const struct _h_connection * conn, json_t ** j_result) {
+  if (conn != NULL && conn->connection != NULL && j_result != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_pipeline_get_result_json_pgsql(conn, j_result, H_OPTION_NONE);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_pipeline_end
+ * Read the results left in the pipeline and exit pipeline mode
+ * return H_OK on success
+ */
+int h_pipeline_end(const struct _h_connection * conn) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_pipeline_end_pgsql(conn);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_transaction_begin
+ * Start a transaction and lock the connection until the transaction ends
+ * return H_OK on success
+ */
+int h_transaction_begin(const struct _h_connection * conn) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_transaction_begin_sqlite(conn);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_transaction_begin_mariadb(conn);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_transaction_begin_pgsql(conn);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_transaction_end
+ * Commit or rollback the transaction and unlock the connection
+ * return H_OK on success
+ */
+static int h_transaction_end(const struct _h_connection * conn, int commit) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_transaction_end_sqlite(conn, commit);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_transaction_end_mariadb(conn, commit);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_transaction_end_pgsql(conn, commit);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_commit
+ * Commit the transaction and unlock the connection
+ * return H_OK on success
+ */
+int h_commit(const struct _h_connection * conn) {
+  return h_transaction_end(conn, 1);
+}
+
+/**
+ * h_rollback
+ * Rollback the transaction and unlock the connection
+ * return H_OK on success
+ */
+int h_rollback(const struct _h_connection * conn) {
+  return h_transaction_end(conn, 0);
+}
+
+/**
+ * h_transaction_query
+ * Execute a savepoint query on the savepoint name in the transaction
+ * The name is inserted in the query as is, so it must be letters, digits and '_' only
+ * return H_OK on success
+ */
+static int h_transaction_query(const struct _h_connection * conn, const char * pattern, const char * name) {
+  char * query;
+  size_t i;
+  int ret;
+  
+  if (conn == NULL || conn->connection == NULL || o_strnullempty(name)) {
+    return H_ERROR_PARAMS;
+  }
+  for (i=0; name[i] != '\0'; i++) {
+    if (!isalnum((unsigned char)name[i]) && name[i] != '_') {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error invalid savepoint name '%s'", name);
+      return H_ERROR_PARAMS;
+    }
+  }
+  if ((query = msprintf(pattern, name)) == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for query");
+    return H_ERROR_MEMORY;
+  }
+  if (0) {
+    /* Not happening */
+    ret = H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+  } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+    ret = h_transaction_query_sqlite(conn, query);
+#endif
+#ifdef _HOEL_MARIADB
+  } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+    ret = h_transaction_query_mariadb(conn, query);
+#endif
+#ifdef _HOEL_PGSQL
+  } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+    ret = h_transaction_query_pgsql(conn, query);
+#endif
+  } else {
+    ret = H_ERROR_PARAMS;
+  }
+  h_free(query);
+  return ret;
+}
+
+/**
+ * h_savepoint
+ * Set a savepoint in the transaction
+ * return H_OK on success
+ */
+int h_savepoint(const struct _h_connection * conn, const char * name) {
+  return h_transaction_query(conn, "SAVEPOINT %s", name);
+}
+
+/**
+ * h_release_savepoint
+ * Release a savepoint of the transaction
+ * return H_OK on success
+ */
+int h_release_savepoint(const struct _h_connection * conn, const char * name) {
+  return h_transaction_query(conn, "RELEASE SAVEPOINT %s", name);
+}
+
+/**
+ * h_rollback_to_savepoint
+ * Rollback the changes made since the savepoint
+ * return H_OK on success
+ */
+int h_rollback_to_savepoint(const struct _h_connection * conn, const char * name) {
+  return h_transaction_query(conn, "ROLLBACK TO SAVEPOINT %s", name);
+}
+
+/**
+ * h_get_socket_fd
+ * Return the socket of the connection
+ * return the file descriptor, -1 on error or if the backend has no socket
+ */
+int h_get_socket_fd(const struct _h_connection * conn) {
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_get_socket_fd_mariadb(conn);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_get_socket_fd_pgsql(conn);
+#endif
+    } else {
+      return -1;
+    }
+  } else {
+    return -1;
+  }
+}
+
+/**
+ * h_execute_query_json
+ * Execute a query, set the returned values in the json result
+ * return H_OK on success
+ */
+int h_execute_query_json(const struct _h_connection * conn, const char * query, json_t ** j_result) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && j_result != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_execute_query_json_sqlite(conn, query, j_result);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_execute_query_json_mariadb(conn, query, j_result);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_execute_query_json_pgsql(conn, query, j_result);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_execute_query_json_compact
+ * Execute a query, set the returned values in the json result in compact format
+ * {"columns":["col1","col2"],"rows":[[value1,value2],[value1,value2]]}
+ * return H_OK on success
+ */
+int h_execute_query_json_compact(const struct _h_connection * conn, const char * query, json_t ** j_result) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && j_result != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_execute_query_json_options_sqlite(conn, query, j_result, H_OPTION_JSON_COMPACT);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_execute_query_json_options_mariadb(conn, query, j_result, H_OPTION_JSON_COMPACT);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_execute_query_json_options_pgsql(conn, query, j_result, H_OPTION_JSON_COMPACT);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_execute_query_json_options
+ * Execute a query, set the returned values in the json result
+ * options can be H_OPTION_JSON_COMPACT and/or H_OPTION_BINARY
+ * return H_OK on success
+ */
+int h_execute_query_json_options(const struct _h_connection * conn, const char * query, json_t ** j_result, int options) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && j_result != NULL) {
+    if (0) {
+      /* Not happening */
+      return H_ERROR_PARAMS;
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      return h_execute_query_json_options_sqlite(conn, query, j_result, options);
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      return h_execute_query_json_options_mariadb(conn, query, j_result, options);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      return h_execute_query_json_options_pgsql(conn, query, j_result, options);
+#endif
+    } else {
+      return H_ERROR_PARAMS;
+    }
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * Add a new struct _h_data * to an array of struct _h_data *, which already has cols columns
+ * return H_OK on success
+ */
+int h_row_add_data(struct _h_data ** row, struct _h_data * data, int cols) {
+  struct _h_data * tmp = o_realloc(*row, ((size_t)cols+1)*sizeof(struct _h_data));
+  * row = tmp;
+  if (tmp == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for h_row_add_data");
+    return H_ERROR_MEMORY;
+  } else {
+    switch (data->type) {
+      case HOEL_COL_TYPE_INT:
+        tmp[cols].type = HOEL_COL_TYPE_INT;
+        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_int));
+        if (tmp[cols].t_data == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
+          return H_ERROR_MEMORY;
+        } else {
+          ((struct _h_type_int *)tmp[cols].t_data)->value = ((struct _h_type_int *)data->t_data)->value;
+          return H_OK;
+        }
+        break;
+      case HOEL_COL_TYPE_DOUBLE:
+        tmp[cols].type = HOEL_COL_TYPE_DOUBLE;
+        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_double));
+        if (tmp[cols].t_data == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
+          return H_ERROR_MEMORY;
+        } else {
+          ((struct _h_type_double *)tmp[cols].t_data)->value = ((struct _h_type_double *)data->t_data)->value;
+          return H_OK;
+        }
+        break;
+      case HOEL_COL_TYPE_TEXT:
+        tmp[cols].type = HOEL_COL_TYPE_TEXT;
+        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_text));
+        if (tmp[cols].t_data == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
+          return H_ERROR_MEMORY;
+        } else {
+          ((struct _h_type_text *)tmp[cols].t_data)->value = o_malloc(((struct _h_type_text *)data->t_data)->length+sizeof(char));
+          if (((struct _h_type_text *)tmp[cols].t_data)->value == NULL) {
+            y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for ((struct _h_type_text *)tmp[cols].t_data)->value");
+            h_free(tmp[cols].t_data);
+            return H_ERROR_MEMORY;
+          }
+          memcpy(((struct _h_type_text *)tmp[cols].t_data)->value, ((struct _h_type_text *)data->t_data)->value, (((struct _h_type_text *)data->t_data)->length+1));
+          ((struct _h_type_text *)tmp[cols].t_data)->length = ((struct _h_type_text *)data->t_data)->length;
+          return H_OK;
+        }
+        break;
+      case HOEL_COL_TYPE_BLOB:
+        tmp[cols].type = HOEL_COL_TYPE_BLOB;
+        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_blob));
+        if (tmp[cols].t_data == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
+          return H_ERROR_MEMORY;
+        } else {
+          ((struct _h_type_blob *)tmp[cols].t_data)->length = ((struct _h_type_blob *)data->t_data)->length;
+          ((struct _h_type_blob *)tmp[cols].t_data)->value = o_malloc(((struct _h_type_blob *)data->t_data)->length);
+          if (((struct _h_type_blob *)tmp[cols].t_data)->value == NULL) {
+            y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for ((struct _h_type_blob *)tmp[cols].t_data)->value");
+            h_free(tmp[cols].t_data);
+            return H_ERROR_MEMORY;
+          }
+          memcpy(((struct _h_type_blob *)tmp[cols].t_data)->value, ((struct _h_type_blob *)data->t_data)->value, ((struct _h_type_blob *)data->t_data)->length);
+          return H_OK;
+        }
+        break;
+      case HOEL_COL_TYPE_DATE:
+        tmp[cols].type = HOEL_COL_TYPE_DATE;
+        tmp[cols].t_data = o_malloc(sizeof(struct _h_type_datetime));
+        if (tmp[cols].t_data == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for tmp[cols].t_data");
+          return H_ERROR_MEMORY;
+        } else {
+          ((struct _h_type_datetime *)tmp[cols].t_data)->value = ((struct _h_type_datetime *)data->t_data)->value;
+          return H_OK;
+        }
+        break;
+      case HOEL_COL_TYPE_NULL:
+        tmp[cols].type = HOEL_COL_TYPE_NULL;
+        tmp[cols].t_data = NULL;
+        break;
+      default:
+        return H_ERROR_PARAMS;
+        break;
+    }
+    return H_OK;
+  }
+}
+
+/**
+ * Add a new row of struct _h_data * in a struct _h_result *
+ * The rows of a result allocated in an arena must be added with h_result_new_row
+ * return H_OK on success
+ */
+int h_result_add_row(struct _h_result * result, struct _h_data * row, int rows) {
+  if (result->arena != NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error a row can't be added to an arena result");
+    return H_ERROR_PARAMS;
+  }
+  result->data = o_realloc(result->data, ((size_t)rows+1)*sizeof(struct _h_data *));
+  if (result->data == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for result->data");
+    return H_ERROR_MEMORY;
+  } else {
+    result->data[rows] = row;
+    result->nb_rows++;
+    return H_OK;
+  }
+}
+
+/**
+ * Size of an arena chunk, values bigger than that are allocated in their own chunk
+ */
+#define H_ARENA_CHUNK_SIZE 65536
+#define H_ARENA_ALIGN(x) (((x)+(sizeof(void *)-1))&~(sizeof(void *)-1))
+
+struct _h_arena_chunk {
+  struct _h_arena_chunk * next;
+  size_t                  size;
+  size_t                  used;
+  unsigned char           data[];
+};
+
+struct _h_arena {
+  struct _h_arena_chunk * chunk;
+  size_t                  rows_size;
+};
+
+/**
+ * Allocate a new empty arena
+ * return pointer to the new arena
+ * return NULL on error
+ */
+void * h_arena_new(void) {
+  struct _h_arena * arena = o_malloc(sizeof(struct _h_arena));
+  if (arena != NULL) {
+    arena->chunk = NULL;
+    arena->rows_size = 0;
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for arena");
+  }
+  return arena;
+}
+
+/**
+ * Allocate size bytes in the arena
+ * The memory is released by h_arena_free only
+ * return pointer to the allocated memory
+ * return NULL on error
+ */
+void * h_arena_alloc(void * arena, size_t size) {
+  struct _h_arena * h_arena = (struct _h_arena *)arena;
+  struct _h_arena_chunk * chunk;
+  void * ptr;
+  
+  size = H_ARENA_ALIGN(size?size:1);
+  if (h_arena->chunk == NULL || h_arena->chunk->size - h_arena->chunk->used < size) {
+    chunk = o_malloc(sizeof(struct _h_arena_chunk) + (size>H_ARENA_CHUNK_SIZE?size:H_ARENA_CHUNK_SIZE));
+    if (chunk == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for arena chunk");
+      return NULL;
+    }
+    chunk->size = size>H_ARENA_CHUNK_SIZE?size:H_ARENA_CHUNK_SIZE;
+    chunk->used = 0;
+    if (size > H_ARENA_CHUNK_SIZE && h_arena->chunk != NULL) {
+      /* Keep the current chunk on top, it still has room for the next values */
+      chunk->next = h_arena->chunk->next;
+      h_arena->chunk->next = chunk;
+    } else {
+      chunk->next = h_arena->chunk;
+      h_arena->chunk = chunk;
+    }
+  } else {
+    chunk = h_arena->chunk;
+  }
+  ptr = chunk->data + chunk->used;
+  chunk->used += size;
+  return ptr;
+}
+
+/**
+ * Free all the chunks of the arena and the arena itself
+ */
+void h_arena_free(void * arena) {
+  struct _h_arena_chunk * chunk, * next;
+  if (arena != NULL) {
+    chunk = ((struct _h_arena *)arena)->chunk;
+    while (chunk != NULL) {
+      next = chunk->next;
+      h_free(chunk);
+      chunk = next;
+    }
+    h_free(arena);
+  }
+}
+
+/**
+ * Initialize an empty result with nb_columns columns
+ * if options has H_OPTION_ARENA set, the rows and values will be allocated in an arena
+ * return H_OK on success
+ */
+int h_result_init(struct _h_result * result, unsigned int nb_columns, int options) {
+  result->nb_rows = 0;
+  result->nb_columns = nb_columns;
+  result->data = NULL;
+  result->arena = NULL;
+  if (options & H_OPTION_ARENA) {
+    if ((result->arena = h_arena_new()) == NULL) {
+      return H_ERROR_MEMORY;
+    }
+  }
+  return H_OK;
+}
+
+/**
+ * Append a new row to the result, all the columns are set to NULL
+ * return H_OK on success
+ */
+int h_result_new_row(struct _h_result * result, struct _h_data ** row) {
+  struct _h_data ** data;
+  struct _h_arena * arena = (struct _h_arena *)result->arena;
+  unsigned int col;
+  size_t rows_size;
+  
+  if (arena != NULL) {
+    if (result->nb_rows >= arena->rows_size) {
+      rows_size = arena->rows_size?(arena->rows_size*2):64;
+      if ((data = o_realloc(result->data, rows_size*sizeof(struct _h_data *))) == NULL) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for result->data");
+        return H_ERROR_MEMORY;
+      }
+      result->data = data;
+      arena->rows_size = rows_size;
+    }
+    * row = h_arena_alloc(arena, result->nb_columns*sizeof(struct _h_data));
+  } else {
+    if ((data = o_realloc(result->data, ((size_t)result->nb_rows+1)*sizeof(struct _h_data *))) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for result->data");
+      return H_ERROR_MEMORY;
+    }
+    result->data = data;
+    * row = o_malloc(result->nb_columns*sizeof(struct _h_data));
+  }
+  if (* row == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for row");
+    return H_ERROR_MEMORY;
+  }
+  for (col=0; col<result->nb_columns; col++) {
+    (* row)[col].type = HOEL_COL_TYPE_NULL;
+    (* row)[col].t_data = NULL;
+  }
+  result->data[result->nb_rows] = * row;
+  result->nb_rows++;
+  return H_OK;
+}
+
+/**
+ * Allocate size bytes for a value of the result, in the arena if the result has one
+ */
+static void * h_result_alloc(struct _h_result * result, size_t size) {
+  if (result->arena != NULL) {
+    return h_arena_alloc(result->arena, size);
+  } else {
+    return o_malloc(size);
+  }
+}
+
+/**
+ * Set the value of a cell of the result from a decoded column value
+ * return H_OK on success
+ */
+int h_result_set_cell(struct _h_result * result, struct _h_data * data, const struct _h_cell * cell) {
+  void * t_data = NULL, * value = NULL;
+  
+  switch (cell->type) {
+    case HOEL_COL_TYPE_INT:
+      if ((t_data = h_result_alloc(result, sizeof(struct _h_type_int))) != NULL) {
+        ((struct _h_type_int *)t_data)->value = cell->i_value;
+      }
+      break;
+    case HOEL_COL_TYPE_DOUBLE:
+      if ((t_data = h_result_alloc(result, sizeof(struct _h_type_double))) != NULL) {
+        ((struct _h_type_double *)t_data)->value = cell->d_value;
+      }
+      break;
+    case HOEL_COL_TYPE_DATE:
+      if ((t_data = h_result_alloc(result, sizeof(struct _h_type_datetime))) != NULL) {
+        ((struct _h_type_datetime *)t_data)->value = cell->dt_value;
+      }
+      break;
+    case HOEL_COL_TYPE_TEXT:
+      if (result->arena != NULL) {
+        /* The value follows the struct in the same arena block */
+        if ((t_data = h_arena_alloc(result->arena, H_ARENA_ALIGN(sizeof(struct _h_type_text))+cell->length+1)) != NULL) {
+          value = (unsigned char *)t_data + H_ARENA_ALIGN(sizeof(struct _h_type_text));
+        }
+      } else if ((t_data = o_malloc(sizeof(struct _h_type_text))) != NULL) {
+        if ((value = o_malloc(cell->length+1)) == NULL) {
+          h_free(t_data);
+          t_data = NULL;
+        }
+      }
+      if (t_data != NULL) {
+        if (cell->length) {
+          memcpy(value, cell->value, cell->length);
+        }
+        ((char *)value)[cell->length] = '\0';
+        ((struct _h_type_text *)t_data)->value = value;
+        ((struct _h_type_text *)t_data)->length = cell->length;
+      }
+      break;
+    case HOEL_COL_TYPE_BLOB:
+      if (result->arena != NULL) {
+        if ((t_data = h_arena_alloc(result->arena, H_ARENA_ALIGN(sizeof(struct _h_type_blob))+cell->length)) != NULL && cell->length) {
+          value = (unsigned char *)t_data + H_ARENA_ALIGN(sizeof(struct _h_type_blob));
+        }
+      } else if ((t_data = o_malloc(sizeof(struct _h_type_blob))) != NULL && cell->length) {
+        if ((value = o_malloc(cell->length)) == NULL) {
+          h_free(t_data);
+          t_data = NULL;
+        }
+      }
+      if (t_data != NULL) {
+        if (cell->length) {
+          memcpy(value, cell->value, cell->length);
+        }
+        ((struct _h_type_blob *)t_data)->value = value;
+        ((struct _h_type_blob *)t_data)->length = cell->length;
+      }
+      break;
+    case HOEL_COL_TYPE_NULL:
+      data->type = HOEL_COL_TYPE_NULL;
+      data->t_data = NULL;
+      return H_OK;
+      break;
+    default:
+      return H_ERROR_PARAMS;
+      break;
+  }
+  if (t_data == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for cell value");
+    return H_ERROR_MEMORY;
+  }
+  data->type = cell->type;
+  data->t_data = t_data;
+  return H_OK;
+}
+
+/**
+ * Convert a struct tm in UTC into a number of seconds since epoch
+ */
+long long int h_tm_to_epoch(const struct tm * tm) {
+  long long int year = (long long int)tm->tm_year + 1900 - (tm->tm_mon < 2), month = tm->tm_mon + 1, era, yoe, doy, doe;
+  
+  era = (year >= 0 ? year : year - 399) / 400;
+  yoe = year - era * 400;
+  doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + tm->tm_mday - 1;
+  doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return (era * 146097 + doe - 719468) * 86400 + tm->tm_hour * 3600 + tm->tm_min * 60 + tm->tm_sec;
+}
+
+/**
+ * Allocate the arrays of a column that had only null values so far
+ */
+static int h_column_set_type(struct _h_column * column, int type, unsigned int nb_rows_allocated) {
+  switch (type) {
+    case HOEL_COL_TYPE_INT:
+    case HOEL_COL_TYPE_DATE:
+      if ((column->i_values = o_malloc(nb_rows_allocated*sizeof(long long int))) == NULL) {
+        return H_ERROR_MEMORY;
+      }
+      memset(column->i_values, 0, nb_rows_allocated*sizeof(long long int));
+      break;
+    case HOEL_COL_TYPE_DOUBLE:
+      if ((column->d_values = o_malloc(nb_rows_allocated*sizeof(double))) == NULL) {
+        return H_ERROR_MEMORY;
+      }
+      memset(column->d_values, 0, nb_rows_allocated*sizeof(double));
+      break;
+    case HOEL_COL_TYPE_TEXT:
+    case HOEL_COL_TYPE_BLOB:
+      if ((column->offsets = o_malloc((nb_rows_allocated+1)*sizeof(size_t))) == NULL) {
+        return H_ERROR_MEMORY;
+      }
+      memset(column->offsets, 0, (nb_rows_allocated+1)*sizeof(size_t));
+      break;
+    default:
+      return H_ERROR_PARAMS;
+      break;
+  }
+  column->type = type;
+  return H_OK;
+}
+
+/**
+ * Write the text representation of a numeric or date value in buffer
+ * return the length of the text
+ */
+static size_t h_column_format_value(int type, long long int i_value, double d_value, char * buffer, size_t buffer_size) {
+  struct tm tm_value;
+  time_t t_value;
+  int len = 0;
+  
+  switch (type) {
+    case HOEL_COL_TYPE_INT:
+      len = snprintf(buffer, buffer_size, "%lld", i_value);
+      break;
+    case HOEL_COL_TYPE_DOUBLE:
+      len = snprintf(buffer, buffer_size, "%.17g", d_value);
+      break;
+    case HOEL_COL_TYPE_DATE:
+      t_value = (time_t)i_value;
+      if (gmtime_r(&t_value, &tm_value) != NULL) {
+        len = (int)strftime(buffer, buffer_size, "%Y-%m-%dT%H:%M:%S", &tm_value);
+      }
+      break;
+    default:
+      break;
+  }
+  return len>0?(size_t)len:0;
+}
+
+/**
+ * Append length bytes of value as the value of the row row of a text or blob column
+ */
+static int h_column_append_bytes(struct _h_column * column, unsigned int row, const void * value, size_t length) {
+  size_t bytes_allocated;
+  char * bytes;
+  
+  if (column->offsets[row] + length > column->bytes_size || column->bytes == NULL) {
+    bytes_allocated = column->bytes_size?column->bytes_size:4096;
+    while (bytes_allocated < column->offsets[row] + length) {
+      bytes_allocated *= 2;
+    }
+    if ((bytes = o_realloc(column->bytes, bytes_allocated)) == NULL) {
+      return H_ERROR_MEMORY;
+    }
+    column->bytes = bytes;
+    column->bytes_size = bytes_allocated;
+  }
+  if (length) {
+    memcpy(column->bytes + column->offsets[row], value, length);
+  }
+  column->offsets[row+1] = column->offsets[row] + length;
+  return H_OK;
+}
+
+/**
+ * Convert an int, date or double column into a text or blob column
+ * The values of the rows before nb_rows are converted to their text representation
+ */
+static int h_column_convert_to_bytes(struct _h_column * column, int type, unsigned int nb_rows, unsigned int nb_rows_allocated) {
+  struct _h_column converted;
+  char buffer[64];
+  size_t length;
+  unsigned int row;
+  int ret;
+  
+  memset(&converted, 0, sizeof(struct _h_column));
+  if ((ret = h_column_set_type(&converted, type, nb_rows_allocated)) != H_OK) {
+    return ret;
+  }
+  for (row=0; row<nb_rows; row++) {
+    length = 0;
+    if (!h_column_is_null(column, row)) {
+      length = h_column_format_value(column->type, column->i_values!=NULL?column->i_values[row]:0, column->d_values!=NULL?column->d_values[row]:0, buffer, sizeof(buffer));
+    }
+    if ((ret = h_column_append_bytes(&converted, row, buffer, length)) != H_OK) {
+      h_free(converted.offsets);
+      h_free(converted.bytes);
+      return ret;
+    }
+  }
+  h_free(column->i_values);
+  h_free(column->d_values);
+  column->i_values = NULL;
+  column->d_values = NULL;
+  column->offsets = converted.offsets;
+  column->bytes = converted.bytes;
+  column->bytes_size = converted.bytes_size;
+  column->type = type;
+  return H_OK;
+}
+
+/**
+ * Initialize an empty columnar result with nb_columns columns
+ * return H_OK on success
+ */
+int h_result_columnar_init(struct _h_result_columnar * result, unsigned int nb_columns) {
+  unsigned int col;
+  
+  result->nb_rows = 0;
+  result->nb_columns = 0;
+  result->nb_rows_allocated = 0;
+  result->columns = NULL;
+  if (nb_columns) {
+    if ((result->columns = o_malloc(nb_columns*sizeof(struct _h_column))) == NULL) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for result->columns");
+      return H_ERROR_MEMORY;
+    }
+    memset(result->columns, 0, nb_columns*sizeof(struct _h_column));
+    for (col=0; col<nb_columns; col++) {
+      result->columns[col].type = HOEL_COL_TYPE_NULL;
+    }
+    result->nb_columns = nb_columns;
+  }
+  return H_OK;
+}
+
+/**
+ * Set the name of the column col
+ * return H_OK on success
+ */
+int h_result_columnar_set_name(struct _h_result_columnar * result, unsigned int col, const char * name) {
+  if ((result->columns[col].name = o_strdup(name)) == NULL && name != NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for column name");
+    return H_ERROR_MEMORY;
+  }
+  return H_OK;
+}
+
+/**
+ * Append a new row to the columnar result, all the values are set to null
+ * return H_OK on success
+ */
+int h_result_columnar_new_row(struct _h_result_columnar * result) {
+  struct _h_column * column;
+  unsigned int col, nb_rows_allocated, row = result->nb_rows;
+  void * ptr;
+  
+  if (result->nb_rows == result->nb_rows_allocated) {
+    nb_rows_allocated = result->nb_rows_allocated?(result->nb_rows_allocated*2):64;
+    for (col=0; col<result->nb_columns; col++) {
+      column = &result->columns[col];
+      if ((ptr = o_realloc(column->validity, (nb_rows_allocated+7)/8)) == NULL) {
+        y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for column->validity");
+        return H_ERROR_MEMORY;
+      }
+      column->validity = ptr;
+      memset(column->validity + (result->nb_rows_allocated+7)/8, 0, (nb_rows_allocated+7)/8 - (result->nb_rows_allocated+7)/8);
+      if (column->i_values != NULL) {
+        if ((ptr = o_realloc(column->i_values, nb_rows_allocated*sizeof(long long int))) == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for column->i_values");
+          return H_ERROR_MEMORY;
+        }
+        column->i_values = ptr;
+      }
+      if (column->d_values != NULL) {
+        if ((ptr = o_realloc(column->d_values, nb_rows_allocated*sizeof(double))) == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for column->d_values");
+          return H_ERROR_MEMORY;
+        }
+        column->d_values = ptr;
+      }
+      if (column->offsets != NULL) {
+        if ((ptr = o_realloc(column->offsets, (nb_rows_allocated+1)*sizeof(size_t))) == NULL) {
+          y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for column->offsets");
+          return H_ERROR_MEMORY;
+        }
+        column->offsets = ptr;
+      }
+    }
+    result->nb_rows_allocated = nb_rows_allocated;
+  }
+  for (col=0; col<result->nb_columns; col++) {
+    column = &result->columns[col];
+    if (column->i_values != NULL) {
+      column->i_values[row] = 0;
+    }
+    if (column->d_values != NULL) {
+      column->d_values[row] = 0;
+    }
+    if (column->offsets != NULL) {
+      column->offsets[row+1] = column->offsets[row];
+    }
+  }
+  result->nb_rows++;
+  return H_OK;
+}
+
+/**
+ * Set the value of the column col in the last row of the columnar result
+ * The column type is widened if the value has a different type
+ * return H_OK on success
+ */
+int h_result_columnar_set_cell(struct _h_result_columnar * result, unsigned int col, const struct _h_cell * cell) {
+  struct _h_column * column = &result->columns[col];
+  unsigned int row = result->nb_rows-1;
+  long long int i_value = cell->i_value;
+  double * d_values;
+  char buffer[64];
+  int ret = H_OK;
+  
+  if (cell->type == HOEL_COL_TYPE_NULL) {
+    return H_OK;
+  }
+  if (cell->type == HOEL_COL_TYPE_DATE) {
+    i_value = h_tm_to_epoch(&cell->dt_value);
+  }
+  if (column->type == HOEL_COL_TYPE_NULL) {
+    ret = h_column_set_type(column, cell->type, result->nb_rows_allocated);
+  } else if (column->type != cell->type) {
+    if ((column->type == HOEL_COL_TYPE_INT || column->type == HOEL_COL_TYPE_DATE) && cell->type == HOEL_COL_TYPE_DOUBLE) {
+      if ((d_values = o_malloc(result->nb_rows_allocated*sizeof(double))) != NULL) {
+        for (row=0; row<result->nb_rows; row++) {
+          d_values[row] = (double)column->i_values[row];
+        }
+        row = result->nb_rows-1;
+        h_free(column->i_values);
+        column->i_values = NULL;
+        column->d_values = d_values;
+        column->type = HOEL_COL_TYPE_DOUBLE;
+      } else {
+        ret = H_ERROR_MEMORY;
+      }
+    } else if ((column->type == HOEL_COL_TYPE_INT && cell->type == HOEL_COL_TYPE_DATE) || (column->type == HOEL_COL_TYPE_DATE && cell->type == HOEL_COL_TYPE_INT)) {
+      column->type = HOEL_COL_TYPE_INT;
+    } else if (column->type == HOEL_COL_TYPE_TEXT && cell->type == HOEL_COL_TYPE_BLOB) {
+      column->type = HOEL_COL_TYPE_BLOB;
+    } else if (column->type != HOEL_COL_TYPE_TEXT && column->type != HOEL_COL_TYPE_BLOB && 
+               !(column->type == HOEL_COL_TYPE_DOUBLE && (cell->type == HOEL_COL_TYPE_INT || cell->type == HOEL_COL_TYPE_DATE))) {
+      ret = h_column_convert_to_bytes(column, cell->type==HOEL_COL_TYPE_BLOB?HOEL_COL_TYPE_BLOB:HOEL_COL_TYPE_TEXT, row, result->nb_rows_allocated);
+    }
+  }
+  if (ret == H_OK) {
+    switch (column->type) {
+      case HOEL_COL_TYPE_INT:
+      case HOEL_COL_TYPE_DATE:
+        column->i_values[row] = i_value;
+        break;
+      case HOEL_COL_TYPE_DOUBLE:
+        column->d_values[row] = cell->type==HOEL_COL_TYPE_DOUBLE?cell->d_value:(double)i_value;
+        break;
+      case HOEL_COL_TYPE_TEXT:
+      case HOEL_COL_TYPE_BLOB:
+        if (cell->type == HOEL_COL_TYPE_TEXT || cell->type == HOEL_COL_TYPE_BLOB) {
+          ret = h_column_append_bytes(column, row, cell->value, cell->length);
+        } else {
+          ret = h_column_append_bytes(column, row, buffer, h_column_format_value(cell->type, i_value, cell->d_value, buffer, sizeof(buffer)));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  if (ret == H_OK) {
+    column->validity[row/8] |= (unsigned char)(1 << (row%8));
+  } else {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for column value");
+  }
+  return ret;
+}
+
+/**
+ * Initialize an empty value result with nb_columns columns
+ * return H_OK on success
+ */
+int h_value_result_init(struct _h_value_result * result, unsigned int nb_columns) {
+  result->nb_rows = 0;
+  result->nb_columns = nb_columns;
+  result->nb_rows_allocated = 0;
+  result->values = NULL;
+  if ((result->arena = h_arena_new()) == NULL) {
+    return H_ERROR_MEMORY;
+  }
+  return H_OK;
+}
+
+/**
+ * Append a new row to the value result, all the values are set to null
+ * return H_OK on success
+ */
+int h_value_result_new_row(struct _h_value_result * result, struct _h_value ** row) {
+  struct _h_value * values;
+  unsigned int nb_rows_allocated, col;
+  
+  if (result->nb_rows == result->nb_rows_allocated) {
+    nb_rows_allocated = result->nb_rows_allocated?(result->nb_rows_allocated*2):64;
+    if ((values = o_realloc(result->values, (size_t)nb_rows_allocated*result->nb_columns*sizeof(struct _h_value))) == NULL && result->nb_columns) {
+      y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for result->values");
+      return H_ERROR_MEMORY;
+    }
+    result->values = values;
+    result->nb_rows_allocated = nb_rows_allocated;
+  }
+  * row = result->values!=NULL?(result->values + (size_t)result->nb_rows*result->nb_columns):NULL;
+  for (col=0; col<result->nb_columns; col++) {
+    (* row)[col].type = HOEL_COL_TYPE_NULL;
+    (* row)[col].length = 0;
+  }
+  result->nb_rows++;
+  return H_OK;
+}
+
+/**
+ * Set a value of the value result from a decoded column value
+ * return H_OK on success
+ */
+int h_value_result_set_cell(struct _h_value_result * result, struct _h_value * value, const struct _h_cell * cell) {
+  char * bytes;
+  
+  switch (cell->type) {
+    case HOEL_COL_TYPE_INT:
+      value->v.i_value = cell->i_value;
+      break;
+    case HOEL_COL_TYPE_DOUBLE:
+      value->v.d_value = cell->d_value;
+      break;
+    case HOEL_COL_TYPE_DATE:
+      value->v.i_value = h_tm_to_epoch(&cell->dt_value);
+      break;
+    case HOEL_COL_TYPE_TEXT:
+    case HOEL_COL_TYPE_BLOB:
+      if (cell->length <= H_VALUE_INLINE_LENGTH) {
+        bytes = value->v.text;
+      } else if ((bytes = value->v.ptr = h_arena_alloc(result->arena, cell->length+1)) == NULL) {
+        return H_ERROR_MEMORY;
+      }
+      if (cell->length) {
+        memcpy(bytes, cell->value, cell->length);
+      }
+      bytes[cell->length] = '\0';
+      value->length = cell->length;
+      break;
+    case HOEL_COL_TYPE_NULL:
+      break;
+    default:
+      return H_ERROR_PARAMS;
+      break;
+  }
+  value->type = cell->type;
+  return H_OK;
+}
+
+/**
+ * Convert a decoded column value into a json_t *
+ * dates are converted into a string in ISO 8601 format
+ * return NULL on error
+ */
+json_t * h_cell_to_json(const struct _h_cell * cell) {
+  char date_stamp[64] = {0};
+  
+  switch (cell->type) {
+    case HOEL_COL_TYPE_INT:
+      return json_integer(cell->i_value);
+      break;
+    case HOEL_COL_TYPE_DOUBLE:
+      return json_real(cell->d_value);
+      break;
+    case HOEL_COL_TYPE_TEXT:
+    case HOEL_COL_TYPE_BLOB:
+      return json_stringn(cell->length?cell->value:"", cell->length);
+      break;
+    case HOEL_COL_TYPE_DATE:
+      strftime(date_stamp, sizeof(date_stamp), "%Y-%m-%dT%H:%M:%S", &cell->dt_value);
+      return json_string(date_stamp);
+      break;
+    default:
+      return json_null();
+      break;
+  }
+}
+
+/**
+ * Allocate the json result of a query
+ * j_result is a json array of json objects,
+ * or a json object {"columns":[],"rows":[]} if options has H_OPTION_JSON_COMPACT
+ * j_rows is set to the json array where the rows must be appended
+ * return H_OK on success
+ */
+int h_json_result_init(json_t ** j_result, json_t ** j_rows, int options) {
+  if (options & H_OPTION_JSON_COMPACT) {
+    *j_result = json_pack("{s[]s[]}", "columns", "rows");
+    *j_rows = json_object_get(*j_result, "rows");
+  } else {
+    *j_result = json_array();
+    *j_rows = *j_result;
+  }
+  if (*j_result == NULL) {
+    y_log_message(Y_LOG_LEVEL_ERROR, "Hoel - Error allocating memory for *j_result");
+    return H_ERROR_MEMORY;
+  }
+  return H_OK;
+}
+
+/**
+ * Add the column name to the columns list of a compact json result
+ * Does nothing if j_result isn't compact
+ */
+void h_json_result_add_column(json_t * j_result, const char * name) {
+  if (json_is_object(j_result)) {
+    json_array_append_new(json_object_get(j_result, "columns"), json_string(name));
+  }
+}
+
+/**
+ * Allocate a new json row, a json object, or a json array if options has H_OPTION_JSON_COMPACT
+ * return NULL on error
+ */
+json_t * h_json_row_new(int options) {
+  if (options & H_OPTION_JSON_COMPACT) {
+    return json_array();
+  } else {
+    return json_object();
+  }
+}
+
+/**
+ * Set the value of the column name in the json row
+ * j_value is appended if j_row is an array
+ */
+void h_json_row_set(json_t * j_row, const char * name, json_t * j_value) {
+  if (json_is_array(j_row)) {
+    json_array_append_new(j_row, j_value!=NULL?j_value:json_null());
+  } else {
+    json_object_set_new(j_row, name, j_value);
+  }
+}
+
+/**
+ * h_query_insert
+ * Execute an insert query
+ * return H_OK on success
+ */
+int h_query_insert(const struct _h_connection * conn, const char * query) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "insert") != NULL) {
+    return h_execute_query(conn, query, NULL, H_OPTION_EXEC);
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_query_last_insert_id
+ * return the id of the last inserted value
+ * return H_OK on success
+ */
+struct _h_data * h_query_last_insert_id(const struct _h_connection * conn) {
+  struct _h_data * data = NULL;
+  if (conn != NULL && conn->connection != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_SQLITE
+    } else if (conn->type == HOEL_DB_TYPE_SQLITE) {
+      long long int last_id = h_last_insert_id_sqlite(conn);
+      if (last_id > 0) {
+        data = h_new_data_int(last_id);
+      } else {
+        data = h_new_data_null();
+      }
+#endif
+#ifdef _HOEL_MARIADB
+    } else if (conn->type == HOEL_DB_TYPE_MARIADB) {
+      long long int last_id = h_last_insert_id_mariadb(conn);
+      if (last_id > 0) {
+        data = h_new_data_int(last_id);
+      } else {
+        data = h_new_data_null();
+      }
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (conn->type == HOEL_DB_TYPE_PGSQL) {
+      long long int last_id = h_last_insert_id_pgsql(conn);
+      if (last_id > 0) {
+        data = h_new_data_int(last_id);
+      } else {
+        data = h_new_data_null();
+      }
+#endif
+    } else {
+      data = h_new_data_null();
+    }
+  }
+  return data;
+}
+
+/**
+ * h_query_update
+ * Execute an update query
+ * return H_OK on success
+ */
+int h_query_update(const struct _h_connection * conn, const char * query) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "update") != NULL) {
+    return h_execute_query(conn, query, NULL, H_OPTION_EXEC);
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_query_delete
+ * Execute an delete query
+ * return H_OK on success
+ */
+int h_query_delete(const struct _h_connection * conn, const char * query) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "delete") != NULL) {
+    return h_execute_query(conn, query, NULL, H_OPTION_EXEC);
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_query_select
+ * Execute a select query, set the result structure with the returned values
+ * return H_OK on success
+ */
+int h_query_select(const struct _h_connection * conn, const char * query, struct _h_result * result) {
+  if (conn != NULL && conn->connection != NULL && query != NULL && o_strcasestr(query, "select") != NULL) {
+    return h_execute_query(conn, query, result, H_OPTION_SELECT);
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_query_select_json
  * Execute a select query, set the returned values in the json results
  * return H_OK on success
  */
@@ -422,15 +2575,261 @@ int h_query_select_json(const struct _h_connection * conn, const char * query, j
 int h_clean_result(struct _h_result * result) {
   unsigned int col, row;
   if (result != NULL) {
-    for (row=0; row<result->nb_rows; row++) {
-      for (col=0; col<result->nb_columns; col++) {
-        if (h_clean_data(&result->data[row][col]) != H_OK) {
-          return H_ERROR_MEMORY;
+    if (result->arena != NULL) {
+      h_arena_free(result->arena);
+    } else {
+      for (row=0; row<result->nb_rows; row++) {
+        for (col=0; col<result->nb_columns; col++) {
+          if (h_clean_data(&result->data[row][col]) != H_OK) {
+            return H_ERROR_MEMORY;
+          }
         }
+        h_free(result->data[row]);
       }
-      h_free(result->data[row]);
     }
     h_free(result->data);
+    result->data = NULL;
+    result->nb_rows = 0;
+    result->arena = NULL;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_column_is_null
+ * Return true if the value of the row row in the column is null
+ */
+int h_column_is_null(const struct _h_column * column, unsigned int row) {
+  if (column != NULL && column->validity != NULL) {
+    return !(column->validity[row/8] & (1 << (row%8)));
+  } else {
+    return 1;
+  }
+}
+
+/**
+ * h_column_get_bytes
+ * Return the text or blob value of the row row in the column
+ */
+const char * h_column_get_bytes(const struct _h_column * column, unsigned int row, size_t * length) {
+  if (!h_column_is_null(column, row) && column->offsets != NULL) {
+    if (length != NULL) {
+      * length = column->offsets[row+1] - column->offsets[row];
+    }
+    return column->bytes + column->offsets[row];
+  } else {
+    if (length != NULL) {
+      * length = 0;
+    }
+    return NULL;
+  }
+}
+
+/**
+ * h_clean_result_columnar
+ * Free all the memory allocated by the struct _h_result_columnar
+ */
+int h_clean_result_columnar(struct _h_result_columnar * result) {
+  unsigned int col;
+  if (result != NULL) {
+    for (col=0; col<result->nb_columns; col++) {
+      h_free(result->columns[col].name);
+      h_free(result->columns[col].i_values);
+      h_free(result->columns[col].d_values);
+      h_free(result->columns[col].offsets);
+      h_free(result->columns[col].bytes);
+      h_free(result->columns[col].validity);
+    }
+    h_free(result->columns);
+    result->columns = NULL;
+    result->nb_columns = 0;
+    result->nb_rows = 0;
+    result->nb_rows_allocated = 0;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_value_result_get
+ * Return the value of the column col in the row row
+ */
+const struct _h_value * h_value_result_get(const struct _h_value_result * result, unsigned int row, unsigned int col) {
+  if (result != NULL && row < result->nb_rows && col < result->nb_columns) {
+    return result->values + (size_t)row*result->nb_columns + col;
+  } else {
+    return NULL;
+  }
+}
+
+/**
+ * h_value_get_bytes
+ * Return a pointer to the text or blob value, inline or not
+ */
+const char * h_value_get_bytes(const struct _h_value * value) {
+  if (value != NULL && (value->type == HOEL_COL_TYPE_TEXT || value->type == HOEL_COL_TYPE_BLOB)) {
+    return value->length<=H_VALUE_INLINE_LENGTH?value->v.text:value->v.ptr;
+  } else {
+    return NULL;
+  }
+}
+
+/**
+ * h_clean_value_result
+ * Free all the memory allocated by the struct _h_value_result
+ */
+int h_clean_value_result(struct _h_value_result * result) {
+  if (result != NULL) {
+    h_arena_free(result->arena);
+    h_free(result->values);
+    result->arena = NULL;
+    result->values = NULL;
+    result->nb_rows = 0;
+    result->nb_rows_allocated = 0;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * Decode the value of the column col in the row row of a result view
+ * return H_OK on success
+ */
+static int h_result_view_get_cell(const struct _h_result_view * view, unsigned int row, unsigned int col, struct _h_cell * cell) {
+#if !defined(_HOEL_MARIADB) && !defined(_HOEL_PGSQL)
+  UNUSED(cell);
+#endif
+  if (view != NULL && row < view->nb_rows && col < view->nb_columns) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (view->type == HOEL_DB_TYPE_MARIADB) {
+      h_result_view_get_cell_mariadb(view, row, col, cell);
+      return H_OK;
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (view->type == HOEL_DB_TYPE_PGSQL) {
+      h_result_view_get_cell_pgsql(view, row, col, cell);
+      return H_OK;
+#endif
+    }
+  }
+  return H_ERROR_PARAMS;
+}
+
+/**
+ * h_result_view_get
+ * Return the value of the column col in the row row as returned by the database
+ */
+const char * h_result_view_get(const struct _h_result_view * view, unsigned int row, unsigned int col, size_t * length) {
+  if (length != NULL) {
+    * length = 0;
+  }
+  if (view != NULL && row < view->nb_rows && col < view->nb_columns) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (view->type == HOEL_DB_TYPE_MARIADB) {
+      return h_result_view_get_value_mariadb(view, row, col, length);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (view->type == HOEL_DB_TYPE_PGSQL) {
+      return h_result_view_get_value_pgsql(view, row, col, length);
+#endif
+    }
+  }
+  return NULL;
+}
+
+/**
+ * h_result_view_get_type
+ * Return the hoel type of the value of the column col in the row row
+ */
+int h_result_view_get_type(const struct _h_result_view * view, unsigned int row, unsigned int col) {
+  struct _h_cell cell;
+  if (h_result_view_get_cell(view, row, col, &cell) == H_OK) {
+    return cell.type;
+  } else {
+    return HOEL_COL_TYPE_NULL;
+  }
+}
+
+/**
+ * h_result_view_get_int
+ * Get the integer value of the column col in the row row
+ */
+int h_result_view_get_int(const struct _h_result_view * view, unsigned int row, unsigned int col, long long int * value) {
+  struct _h_cell cell;
+  if (value != NULL && h_result_view_get_cell(view, row, col, &cell) == H_OK && cell.type == HOEL_COL_TYPE_INT) {
+    * value = cell.i_value;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_result_view_get_double
+ * Get the double value of the column col in the row row, integer values are converted
+ */
+int h_result_view_get_double(const struct _h_result_view * view, unsigned int row, unsigned int col, double * value) {
+  struct _h_cell cell;
+  if (value != NULL && h_result_view_get_cell(view, row, col, &cell) == H_OK) {
+    if (cell.type == HOEL_COL_TYPE_DOUBLE) {
+      * value = cell.d_value;
+      return H_OK;
+    } else if (cell.type == HOEL_COL_TYPE_INT) {
+      * value = (double)cell.i_value;
+      return H_OK;
+    }
+  }
+  return H_ERROR_PARAMS;
+}
+
+/**
+ * h_result_view_get_date
+ * Get the date value of the column col in the row row
+ */
+int h_result_view_get_date(const struct _h_result_view * view, unsigned int row, unsigned int col, struct tm * value) {
+  struct _h_cell cell;
+  if (value != NULL && h_result_view_get_cell(view, row, col, &cell) == H_OK && cell.type == HOEL_COL_TYPE_DATE) {
+    * value = cell.dt_value;
+    return H_OK;
+  } else {
+    return H_ERROR_PARAMS;
+  }
+}
+
+/**
+ * h_result_view_free
+ * Free the driver result and the memory allocated by the struct _h_result_view
+ */
+int h_result_view_free(struct _h_result_view * view) {
+  if (view != NULL) {
+    if (0) {
+      /* Not happening */
+#ifdef _HOEL_MARIADB
+    } else if (view->type == HOEL_DB_TYPE_MARIADB) {
+      h_result_view_free_mariadb(view);
+#endif
+#ifdef _HOEL_PGSQL
+    } else if (view->type == HOEL_DB_TYPE_PGSQL) {
+      h_result_view_free_pgsql(view);
+#endif
+    }
+    h_free(view->col_types);
+    h_free(view->rows);
+    h_free(view->lengths);
+    view->result = NULL;
+    view->col_types = NULL;
+    view->rows = NULL;
+    view->lengths = NULL;
+    view->nb_rows = 0;
+    view->nb_columns = 0;
     return H_OK;
   } else {
     return H_ERROR_PARAMS;
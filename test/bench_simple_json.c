@@ -0,0 +1,103 @@
+/* Public domain, no copyright. Use at your own risk. */
+/* Benchmark of the simple json query generators */
+/* h_insert and h_delete are run on a sqlite3 in-memory database */
+/* with 10 to 100000 rows or values, the cost per row must stay */
+/* the same when the number of rows grows */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <jansson.h>
+
+#ifndef  _HOEL_SQLITE
+  #define _HOEL_SQLITE
+#endif
+#include "hoel.h"
+
+#define BENCH_DB_PATH ":memory:"
+#define BENCH_MIN_ROWS 10
+#define BENCH_MAX_ROWS 100000
+/* Rows used as the reference cost, smaller sizes are dominated by fixed costs */
+#define BENCH_REF_ROWS 1000
+/* Maximum ratio between the cost per row of the largest size and the reference */
+#define BENCH_MAX_RATIO 4.0
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static json_t * bench_insert_query(size_t nb_rows) {
+  json_t * j_query = json_pack("{sss[]}", "table", "bench_table", "values"), * j_values = json_object_get(j_query, "values");
+  size_t i;
+
+  for (i = 0; i < nb_rows; i++) {
+    json_array_append_new(j_values, json_pack("{sIsfss}", "integer_col", (json_int_t)i, "double_col", (double)i/2, "string_col", "it's a value"));
+  }
+  return j_query;
+}
+
+static json_t * bench_delete_query(size_t nb_rows) {
+  json_t * j_query = json_pack("{sss{s{sss[]}}}", "table", "bench_table", "where", "integer_col", "operator", "IN", "value"),
+         * j_in = json_object_get(json_object_get(json_object_get(j_query, "where"), "integer_col"), "value");
+  size_t i;
+
+  for (i = 0; i < nb_rows; i++) {
+    json_array_append_new(j_in, json_integer((json_int_t)i));
+  }
+  return j_query;
+}
+
+int main(void) {
+  struct _h_connection * conn;
+  json_t * j_insert, * j_delete;
+  size_t nb_rows;
+  double start, insert_time, delete_time, ref_cost = 0, cost = 0;
+  int ret = 0;
+
+  if ((conn = h_connect_sqlite(BENCH_DB_PATH)) == NULL) {
+    fprintf(stderr, "Error connecting to %s\n", BENCH_DB_PATH);
+    return 1;
+  }
+  if (h_execute_query(conn, "CREATE TABLE bench_table (integer_col INTEGER, double_col NUMERIC, string_col TEXT)", NULL, H_OPTION_EXEC) != H_OK) {
+    fprintf(stderr, "Error creating bench_table\n");
+    h_close_db(conn);
+    return 1;
+  }
+  printf("%10s %14s %14s %14s\n", "rows", "insert (ms)", "delete (ms)", "ns per row");
+  for (nb_rows = BENCH_MIN_ROWS; ret == 0 && nb_rows <= BENCH_MAX_ROWS; nb_rows *= 10) {
+    j_insert = bench_insert_query(nb_rows);
+    j_delete = bench_delete_query(nb_rows);
+    start = bench_now();
+    if (h_insert(conn, j_insert, NULL) != H_OK) {
+      fprintf(stderr, "Error h_insert %zu rows\n", nb_rows);
+      ret = 1;
+    }
+    insert_time = bench_now() - start;
+    start = bench_now();
+    if (h_delete(conn, j_delete, NULL) != H_OK) {
+      fprintf(stderr, "Error h_delete %zu rows\n", nb_rows);
+      ret = 1;
+    }
+    delete_time = bench_now() - start;
+    cost = (insert_time + delete_time) * 1e9 / (double)nb_rows;
+    if (nb_rows == BENCH_REF_ROWS) {
+      ref_cost = cost;
+    }
+    printf("%10zu %14.3f %14.3f %14.1f\n", nb_rows, insert_time * 1e3, delete_time * 1e3, cost);
+    json_decref(j_insert);
+    json_decref(j_delete);
+  }
+  if (ret == 0) {
+    if (cost > ref_cost * BENCH_MAX_RATIO) {
+      printf("Cost per row with %d rows is %.1f times the cost with %d rows, the generators don't scale linearly\n", BENCH_MAX_ROWS, cost / ref_cost, BENCH_REF_ROWS);
+      ret = 1;
+    } else {
+      printf("Cost per row with %d rows is %.1f times the cost with %d rows\n", BENCH_MAX_ROWS, cost / ref_cost, BENCH_REF_ROWS);
+    }
+  }
+  h_close_db(conn);
+  h_clean_connection(conn);
+  return ret;
+}
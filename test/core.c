@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 #include <jansson.h>
 
 #include <check.h>
@@ -69,6 +70,76 @@ void print_result(struct _h_result result) {
   }
 }
 
+static int json_stream_write(const char * buffer, size_t size, void * user_data) {
+  char ** output = (char **)user_data;
+  size_t len = o_strlen(*output);
+  *output = o_realloc(*output, len+size+1);
+  memcpy(*output+len, buffer, size);
+  (*output)[len+size] = '\0';
+  return 0;
+}
+
+static int json_stream_write_error(const char * buffer, size_t size, void * user_data) {
+  (void)buffer;
+  (void)size;
+  (void)user_data;
+  return 1;
+}
+
+struct pool_thread_arg {
+  struct _h_pool * pool;
+  int errors;
+};
+
+static void * pool_select_thread(void * args) {
+  struct pool_thread_arg * arg = (struct pool_thread_arg *)args;
+  json_t * j_result;
+  int i;
+  
+  for (i=0; i<20; i++) {
+    if (h_pool_query_select_json(arg->pool, SELECT_DATA_1, &j_result) == H_OK) {
+      if (json_array_size(j_result) != 1) {
+        arg->errors++;
+      }
+      json_decref(j_result);
+    } else {
+      arg->errors++;
+    }
+  }
+  return NULL;
+}
+
+struct pool_release_arg {
+  struct _h_pool * pool;
+  struct _h_connection * conn;
+  int res;
+};
+
+static void * pool_release_thread(void * args) {
+  struct pool_release_arg * arg = (struct pool_release_arg *)args;
+  
+  arg->res = h_pool_release(arg->pool, arg->conn);
+  return NULL;
+}
+
+struct transaction_thread_arg {
+  struct _h_connection * conn;
+  pthread_mutex_t lock;
+  int done;
+  int res;
+};
+
+static void * transaction_insert_thread(void * args) {
+  struct transaction_thread_arg * arg = (struct transaction_thread_arg *)args;
+  int res = h_query_insert(arg->conn, INSERT_DATA_2);
+  
+  pthread_mutex_lock(&arg->lock);
+  arg->res = res;
+  arg->done = 1;
+  pthread_mutex_unlock(&arg->lock);
+  return NULL;
+}
+
 START_TEST(test_hoel_init)
 {
   struct _h_connection * conn;
@@ -252,6 +323,532 @@ START_TEST(test_hoel_delete)
 }
 END_TEST
 
+START_TEST(test_hoel_arena_select)
+{
+  struct _h_connection * conn;
+  struct _h_result result;
+  char * query, * long_value;
+  int i;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  for (i=0; i<200; i++) {
+    query = msprintf("INSERT INTO test_table (integer_col, double_col, string_col) VALUES (%d, %d.5, 'value%d')", i, i, i);
+    ck_assert_int_eq(h_query_insert(conn, query), H_OK);
+    o_free(query);
+  }
+  long_value = o_malloc(100001);
+  memset(long_value, 'a', 100000);
+  long_value[100000] = '\0';
+  query = msprintf("INSERT INTO test_table (integer_col, string_col) VALUES (200, '%s')", long_value);
+  ck_assert_int_eq(h_query_insert(conn, query), H_OK);
+  o_free(query);
+  ck_assert_int_eq(h_execute_query(conn, "SELECT integer_col, double_col, string_col, date_col FROM test_table ORDER BY integer_col", &result, H_OPTION_SELECT|H_OPTION_ARENA), H_OK);
+  ck_assert_ptr_ne(result.arena, NULL);
+  ck_assert_int_eq(result.nb_rows, 201);
+  ck_assert_int_eq(result.nb_columns, 4);
+  ck_assert_int_eq(result.data[0][0].type, HOEL_COL_TYPE_INT);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 0);
+  ck_assert_int_eq(result.data[150][1].type, HOEL_COL_TYPE_DOUBLE);
+  ck_assert_double_eq(((struct _h_type_double *)result.data[150][1].t_data)->value, 150.5);
+  ck_assert_int_eq(result.data[199][2].type, HOEL_COL_TYPE_TEXT);
+  ck_assert_str_eq(((struct _h_type_text *)result.data[199][2].t_data)->value, "value199");
+  ck_assert_int_eq(((struct _h_type_text *)result.data[199][2].t_data)->length, 8);
+  ck_assert_int_eq(result.data[199][3].type, HOEL_COL_TYPE_NULL);
+  ck_assert_str_eq(((struct _h_type_text *)result.data[200][2].t_data)->value, long_value);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_ptr_eq(result.arena, NULL);
+  ck_assert_int_eq(h_execute_query(conn, SELECT_DATA_ERROR, &result, H_OPTION_SELECT|H_OPTION_ARENA), H_OK);
+  ck_assert_int_eq(result.nb_rows, 0);
+  ck_assert_int_eq(result.nb_columns, 4);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_execute_query(conn, SELECT_DATA_ALL, &result, H_OPTION_SELECT), H_OK);
+  ck_assert_ptr_eq(result.arena, NULL);
+  ck_assert_int_eq(result.nb_rows, 201);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  o_free(long_value);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_columnar_select)
+{
+  struct _h_connection * conn;
+  struct _h_result_columnar result;
+  const char * value;
+  size_t length;
+  long long int sum = 0;
+  unsigned int row;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_table (integer_col, double_col, string_col, date_col) VALUES (3, 6, NULL, NULL)"), H_OK);
+  ck_assert_int_eq(h_execute_query_columnar(conn, "SELECT integer_col, double_col, string_col, date_col FROM test_table ORDER BY integer_col", &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 3);
+  ck_assert_int_eq(result.nb_columns, 4);
+  ck_assert_str_eq(result.columns[0].name, "integer_col");
+  ck_assert_int_eq(result.columns[0].type, HOEL_COL_TYPE_INT);
+  for (row=0; row<result.nb_rows; row++) {
+    sum += result.columns[0].i_values[row];
+  }
+  ck_assert_int_eq(sum, 6);
+  ck_assert_int_eq(result.columns[1].type, HOEL_COL_TYPE_DOUBLE);
+  ck_assert_double_eq(result.columns[1].d_values[0], 4.2);
+  ck_assert_double_eq(result.columns[1].d_values[2], 6.0);
+  ck_assert_int_eq(result.columns[2].type, HOEL_COL_TYPE_TEXT);
+  value = h_column_get_bytes(&result.columns[2], 1, &length);
+  ck_assert_int_eq(length, 6);
+  ck_assert_int_eq(0, memcmp(value, "value2", length));
+  ck_assert_int_eq(h_column_is_null(&result.columns[2], 1), 0);
+  ck_assert_int_eq(h_column_is_null(&result.columns[2], 2), 1);
+  ck_assert_ptr_eq(h_column_get_bytes(&result.columns[2], 2, &length), NULL);
+  /* date_col has a text value and an integer value, the column is widened to text */
+  ck_assert_int_eq(result.columns[3].type, HOEL_COL_TYPE_TEXT);
+  value = h_column_get_bytes(&result.columns[3], 1, &length);
+  ck_assert_int_eq(0, memcmp(value, "1466556776", length));
+  ck_assert_int_eq(h_column_is_null(&result.columns[3], 2), 1);
+  ck_assert_int_eq(h_clean_result_columnar(&result), H_OK);
+  ck_assert_int_eq(h_execute_query_columnar(conn, SELECT_DATA_ERROR, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 0);
+  ck_assert_int_eq(result.nb_columns, 4);
+  ck_assert_int_eq(result.columns[0].type, HOEL_COL_TYPE_NULL);
+  ck_assert_int_eq(h_clean_result_columnar(&result), H_OK);
+  ck_assert_int_eq(h_execute_query_columnar(conn, "SELECT * FROM wrong_table", &result), H_ERROR_QUERY);
+  ck_assert_int_eq(h_execute_query_columnar(conn, NULL, &result), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_value_select)
+{
+  struct _h_connection * conn;
+  struct _h_value_result result;
+  const struct _h_value * value;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(sizeof(struct _h_value), 32);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_table (integer_col, double_col, string_col, date_col) VALUES (2, 5.4, 'a value longer than fifteen characters', NULL)"), H_OK);
+  ck_assert_int_eq(h_execute_query_value(conn, "SELECT integer_col, double_col, string_col, date_col FROM test_table ORDER BY integer_col", &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 2);
+  ck_assert_int_eq(result.nb_columns, 4);
+  value = h_value_result_get(&result, 0, 0);
+  ck_assert_int_eq(value->type, HOEL_COL_TYPE_INT);
+  ck_assert_int_eq(value->v.i_value, 1);
+  value = h_value_result_get(&result, 1, 1);
+  ck_assert_int_eq(value->type, HOEL_COL_TYPE_DOUBLE);
+  ck_assert_double_eq(value->v.d_value, 5.4);
+  value = h_value_result_get(&result, 0, 2);
+  ck_assert_int_eq(value->type, HOEL_COL_TYPE_TEXT);
+  ck_assert_int_eq(value->length, 6);
+  ck_assert_str_eq(value->v.text, "value1");
+  ck_assert_str_eq(h_value_get_bytes(value), "value1");
+  value = h_value_result_get(&result, 1, 2);
+  ck_assert_int_eq(value->type, HOEL_COL_TYPE_TEXT);
+  ck_assert_str_eq(h_value_get_bytes(value), "a value longer than fifteen characters");
+  value = h_value_result_get(&result, 1, 3);
+  ck_assert_int_eq(value->type, HOEL_COL_TYPE_NULL);
+  ck_assert_ptr_eq(h_value_get_bytes(value), NULL);
+  ck_assert_ptr_eq(h_value_result_get(&result, 2, 0), NULL);
+  ck_assert_ptr_eq(h_value_result_get(&result, 0, 4), NULL);
+  ck_assert_int_eq(h_clean_value_result(&result), H_OK);
+  ck_assert_int_eq(h_execute_query_value(conn, "SELECT * FROM wrong_table", &result), H_ERROR_QUERY);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_cursor_select)
+{
+  struct _h_connection * conn;
+  struct _h_cursor cursor;
+  struct _h_result result;
+  json_t * j_result;
+  unsigned int nb_rows = 0;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_table (integer_col, double_col, string_col, date_col) VALUES (3, 6.6, 'value3', NULL)"), H_OK);
+  ck_assert_int_eq(h_cursor_open(NULL, SELECT_DATA_ALL, &cursor), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_cursor_open(conn, NULL, &cursor), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_cursor_open(conn, SELECT_DATA_ALL, NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_cursor_open(conn, "SELECT * FROM wrong_table", &cursor), H_ERROR_QUERY);
+  
+  ck_assert_int_eq(h_cursor_open(conn, "SELECT integer_col, string_col FROM test_table ORDER BY integer_col", &cursor), H_OK);
+  ck_assert_int_eq(cursor.nb_columns, 2);
+  ck_assert_int_eq(h_cursor_next(&cursor, &result, 0), H_ERROR_PARAMS);
+  do {
+    ck_assert_int_eq(h_cursor_next(&cursor, &result, 2), H_OK);
+    ck_assert_int_le(result.nb_rows, 2);
+    if (result.nb_rows) {
+      ck_assert_int_eq(result.nb_columns, 2);
+      ck_assert_int_eq(result.data[0][0].type, HOEL_COL_TYPE_INT);
+      ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, (long long int)nb_rows+1);
+    }
+    nb_rows += result.nb_rows;
+    ck_assert_int_eq(h_clean_result(&result), H_OK);
+  } while (result.nb_rows || !cursor.end);
+  ck_assert_int_eq(nb_rows, 3);
+  ck_assert_int_eq(h_cursor_close(&cursor), H_OK);
+  
+  ck_assert_int_eq(h_cursor_open(conn, "SELECT integer_col, string_col FROM test_table ORDER BY integer_col", &cursor), H_OK);
+  ck_assert_int_eq(h_cursor_next_json(&cursor, &j_result, 1), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), 1);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "string_col")), "value1");
+  json_decref(j_result);
+  ck_assert_int_eq(h_cursor_close(&cursor), H_OK);
+  ck_assert_int_eq(h_cursor_close(&cursor), H_ERROR_PARAMS);
+  
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_prepared_statement)
+{
+  struct _h_connection * conn;
+  struct _h_statement stmt;
+  struct _h_result result;
+  struct _h_cursor cursor;
+  json_t * j_result;
+  long long int i;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_prepare(NULL, "SELECT 1", &stmt), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_prepare(conn, NULL, &stmt), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_prepare(conn, "SELECT 1", NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_prepare(conn, "SELECT * FROM wrong_table WHERE integer_col=?", &stmt), H_ERROR_QUERY);
+  
+  ck_assert_int_eq(h_prepare(conn, "INSERT INTO test_table (integer_col, double_col, string_col) VALUES (?, ?, ?)", &stmt), H_OK);
+  ck_assert_int_eq(stmt.nb_params, 3);
+  ck_assert_int_eq(h_bind_int(&stmt, 0, 1), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_bind_int(&stmt, 4, 1), H_ERROR_PARAMS);
+  for (i=1; i<=3; i++) {
+    ck_assert_int_eq(h_bind_int(&stmt, 1, i), H_OK);
+    ck_assert_int_eq(h_bind_double(&stmt, 2, (double)i+0.5), H_OK);
+    if (i == 2) {
+      ck_assert_int_eq(h_bind_text(&stmt, 3, "a value longer than fifteen characters with a 'quote'"), H_OK);
+    } else if (i == 3) {
+      ck_assert_int_eq(h_bind_null(&stmt, 3), H_OK);
+    } else {
+      ck_assert_int_eq(h_bind_text(&stmt, 3, "value1"), H_OK);
+    }
+    ck_assert_int_eq(h_execute_prepared(&stmt, NULL), H_OK);
+  }
+  ck_assert_int_eq(h_finalize(&stmt), H_OK);
+  ck_assert_int_eq(h_finalize(&stmt), H_ERROR_PARAMS);
+  
+  ck_assert_int_eq(h_prepare(conn, "SELECT integer_col, double_col, string_col FROM test_table WHERE integer_col >= ? ORDER BY integer_col", &stmt), H_OK);
+  ck_assert_int_eq(stmt.nb_params, 1);
+  ck_assert_int_eq(h_bind_int(&stmt, 1, 2), H_OK);
+  ck_assert_int_eq(h_execute_prepared(&stmt, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 2);
+  ck_assert_int_eq(result.nb_columns, 3);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 2);
+  ck_assert_double_eq(((struct _h_type_double *)result.data[0][1].t_data)->value, 2.5);
+  ck_assert_str_eq(((struct _h_type_text *)result.data[0][2].t_data)->value, "a value longer than fifteen characters with a 'quote'");
+  ck_assert_int_eq(result.data[1][2].type, HOEL_COL_TYPE_NULL);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  ck_assert_int_eq(h_bind_int(&stmt, 1, 1), H_OK);
+  ck_assert_int_eq(h_execute_prepared_json(&stmt, &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 3);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "string_col")), "value1");
+  json_decref(j_result);
+  
+  ck_assert_int_eq(h_cursor_open_prepared(&stmt, &cursor), H_OK);
+  ck_assert_int_eq(h_cursor_next(&cursor, &result, 1), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_cursor_close(&cursor), H_OK);
+  
+  ck_assert_int_eq(h_bind_int(&stmt, 1, 3), H_OK);
+  ck_assert_int_eq(h_execute_prepared(&stmt, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_finalize(&stmt), H_OK);
+  
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_statement_cache)
+{
+  struct _h_connection * conn;
+  struct _h_result result;
+  json_t * j_result;
+  int i;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_set_statement_cache_size(NULL, 4), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_set_statement_cache_size(conn, 2), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  for (i=0; i<3; i++) {
+    ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+    ck_assert_int_eq(result.nb_rows, 1);
+    ck_assert_int_eq(h_clean_result(&result), H_OK);
+    ck_assert_int_eq(h_query_select_json(conn, SELECT_DATA_1, &j_result), H_OK);
+    ck_assert_int_eq(json_array_size(j_result), 1);
+    json_decref(j_result);
+    ck_assert_int_eq(h_query_select(conn, SELECT_DATA_2, &result), H_OK);
+    ck_assert_int_eq(result.nb_rows, 0);
+    ck_assert_int_eq(h_clean_result(&result), H_OK);
+    // The statements are cached with the query given, trailing text included
+    ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1 "; -- trailing comment", &result), H_OK);
+    ck_assert_int_eq(result.nb_rows, 1);
+    ck_assert_int_eq(h_clean_result(&result), H_OK);
+  }
+  
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "DROP TABLE IF EXISTS test_cache"), H_OK);
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "CREATE TABLE test_cache (a INTEGER)"), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_cache (a) VALUES (1)"), H_OK);
+  ck_assert_int_eq(h_query_select(conn, "SELECT * FROM test_cache", &result), H_OK);
+  ck_assert_int_eq(result.nb_columns, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "ALTER TABLE test_cache ADD COLUMN b TEXT"), H_OK);
+  ck_assert_int_eq(h_query_select(conn, "SELECT * FROM test_cache", &result), H_OK);
+  ck_assert_int_eq(result.nb_columns, 2);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "DROP TABLE test_cache"), H_OK);
+  ck_assert_int_eq(h_query_select(conn, "SELECT * FROM test_cache", &result), H_ERROR_QUERY);
+  
+  ck_assert_int_eq(h_set_statement_cache_size(conn, 0), H_OK);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_set_statement_cache_size(conn, 16), H_OK);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_pool)
+{
+  struct _h_pool * pool;
+  struct _h_connection * conn[4], * conn_again;
+  struct pool_thread_arg args[8];
+  struct pool_release_arg release_args[2];
+  pthread_t threads[8];
+  struct _h_result result;
+  json_t * j_query, * j_result;
+  int i;
+  ck_assert_ptr_eq(h_pool_new_sqlite(DEFAULT_BD_PATH, 0), NULL);
+  ck_assert_ptr_eq(h_pool_new_sqlite(WRONG_BD_PATH, 4), NULL);
+  pool = h_pool_new_sqlite(DEFAULT_BD_PATH, 4);
+  ck_assert_ptr_ne(pool, NULL);
+  ck_assert_int_eq(h_pool_query_delete(pool, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_pool_query_insert(pool, INSERT_DATA_1), H_OK);
+  
+  ck_assert_int_eq(h_pool_set_timeout(pool, 100), H_OK);
+  for (i=0; i<4; i++) {
+    conn[i] = h_pool_acquire(pool);
+    ck_assert_ptr_ne(conn[i], NULL);
+  }
+  ck_assert_ptr_ne(conn[0], conn[1]);
+  ck_assert_ptr_eq(h_pool_acquire(pool), NULL);
+  ck_assert_int_eq(h_pool_query_select(pool, SELECT_DATA_1, &result), H_ERROR_TIMEOUT);
+  ck_assert_int_eq(h_pool_close(pool), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_select(conn[3], SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  /* A transaction left open is rolled back on release */
+  ck_assert_int_eq(h_execute_query_sqlite(conn[3], "BEGIN"), H_OK);
+  ck_assert_int_eq(h_query_insert(conn[3], INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_pool_release(pool, conn[3]), H_OK);
+  ck_assert_int_eq(h_pool_release(pool, conn[3]), H_ERROR_PARAMS);
+  conn_again = h_pool_acquire(pool);
+  ck_assert_ptr_eq(conn_again, conn[3]);
+  ck_assert_int_eq(h_query_select(conn_again, SELECT_DATA_2, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 0);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_execute_query_sqlite(conn_again, "BEGIN"), H_OK);
+  ck_assert_int_eq(h_execute_query_sqlite(conn_again, "COMMIT"), H_OK);
+  for (i=0; i<4; i++) {
+    ck_assert_int_eq(h_pool_release(pool, conn[i]), H_OK);
+  }
+  
+  ck_assert_int_eq(h_pool_set_timeout(pool, H_POOL_DEFAULT_TIMEOUT), H_OK);
+  for (i=0; i<8; i++) {
+    args[i].pool = pool;
+    args[i].errors = 0;
+    ck_assert_int_eq(pthread_create(&threads[i], NULL, pool_select_thread, &args[i]), 0);
+  }
+  for (i=0; i<8; i++) {
+    ck_assert_int_eq(pthread_join(threads[i], NULL), 0);
+    ck_assert_int_eq(args[i].errors, 0);
+  }
+  
+  /* A connection released by two threads at the same time is given back once */
+  for (i=0; i<50; i++) {
+    release_args[0].pool = release_args[1].pool = pool;
+    release_args[0].conn = release_args[1].conn = h_pool_acquire(pool);
+    ck_assert_ptr_ne(release_args[0].conn, NULL);
+    ck_assert_int_eq(pthread_create(&threads[0], NULL, pool_release_thread, &release_args[0]), 0);
+    ck_assert_int_eq(pthread_create(&threads[1], NULL, pool_release_thread, &release_args[1]), 0);
+    ck_assert_int_eq(pthread_join(threads[0], NULL), 0);
+    ck_assert_int_eq(pthread_join(threads[1], NULL), 0);
+    ck_assert_int_eq(release_args[0].res + release_args[1].res, H_ERROR_PARAMS);
+    ck_assert_int_eq(pool->nb_available, 4);
+  }
+  
+  j_query = json_pack("{sss{si}}", "table", "test_table", "where", "integer_col", 1);
+  ck_assert_int_eq(h_pool_select(pool, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  json_decref(j_result);
+  json_decref(j_query);
+  ck_assert_int_eq(h_pool_query_delete(pool, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_pool_close(pool), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_transaction)
+{
+  struct _h_connection * conn;
+  struct _h_result result;
+  struct transaction_thread_arg arg;
+  pthread_t thread;
+  int done;
+  
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_commit(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_rollback(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_savepoint(conn, "sp1"), H_ERROR_PARAMS);
+  
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_transaction_begin(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_commit(conn), H_OK);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  ck_assert_int_eq(h_rollback(conn), H_OK);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_savepoint(conn, "sp1"), H_OK);
+  ck_assert_int_eq(h_savepoint(conn, "sp'1"), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  ck_assert_int_eq(h_rollback_to_savepoint(conn, "sp1"), H_OK);
+  ck_assert_int_eq(h_release_savepoint(conn, "sp1"), H_OK);
+  ck_assert_int_eq(h_release_savepoint(conn, "sp1"), H_ERROR_QUERY);
+  ck_assert_int_eq(h_commit(conn), H_OK);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  /* The queries of another thread wait until the transaction ends */
+  arg.conn = conn;
+  arg.done = 0;
+  arg.res = H_ERROR;
+  pthread_mutex_init(&arg.lock, NULL);
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  ck_assert_int_eq(pthread_create(&thread, NULL, transaction_insert_thread, &arg), 0);
+  usleep(100000);
+  pthread_mutex_lock(&arg.lock);
+  done = arg.done;
+  pthread_mutex_unlock(&arg.lock);
+  ck_assert_int_eq(done, 0);
+  ck_assert_int_eq(h_rollback(conn), H_OK);
+  ck_assert_int_eq(pthread_join(thread, NULL), 0);
+  ck_assert_int_eq(arg.res, H_OK);
+  pthread_mutex_destroy(&arg.lock);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_2, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  /* A transaction left open is rolled back by h_check_connection */
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  ck_assert_int_eq(h_check_connection(conn), H_OK);
+  ck_assert_int_eq(h_commit(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_1, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_json_stream_select)
+{
+  struct _h_connection * conn;
+  char * output = o_strdup("");
+  json_t * j_result, * j_expected;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_table (integer_col, double_col, string_col, date_col) VALUES (2, 5.0, 'a \"quoted\"\\ value\n', NULL)"), H_OK);
+  ck_assert_int_eq(h_query_select_json_stream(NULL, SELECT_DATA_ALL, json_stream_write, &output), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_select_json_stream(conn, NULL, json_stream_write, &output), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_select_json_stream(conn, SELECT_DATA_ALL, NULL, &output), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_select_json_stream(conn, "SELECT * FROM wrong_table", json_stream_write, &output), H_ERROR_QUERY);
+  ck_assert_int_eq(h_query_select_json_fd(conn, SELECT_DATA_ALL, -1), H_ERROR_PARAMS);
+  
+  ck_assert_int_eq(h_query_select_json_stream(conn, "SELECT integer_col, double_col, string_col FROM test_table ORDER BY integer_col", json_stream_write, &output), H_OK);
+  ck_assert_str_eq(output, "[{\"integer_col\":1,\"double_col\":4.2000000000000002,\"string_col\":\"value1\"},{\"integer_col\":2,\"double_col\":5.0,\"string_col\":\"a \\\"quoted\\\"\\\\ value\\n\"}]");
+  o_free(output);
+  
+  // The blob values are hex-encoded, so the json text is valid
+  output = o_strdup("");
+  ck_assert_int_eq(h_query_select_json_stream(conn, "SELECT x'00ff22' AS b, x'' AS e", json_stream_write, &output), H_OK);
+  ck_assert_str_eq(output, "[{\"b\":\"\\\\x00ff22\",\"e\":\"\\\\x\"}]");
+  o_free(output);
+  
+  output = o_strdup("");
+  ck_assert_int_eq(h_query_select_json_stream(conn, "SELECT * FROM test_table WHERE integer_col > 10", json_stream_write, &output), H_OK);
+  ck_assert_str_eq(output, "[]");
+  o_free(output);
+  
+  output = o_strdup("");
+  ck_assert_int_eq(h_query_select_json_stream(conn, "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<1000) SELECT x, 'value' AS s FROM c", json_stream_write, &output), H_OK);
+  ck_assert_ptr_ne((j_result = json_loads(output, 0, NULL)), NULL);
+  ck_assert_int_eq(h_execute_query_json(conn, "WITH RECURSIVE c(x) AS (SELECT 1 UNION ALL SELECT x+1 FROM c WHERE x<1000) SELECT x, 'value' AS s FROM c", &j_expected), H_OK);
+  ck_assert_int_eq(json_equal(j_result, j_expected), 1);
+  json_decref(j_result);
+  json_decref(j_expected);
+  o_free(output);
+  
+  ck_assert_int_eq(h_query_select_json_stream(conn, SELECT_DATA_ALL, json_stream_write_error, NULL), H_ERROR);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
 START_TEST(test_hoel_json_insert)
 {
   struct _h_connection * conn;
@@ -293,6 +890,164 @@ START_TEST(test_hoel_json_insert)
 }
 END_TEST
 
+START_TEST(test_hoel_json_insert_chunks)
+{
+  struct _h_connection * conn;
+  struct _h_pool * pool;
+  json_t * j_query, * j_values, * j_report = NULL, * j_result = NULL;
+  char * str_query = NULL;
+  int i;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  j_query = json_pack("{sss[]si}", "table", "test_table", "values", "chunk_rows", 10);
+  j_values = json_object_get(j_query, "values");
+  for (i=0; i<25; i++) {
+    json_array_append_new(j_values, json_pack("{sisfss}", "integer_col", i, "double_col", (double)i/2, "string_col", "chunk'value"));
+  }
+  ck_assert_int_eq(h_insert(conn, j_query, &str_query), H_OK);
+  ck_assert_ptr_ne(o_strstr(str_query, "(9,4.500000,'chunk''value');\nINSERT INTO test_table"), NULL);
+  ck_assert_ptr_ne(o_strstr(str_query, "VALUES (10,5.000000,'chunk''value')"), NULL);
+  ck_assert_ptr_ne(o_strstr(str_query, "(24,12.000000,'chunk''value')"), NULL);
+  h_free(str_query);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT COUNT(*) AS nb FROM test_table", &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "nb")), 25);
+  json_decref(j_result);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  
+  // Without limits, the rows are inserted with a single query
+  json_object_del(j_query, "chunk_rows");
+  ck_assert_int_eq(h_insert(conn, j_query, &str_query), H_OK);
+  ck_assert_ptr_eq(o_strstr(str_query, ";\n"), NULL);
+  ck_assert_ptr_ne(o_strstr(str_query, "(24,12.000000,'chunk''value')"), NULL);
+  h_free(str_query);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  json_object_set_new(j_query, "chunk_rows", json_integer(10));
+  
+  // The chunks of h_insert are inserted in a transaction, or in a savepoint in an open transaction
+  json_object_set_new(json_array_get(j_values, 15), "date_col", json_null());
+  ck_assert_int_eq(h_insert(conn, j_query, NULL), H_ERROR_QUERY);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT COUNT(*) AS nb FROM test_table", &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "nb")), 0);
+  json_decref(j_result);
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_table (integer_col) VALUES (100)"), H_OK);
+  ck_assert_int_eq(h_insert(conn, j_query, NULL), H_ERROR_QUERY);
+  ck_assert_int_eq(h_commit(conn), H_OK);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT COUNT(*) AS nb FROM test_table", &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "nb")), 1);
+  json_decref(j_result);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  json_object_del(json_array_get(j_values, 15), "date_col");
+  
+  ck_assert_int_eq(h_insert_chunks(NULL, j_query, &j_report), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_insert_chunks(conn, j_query, NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_insert_chunks(conn, j_query, &j_report), H_OK);
+  ck_assert_int_eq(json_array_size(j_report), 3);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_report, 2), "offset")), 20);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_report, 2), "rows")), 5);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_report, 2), "result")), H_OK);
+  json_decref(j_report);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  
+  json_object_del(j_query, "chunk_rows");
+  json_object_set_new(j_query, "chunk_bytes", json_integer(200));
+  ck_assert_int_eq(h_insert_chunks(conn, j_query, &j_report), H_OK);
+  ck_assert_int_gt(json_array_size(j_report), 3);
+  ck_assert_int_lt(json_integer_value(json_object_get(json_array_get(j_report, 0), "rows")), 10);
+  json_decref(j_report);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT COUNT(*) AS nb FROM test_table", &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "nb")), 25);
+  json_decref(j_result);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  
+  json_object_del(j_query, "chunk_bytes");
+  json_object_set_new(j_query, "chunk_rows", json_integer(10));
+  json_object_set_new(json_array_get(j_values, 15), "date_col", json_null());
+  ck_assert_int_eq(h_insert_chunks(conn, j_query, &j_report), H_ERROR_QUERY);
+  ck_assert_int_eq(json_array_size(j_report), 2);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_report, 0), "result")), H_OK);
+  ck_assert_int_ne(json_integer_value(json_object_get(json_array_get(j_report, 1), "result")), H_OK);
+  json_decref(j_report);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT COUNT(*) AS nb FROM test_table", &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "nb")), 10);
+  json_decref(j_result);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  json_object_del(json_array_get(j_values, 15), "date_col");
+  
+  json_array_append_new(j_values, json_object());
+  ck_assert_int_eq(h_insert(conn, j_query, NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT COUNT(*) AS nb FROM test_table", &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "nb")), 0);
+  json_decref(j_result);
+  json_array_remove(j_values, 25);
+  
+  pool = h_pool_new_sqlite(DEFAULT_BD_PATH, 4);
+  ck_assert_ptr_ne(pool, NULL);
+  ck_assert_int_eq(h_pool_insert_chunks(NULL, j_query, 4, &j_report), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pool_insert_chunks(pool, j_query, 4, &j_report), H_OK);
+  ck_assert_int_eq(json_array_size(j_report), 3);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_report, 1), "offset")), 10);
+  json_decref(j_report);
+  ck_assert_int_eq(h_pool_close(pool), H_OK);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT COUNT(*) AS nb FROM test_table", &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "nb")), 25);
+  json_decref(j_result);
+  json_decref(j_query);
+  
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_json_bulk_insert)
+{
+  struct _h_connection * conn;
+  struct _h_result result;
+  json_t * j_query, * j_values = json_array(), * j_row;
+  int i;
+  
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  for (i=0; i<1000; i++) {
+    json_array_append_new(j_values, json_pack("{sisfss}", "integer_col", 3, "double_col", (double)i, "string_col", i%2?"odd":UNSAFE_STRING));
+  }
+  j_query = json_pack("{sssO}", "table", "test_table", "values", j_values);
+  ck_assert_int_eq(h_bulk_insert(conn, j_query), H_OK);
+  ck_assert_int_eq(h_query_select(conn, "SELECT COUNT(*), SUM(double_col) FROM test_table WHERE integer_col = 3 AND string_col = 'odd'", &result), H_OK);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 500);
+  ck_assert_double_eq(((struct _h_type_double *)result.data[0][1].t_data)->value, 250000.0);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, "DELETE FROM test_table WHERE integer_col = 3"), H_OK);
+  
+  // A raw value cancels the whole insert
+  j_row = json_pack("{sis{ss}ss}", "integer_col", 3, "double_col", "raw", "1.0", "string_col", "raw");
+  json_array_append_new(j_values, j_row);
+  ck_assert_int_eq(h_bulk_insert(conn, j_query), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_select(conn, "SELECT COUNT(*) FROM test_table WHERE integer_col = 3", &result), H_OK);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 0);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  // In an open transaction, the insert runs in a savepoint
+  json_array_remove(j_values, 1000);
+  ck_assert_int_eq(h_execute_query(conn, "BEGIN", NULL, H_OPTION_EXEC), H_OK);
+  ck_assert_int_eq(h_bulk_insert(conn, j_query), H_OK);
+  ck_assert_int_eq(h_execute_query(conn, "ROLLBACK", NULL, H_OPTION_EXEC), H_OK);
+  ck_assert_int_eq(h_query_select(conn, "SELECT COUNT(*) FROM test_table WHERE integer_col = 3", &result), H_OK);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 0);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  json_decref(j_query);
+  json_decref(j_values);
+  
+  j_query = json_pack("{sss[]}", "table", "test_table", "values");
+  ck_assert_int_eq(h_bulk_insert(conn, j_query), H_ERROR_PARAMS);
+  json_decref(j_query);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
 START_TEST(test_hoel_json_update)
 {
   struct _h_connection * conn;
@@ -644,6 +1399,164 @@ START_TEST(test_hoel_json_select)
 }
 END_TEST
 
+START_TEST(test_hoel_json_compact_select)
+{
+  struct _h_connection * conn;
+  json_t * j_query, * j_result = NULL;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_execute_query_json_compact(NULL, SELECT_DATA_ALL, &j_result), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_execute_query_json_compact(conn, NULL, &j_result), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_execute_query_json_compact(conn, SELECT_DATA_ALL, NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_execute_query_json_compact(conn, "SELECT * FROM wrong_table", &j_result), H_ERROR_QUERY);
+  
+  ck_assert_int_eq(h_execute_query_json_compact(conn, "SELECT integer_col, string_col, date_col FROM test_table ORDER BY integer_col", &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(json_object_get(j_result, "columns")), 3);
+  ck_assert_str_eq(json_string_value(json_array_get(json_object_get(j_result, "columns"), 0)), "integer_col");
+  ck_assert_str_eq(json_string_value(json_array_get(json_object_get(j_result, "columns"), 1)), "string_col");
+  ck_assert_int_eq(json_array_size(json_object_get(j_result, "rows")), 2);
+  ck_assert_int_eq(json_array_size(json_array_get(json_object_get(j_result, "rows"), 0)), 3);
+  ck_assert_int_eq(json_integer_value(json_array_get(json_array_get(json_object_get(j_result, "rows"), 1), 0)), 2);
+  ck_assert_str_eq(json_string_value(json_array_get(json_array_get(json_object_get(j_result, "rows"), 1), 1)), "value2");
+  json_decref(j_result);
+  
+  ck_assert_int_eq(h_execute_query_json_compact(conn, "SELECT integer_col, string_col FROM test_table WHERE integer_col > 10", &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(json_object_get(j_result, "columns")), 2);
+  ck_assert_int_eq(json_array_size(json_object_get(j_result, "rows")), 0);
+  json_decref(j_result);
+  
+  j_query = json_pack("{sss[ss]s{si}so}", "table", "test_table", "columns", "integer_col", "double_col", "where", "integer_col", 1, "compact", json_true());
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_str_eq(json_string_value(json_array_get(json_object_get(j_result, "columns"), 1)), "double_col");
+  ck_assert_int_eq(json_array_size(json_object_get(j_result, "rows")), 1);
+  ck_assert_double_eq(json_real_value(json_array_get(json_array_get(json_object_get(j_result, "rows"), 0), 1)), 4.2);
+  json_decref(j_result);
+  json_decref(j_query);
+  
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
+START_TEST(test_hoel_json_statement_cache)
+{
+  struct _h_connection * conn;
+  json_t * j_query, * j_result = NULL;
+  char * str_query = NULL;
+  unsigned long nb_hits, nb_prepared, nb_hits_after, nb_prepared_after;
+  int i, size;
+  conn = h_connect_sqlite(DEFAULT_BD_PATH);
+  ck_assert_ptr_ne(conn, NULL);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  j_query = json_pack("{sss[{sisfss}{sisfss}{sisfss}{sisfsn}]}", "table", "test_table", "values",
+                      "integer_col", 1, "double_col", 1.5, "string_col", "value1",
+                      "integer_col", 2, "double_col", 2.5, "string_col", "value'2",
+                      "integer_col", 3, "double_col", 3.5, "string_col", "value3",
+                      "integer_col", 4, "double_col", 4.5, "string_col");
+  ck_assert_int_eq(h_insert(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  
+  for (size=16; size>=0; size-=16) {
+    ck_assert_int_eq(h_set_statement_cache_size(conn, (unsigned int)size), H_OK);
+    ck_assert_int_eq(h_get_statement_cache_stats(conn, &nb_hits, &nb_prepared), H_OK);
+    for (i=1; i<=4; i++) {
+      j_query = json_pack("{sss[ss]s{si}}", "table", "test_table", "columns", "integer_col", "string_col", "where", "integer_col", i);
+      ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+      ck_assert_int_eq(json_array_size(j_result), 1);
+      ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), i);
+      json_decref(j_result);
+      json_decref(j_query);
+    }
+    // The queries with the same shape are prepared once
+    ck_assert_int_eq(h_get_statement_cache_stats(conn, &nb_hits_after, &nb_prepared_after), H_OK);
+    ck_assert_int_eq(nb_prepared_after - nb_prepared, size?1:0);
+    ck_assert_int_eq(nb_hits_after - nb_hits, size?3:0);
+    
+    j_query = json_pack("{sss{ss}}", "table", "test_table", "where", "string_col", "value'2");
+    ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+    ck_assert_int_eq(json_array_size(j_result), 1);
+    ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), 2);
+    json_decref(j_result);
+    json_decref(j_query);
+    
+    j_query = json_pack("{sss{sn}}", "table", "test_table", "where", "string_col");
+    ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+    ck_assert_int_eq(json_array_size(j_result), 1);
+    ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), 4);
+    json_decref(j_result);
+    json_decref(j_query);
+    
+    j_query = json_pack("{sss[s]s{s{sss[iis]}s{sssf}}sssisi}", "table", "test_table", "columns", "integer_col", "where", "integer_col", "operator", "IN", "value", 1, 3, "4", "double_col", "operator", ">", "value", 1.0, "order_by", "integer_col", "limit", 1, "offset", 1);
+    ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+    ck_assert_int_eq(json_array_size(j_result), 1);
+    ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), 3);
+    json_decref(j_result);
+    ck_assert_int_eq(h_select(conn, j_query, &j_result, &str_query), H_OK);
+    ck_assert_str_eq(str_query, "SELECT integer_col FROM test_table WHERE integer_col IN (1,3,'4') AND double_col > 1.000000 ORDER BY integer_col LIMIT 1 OFFSET 1");
+    ck_assert_int_eq(json_array_size(j_result), 1);
+    h_free(str_query);
+    json_decref(j_result);
+    json_decref(j_query);
+    
+    j_query = json_pack("{sss{s{ssss}}}", "table", "test_table", "where", "integer_col", "operator", "raw", "value", "> 3");
+    ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+    ck_assert_int_eq(json_array_size(j_result), 1);
+    json_decref(j_result);
+    json_decref(j_query);
+    
+    for (i=1; i<=3; i++) {
+      j_query = json_pack("{sss{sf}s{si}}", "table", "test_table", "set", "double_col", (double)i*(double)(size+1), "where", "integer_col", i);
+      ck_assert_int_eq(h_update(conn, j_query, NULL), H_OK);
+      json_decref(j_query);
+    }
+    j_query = json_pack("{sss{s{ss}}s{ss}}", "table", "test_table", "set", "integer_col", "raw", "integer_col", "where", "string_col", "value'2");
+    ck_assert_int_eq(h_update(conn, j_query, NULL), H_OK);
+    json_decref(j_query);
+    j_query = json_pack("{sss{ss}}", "table", "test_table", "where", "string_col", "value'2");
+    ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+    ck_assert_int_eq(json_array_size(j_result), 1);
+    ck_assert_double_eq(json_real_value(json_object_get(json_array_get(j_result, 0), "double_col")), 2.0*(size+1));
+    json_decref(j_result);
+    json_decref(j_query);
+  }
+  
+  j_query = json_pack("{sss{si}}", "table", "test_table", "where", "integer_col", 4);
+  ck_assert_int_eq(h_delete(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  j_query = json_pack("{sss{si}}", "table", "test_table", "where", "integer_col", 3);
+  ck_assert_int_eq(h_delete(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  j_query = json_pack("{ss}", "table", "test_table");
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 2);
+  json_decref(j_result);
+  json_decref(j_query);
+  
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "DROP TABLE IF EXISTS test_cache"), H_OK);
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "CREATE TABLE test_cache (a INTEGER)"), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_cache (a) VALUES (1)"), H_OK);
+  j_query = json_pack("{sss{si}}", "table", "test_cache", "where", "a", 1);
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_object_size(json_array_get(j_result, 0)), 1);
+  json_decref(j_result);
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "ALTER TABLE test_cache ADD COLUMN b TEXT"), H_OK);
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_object_size(json_array_get(j_result, 0)), 2);
+  json_decref(j_result);
+  ck_assert_int_eq(h_execute_query_sqlite(conn, "DROP TABLE test_cache"), H_OK);
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_ERROR_QUERY);
+  json_decref(j_query);
+  
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_close_db(conn), H_OK);
+  ck_assert_int_eq(h_clean_connection(conn), H_OK);
+}
+END_TEST
+
 START_TEST(test_hoel_json_escape)
 {
   struct _h_connection * conn;
@@ -1096,10 +2009,23 @@ static Suite *hoel_suite(void)
 	tcase_add_test(tc_core, test_hoel_insert);
 	tcase_add_test(tc_core, test_hoel_update);
 	tcase_add_test(tc_core, test_hoel_delete);
+	tcase_add_test(tc_core, test_hoel_arena_select);
+	tcase_add_test(tc_core, test_hoel_columnar_select);
+	tcase_add_test(tc_core, test_hoel_value_select);
+	tcase_add_test(tc_core, test_hoel_cursor_select);
+	tcase_add_test(tc_core, test_hoel_prepared_statement);
+	tcase_add_test(tc_core, test_hoel_statement_cache);
+	tcase_add_test(tc_core, test_hoel_pool);
+	tcase_add_test(tc_core, test_hoel_transaction);
+	tcase_add_test(tc_core, test_hoel_json_stream_select);
 	tcase_add_test(tc_core, test_hoel_json_insert);
+	tcase_add_test(tc_core, test_hoel_json_insert_chunks);
+	tcase_add_test(tc_core, test_hoel_json_bulk_insert);
 	tcase_add_test(tc_core, test_hoel_json_update);
 	tcase_add_test(tc_core, test_hoel_json_delete);
 	tcase_add_test(tc_core, test_hoel_json_select);
+	tcase_add_test(tc_core, test_hoel_json_compact_select);
+	tcase_add_test(tc_core, test_hoel_json_statement_cache);
 	tcase_add_test(tc_core, test_hoel_json_escape);
 	tcase_add_test(tc_core, test_hoel_json_generate_where_clause);
 	tcase_set_timeout(tc_core, 30);
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <poll.h>
 #include <jansson.h>
 
 #include <check.h>
@@ -451,6 +452,384 @@ START_TEST(test_hoel_delete)
 }
 END_TEST
 
+START_TEST(test_hoel_binary_result)
+{
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  struct _h_result result;
+  json_t * j_result = NULL, * j_row;
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_execute_query_json_options(conn, "SELECT integer_col, double_col, string_col FROM test_table WHERE integer_col = 2", &j_result, H_OPTION_BINARY), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  j_row = json_array_get(j_result, 0);
+  ck_assert_int_eq(json_integer_value(json_object_get(j_row, "integer_col")), 2);
+  ck_assert_double_eq(json_real_value(json_object_get(j_row, "double_col")), 5.4);
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "string_col")), "value2");
+  json_decref(j_result);
+  ck_assert_int_eq(h_execute_query(conn, "SELECT integer_col, double_col FROM test_table WHERE integer_col = 2", &result, H_OPTION_BINARY), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 2);
+  ck_assert_double_eq(((struct _h_type_double *)result.data[0][1].t_data)->value, 5.4);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+#ifdef PGSQL
+  ck_assert_int_eq(h_execute_query_json_options(conn, "SELECT -42::int2 AS i2, 9000000000::int8 AS i8, 1.5::float4 AS f4, -1234.5::numeric AS num, true AS b, '\\x00ff'::bytea AS bin, '2016-06-22 00:52:56'::timestamp AS ts, '2016-06-22 00:52:56.5+02'::timestamptz AS tstz, '10:11:12.125'::time AS t, '2016-06-22'::date AS d, 'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'::uuid AS id, '{\"a\": 1}'::jsonb AS j, NULL::int4 AS n", &j_result, H_OPTION_BINARY), H_OK);
+  j_row = json_array_get(j_result, 0);
+  ck_assert_int_eq(json_integer_value(json_object_get(j_row, "i2")), -42);
+  ck_assert_int_eq(json_integer_value(json_object_get(j_row, "i8")), 9000000000);
+  ck_assert_double_eq(json_real_value(json_object_get(j_row, "f4")), 1.5);
+  ck_assert_double_eq(json_real_value(json_object_get(j_row, "num")), -1234.5);
+  ck_assert_int_eq(json_integer_value(json_object_get(j_row, "b")), 1);
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "bin")), "\\x00ff");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "ts")), "2016-06-22 00:52:56");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "tstz")), "2016-06-21 22:52:56.5+00");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "t")), "10:11:12.125");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "d")), "2016-06-22T00:00:00");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "id")), "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "j")), "{\"a\": 1}");
+  ck_assert_int_eq(json_is_null(json_object_get(j_row, "n")), 1);
+  json_decref(j_result);
+#endif
+#ifdef MARIADB
+  ck_assert_int_eq(h_execute_query_json_options(conn, "SELECT CAST(-42 AS SIGNED) AS i, 1.5e0 AS f, CAST('2016-06-22 00:52:56' AS DATETIME) AS ts, CAST('2016-06-22' AS DATE) AS d, CAST('10:11:12' AS TIME) AS t, 'value' AS s, NULL AS n", &j_result, H_OPTION_BINARY), H_OK);
+  j_row = json_array_get(j_result, 0);
+  ck_assert_int_eq(json_integer_value(json_object_get(j_row, "i")), -42);
+  ck_assert_double_eq(json_real_value(json_object_get(j_row, "f")), 1.5);
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "ts")), "2016-06-22T00:52:56");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "d")), "2016-06-22T00:00:00");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "t")), "1900-01-00T10:11:12");
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "s")), "value");
+  ck_assert_int_eq(json_is_null(json_object_get(j_row, "n")), 1);
+  json_decref(j_result);
+  // The values that can't be decoded in their binary format are decoded like the text protocol does
+  ck_assert_int_eq(h_execute_query_json_options(conn, "SELECT CAST(18446744073709551615 AS UNSIGNED) AS u, CAST(42 AS UNSIGNED) AS u2, CAST('0000-00-00' AS DATE) AS zd, CAST('-10:11:12' AS TIME) AS nt, CAST('100:11:12' AS TIME) AS lt, CAST(1.1 AS FLOAT) AS fl", &j_result, H_OPTION_BINARY), H_OK);
+  j_row = json_array_get(j_result, 0);
+  ck_assert_str_eq(json_string_value(json_object_get(j_row, "u")), "18446744073709551615");
+  ck_assert_int_eq(json_integer_value(json_object_get(j_row, "u2")), 42);
+  ck_assert_int_eq(json_is_null(json_object_get(j_row, "zd")), 1);
+  ck_assert_int_eq(json_is_null(json_object_get(j_row, "nt")), 1);
+  ck_assert_int_eq(json_is_null(json_object_get(j_row, "lt")), 1);
+  ck_assert_double_eq(json_real_value(json_object_get(j_row, "fl")), 1.1);
+  json_decref(j_result);
+  ck_assert_int_eq(h_execute_query_json_options(conn, "SELECT ? AS p", &j_result, H_OPTION_BINARY), H_ERROR_PARAMS);
+#endif
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_2), H_OK);
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
+START_TEST(test_hoel_view)
+{
+  struct _h_result_view view;
+#ifndef SQLITE
+  long long int i_value;
+  double d_value;
+  size_t length;
+#endif
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+#ifdef SQLITE
+  // Result views are not available with SQLite
+  ck_assert_int_eq(h_execute_query_view(conn, SELECT_DATA_1, &view), H_ERROR_PARAMS);
+#else
+  ck_assert_int_eq(h_execute_query_view(conn, SELECT_DATA_1, &view), H_OK);
+  ck_assert_int_eq(view.nb_rows, 1);
+  ck_assert_int_eq(view.nb_columns, 4);
+  ck_assert_int_eq(h_result_view_get_type(&view, 0, 0), HOEL_COL_TYPE_INT);
+  ck_assert_int_eq(h_result_view_get_int(&view, 0, 0, &i_value), H_OK);
+  ck_assert_int_eq(i_value, 1);
+  ck_assert_int_eq(h_result_view_get_double(&view, 0, 1, &d_value), H_OK);
+  ck_assert_double_eq(d_value, 4.2);
+  ck_assert_int_eq(0, memcmp(h_result_view_get(&view, 0, 2, &length), "value1", 6));
+  ck_assert_int_eq(length, 6);
+  ck_assert_int_eq(h_result_view_get_int(&view, 0, 2, &i_value), H_ERROR_PARAMS);
+  ck_assert_ptr_eq(h_result_view_get(&view, 1, 0, &length), NULL);
+  ck_assert_int_eq(h_result_view_free(&view), H_OK);
+  memset(&view, 0xff, sizeof(struct _h_result_view));
+  ck_assert_int_eq(h_execute_query_view(conn, "SELECT * FROM wrong_table", &view), H_ERROR_QUERY);
+  ck_assert_ptr_eq(view.result, NULL);
+  ck_assert_int_eq(view.nb_rows, 0);
+  ck_assert_int_eq(h_result_view_free(&view), H_OK);
+#endif
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
+START_TEST(test_hoel_async)
+{
+  struct _h_result result;
+  json_t * j_result;
+#if defined(PGSQL) || defined(MARIADB)
+  struct pollfd pfd;
+  int res;
+#endif
+#ifdef PGSQL
+  char * large_query;
+#endif
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+#ifdef SQLITE
+  // Asynchronous queries are available with PostgreSQL and MariaDB only
+  ck_assert_int_eq(h_async_send(conn, SELECT_DATA_1), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_async_poll(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_async_get_result(conn, &result), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_async_get_result_json(conn, &j_result), H_ERROR_PARAMS);
+#else
+  ck_assert_int_ge(h_get_socket_fd(conn), 0);
+  ck_assert_int_eq(h_async_poll(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_async_send(conn, SELECT_DATA_1), H_OK);
+  ck_assert_int_eq(h_async_send(conn, SELECT_DATA_1), H_ERROR_PARAMS);
+  pfd.fd = h_get_socket_fd(conn);
+  pfd.events = POLLIN;
+  while ((res = h_async_poll(conn)) == H_AGAIN) {
+    ck_assert_int_ge(poll(&pfd, 1, 1000), 0);
+  }
+  ck_assert_int_eq(res, H_OK);
+  ck_assert_int_eq(h_async_get_result(conn, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(result.nb_columns, 4);
+  ck_assert_int_eq(((struct _h_type_int *)result.data[0][0].t_data)->value, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  ck_assert_int_eq(h_async_send(conn, SELECT_DATA_1), H_OK);
+  ck_assert_int_eq(h_async_get_result_json(conn, &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), 1);
+  json_decref(j_result);
+  
+  ck_assert_int_eq(h_async_send(conn, "SELECT * FROM wrong_table"), H_OK);
+  ck_assert_int_eq(h_async_get_result(conn, NULL), H_ERROR_QUERY);
+  ck_assert_int_eq(h_async_get_result(conn, &result), H_ERROR_PARAMS);
+  
+  // A slow query isn't ready right after it's sent, reading its result waits for it
+#ifdef MARIADB
+  ck_assert_int_eq(h_async_send(conn, "SELECT SLEEP(1)"), H_OK);
+#else
+  ck_assert_int_eq(h_async_send(conn, "SELECT pg_sleep(1)"), H_OK);
+#endif
+  ck_assert_int_eq(h_async_poll(conn), H_AGAIN);
+  ck_assert_int_eq(h_async_get_result(conn, NULL), H_OK);
+  ck_assert_int_eq(h_async_poll(conn), H_ERROR_PARAMS);
+  
+#ifdef PGSQL
+  // A large query is sent by h_async_poll when the socket is writable
+  large_query = o_malloc(4*1024*1024+32);
+  strcpy(large_query, "SELECT length('");
+  memset(large_query+15, 'a', 4*1024*1024);
+  strcpy(large_query+15+4*1024*1024, "') AS l");
+  ck_assert_int_eq(h_async_send(conn, large_query), H_OK);
+  pfd.events = POLLIN|POLLOUT;
+  while ((res = h_async_poll(conn)) == H_AGAIN) {
+    ck_assert_int_ge(poll(&pfd, 1, 1000), 0);
+  }
+  ck_assert_int_eq(res, H_OK);
+  ck_assert_int_eq(h_async_get_result_json(conn, &j_result), H_OK);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "l")), 4*1024*1024);
+  json_decref(j_result);
+  o_free(large_query);
+#endif
+  
+  // The blocking functions are still available after an asynchronous query
+  ck_assert_int_eq(h_execute_query(conn, SELECT_DATA_1, &result, H_OPTION_SELECT), H_OK);
+  ck_assert_int_eq(result.nb_rows, 1);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+#endif
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
+START_TEST(test_hoel_pipeline)
+{
+  struct _h_result result;
+#ifdef PGSQL
+  json_t * j_query, * j_result;
+  struct _h_statement stmt;
+#endif
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+#ifndef PGSQL
+  // Pipeline mode is available with PostgreSQL only
+  ck_assert_int_eq(h_pipeline_begin(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pipeline_queue(conn, SELECT_DATA_1), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pipeline_get_result(conn, &result), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pipeline_end(conn), H_ERROR_PARAMS);
+#else
+  ck_assert_int_eq(h_pipeline_queue(conn, SELECT_DATA_1), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pipeline_begin(conn), H_OK);
+  ck_assert_int_eq(h_pipeline_begin(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pipeline_queue(conn, INSERT_DATA_1), H_OK);
+  j_query = json_pack("{sss{sisfssss}}", "table", "test_table", "values", "integer_col", 2, "double_col", 5.4, "string_col", "value2", "date_col", "2016-06-22");
+  ck_assert_int_eq(h_insert(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  ck_assert_int_eq(h_query_update(conn, UPDATE_DATA_1), H_OK);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_ALL, &result), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pipeline_queue(conn, SELECT_DATA_ALL), H_OK);
+  ck_assert_int_eq(h_pipeline_queue(conn, SELECT_DATA_1), H_OK);
+  ck_assert_int_eq(h_pipeline_get_result(conn, NULL), H_OK);
+  ck_assert_int_eq(h_pipeline_get_result(conn, NULL), H_OK);
+  ck_assert_int_eq(h_pipeline_get_result(conn, NULL), H_OK);
+  ck_assert_int_eq(h_pipeline_get_result(conn, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 2);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  ck_assert_int_eq(h_pipeline_get_result_json(conn, &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "string_col")), "new value1");
+  json_decref(j_result);
+  ck_assert_int_eq(h_pipeline_get_result(conn, NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_pipeline_end(conn), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+  
+  // A failed query aborts the queries queued before the next sync point
+  ck_assert_int_eq(h_pipeline_begin(conn), H_OK);
+  ck_assert_int_eq(h_pipeline_queue(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_pipeline_queue(conn, INSERT_DATA_ERROR), H_OK);
+  ck_assert_int_eq(h_pipeline_queue(conn, INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_pipeline_end(conn), H_ERROR_QUERY);
+  ck_assert_int_eq(h_query_select(conn, SELECT_DATA_ALL, &result), H_OK);
+  ck_assert_int_eq(result.nb_rows, 0);
+  ck_assert_int_eq(h_clean_result(&result), H_OK);
+  
+  // The json queries are queued without the statement cache, no statement can be prepared in a pipeline
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_pipeline_begin(conn), H_OK);
+  ck_assert_int_eq(h_prepare(conn, SELECT_DATA_2, &stmt), H_ERROR_PARAMS);
+  j_query = json_pack("{sss{ss}s{si}}", "table", "test_table", "set", "string_col", "new value2", "where", "integer_col", 2);
+  ck_assert_int_eq(h_update(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  ck_assert_int_eq(h_pipeline_queue(conn, SELECT_DATA_2), H_OK);
+  ck_assert_int_eq(h_pipeline_get_result(conn, NULL), H_OK);
+  ck_assert_int_eq(h_pipeline_get_result_json(conn, &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "string_col")), "new value2");
+  json_decref(j_result);
+  ck_assert_int_eq(h_pipeline_end(conn), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_ALL), H_OK);
+#endif
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
+START_TEST(test_hoel_transaction)
+{
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  json_t * j_result = NULL;
+  ck_assert_int_eq(h_transaction_begin(NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_commit(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_rollback(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_savepoint(conn, "sp1"), H_ERROR_PARAMS);
+  
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_transaction_begin(conn), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_1), H_OK);
+  ck_assert_int_eq(h_savepoint(conn, "sp1"), H_OK);
+  ck_assert_int_eq(h_savepoint(conn, "sp 1"), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_query_insert(conn, INSERT_DATA_2), H_OK);
+  ck_assert_int_eq(h_rollback_to_savepoint(conn, "sp1"), H_OK);
+  ck_assert_int_eq(h_release_savepoint(conn, "sp1"), H_OK);
+  ck_assert_int_eq(h_commit(conn), H_OK);
+  ck_assert_int_eq(h_query_select_json(conn, SELECT_DATA_1, &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  json_decref(j_result);
+  ck_assert_int_eq(h_query_select_json(conn, SELECT_DATA_2, &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 0);
+  json_decref(j_result);
+  
+  ck_assert_int_eq(h_transaction_begin(conn), H_OK);
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  ck_assert_int_eq(h_rollback(conn), H_OK);
+  ck_assert_int_eq(h_query_select_json(conn, SELECT_DATA_1, &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  json_decref(j_result);
+  
+  ck_assert_int_eq(h_query_delete(conn, DELETE_DATA_1), H_OK);
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
 START_TEST(test_hoel_json_insert)
 {
   
@@ -507,6 +886,176 @@ START_TEST(test_hoel_json_insert)
 }
 END_TEST
 
+START_TEST(test_hoel_json_upsert)
+{
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  char * str_query = NULL;
+  json_t * j_query = json_pack("{sss[{sisiss}{sisiss}]}",
+                               "table",
+                               "test_table",
+                               "values",
+                                 "id_col", 1001,
+                                 "integer_col", 1,
+                                 "string_col", "value1",
+                                 "id_col", 1002,
+                                 "integer_col", 2,
+                                 "string_col", "value2"),
+          * j_result = NULL;
+  ck_assert_int_eq(h_insert(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  
+  j_query = json_pack("{sss[{sisiss}{sisiss}]}",
+                      "table",
+                      "test_table",
+                      "values",
+                        "id_col", 1001,
+                        "integer_col", 11,
+                        "string_col", "new value1",
+                        "id_col", 1003,
+                        "integer_col", 3,
+                        "string_col", "value3");
+  ck_assert_int_eq(h_upsert(NULL, j_query, NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_upsert(conn, j_query, NULL), H_ERROR_PARAMS);
+  json_object_set_new(j_query, "conflict", json_pack("[]"));
+  ck_assert_int_eq(h_upsert(conn, j_query, NULL), H_ERROR_PARAMS);
+  json_object_set_new(j_query, "conflict", json_pack("[s]", "id_col"));
+  ck_assert_int_eq(h_upsert(conn, j_query, &str_query), H_OK);
+#ifdef MARIADB
+  ck_assert_str_eq(str_query, "INSERT INTO test_table (id_col,integer_col,string_col) VALUES (1001,11,'new value1'),(1003,3,'value3') ON DUPLICATE KEY UPDATE integer_col=VALUES(integer_col), string_col=VALUES(string_col)");
+#else
+  ck_assert_str_eq(str_query, "INSERT INTO test_table (id_col,integer_col,string_col) VALUES (1001,11,'new value1'),(1003,3,'value3') ON CONFLICT (id_col) DO UPDATE SET integer_col=excluded.integer_col, string_col=excluded.string_col");
+#endif
+  h_free(str_query);
+  
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT id_col, integer_col, string_col FROM test_table WHERE id_col > 1000 ORDER BY id_col", &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 3);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), 11);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "string_col")), "new value1");
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 1), "integer_col")), 2);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 2), "integer_col")), 3);
+  json_decref(j_result);
+  json_decref(j_query);
+  
+  j_query = json_pack("{sss{sisiss}s[s]s[s]}",
+                      "table",
+                      "test_table",
+                      "values",
+                        "id_col", 1002,
+                        "integer_col", 22,
+                        "string_col", "new value2",
+                      "conflict", "id_col",
+                      "update", "string_col");
+  ck_assert_int_eq(h_upsert(conn, j_query, NULL), H_OK);
+  json_object_set_new(j_query, "update", json_pack("[]"));
+  json_object_set_new(json_object_get(j_query, "values"), "string_col", json_string("value2 unchanged"));
+  ck_assert_int_eq(h_upsert(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  ck_assert_int_eq(h_execute_query_json(conn, "SELECT integer_col, string_col FROM test_table WHERE id_col = 1002", &j_result), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  ck_assert_int_eq(json_integer_value(json_object_get(json_array_get(j_result, 0), "integer_col")), 2);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "string_col")), "new value2");
+  json_decref(j_result);
+  
+  ck_assert_int_eq(h_query_delete(conn, "DELETE FROM test_table WHERE id_col > 1000"), H_OK);
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
+START_TEST(test_hoel_bulk_insert)
+{
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  json_t * j_query = json_pack("{sss[]}", "table", "test_table", "values"), * j_result = NULL;
+  ck_assert_int_eq(h_bulk_insert(conn, NULL), H_ERROR_PARAMS);
+  ck_assert_int_eq(h_bulk_insert(conn, j_query), H_ERROR_PARAMS);
+  json_decref(j_query);
+  // The columns are the keys of the first row, a key missing in the first row is an error
+  j_query = json_pack("{sss[{siss}{sisfss}]}",
+                      "table",
+                      "test_table",
+                      "values",
+                        "integer_col", 3,
+                        "string_col", "value1",
+                        "integer_col", 3,
+                        "double_col", 4.2,
+                        "string_col", "value2");
+  ck_assert_int_eq(h_bulk_insert(conn, j_query), H_ERROR_PARAMS);
+  json_decref(j_query);
+  j_query = json_pack("{sss{si}}", "table", "test_table", "where", "integer_col", 3);
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 0);
+  json_decref(j_result);
+  json_decref(j_query);
+  j_query = json_pack("{sss[{sisfss}{sisfss}{sisnss}]}",
+                      "table",
+                      "test_table",
+                      "values",
+                        "integer_col", 3,
+                        "double_col", 4.2,
+                        "string_col", "value\twith\ttabs",
+                        "integer_col", 3,
+                        "double_col", 5.4,
+                        "string_col", "value\nwith\\backslash",
+                        "integer_col", 3,
+                        "double_col",
+                        "string_col", UNSAFE_STRING);
+  ck_assert_int_eq(h_bulk_insert(conn, j_query), H_OK);
+  json_decref(j_query);
+  j_query = json_pack("{sss{si}ss}",
+                      "table",
+                      "test_table",
+                      "where",
+                        "integer_col",
+                        3,
+                      "order_by",
+                      "id_col");
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 3);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "string_col")), "value\twith\ttabs");
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 1), "string_col")), "value\nwith\\backslash");
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 2), "string_col")), UNSAFE_STRING);
+  ck_assert_double_eq(json_real_value(json_object_get(json_array_get(j_result, 1), "double_col")), 5.4);
+  ck_assert_int_eq(json_is_null(json_object_get(json_array_get(j_result, 2), "double_col")), 1);
+  json_decref(j_result);
+  ck_assert_int_eq(h_delete(conn, j_query, NULL), H_OK);
+  json_decref(j_query);
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
 START_TEST(test_hoel_json_update)
 {
   
@@ -1018,6 +1567,99 @@ START_TEST(test_hoel_json_select)
 }
 END_TEST
 
+START_TEST(test_hoel_json_statement_cache)
+{
+  json_t * j_query, * j_result = NULL;
+  unsigned long nb_hits, nb_prepared, nb_hits_after, nb_prepared_after;
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  h_execute_query(conn, "DROP TABLE IF EXISTS test_cache", NULL, H_OPTION_EXEC);
+  ck_assert_int_eq(h_execute_query(conn, "CREATE TABLE test_cache (a INTEGER)", NULL, H_OPTION_EXEC), H_OK);
+  ck_assert_int_eq(h_query_insert(conn, "INSERT INTO test_cache (a) VALUES (1)"), H_OK);
+  ck_assert_int_eq(h_get_statement_cache_stats(conn, &nb_hits, &nb_prepared), H_OK);
+  j_query = json_pack("{sss{si}}", "table", "test_cache", "where", "a", 1);
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_object_size(json_array_get(j_result, 0)), 1);
+  json_decref(j_result);
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  json_decref(j_result);
+  ck_assert_int_eq(h_get_statement_cache_stats(conn, &nb_hits_after, &nb_prepared_after), H_OK);
+  ck_assert_int_eq(nb_prepared_after - nb_prepared, 1);
+  ck_assert_int_eq(nb_hits_after - nb_hits, 1);
+  
+  // The cached SELECT * returns the new column after the table is altered
+  ck_assert_int_eq(h_execute_query(conn, "ALTER TABLE test_cache ADD COLUMN b INTEGER", NULL, H_OPTION_EXEC), H_OK);
+  ck_assert_int_eq(h_select(conn, j_query, &j_result, NULL), H_OK);
+  ck_assert_int_eq(json_array_size(j_result), 1);
+  ck_assert_int_eq(json_object_size(json_array_get(j_result, 0)), 2);
+  json_decref(j_result);
+  json_decref(j_query);
+  ck_assert_int_eq(h_execute_query(conn, "DROP TABLE test_cache", NULL, H_OPTION_EXEC), H_OK);
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
+START_TEST(test_hoel_prepare_placeholders)
+{
+  struct _h_statement stmt;
+  json_t * j_result = NULL;
+  
+  struct _h_connection * conn = NULL;
+#ifdef SQLITE
+  // Sqlite3
+  conn = h_connect_sqlite(SQLITE_BD_PATH);
+#endif
+  
+#ifdef MARIADB
+  // Mysql
+  conn = h_connect_mariadb(MARIADB_HOST, MARIADB_USER, MARIADB_PASSWD, MARIADB_DB, MARIADB_PORT, NULL);
+#endif
+  
+#ifdef PGSQL
+  // PostgreSQL
+  conn = h_connect_pgsql(PGSQL_CONNINFO);
+#endif
+  
+  // The ? in strings, quoted identifiers and comments aren't parameters
+  ck_assert_int_eq(h_prepare(conn, "SELECT '?' AS q, ? AS v /* ? */ -- ?\n", &stmt), H_OK);
+  ck_assert_int_eq(h_bind_text(&stmt, 1, "value"), H_OK);
+  ck_assert_int_eq(h_execute_prepared_json(&stmt, &j_result), H_OK);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "q")), "?");
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "v")), "value");
+  json_decref(j_result);
+  h_finalize(&stmt);
+#ifdef PGSQL
+  ck_assert_int_eq(h_prepare(conn, "SELECT $$?$$ AS d, $t$ $$ ? $t$ AS t, E'it\\'s ?' AS e, ?::text AS v /* a /* ? */ ? */", &stmt), H_OK);
+  ck_assert_int_eq(h_bind_text(&stmt, 1, "value"), H_OK);
+  ck_assert_int_eq(h_execute_prepared_json(&stmt, &j_result), H_OK);
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "d")), "?");
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "t")), " $$ ? ");
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "e")), "it's ?");
+  ck_assert_str_eq(json_string_value(json_object_get(json_array_get(j_result, 0), "v")), "value");
+  json_decref(j_result);
+  h_finalize(&stmt);
+#endif
+  h_close_db(conn);
+  h_clean_connection(conn);
+}
+END_TEST
+
 static Suite *hoel_suite(void)
 {
 	Suite *s;
@@ -1030,10 +1672,19 @@ static Suite *hoel_suite(void)
 	tcase_add_test(tc_core, test_hoel_insert);
 	tcase_add_test(tc_core, test_hoel_update);
 	tcase_add_test(tc_core, test_hoel_delete);
+	tcase_add_test(tc_core, test_hoel_binary_result);
+	tcase_add_test(tc_core, test_hoel_view);
+	tcase_add_test(tc_core, test_hoel_async);
+	tcase_add_test(tc_core, test_hoel_pipeline);
+	tcase_add_test(tc_core, test_hoel_transaction);
 	tcase_add_test(tc_core, test_hoel_json_insert);
+	tcase_add_test(tc_core, test_hoel_json_upsert);
+	tcase_add_test(tc_core, test_hoel_bulk_insert);
 	tcase_add_test(tc_core, test_hoel_json_update);
 	tcase_add_test(tc_core, test_hoel_json_delete);
 	tcase_add_test(tc_core, test_hoel_json_select);
+	tcase_add_test(tc_core, test_hoel_json_statement_cache);
+	tcase_add_test(tc_core, test_hoel_prepare_placeholders);
 	tcase_set_timeout(tc_core, 30);
 	suite_add_tcase(s, tc_core);
 